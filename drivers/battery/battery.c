@@ -10,7 +10,9 @@
  *
  */
 
+#include <stdbool.h>
 #include "nrf_drv_saadc.h"
+#include "app_util_platform.h"
 #include "battery.h"
 #include "boards.h" //For reverse voltage protection define
 #define NRF_LOG_MODULE_NAME "ADC"
@@ -18,13 +20,58 @@
 #include "nrf_log_ctrl.h"
 
 #define ADC_REF_VOLTAGE_IN_MILLIVOLTS  600  //!< Reference voltage (in milli volts) used by ADC while doing conversion.
-#define ADC_RES_10BIT                  1024 //!< Maximum digital value for 10-bit ADC conversion.
-#define ADC_PRE_SCALING_COMPENSATION   6    //!< The ADC is configured to use VDD with 1/3 prescaling as input. And hence the result of conversion is to be multiplied by 3 to get the actual value of the battery voltage.
+#define ADC_RES_12BIT                  4096 //!< Maximum digital value for 12-bit ADC conversion.
+#define ADC_PRE_SCALING_COMPENSATION   6    //!< The ADC is configured to use VDD with 1/6 gain as input. And hence the result of conversion is to be multiplied by 6 to get the actual value of the battery voltage.
 #define ADC_RESULT_IN_MILLI_VOLTS(ADC_VALUE) \
-    ((((ADC_VALUE) *ADC_REF_VOLTAGE_IN_MILLIVOLTS) / ADC_RES_10BIT) * ADC_PRE_SCALING_COMPENSATION)
+    (((ADC_VALUE) * ADC_REF_VOLTAGE_IN_MILLIVOLTS * ADC_PRE_SCALING_COMPENSATION) / ADC_RES_12BIT)
+#define ADC_OVERSAMPLE                 NRF_SAADC_OVERSAMPLE_8X //!< Averaged in hardware, burst mode takes all conversions with one sample task.
+#define AVERAGE_MAX_SAMPLES            (1 << 12) //!< Sum and count are halved at this count to keep average recent and sum in 32 bits.
 
 static nrf_saadc_value_t adc_buf;           //!< Buffer used for storing ADC values.
 static uint8_t battery_is_init = 0;
+static volatile bool m_busy = false;        //!< Sample started and not filtered yet, SAADC handler may be preempted by radio notification.
+static battery_sample_t m_type = BATTERY_SAMPLE_IDLE;
+
+// Filter states are scaled by 2^BATTERY_FILTER_SHIFT, updated in SAADC interrupt
+static uint32_t m_idle_state = 0;
+static uint32_t m_loaded_state = 0;
+static bool m_loaded_valid = false;
+static uint16_t m_min_loaded = UINT16_MAX;
+static uint32_t m_idle_sum = 0;
+static uint32_t m_idle_count = 0;
+
+static uint16_t to_millivolts(const nrf_saadc_value_t value)
+{
+    // Noise can give slightly negative results at 0 V
+    const int32_t mv = (value < 0) ? 0 : ADC_RESULT_IN_MILLI_VOLTS((int32_t)value);
+    return mv + REVERSE_PROT_VOLT_DROP_MILLIVOLTS;
+}
+
+/** Low-pass filter state += sample - state / 2^BATTERY_FILTER_SHIFT, first sample initialises state */
+static void low_pass(uint32_t* const state, const uint16_t sample, const bool valid)
+{
+    if(!valid) { *state = (uint32_t)sample << BATTERY_FILTER_SHIFT; }
+    else { *state = *state - (*state >> BATTERY_FILTER_SHIFT) + sample; }
+}
+
+static void process_sample(const battery_sample_t type, const uint16_t mv)
+{
+    if(BATTERY_SAMPLE_LOADED == type)
+    {
+        low_pass(&m_loaded_state, mv, m_loaded_valid);
+        m_loaded_valid = true;
+        if(mv < m_min_loaded) { m_min_loaded = mv; }
+        return;
+    }
+    low_pass(&m_idle_state, mv, 0 != m_idle_count);
+    if(AVERAGE_MAX_SAMPLES <= m_idle_count)
+    {
+        m_idle_sum /= 2;
+        m_idle_count /= 2;
+    }
+    m_idle_sum += mv;
+    m_idle_count++;
+}
 
 /**@brief Function handling events from 'nrf_drv_saadc.c'.
  *
@@ -35,38 +82,65 @@ static void saadc_event_handler(nrf_drv_saadc_evt_t const * p_evt)
 
     if (p_evt->type == NRF_DRV_SAADC_EVT_DONE)
     {
-      NRF_LOG_DEBUG("ADC done \r\n");
+      process_sample(m_type, to_millivolts(p_evt->data.done.p_buffer[0]));
+      m_busy = false;
     }
 }
 
 
 void battery_voltage_init(void)
 {
-    ret_code_t err_code = nrf_drv_saadc_init(NULL, saadc_event_handler);
+    nrf_drv_saadc_config_t saadc_config = NRF_DRV_SAADC_DEFAULT_CONFIG;
+    saadc_config.resolution = NRF_SAADC_RESOLUTION_12BIT;
+    saadc_config.oversample = ADC_OVERSAMPLE;
+    saadc_config.low_power_mode = true; // Start SAADC only for a sample
+    ret_code_t err_code = nrf_drv_saadc_init(&saadc_config, saadc_event_handler);
 
     APP_ERROR_CHECK(err_code);
 
     nrf_saadc_channel_config_t config = NRF_DRV_SAADC_DEFAULT_CHANNEL_CONFIG_SE(NRF_SAADC_INPUT_VDD);
     err_code = nrf_drv_saadc_channel_init(0, &config);
     APP_ERROR_CHECK(err_code);
+    // Oversampling needs a sample task per conversion unless burst is enabled, SDK 12 channel config has no field for burst
+    NRF_SAADC->CH[0].CONFIG |= (SAADC_CH_CONFIG_BURST_Enabled << SAADC_CH_CONFIG_BURST_Pos);
+
+    // Start filters with a blocking sample while radio is off
+    err_code = nrf_drv_saadc_sample_convert(0, &adc_buf);
+    APP_ERROR_CHECK(err_code);
+    process_sample(BATTERY_SAMPLE_IDLE, to_millivolts(adc_buf));
 
     battery_is_init = 1;
 }
 
+ret_code_t battery_sample_start(const battery_sample_t type)
+{
+    if(!battery_is_init) { return NRF_ERROR_INVALID_STATE; }
+    if(m_busy || nrf_drv_saadc_is_busy()) { return NRF_ERROR_BUSY; }
+    m_busy = true;
+    m_type = type;
+    ret_code_t err_code = nrf_drv_saadc_buffer_convert(&adc_buf, 1);
+    if(NRF_SUCCESS == err_code) { err_code = nrf_drv_saadc_sample(); }
+    if(NRF_SUCCESS != err_code) { m_busy = false; }
+    return err_code;
+}
 
 uint16_t getBattery(void)
 {
-    ret_code_t err_code;
     if(!battery_is_init)
     {
       battery_voltage_init();
     }
+    return m_idle_state >> BATTERY_FILTER_SHIFT;
+}
 
-    if (!nrf_drv_saadc_is_busy())
-    {
-        err_code = nrf_drv_saadc_sample_convert(NRF_SAADC_INPUT_VDD, &adc_buf);
-        APP_ERROR_CHECK(err_code);
-
-    }
-    return ADC_RESULT_IN_MILLI_VOLTS(adc_buf) + REVERSE_PROT_VOLT_DROP_MILLIVOLTS;
+void battery_stats_get(battery_stats_t* const stats)
+{
+    if(NULL == stats) { return; }
+    CRITICAL_REGION_ENTER();
+    stats->idle_mv = m_idle_state >> BATTERY_FILTER_SHIFT;
+    stats->average_mv = m_idle_count ? m_idle_sum / m_idle_count : 0;
+    stats->min_mv = m_loaded_valid ? m_min_loaded : 0;
+    const uint16_t loaded_mv = m_loaded_state >> BATTERY_FILTER_SHIFT;
+    stats->sag_mv = (m_loaded_valid && stats->idle_mv > loaded_mv) ? stats->idle_mv - loaded_mv : 0;
+    CRITICAL_REGION_EXIT();
 }
@@ -14,19 +14,55 @@
 #define BATTERY_VOLTAGE_H__
 
 #include <stdint.h>
+#include "sdk_errors.h"
+
+/** Weight of new sample in low-pass filters is 1 / 2^BATTERY_FILTER_SHIFT */
+#define BATTERY_FILTER_SHIFT 3
+
+/** Battery is sampled idle, before radio activity, or loaded, right after radio TX */
+typedef enum {
+  BATTERY_SAMPLE_IDLE,
+  BATTERY_SAMPLE_LOADED
+}battery_sample_t;
+
+/** Battery statistics in millivolts */
+typedef struct {
+  uint16_t idle_mv;    /**< Low-passed idle voltage, same as getBattery() */
+  uint16_t average_mv; /**< Average of idle samples, older samples are halved out of the average */
+  uint16_t min_mv;     /**< Lowest loaded sample */
+  uint16_t sag_mv;     /**< Low-passed drop from idle to loaded voltage, grows with internal resistance of battery */
+}battery_stats_t;
 
 /**@brief Function for initializing the battery voltage module.
+ *
+ * Configures SAADC with oversampling and takes one blocking sample to start filters.
+ * Call before SoftDevice is enabled.
  */
 void battery_voltage_init(void);
 
+/**@brief Start an asynchronous battery sample. Result is filtered in SAADC interrupt.
+ *
+ * Can be called in interrupt context, e.g. from radio notification.
+ *
+ * @param[in] type Idle or loaded sample
+ * @returns NRF_SUCCESS if sample was started, NRF_ERROR_BUSY if previous sample is in progress,
+ *          NRF_ERROR_INVALID_STATE if module is not initialised.
+ */
+ret_code_t battery_sample_start(const battery_sample_t type);
 
 /**@brief Function for reading the battery voltage.
  *
  * If battery ADC is not already initialised, this function
- * initialises battery reading automatically. 
+ * initialises battery reading automatically. Does not use ADC otherwise.
  *
- * @returns battery voltage in millivolts.
+ * @returns low-passed idle battery voltage in millivolts.
  */
 uint16_t getBattery(void);
 
+/**@brief Copy battery statistics.
+ *
+ * Loaded statistics are 0 until first loaded sample.
+ */
+void battery_stats_get(battery_stats_t* const stats);
+
 #endif
@@ -0,0 +1,37 @@
+#include "battery_handler.h"
+#include "battery.h"
+
+#include <string.h>
+
+static ret_code_t read_battery(const ruuvi_standard_message_t message)
+{
+  battery_stats_t stats;
+  battery_stats_get(&stats);
+  const uint16_t values[4] = { stats.idle_mv, stats.average_mv, stats.min_mv, stats.sag_mv };
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = BATTERY,
+                                     .type                 = UINT16,
+                                     .payload              = {0}};
+  memcpy(reply.payload, values, sizeof(reply.payload));
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler) { return p_reply_handler(reply); }
+  return ENDPOINT_HANDLER_ERROR;
+}
+
+/**
+ *  Handles incoming messages.
+ */
+ret_code_t battery_handler(const ruuvi_standard_message_t message)
+{
+  //Return if message was not meant for this endpoint.
+  if(BATTERY != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  switch(message.type)
+  {
+    case DATA_QUERY:
+      return read_battery(message);
+
+    default:
+      return unknown_handler(message);
+  }
+  return ENDPOINT_HANDLER_ERROR; // Should not be reached
+}
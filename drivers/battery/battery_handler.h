@@ -0,0 +1,23 @@
+#ifndef BATTERY_HANDLER_H
+#define BATTERY_HANDLER_H
+
+/**
+ *  Handler for BATTERY endpoint.
+ *
+ *  DATA_QUERY is replied with UINT16 array of battery statistics in millivolts:
+ *  low-passed idle voltage, average idle voltage, lowest loaded voltage and sag from idle to loaded voltage.
+ *  See battery_stats_t.
+ */
+
+#include "ruuvi_endpoints.h"
+#include "nrf_error.h"
+
+/**
+ *  Handle messages with "BATTERY" as destination endpoint. This should not be called directly, but rather
+ *  through ruuvi_endpoints function route_message.
+ *
+ *  Returns error code from endpoint, i.e. ENDPOINT_SUCCESS if message was understood.
+ */
+ret_code_t battery_handler(const ruuvi_standard_message_t message);
+
+#endif
@@ -4,6 +4,7 @@
 #include "nrf_queue.h"
 #include "nrf_error.h"
 
+#include "counters.h"
 #include "ruuvi_endpoints.h"
 
 #define NRF_LOG_MODULE_NAME "BLE_BULK_TX"
@@ -28,7 +29,7 @@ ble_nus_t* p_nus;
  **/
 bulk_transfer_ret_t ble_bulk_transfer_asynchronous(const ruuvi_endpoint_t endpoint, uint8_t* data, const size_t length)
 {
-  if(!nrf_queue_available_get(&m_ble_tx_queue)) { return NRF_ERROR_NO_MEM; }
+  if(!nrf_queue_available_get(&m_ble_tx_queue)) { COUNTER_INC(COUNTER_NUS_DROPPED); return NRF_ERROR_NO_MEM; }
   if(BLE_BULK_TX_MAX_SIZE < length) { return TX_ERROR_MAX_SIZE_EXCEEDED; }
   
   uint8_t num_chunks = (length/BLE_CHUNK_SIZE);
@@ -51,6 +52,8 @@ bulk_transfer_ret_t ble_bulk_transfer_asynchronous(const ruuvi_endpoint_t endpoi
 
 ret_code_t ble_std_transfer_asynchronous(const ruuvi_standard_message_t message)
 {
+  // Queue overwrites oldest message when full
+  if(nrf_queue_is_full(&m_std_tx_queue)) { COUNTER_INC(COUNTER_NUS_DROPPED); }
   NRF_LOG_DEBUG("STD message added to queue\r\n");
   return nrf_queue_push(&m_std_tx_queue, &message);
 }
@@ -156,6 +159,12 @@ ret_code_t ble_message_queue_process(void)
   return err_code;
 }
 
+/** Continue queued transfers when SoftDevice has room for more packets **/
+void ble_bulk_scheduler_event_handler(void *p_event_data, uint16_t event_size)
+{
+  ble_message_queue_process();
+}
+
 /**
  *  Asynchronous transfer of raw binary data, max 20 bytes per chunk.
  *  This function is meant for driver's own use only. 
@@ -167,6 +176,8 @@ ret_code_t ble_transfer_raw(uint8_t* data, size_t length)
   uint32_t       err_code;
   memcpy(&data_array, data, length);  
   err_code = ble_nus_string_send(p_nus, data_array, length);
+  // Packet is retried on TX complete
+  if(BLE_ERROR_NO_TX_PACKETS == err_code) { COUNTER_INC(COUNTER_SD_RESOURCES); }
   return err_code;
 }
 
@@ -46,6 +46,9 @@ ret_code_t ble_std_transfer_asynchronous(const ruuvi_standard_message_t message)
 
 ret_code_t ble_message_queue_process(void);
 
+/** Scheduler event handler to process message queue, schedule on BLE TX complete **/
+void ble_bulk_scheduler_event_handler(void *p_event_data, uint16_t event_size);
+
 ret_code_t ble_transfer_raw(uint8_t* data, size_t length);
 
 ret_code_t ble_bulk_message_queue_purge(void);
@@ -12,6 +12,7 @@
 
 #include "bluetooth_config.h"
 #include "app_scheduler.h"
+#include "ble_bulk_transfer.h"
 
 #if APPLICATION_GATT
 #include "application_ble_event_handlers.h"
@@ -119,6 +120,11 @@ void on_ble_evt(ble_evt_t * p_ble_evt)
             NRF_LOG_INFO("Disconnected\r\n");
             break; // BLE_GAP_EVT_DISCONNECTED
 
+        case BLE_EVT_TX_COMPLETE:
+            // Queued bulk transfers wait for free SoftDevice buffers
+            app_sched_event_put(NULL, 0, ble_bulk_scheduler_event_handler);
+            break; // BLE_EVT_TX_COMPLETE
+
         case BLE_GAP_EVT_SEC_PARAMS_REQUEST:
             // Pairing not supported
             err_code = sd_ble_gap_sec_params_reply(m_conn_handle, BLE_GAP_SEC_STATUS_PAIRING_NOT_SUPP, NULL, NULL);
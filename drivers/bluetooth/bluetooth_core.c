@@ -25,6 +25,8 @@
 #include "peer_manager.h"
 #include "sdk_errors.h"
 #include "nrf_delay.h"
+#include "app_scheduler.h"
+#include "counters.h"
 
 #include "bluetooth_config.h"
 #include "bluetooth_application_config.h"
@@ -141,6 +143,20 @@ static ble_gap_conn_params_t   gap_conn_params;
 static ble_gap_conn_sec_mode_t sec_mode;
 static ble_advdata_manuf_data_t m_manufacturer_data;
 
+/** Precomputed advertisement data of interleaved advertising */
+typedef struct
+{
+  uint8_t  data[BLE_GAP_ADV_MAX_SIZE];
+  uint16_t length;
+  uint16_t period;     // Advertising events between transmissions, 0 if disabled
+  uint16_t countdown;  // Advertising events until slot is due
+}advertising_slot_t;
+
+static advertising_slot_t m_slots[BLUETOOTH_ADV_SLOTS];
+static uint8_t m_current_slot = BLUETOOTH_ADV_SLOT_PRIMARY;
+static volatile uint8_t m_next_slot = BLUETOOTH_ADV_SLOT_PRIMARY;
+static volatile uint32_t m_adv_event_count = 0;
+
 /**
  * Generate name "BASEXXXX", where Base is human-readable (i.e. Ruuvi) and XXXX is  last 4 chars of mac address
  *
@@ -510,7 +526,13 @@ ret_code_t bluetooth_set_manufacturer_data(uint8_t* data, size_t length)
     memset(&advdata, 0, sizeof(advdata));
     advdata.p_manuf_specific_data = &m_manufacturer_data;
     advdata.flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
-    err_code |= ble_advdata_set(&advdata, &scanresp);
+    err_code |= bluetooth_advertising_slot_set(BLUETOOTH_ADV_SLOT_PRIMARY, &advdata, 1);
+    // Don't overwrite interleaved slot on air, primary data gets swapped in after next advertisement.
+    if(BLUETOOTH_ADV_SLOT_PRIMARY == m_current_slot)
+    {
+      err_code |= ble_advdata_set(&advdata, &scanresp);
+    }
+    COUNTER_INC(COUNTER_ADV_UPDATES);
   }
   NRF_LOG_DEBUG("ADV data status %s\r\n", (uint32_t)ERR_TO_STR(err_code));
 
@@ -531,3 +553,124 @@ ret_code_t bluetooth_set_eddystone_url(char* url_buffer, size_t length)
   err_code |= ble_advdata_set(&advdata, &scanresp);
   return err_code;
 }
+
+/**
+ * Precompute advertisement data of a slot.
+ *
+ * @param slot slot index, 0 ... BLUETOOTH_ADV_SLOTS - 1
+ * @param advdata data to encode into slot.
+ * @param period number of advertising events between transmissions of slot. 0 disables slot.
+ */
+ret_code_t bluetooth_advertising_slot_set(uint8_t slot, const ble_advdata_t* advdata, uint16_t period)
+{
+  if(BLUETOOTH_ADV_SLOTS <= slot) { return NRF_ERROR_INVALID_PARAM; }
+  if(BLUETOOTH_ADV_SLOT_PRIMARY == slot) { period = 1; }
+  uint16_t length = sizeof(m_slots[slot].data);
+  ret_code_t err_code = adv_data_encode(advdata, m_slots[slot].data, &length);
+  if(NRF_SUCCESS != err_code) { return err_code; }
+  m_slots[slot].length = length;
+  // Keep phase of slot if only data changes
+  if(m_slots[slot].period != period)
+  {
+    m_slots[slot].countdown = period;
+    m_slots[slot].period = period;
+  }
+  return NRF_SUCCESS;
+}
+
+ret_code_t bluetooth_advertising_slot_clear(uint8_t slot)
+{
+  if(BLUETOOTH_ADV_SLOTS <= slot || BLUETOOTH_ADV_SLOT_PRIMARY == slot) { return NRF_ERROR_INVALID_PARAM; }
+  m_slots[slot].period = 0;
+  return NRF_SUCCESS;
+}
+
+ret_code_t bluetooth_advertising_slot_set_eddystone_url(uint8_t slot, char* url_buffer, size_t length, uint16_t period)
+{
+  ble_advdata_t url;
+  ret_code_t err_code = eddystone_prepare_url_advertisement(&url, url_buffer, length);
+  if(NRF_SUCCESS != err_code) { return err_code; }
+  return bluetooth_advertising_slot_set(slot, &url, period);
+}
+
+ret_code_t bluetooth_advertising_slot_set_eddystone_tlm(uint8_t slot, uint16_t vbatt, int32_t temperature, uint64_t uptime_ms, uint16_t period)
+{
+  ble_advdata_t tlm;
+  ret_code_t err_code = eddystone_prepare_tlm_advertisement(&tlm, vbatt, temperature, m_adv_event_count, uptime_ms);
+  if(NRF_SUCCESS != err_code) { return err_code; }
+  return bluetooth_advertising_slot_set(slot, &tlm, period);
+}
+
+ret_code_t bluetooth_advertising_slot_set_identity(uint8_t slot, uint16_t period)
+{
+  ble_advdata_t identity;
+  memset(&identity, 0, sizeof(identity));
+  identity.name_type = BLE_ADVDATA_FULL_NAME;
+  identity.flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+  identity.p_tx_power_level = &tx_power;
+  return bluetooth_advertising_slot_set(slot, &identity, period);
+}
+
+ret_code_t bluetooth_advertising_slot_set_manufacturer_data(uint8_t slot, const uint8_t* data, size_t length, uint16_t period)
+{
+  if(24 < length || NULL == data) { return NRF_ERROR_INVALID_PARAM; }
+  ble_advdata_manuf_data_t manufacturer_data;
+  manufacturer_data.company_identifier = BLE_COMPANY_IDENTIFIER;
+  manufacturer_data.data.size = length;
+  manufacturer_data.data.p_data = (uint8_t*)data;
+  ble_advdata_t slot_data;
+  memset(&slot_data, 0, sizeof(slot_data));
+  slot_data.p_manuf_specific_data = &manufacturer_data;
+  slot_data.flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+  // Slot is encoded immediately, data does not need to outlive the call
+  return bluetooth_advertising_slot_set(slot, &slot_data, period);
+}
+
+/**
+ * Put precomputed data of next slot on air. Runs in scheduler.
+ */
+static void advertising_slot_swap(void* p_event_data, uint16_t event_size)
+{
+  uint8_t slot = m_next_slot;
+  if(slot == m_current_slot || 0 == m_slots[slot].length) { return; }
+  // NULL scan response keeps current scan response data.
+  ret_code_t err_code = sd_ble_gap_adv_data_set(m_slots[slot].data, m_slots[slot].length, NULL, 0);
+  if(NRF_SUCCESS == err_code)
+  {
+    m_current_slot = slot;
+    if(BLUETOOTH_ADV_SLOT_PRIMARY != slot) { COUNTER_INC(COUNTER_ADV_SLOT_SWAPS); }
+  }
+  else { NRF_LOG_DEBUG("Slot swap failed: %d\r\n", err_code); }
+}
+
+/**
+ * Choose slot for next advertising event after radio has been active.
+ * Each enabled slot counts down its period, first due slot replaces primary data for one event.
+ * Slots which are due but not chosen stay due and are sent on following events.
+ */
+void bluetooth_advertising_scheduler_radio_evt(bool active)
+{
+  if(active) { return; }
+  m_adv_event_count++;
+  uint8_t next = BLUETOOTH_ADV_SLOT_PRIMARY;
+  for(uint8_t ii = BLUETOOTH_ADV_SLOT_PRIMARY + 1; ii < BLUETOOTH_ADV_SLOTS; ii++)
+  {
+    if(0 == m_slots[ii].period) { continue; }
+    if(m_slots[ii].countdown) { m_slots[ii].countdown--; }
+    if(0 == m_slots[ii].countdown && BLUETOOTH_ADV_SLOT_PRIMARY == next)
+    {
+      next = ii;
+      m_slots[ii].countdown = m_slots[ii].period;
+    }
+  }
+  if(next != m_current_slot)
+  {
+    m_next_slot = next;
+    app_sched_event_put(NULL, 0, advertising_slot_swap);
+  }
+}
+
+uint32_t bluetooth_advertising_event_count(void)
+{
+  return m_adv_event_count;
+}
@@ -109,4 +109,74 @@ ret_code_t bluetooth_configure_advertisement_type(uint8_t type);
  *        as long as https:// is written as 0x03
  */
 ret_code_t bluetooth_set_eddystone_url(char* url_buffer, size_t length);
+
+/** Advertisement slots of interleaved advertising. Slot 0 is primary, sent when no other slot is due */
+#define BLUETOOTH_ADV_SLOT_PRIMARY   0
+#define BLUETOOTH_ADV_SLOT_URL       1
+#define BLUETOOTH_ADV_SLOT_TLM       2
+#define BLUETOOTH_ADV_SLOT_IDENTITY  3
+#define BLUETOOTH_ADV_SLOT_COUNTERS  4
+#define BLUETOOTH_ADV_SLOTS          5
+
+/**
+ * Precompute advertisement data of a slot.
+ * Slot is sent once every period advertising events in place of primary data.
+ * Slots are swapped after radio activity, see bluetooth_advertising_scheduler_radio_evt.
+ *
+ * @param slot slot index, 0 ... BLUETOOTH_ADV_SLOTS - 1
+ * @param advdata data to encode into slot.
+ * @param period number of advertising events between transmissions of slot. 0 disables slot. Primary slot is always enabled.
+ * @return NRF_ERROR_INVALID_PARAM if slot is invalid, error code from encoding otherwise.
+ */
+ret_code_t bluetooth_advertising_slot_set(uint8_t slot, const ble_advdata_t* advdata, uint16_t period);
+
+/**
+ * Disable a slot. Primary slot cannot be disabled.
+ */
+ret_code_t bluetooth_advertising_slot_clear(uint8_t slot);
+
+/**
+ * Precompute Eddystone URL into given slot.
+ * @param url_buffer see bluetooth_set_eddystone_url
+ * @param length see bluetooth_set_eddystone_url
+ * @param period see bluetooth_advertising_slot_set
+ */
+ret_code_t bluetooth_advertising_slot_set_eddystone_url(uint8_t slot, char* url_buffer, size_t length, uint16_t period);
+
+/**
+ * Precompute Eddystone TLM into given slot. Advertisement count is tracked by the scheduler.
+ * @param vbatt battery voltage in millivolts
+ * @param temperature temperature in 1/100 C
+ * @param uptime_ms milliseconds since boot
+ * @param period see bluetooth_advertising_slot_set
+ */
+ret_code_t bluetooth_advertising_slot_set_eddystone_tlm(uint8_t slot, uint16_t vbatt, int32_t temperature, uint64_t uptime_ms, uint16_t period);
+
+/**
+ * Precompute identity frame with complete device name into given slot.
+ * @param period see bluetooth_advertising_slot_set
+ */
+ret_code_t bluetooth_advertising_slot_set_identity(uint8_t slot, uint16_t period);
+
+/**
+ * Precompute manufacturer specific data with Ruuvi company identifier into given slot.
+ * @param data data after company identifier, copied into slot
+ * @param length length of data, at most 24 bytes
+ * @param period see bluetooth_advertising_slot_set
+ */
+ret_code_t bluetooth_advertising_slot_set_manufacturer_data(uint8_t slot, const uint8_t* data, size_t length, uint16_t period);
+
+/**
+ * Advance interleaved advertising. Call from radio notification handler, i.e. interrupt context.
+ * Chooses the slot for the next advertising event after radio goes inactive and swaps the
+ * precomputed data in scheduler, as SoftDevice cannot be called from radio notification priority.
+ *
+ * @param active true if radio is going to be active, false if radio was turned off.
+ */
+void bluetooth_advertising_scheduler_radio_evt(bool active);
+
+/**
+ * Return number of advertising events since boot, as counted by bluetooth_advertising_scheduler_radio_evt.
+ */
+uint32_t bluetooth_advertising_event_count(void);
 #endif
@@ -32,12 +32,16 @@
 #include "bluetooth_core.h"
 #include "bsp.h"
 #include "es.h"
+#include "ruuvi_format_definitions.h"
 
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 
 #include "bluetooth_core.h"
 #define EDDYSTONE_UUID 0xFEAA
+#define EDDYSTONE_TLM_TEMPERATURE_NOT_SUPPORTED 0x8000
+#define EDDYSTONE_TLM_LENGTH  14   // Frame type, version, vbatt, temperature, adv count, uptime
+#define EDDYSTONE_TLM_VERSION 0x00 // Unencrypted TLM
 /**
  *  @brief Helper for advertising Eddystone URLs. 
  *
@@ -45,7 +49,7 @@
  *  @param url url to advertise. May include prefix and suffix bytes, such as 0x03 for https://
  *  @param length length of URL to advertise. 
  *  @return Error code, 0 on success
- *  TODO: Refactor static variables out
+ *  advdata points to static buffers of this function, valid until next call.
  */
 ret_code_t eddystone_prepare_url_advertisement(ble_advdata_t* advdata, char* url, size_t length)
 {
@@ -80,3 +84,60 @@ ret_code_t eddystone_prepare_url_advertisement(ble_advdata_t* advdata, char* url
 
     return NRF_SUCCESS;
 }
+
+/**
+ *  @brief Helper for advertising unencrypted Eddystone TLM frames.
+ *
+ *  @param advdata Advertisement data which will be filled with Eddystone TLM
+ *  @param vbatt battery voltage in millivolts, 0 if not supported
+ *  @param temperature temperature in 1/100 C, TLM encodes it as signed 8.8 fixed point.
+ *                    TEMPERATURE_INVALID is sent as 0x8000, not supported
+ *  @param adv_count number of advertisements sent since boot
+ *  @param uptime_ms time since boot in milliseconds, TLM encodes it in 0.1 s resolution
+ *  @return Error code, 0 on success
+ *  advdata points to static buffers of this function, valid until next call.
+ */
+ret_code_t eddystone_prepare_tlm_advertisement(ble_advdata_t* advdata, uint16_t vbatt, int32_t temperature, uint32_t adv_count, uint64_t uptime_ms)
+{
+    static ble_uuid_t    adv_uuids[] = {{EDDYSTONE_UUID, BLE_UUID_TYPE_BLE}};
+    static uint8_t       eddystone_tlm_data[EDDYSTONE_TLM_LENGTH];
+    static ble_advdata_service_data_t service_data;
+
+    // 0x8000 is reserved for not supported, valid values saturate to +-127.996 C
+    uint16_t temperature_8_8 = EDDYSTONE_TLM_TEMPERATURE_NOT_SUPPORTED;
+    if(TEMPERATURE_INVALID != temperature)
+    {
+        int64_t fixed = ((int64_t)temperature * 256) / 100;
+        if(fixed > INT16_MAX)  { fixed = INT16_MAX; }
+        if(fixed < -INT16_MAX) { fixed = -INT16_MAX; }
+        temperature_8_8 = (uint16_t)(int16_t)fixed;
+    }
+    uint32_t uptime = uptime_ms / 100;
+    eddystone_tlm_data[0]  = ES_FRAME_TYPE_TLM;                     // Eddystone TLM frame type.
+    eddystone_tlm_data[1]  = EDDYSTONE_TLM_VERSION;
+    eddystone_tlm_data[2]  = vbatt >> 8;
+    eddystone_tlm_data[3]  = vbatt & 0xFF;
+    eddystone_tlm_data[4]  = temperature_8_8 >> 8;
+    eddystone_tlm_data[5]  = temperature_8_8 & 0xFF;
+    eddystone_tlm_data[6]  = adv_count >> 24;
+    eddystone_tlm_data[7]  = adv_count >> 16;
+    eddystone_tlm_data[8]  = adv_count >> 8;
+    eddystone_tlm_data[9]  = adv_count & 0xFF;
+    eddystone_tlm_data[10] = uptime >> 24;
+    eddystone_tlm_data[11] = uptime >> 16;
+    eddystone_tlm_data[12] = uptime >> 8;
+    eddystone_tlm_data[13] = uptime & 0xFF;
+
+    service_data.service_uuid = EDDYSTONE_UUID;
+    service_data.data.p_data  = eddystone_tlm_data;
+    service_data.data.size    = sizeof(eddystone_tlm_data);
+
+    memset(advdata, 0, sizeof(ble_advdata_t));
+    advdata->flags = BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE;
+    advdata->uuids_complete.uuid_cnt = sizeof(adv_uuids) / sizeof(adv_uuids[0]);
+    advdata->uuids_complete.p_uuids  = adv_uuids;
+    advdata->p_service_data_array    = &service_data;
+    advdata->service_data_count      = 1;
+
+    return NRF_SUCCESS;
+}
@@ -15,4 +15,17 @@
  */
  ret_code_t eddystone_prepare_url_advertisement(ble_advdata_t* advdata, char* url, size_t length);
 
+/**
+ *  @brief Helper for advertising unencrypted Eddystone TLM frames.
+ *
+ *  @param advdata Advertisement data which will be filled with Eddystone TLM
+ *  @param vbatt battery voltage in millivolts, 0 if not supported
+ *  @param temperature temperature in 1/100 C, TLM encodes it as signed 8.8 fixed point.
+ *                    TEMPERATURE_INVALID is sent as 0x8000, not supported
+ *  @param adv_count number of advertisements sent since boot
+ *  @param uptime_ms time since boot in milliseconds, TLM encodes it in 0.1 s resolution
+ *  @return Error code, 0 on success
+ */
+ ret_code_t eddystone_prepare_tlm_advertisement(ble_advdata_t* advdata, uint16_t vbatt, int32_t temperature, uint32_t adv_count, uint64_t uptime_ms);
+
 #endif
@@ -0,0 +1,144 @@
+/**
+ *  Host harness for BME280 pressure compensation formulas.
+ *
+ *  Sweeps full 20-bit pressure ADC range over -40...85 C for each calibration set and
+ *  compares 64-bit and 32-bit integer formulas against double precision reference.
+ *  Error is reported within operating range of sensor, 300...1100 hPa.
+ *  Cycles per call are read from time stamp counter on x86, nanoseconds elsewhere.
+ */
+#include "bme280_compensation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_CYCLE_COUNTER 1
+#else
+#define HAS_CYCLE_COUNTER 0
+#endif
+
+#define PRESSURE_MIN_PA     30000.0
+#define PRESSURE_MAX_PA     110000.0
+#define TEMPERATURE_MIN     -4000
+#define TEMPERATURE_MAX     8500
+#define ADC_T_STEP          0x100
+#define ADC_P_STEP          31
+#define BENCHMARK_ROUNDS    200
+#define BENCHMARK_INPUTS    1024
+
+typedef struct
+{
+  const char* name;
+  struct comp_params cp;
+}calibration_t;
+
+// Add new sets by logging bme280.cp from a tag.
+static const calibration_t calibrations[] =
+{
+  { "datasheet example", { .dig_T1 = 27504, .dig_T2 = 26435, .dig_T3 = -1000,
+                           .dig_P1 = 36477, .dig_P2 = -10685, .dig_P3 = 3024, .dig_P4 = 2855, .dig_P5 = 140,
+                           .dig_P6 = -7, .dig_P7 = 15500, .dig_P8 = -14600, .dig_P9 = 6000 } },
+  { "typical set A",     { .dig_T1 = 28485, .dig_T2 = 26735, .dig_T3 = 50,
+                           .dig_P1 = 37227, .dig_P2 = -10760, .dig_P3 = 3024, .dig_P4 = 7604, .dig_P5 = -143,
+                           .dig_P6 = -7, .dig_P7 = 9900, .dig_P8 = -10230, .dig_P9 = 4285 } },
+  { "typical set B",     { .dig_T1 = 27836, .dig_T2 = 26511, .dig_T3 = 50,
+                           .dig_P1 = 36745, .dig_P2 = -10637, .dig_P3 = 3024, .dig_P4 = 5851, .dig_P5 = -39,
+                           .dig_P6 = -7, .dig_P7 = 9900, .dig_P8 = -10230, .dig_P9 = 4285 } }
+};
+
+typedef struct
+{
+  double max_error;
+  double sum_error;
+  uint32_t samples;
+}error_t;
+
+static void accumulate(error_t* e, double error)
+{
+  error = fabs(error);
+  if(error > e->max_error) { e->max_error = error; }
+  e->sum_error += error;
+  e->samples++;
+}
+
+static void sweep(const calibration_t* c)
+{
+  error_t e64 = {0}, e32 = {0};
+  uint32_t out_of_range = 0;
+  for(int32_t adc_T = 0; adc_T < (1 << 20); adc_T += ADC_T_STEP)
+  {
+    int32_t t_fine;
+    int32_t T = bme280_compensate_T_int32(&c->cp, adc_T, &t_fine);
+    if(T < TEMPERATURE_MIN || T > TEMPERATURE_MAX) { continue; }
+    for(int32_t adc_P = 0; adc_P < (1 << 20); adc_P += ADC_P_STEP)
+    {
+      double reference = bme280_compensate_P_double(&c->cp, t_fine, adc_P);
+      if(reference < PRESSURE_MIN_PA || reference > PRESSURE_MAX_PA) { out_of_range++; continue; }
+      accumulate(&e64, bme280_compensate_P_int64(&c->cp, t_fine, adc_P) / 256.0 - reference);
+      accumulate(&e32, (double)bme280_compensate_P_int32(&c->cp, t_fine, adc_P) - reference);
+    }
+  }
+  printf("%-18s %9u points, %9u out of range\n", c->name, e64.samples, out_of_range);
+  printf("  int64: max error %.3f Pa, mean %.3f Pa\n", e64.max_error, e64.sum_error / e64.samples);
+  printf("  int32: max error %.3f Pa, mean %.3f Pa\n", e32.max_error, e32.sum_error / e32.samples);
+}
+
+static uint64_t now(void)
+{
+#if HAS_CYCLE_COUNTER
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static volatile double sink;
+
+#define BENCHMARK(name, expression)                                   \
+  do {                                                                \
+    double acc = 0;                                                   \
+    uint64_t start = now();                                           \
+    for(int round = 0; round < BENCHMARK_ROUNDS; round++)             \
+    {                                                                 \
+      for(int ii = 0; ii < BENCHMARK_INPUTS; ii++)                    \
+      {                                                               \
+        int32_t adc_P = inputs[ii];                                   \
+        acc += (expression);                                          \
+      }                                                               \
+    }                                                                 \
+    uint64_t elapsed = now() - start;                                 \
+    sink = acc;                                                       \
+    printf("  %-6s %8.1f %s per call\n", name,                        \
+           (double)elapsed / (BENCHMARK_ROUNDS * BENCHMARK_INPUTS),   \
+           HAS_CYCLE_COUNTER ? "cycles" : "ns");                      \
+  } while(0)
+
+static void benchmark(const calibration_t* c)
+{
+  static int32_t inputs[BENCHMARK_INPUTS];
+  int32_t t_fine;
+  bme280_compensate_T_int32(&c->cp, 519888, &t_fine);
+  for(int ii = 0; ii < BENCHMARK_INPUTS; ii++)
+  {
+    inputs[ii] = 250000 + ii * 317;
+  }
+  printf("Speed, %s:\n", c->name);
+  BENCHMARK("int64",  bme280_compensate_P_int64(&c->cp, t_fine, adc_P));
+  BENCHMARK("int32",  bme280_compensate_P_int32(&c->cp, t_fine, adc_P));
+  BENCHMARK("double", bme280_compensate_P_double(&c->cp, t_fine, adc_P));
+}
+
+int main(void)
+{
+  size_t count = sizeof(calibrations) / sizeof(calibrations[0]);
+  printf("Pressure compensation error against double precision, %.0f...%.0f Pa\n", PRESSURE_MIN_PA, PRESSURE_MAX_PA);
+  for(size_t ii = 0; ii < count; ii++)
+  {
+    sweep(&calibrations[ii]);
+  }
+  benchmark(&calibrations[0]);
+  return 0;
+}
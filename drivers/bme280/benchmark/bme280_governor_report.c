@@ -0,0 +1,55 @@
+/**
+ *  Host report of BME280 oversampling governor selections.
+ *
+ *  Prints settings selected for main loop intervals of the firmware modes and a sweep of
+ *  charge budgets, with conversion time, charge and average current at the given interval.
+ *  Targets below match defaults of ruuvi_firmware/application_config.h.
+ */
+#include "bme280_governor.h"
+
+#include <stdio.h>
+
+#define NOISE_TEMPERATURE 20    // 0.002 C
+#define NOISE_HUMIDITY    20    // 0.020 %RH
+#define NOISE_PRESSURE    60    // 0.60 Pa
+#define BUDGET_NC         20000
+#define RESPONSE_MS       60000
+
+static const char* const os_names[] = {"skip", "1x", "2x", "4x", "8x", "16x"};
+static const char* const iir_names[] = {"off", "2", "4", "8", "16"};
+
+static void report(const char* name, const bme280_governor_target_t* target, uint32_t interval_ms)
+{
+  bme280_governor_setting_t setting;
+  bme280_governor_select(target, interval_ms, &setting);
+  printf("%-22s %8u %8u | %4s %4s %4s %4s | %7u %8u %8.3f %s\n",
+         name, (unsigned)interval_ms, (unsigned)target->budget_nc,
+         os_names[setting.oversampling_temp], os_names[setting.oversampling_press],
+         os_names[setting.oversampling_hum], iir_names[setting.iir >> 2],
+         (unsigned)setting.measurement_time_us, (unsigned)setting.charge_nc,
+         setting.charge_nc / (double)interval_ms, setting.targets_met ? "yes" : "no");
+}
+
+int main(void)
+{
+  bme280_governor_target_t target = { .noise_temperature = NOISE_TEMPERATURE,
+                                      .noise_humidity    = NOISE_HUMIDITY,
+                                      .noise_pressure    = NOISE_PRESSURE,
+                                      .budget_nc         = BUDGET_NC,
+                                      .response_ms       = RESPONSE_MS };
+
+  printf("%-22s %8s %8s | %4s %4s %4s %4s | %7s %8s %8s %s\n", "case", "interval", "budget",
+         "T", "P", "H", "IIR", "t_us", "nC", "uA", "met");
+  report("RAWv1 / RAWv2_FAST", &target, 1280);
+  report("RAWv2_SLOW", &target, 6420);
+  report("Adaptive ceiling", &target, 10000);
+  report("Normal mode 1 s", &target, 1000);
+  report("Streaming 10 Hz", &target, 100);
+
+  for(uint32_t budget = 2000; budget <= 32000; budget *= 2)
+  {
+    target.budget_nc = budget;
+    report("RAWv2_SLOW, budget", &target, 6420);
+  }
+  return 0;
+}
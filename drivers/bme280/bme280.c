@@ -45,6 +45,7 @@
 
 #include "bme280.h"
 #include "init.h" //Timer ticks - todo: refactor
+#include "probe.h"
 
 #define NRF_LOG_MODULE_NAME "BME280"
 #include "nrf_log.h"
@@ -59,6 +60,16 @@ void timer_bme280_event_handler(void* p_context);
 /** state variable **/
 static uint8_t current_mode = BME280_MODE_SLEEP;
 static uint8_t current_interval = BME280_STANDBY_1000_MS;
+static uint8_t current_os_temp  = BME280_OVERSAMPLING_SKIP;
+static uint8_t current_os_press = BME280_OVERSAMPLING_SKIP;
+static uint8_t current_os_hum   = BME280_OVERSAMPLING_SKIP;
+
+/** Compensated values and raw values they were computed from **/
+static bme280_data_t compensated;
+static int32_t compensated_adc_t;
+static int32_t compensated_adc_p;
+static int32_t compensated_adc_h;
+static bool compensation_valid = false;
 
 BME280_Ret bme280_init()
 {
@@ -82,53 +93,39 @@ BME280_Ret bme280_init()
 		return (0x00 == reg) ? BME280_RET_ERROR : BME280_RET_ERROR_SELFTEST;
   }
 
-  // load calibration data...
-  bme280.cp.dig_T1  = bme280_read_reg(BME280REG_CALIB_00);
-  bme280.cp.dig_T1 |= bme280_read_reg(BME280REG_CALIB_00+1) << 8;
-  bme280.cp.dig_T2  = bme280_read_reg(BME280REG_CALIB_00+2);
-  bme280.cp.dig_T2 |= bme280_read_reg(BME280REG_CALIB_00+3) << 8;
-  bme280.cp.dig_T3  = bme280_read_reg(BME280REG_CALIB_00+4);
-  bme280.cp.dig_T3 |= bme280_read_reg(BME280REG_CALIB_00+5) << 8;
-
-  bme280.cp.dig_P1  = bme280_read_reg(BME280REG_CALIB_00+6);
-  bme280.cp.dig_P1 |= bme280_read_reg(BME280REG_CALIB_00+7) << 8;
-  bme280.cp.dig_P2  = bme280_read_reg(BME280REG_CALIB_00+8);
-  bme280.cp.dig_P2 |= bme280_read_reg(BME280REG_CALIB_00+9) << 8;
-  bme280.cp.dig_P3  = bme280_read_reg(BME280REG_CALIB_00+10);
-  bme280.cp.dig_P3 |= bme280_read_reg(BME280REG_CALIB_00+11) << 8;
-  bme280.cp.dig_P4  = bme280_read_reg(BME280REG_CALIB_00+12);
-  bme280.cp.dig_P4 |= bme280_read_reg(BME280REG_CALIB_00+13) << 8;
-  bme280.cp.dig_P5  = bme280_read_reg(BME280REG_CALIB_00+14);
-  bme280.cp.dig_P5 |= bme280_read_reg(BME280REG_CALIB_00+15) << 8;
-  bme280.cp.dig_P6  = bme280_read_reg(BME280REG_CALIB_00+16);
-  bme280.cp.dig_P6 |= bme280_read_reg(BME280REG_CALIB_00+17) << 8;
-  bme280.cp.dig_P7  = bme280_read_reg(BME280REG_CALIB_00+18);
-  bme280.cp.dig_P7 |= bme280_read_reg(BME280REG_CALIB_00+19) << 8;
-  bme280.cp.dig_P8  = bme280_read_reg(BME280REG_CALIB_00+20);
-  bme280.cp.dig_P8 |= bme280_read_reg(BME280REG_CALIB_00+21) << 8;
-  bme280.cp.dig_P9  = bme280_read_reg(BME280REG_CALIB_00+22);
-  bme280.cp.dig_P9 |= bme280_read_reg(BME280REG_CALIB_00+23) << 8;
-
-  bme280.cp.dig_H1  = bme280_read_reg(0xA1);
-  bme280.cp.dig_H2  = bme280_read_reg(0xE1);
-  bme280.cp.dig_H2 |= bme280_read_reg(0xE2) << 8;
-  bme280.cp.dig_H3  = bme280_read_reg(0xE3);
-
-  bme280.cp.dig_H4  = bme280_read_reg(0xE4) << 4;		// 11:4
-  bme280.cp.dig_H4 |= bme280_read_reg(0xE5) & 0x0f;	// 3:0
-
-  bme280.cp.dig_H5  = bme280_read_reg(0xE5) >> 4;		// 3:0
-  bme280.cp.dig_H5 |= bme280_read_reg(0xE6) << 4;		// 11:4
-
-  bme280.cp.dig_H6  = bme280_read_reg(0xE7);
- 
-  return BME280_RET_OK;
+  // load calibration data in two bursts, data[0] is the address byte
+  uint8_t calib[BME280_CALIB_00_LENGTH];
+  BME280_Ret err_code = bme280_read_burst(BME280REG_CALIB_00, BME280_CALIB_00_LENGTH, calib);
+  bme280.cp.dig_T1 = (uint16_t)(calib[1]  | (calib[2]  << 8));
+  bme280.cp.dig_T2 = (int16_t) (calib[3]  | (calib[4]  << 8));
+  bme280.cp.dig_T3 = (int16_t) (calib[5]  | (calib[6]  << 8));
+
+  bme280.cp.dig_P1 = (uint16_t)(calib[7]  | (calib[8]  << 8));
+  bme280.cp.dig_P2 = (int16_t) (calib[9]  | (calib[10] << 8));
+  bme280.cp.dig_P3 = (int16_t) (calib[11] | (calib[12] << 8));
+  bme280.cp.dig_P4 = (int16_t) (calib[13] | (calib[14] << 8));
+  bme280.cp.dig_P5 = (int16_t) (calib[15] | (calib[16] << 8));
+  bme280.cp.dig_P6 = (int16_t) (calib[17] | (calib[18] << 8));
+  bme280.cp.dig_P7 = (int16_t) (calib[19] | (calib[20] << 8));
+  bme280.cp.dig_P8 = (int16_t) (calib[21] | (calib[22] << 8));
+  bme280.cp.dig_P9 = (int16_t) (calib[23] | (calib[24] << 8));
+  // calib[25] is 0xA0, unused
+  bme280.cp.dig_H1 = calib[26];
+
+  err_code |= bme280_read_burst(BME280REG_CALIB_26, BME280_CALIB_26_LENGTH, calib);
+  bme280.cp.dig_H2 = (int16_t) (calib[1]  | (calib[2]  << 8));
+  bme280.cp.dig_H3 = calib[3];
+  bme280.cp.dig_H4 = (calib[4] << 4) | (calib[5] & 0x0f); // 11:4, 3:0
+  bme280.cp.dig_H5 = (calib[5] >> 4) | (calib[6] << 4);   // 3:0, 11:4
+  bme280.cp.dig_H6 = calib[7];
+  compensation_valid = false;
+
+  return err_code;
 }
 
 
 /*
- *  TODO: Adjust timer frequency by BME280 sampling speed.
- *  TODO: return APP_ERROR_CHECK values?
+ *  Mode is updated only if both register writes succeed.
  */
 BME280_Ret bme280_set_mode(enum BME280_MODE mode)
 {
@@ -136,7 +133,7 @@ BME280_Ret bme280_set_mode(enum BME280_MODE mode)
   if(!bme280.sensor_available) { return BME280_RET_ERROR;  }
   uint8_t conf, reg;
   
-  BME280_Ret status = BME280_RET_ERROR;
+  BME280_Ret status = BME280_RET_OK;
   reg = bme280_read_reg(BME280REG_CTRL_HUM);
   conf = bme280_read_reg(BME280REG_CTRL_MEAS);
   NRF_LOG_DEBUG("CONFIG before mode: %x\r\n", conf);
@@ -161,13 +158,23 @@ BME280_Ret bme280_set_mode(enum BME280_MODE mode)
       break;
 
     default:
-      break;
+      return BME280_RET_ILLEGAL;
   }
 
   if(BME280_RET_OK == status) {current_mode = mode;}
   return status;
 }
 
+BME280_Ret bme280_start_forced_conversion(const app_timer_id_t timer_id)
+{
+  BME280_Ret status = bme280_set_mode(BME280_MODE_FORCED);
+  if(BME280_RET_OK != status) { return status; }
+  // Round up, APP_TIMER_TICKS rounds to nearest tick.
+  uint32_t ticks = APP_TIMER_TICKS((bme280_get_measurement_time_us() / 1000) + 1, RUUVITAG_APP_TIMER_PRESCALER);
+  if(ticks < APP_TIMER_MIN_TIMEOUT_TICKS) { ticks = APP_TIMER_MIN_TIMEOUT_TICKS; }
+  return (NRF_SUCCESS == app_timer_start(timer_id, ticks, NULL)) ? BME280_RET_OK : BME280_RET_ERROR;
+}
+
 BME280_Ret bme280_set_interval(enum BME280_INTERVAL interval)
 {
   if(BME280_MODE_SLEEP != current_mode){ return BME280_RET_ILLEGAL; }
@@ -205,6 +212,23 @@ int bme280_is_measuring(void)
   }
 }
 
+/** Number of samples taken with given oversampling setting */
+static uint32_t oversampling_samples(uint8_t os)
+{
+  if(BME280_OVERSAMPLING_SKIP == os) { return 0; }
+  if(BME280_OVERSAMPLING_16 <= os)   { return 16; }
+  return 1 << (os - 1);
+}
+
+uint32_t bme280_get_measurement_time_us(void)
+{
+  // t_measure,max = 1.25 + 2.3 * T + (2.3 * P + 0.575) + (2.3 * H + 0.575) ms
+  uint32_t t_us = 1250 + 2300 * oversampling_samples(current_os_temp);
+  if(current_os_press) { t_us += 2300 * oversampling_samples(current_os_press) + 575; }
+  if(current_os_hum)   { t_us += 2300 * oversampling_samples(current_os_hum) + 575; }
+  return t_us;
+}
+
 
 BME280_Ret bme280_set_oversampling_hum(uint8_t os)
 {
@@ -212,7 +236,9 @@ BME280_Ret bme280_set_oversampling_hum(uint8_t os)
   uint8_t meas;
   meas = bme280_read_reg(BME280REG_CTRL_MEAS);
   bme280_write_reg(BME280REG_CTRL_HUM, os);
-  return bme280_write_reg(BME280REG_CTRL_MEAS, meas); //Changes to humi take effect after write to meas
+  BME280_Ret status = bme280_write_reg(BME280REG_CTRL_MEAS, meas); //Changes to humi take effect after write to meas
+  if(BME280_RET_OK == status) { current_os_hum = os; }
+  return status;
 }
 
 
@@ -225,7 +251,9 @@ BME280_Ret bme280_set_oversampling_temp(uint8_t os)
   bme280_write_reg(BME280REG_CTRL_HUM, humi);
   meas &= 0b00011111;
   meas |= (os<<5);
-  return bme280_write_reg(BME280REG_CTRL_MEAS, meas);
+  BME280_Ret status = bme280_write_reg(BME280REG_CTRL_MEAS, meas);
+  if(BME280_RET_OK == status) { current_os_temp = os; }
+  return status;
 }
 
 
@@ -238,7 +266,9 @@ BME280_Ret bme280_set_oversampling_press(uint8_t os)
   bme280_write_reg(BME280REG_CTRL_HUM, humi);
   meas &= 0b11100011;
   meas |= (os<<2);
-  return bme280_write_reg(BME280REG_CTRL_MEAS, meas);
+  BME280_Ret status = bme280_write_reg(BME280REG_CTRL_MEAS, meas);
+  if(BME280_RET_OK == status) { current_os_press = os; }
+  return status;
 }
 	
 BME280_Ret bme280_set_iir(uint8_t iir)
@@ -251,6 +281,31 @@ BME280_Ret bme280_set_iir(uint8_t iir)
    return bme280_write_reg(BME280REG_CONFIG, conf);
 }
 
+BME280_Ret bme280_configure(const bme280_config_t* const config)
+{
+  if(NULL == config) { return BME280_RET_NULL; }
+  if(!bme280.sensor_available) { return BME280_RET_ERROR; }
+  if(BME280_MODE_SLEEP != current_mode){ return BME280_RET_ILLEGAL; }
+
+  // Multiple write: pairs of register address and data in one transaction, written in order.
+  uint8_t tx[6];
+  uint8_t rx[6] = {0};
+  tx[0] = BME280REG_CONFIG & 0x7F;
+  tx[1] = (config->interval & BME280_INTERVAL_MASK) | (config->iir & BME280_IIR_MASK);
+  tx[2] = BME280REG_CTRL_HUM & 0x7F;
+  tx[3] = config->oversampling_hum & 0x07;
+  tx[4] = BME280REG_CTRL_MEAS & 0x7F;
+  tx[5] = ((config->oversampling_temp & 0x07) << 5) | ((config->oversampling_press & 0x07) << 2) | (config->mode & 0x03);
+  if(SPI_RET_OK != spi_transfer_bme280(tx, sizeof(tx), rx)) { return BME280_RET_ERROR; }
+
+  current_interval = config->interval;
+  current_os_temp  = config->oversampling_temp;
+  current_os_press = config->oversampling_press;
+  current_os_hum   = config->oversampling_hum;
+  current_mode     = config->mode;
+  return BME280_RET_OK;
+}
+
 /**
  * @brief Read new raw values.
  */
@@ -258,6 +313,7 @@ BME280_Ret bme280_read_measurements()
 {
 
   if(!bme280.sensor_available) { return BME280_RET_ERROR;  }
+  PROBE_START(PROBE_BME280_READ);
   uint8_t data[BME280_BURST_READ_LENGTH];
   
   BME280_Ret err_code = bme280_read_burst(BME280REG_PRESS_MSB, BME280_BURST_READ_LENGTH, data);
@@ -272,78 +328,54 @@ BME280_Ret bme280_read_measurements()
   bme280.adc_p |= (uint32_t) data[2] << 4;
   bme280.adc_p |= (uint32_t) data[1] << 12;
 
-  return err_code;
-}
-
+  // Forced measurement returns sensor to sleep
+  if(BME280_RET_OK == err_code && BME280_MODE_FORCED == current_mode) { current_mode = BME280_MODE_SLEEP; }
 
-static uint32_t compensate_P_int64(int32_t adc_P)
-{
-	int64_t var1, var2, p;
-
-	var1 = ((int64_t)bme280.t_fine) - 128000;
-	var2 = var1 * var1 * (int64_t)bme280.cp.dig_P6;
-	var2 = var2 + ((var1*(int64_t)bme280.cp.dig_P5) << 17);
-	var2 = var2 + (((int64_t)bme280.cp.dig_P4) << 35);
-	var1 = ((var1 * var1 * (int64_t)bme280.cp.dig_P3) >> 8) + ((var1 * (int64_t)bme280.cp.dig_P2) << 12);
-	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)bme280.cp.dig_P1) >> 33;
-	if (var1 == 0) {
-		return 0;
-	}
-
-	p = 1048576 - adc_P;
-	p = (((p << 31) - var2) * 3125) / var1;
-	var1 = (((int64_t)bme280.cp.dig_P9) * (p >> 13) * (p >> 13)) >> 25;
-	var2 = (((int64_t)bme280.cp.dig_P8) * p) >> 19;
-	p = ((p + var1 + var2) >> 8) + (((int64_t)bme280.cp.dig_P7) << 4);
-
-	return (uint32_t)p;
+  PROBE_STOP(PROBE_BME280_READ);
+  return err_code;
 }
 
 
-static uint32_t compensate_H_int32(int32_t adc_H)
+/**
+ * Compensate raw values if they have changed since last call.
+ * t_fine is calculated once per new reading and used for pressure and humidity.
+ */
+static void compensate(void)
 {
-	int32_t v_x1_u32r;
-
-	v_x1_u32r = (bme280.t_fine - ((int32_t)76800));
-	v_x1_u32r = (((((adc_H << 14) - (((int32_t)bme280.cp.dig_H4) << 20) - (((int32_t)bme280.cp.dig_H5) * v_x1_u32r)) +
-		       ((int32_t)16384)) >> 15) * (((((((v_x1_u32r * ((int32_t)bme280.cp.dig_H6)) >> 10) * (((v_x1_u32r * ((int32_t)bme280.cp.dig_H3)) >> 11) +
-		       ((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)bme280.cp.dig_H2) + 8192) >> 14));
-
-	v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)bme280.cp.dig_H1)) >> 4));
-	v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
-        // Cap maximum reported value to 100%
-	v_x1_u32r = (v_x1_u32r > (100<<22) ? (100<<22) : v_x1_u32r);
-
-	return (uint32_t)(v_x1_u32r >> 12);
+  if(compensation_valid && compensated_adc_t == bme280.adc_t &&
+     compensated_adc_p == bme280.adc_p && compensated_adc_h == bme280.adc_h)
+  {
+    return;
+  }
+  compensated.temperature = bme280_compensate_T_int32(&bme280.cp, bme280.adc_t, &bme280.t_fine);
+#if BME280_COMPENSATION_32BIT
+  compensated.pressure = bme280_compensate_P_int32(&bme280.cp, bme280.t_fine, bme280.adc_p) << 8;
+#else
+  compensated.pressure = bme280_compensate_P_int64(&bme280.cp, bme280.t_fine, bme280.adc_p);
+#endif
+  compensated.humidity = bme280_compensate_H_int32(&bme280.cp, bme280.t_fine, bme280.adc_h);
+  compensated_adc_t = bme280.adc_t;
+  compensated_adc_p = bme280.adc_p;
+  compensated_adc_h = bme280.adc_h;
+  compensation_valid = true;
 }
 
-
-static int32_t compensate_T_int32(int32_t adc_T)
+BME280_Ret bme280_get_data(bme280_data_t* const data)
 {
-	int32_t var1, var2, T;
-
-	var1 = ((((adc_T>>3) - ((int32_t)bme280.cp.dig_T1<<1))) * 
-               ((int32_t)bme280.cp.dig_T2)) >> 11;
-	var2 = (((((adc_T>>4) - ((int32_t)bme280.cp.dig_T1)) *
-               ((adc_T>>4) - ((int32_t)bme280.cp.dig_T1))) >> 12) * 
-               ((int32_t)bme280.cp.dig_T3)) >> 14;
-
-	bme280.t_fine = var1 + var2;
-
-	T = (bme280.t_fine * 5 + 128) >> 8;
-	
-  return T;
+  if(NULL == data) { return BME280_RET_NULL; }
+  compensate();
+  *data = compensated;
+  return BME280_RET_OK;
 }
 
-
 /**
  * Returns temperature in DegC, resolution is 0.01 DegC.
  * Output value of “2134” equals 21.34 DegC.
  */
 int32_t bme280_get_temperature(void)
 {
-	int32_t temp = compensate_T_int32(bme280.adc_t);
-	return temp;
+  compensate();
+  return compensated.temperature;
 }
 
 
@@ -351,11 +383,12 @@ int32_t bme280_get_temperature(void)
  * Returns pressure in Pa as unsigned 32 bit integer in Q24.8 format
  * (24 integer bits and 8 fractional bits).
  * Output value of “24674867” represents 24674867/256 = 96386.2 Pa = 963.862 hPa
+ * Fractional bits are zero if BME280_COMPENSATION_32BIT is set.
  */
 uint32_t bme280_get_pressure(void)
 {
-	uint32_t press = compensate_P_int64(bme280.adc_p);
-	return press;
+  compensate();
+  return compensated.pressure;
 }
 
 
@@ -366,8 +399,8 @@ uint32_t bme280_get_pressure(void)
  */
 uint32_t bme280_get_humidity(void)
 {
-	uint32_t humi = compensate_H_int32(bme280.adc_h);
-	return humi;
+  compensate();
+  return compensated.humidity;
 }
 
 uint8_t bme280_read_reg(uint8_t reg)
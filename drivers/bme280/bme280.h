@@ -54,27 +54,8 @@
 #include "app_scheduler.h"
 #include "nordic_common.h"
 #include "app_timer_appsh.h"
-
-struct comp_params {
-	uint16_t dig_T1;
-	int16_t  dig_T2;
-	int16_t  dig_T3;
-	uint16_t dig_P1;
-	int16_t  dig_P2;
-	int16_t  dig_P3;
-	int16_t  dig_P4;
-	int16_t  dig_P5;
-	int16_t  dig_P6;
-	int16_t  dig_P7;
-	int16_t  dig_P8;
-	int16_t  dig_P9;
-	uint8_t  dig_H1;
-	int16_t  dig_H2;
-	uint8_t  dig_H3;
-	int16_t  dig_H4;
-	int16_t  dig_H5;
-	int8_t   dig_H6;
-};
+#include "bme280_compensation.h"
+#include "bme280_registers.h"
 
 struct bme280_driver {
 	bool sensor_available;
@@ -105,51 +86,15 @@ typedef enum
     BME280_RET_ERROR = 32               /**< Not otherwise specified error */
 } BME280_Ret;
 
-#define BME280REG_CALIB_00       (0x88)
-#define BME280REG_ID             (0xD0)
-#define BME280REG_RESET          (0xE0)
-#define BME280REG_CALIB_26       (0xE1)
-#define BME280REG_CTRL_HUM       (0xF2)
-#define BME280REG_STATUS         (0xF3)
-#define BME280REG_CTRL_MEAS      (0xF4)
-#define BME280REG_CONFIG         (0xF5)
-#define BME280REG_PRESS_MSB      (0xF7)
-#define BME280REG_PRESS_LSB      (0xF8)
-#define BME280REG_PRESS_XLSB     (0xF9)
-#define BME280REG_TEMP_MSB       (0xFA)
-#define BME280REG_TEMP_LSB       (0xFB)
-#define BME280REG_TEMP_XLSB      (0xFC)
-#define BME280REG_HUM_MSB        (0xFD)
-#define BME280REG_HUM_LSB        (0xFE)
-
-#define BME280_ID_VALUE          (0x60)
-
-#define BME280_OVERSAMPLING_SKIP (0x00)
-#define BME280_OVERSAMPLING_1    (0x01)
-#define BME280_OVERSAMPLING_2    (0x02)
-#define BME280_OVERSAMPLING_4    (0x03)
-#define BME280_OVERSAMPLING_8    (0x04)
-#define BME280_OVERSAMPLING_16   (0x05)
-
-#define BME280_IIR_MASK          (0x1C)
-#define BME280_IIR_OFF           (0x00)
-#define BME280_IIR_2             (0x04)
-#define BME280_IIR_4             (0x08)
-#define BME280_IIR_8             (0x0C)
-#define BME280_IIR_16            (0x10)
-
-#define BME280_INTERVAL_MASK     (0xE0)
-
-#define BME280_BURST_READ_LENGTH (9) // 8 bytes + address
-#define BME280_MAX_READ_LENGTH BME280_BURST_READ_LENGTH
-
-enum BME280_INTERVAL {
-	BME280_STANDBY_0_5_MS  = 0x0,
-	BME280_STANDBY_62_5_MS = 0x20,
-	BME280_STANDBY_125_MS  = 0x40,
-	BME280_STANDBY_500_MS  = 0x80,
-	BME280_STANDBY_1000_MS = 0xA0
-};
+/** Complete configuration of BME280, committed with bme280_configure() */
+typedef struct {
+  uint8_t oversampling_temp;     /**< BME280_OVERSAMPLING_* */
+  uint8_t oversampling_press;    /**< BME280_OVERSAMPLING_* */
+  uint8_t oversampling_hum;      /**< BME280_OVERSAMPLING_* */
+  uint8_t iir;                   /**< BME280_IIR_* */
+  enum BME280_INTERVAL interval; /**< Standby time in normal mode */
+  enum BME280_MODE mode;         /**< Mode to enter after configuration */
+}bme280_config_t;
 
 /** Structure containing sensor data from all 3 sensors */
 typedef struct {
@@ -171,6 +116,12 @@ BME280_Ret bme280_init();
  */
 BME280_Ret bme280_set_mode(enum BME280_MODE mode);
 
+/**
+ *  Start forced conversion and single shot timer timer_id, which expires once results are ready
+ *  to be read with bme280_read_measurements(). Returns BME280_RET_OK only if both have started.
+ */
+BME280_Ret bme280_start_forced_conversion(const app_timer_id_t timer_id);
+
 /**
  * Set sampling interval of BME280 in normal mode
  * Note that interval is a standby time between measurements,
@@ -187,6 +138,15 @@ enum BME280_INTERVAL bme280_get_interval(void);
  
 int  bme280_is_measuring(void);
 
+/**
+ *  Return maximum duration of one measurement in microseconds with current oversampling settings,
+ *  datasheet section 9.1. Forced mode can be used without polling bme280_is_measuring():
+ *  bme_set_mode(BME280_MODE_FORCED)
+ *  wait bme280_get_measurement_time_us()
+ *  bme280_read_measurements();
+ */
+uint32_t bme280_get_measurement_time_us(void);
+
 /**
  *  Read measurements from BME280 to nRF52.
  *  You have to call this manually, in normal mode you get latest stored values.
@@ -194,6 +154,7 @@ int  bme280_is_measuring(void);
  *  bme_set_mode(BME280_MODE_FORCED)
  *  while(bme280_is_measuroing());
  *  bme280_read_measurements();
+ *  Sensor is considered to be back in sleep after forced measurement has been read.
  */
 BME280_Ret bme280_read_measurements();
 
@@ -215,6 +176,13 @@ BME280_Ret bme280_set_oversampling_press(uint8_t os);
  */
 BME280_Ret bme280_set_iir(uint8_t iir);
 
+/**
+ *  Write complete configuration in one SPI transaction: CONFIG, CTRL_HUM and CTRL_MEAS in this order,
+ *  so humidity setting takes effect with CTRL_MEAS write which also sets the mode.
+ *  Sensor must be in sleep mode, returns BME280_RET_ILLEGAL otherwise.
+ */
+BME280_Ret bme280_configure(const bme280_config_t* const config);
+
 /**
  * Returns temperature in DegC, resolution is 0.01 DegC.
  * Output value of “2134” equals 21.34 DegC.
@@ -235,6 +203,12 @@ uint32_t bme280_get_pressure(void);
  */
 uint32_t   bme280_get_humidity(void);
 
+/**
+ * Returns temperature, pressure and humidity in formats above.
+ * Compensated values are cached until raw values change, so repeated calls are cheap.
+ */
+BME280_Ret bme280_get_data(bme280_data_t* const data);
+
 // Used internally
 uint8_t    bme280_read_reg(uint8_t reg);
 BME280_Ret bme280_read_burst(uint8_t start, uint8_t length, uint8_t* buffer);
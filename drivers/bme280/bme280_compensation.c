@@ -0,0 +1,117 @@
+/*
+ * BME280 compensation formulas, BST-BME280-DS001-11 section 4.2.3 and 8.
+ * Formulas are from datasheet, see bme280_compensation.h for selection.
+ */
+
+#include "bme280_compensation.h"
+
+int32_t bme280_compensate_T_int32(const struct comp_params* cp, int32_t adc_T, int32_t* t_fine)
+{
+	int32_t var1, var2;
+
+	var1 = ((((adc_T>>3) - ((int32_t)cp->dig_T1<<1))) *
+               ((int32_t)cp->dig_T2)) >> 11;
+	var2 = (((((adc_T>>4) - ((int32_t)cp->dig_T1)) *
+               ((adc_T>>4) - ((int32_t)cp->dig_T1))) >> 12) *
+               ((int32_t)cp->dig_T3)) >> 14;
+
+	*t_fine = var1 + var2;
+
+	return (*t_fine * 5 + 128) >> 8;
+}
+
+
+uint32_t bme280_compensate_P_int64(const struct comp_params* cp, int32_t t_fine, int32_t adc_P)
+{
+	int64_t var1, var2, p;
+
+	var1 = ((int64_t)t_fine) - 128000;
+	var2 = var1 * var1 * (int64_t)cp->dig_P6;
+	var2 = var2 + ((var1*(int64_t)cp->dig_P5) << 17);
+	var2 = var2 + (((int64_t)cp->dig_P4) << 35);
+	var1 = ((var1 * var1 * (int64_t)cp->dig_P3) >> 8) + ((var1 * (int64_t)cp->dig_P2) << 12);
+	var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)cp->dig_P1) >> 33;
+	if (var1 == 0) {
+		return 0;
+	}
+
+	p = 1048576 - adc_P;
+	p = (((p << 31) - var2) * 3125) / var1;
+	var1 = (((int64_t)cp->dig_P9) * (p >> 13) * (p >> 13)) >> 25;
+	var2 = (((int64_t)cp->dig_P8) * p) >> 19;
+	p = ((p + var1 + var2) >> 8) + (((int64_t)cp->dig_P7) << 4);
+
+	return (uint32_t)p;
+}
+
+
+uint32_t bme280_compensate_P_int32(const struct comp_params* cp, int32_t t_fine, int32_t adc_P)
+{
+	int32_t var1, var2;
+	uint32_t p;
+
+	var1 = (t_fine >> 1) - (int32_t)64000;
+	var2 = (((var1 >> 2) * (var1 >> 2)) >> 11) * ((int32_t)cp->dig_P6);
+	var2 = var2 + ((var1 * ((int32_t)cp->dig_P5)) << 1);
+	var2 = (var2 >> 2) + (((int32_t)cp->dig_P4) << 16);
+	var1 = (((cp->dig_P3 * (((var1 >> 2) * (var1 >> 2)) >> 13)) >> 3) + ((((int32_t)cp->dig_P2) * var1) >> 1)) >> 18;
+	var1 = ((((32768 + var1)) * ((int32_t)cp->dig_P1)) >> 15);
+	if (var1 == 0) {
+		return 0;
+	}
+
+	p = (((uint32_t)(((int32_t)1048576) - adc_P) - (var2 >> 12))) * 3125;
+	if (p < 0x80000000) {
+		p = (p << 1) / ((uint32_t)var1);
+	}
+	else {
+		p = (p / (uint32_t)var1) * 2;
+	}
+	var1 = (((int32_t)cp->dig_P9) * ((int32_t)(((p >> 3) * (p >> 3)) >> 13))) >> 12;
+	var2 = (((int32_t)(p >> 2)) * ((int32_t)cp->dig_P8)) >> 13;
+	p = (uint32_t)((int32_t)p + ((var1 + var2 + cp->dig_P7) >> 4));
+
+	return p;
+}
+
+
+double bme280_compensate_P_double(const struct comp_params* cp, int32_t t_fine, int32_t adc_P)
+{
+	double var1, var2, p;
+
+	var1 = ((double)t_fine / 2.0) - 64000.0;
+	var2 = var1 * var1 * ((double)cp->dig_P6) / 32768.0;
+	var2 = var2 + var1 * ((double)cp->dig_P5) * 2.0;
+	var2 = (var2 / 4.0) + (((double)cp->dig_P4) * 65536.0);
+	var1 = (((double)cp->dig_P3) * var1 * var1 / 524288.0 + ((double)cp->dig_P2) * var1) / 524288.0;
+	var1 = (1.0 + var1 / 32768.0) * ((double)cp->dig_P1);
+	if (var1 == 0.0) {
+		return 0;
+	}
+
+	p = 1048576.0 - (double)adc_P;
+	p = (p - (var2 / 4096.0)) * 6250.0 / var1;
+	var1 = ((double)cp->dig_P9) * p * p / 2147483648.0;
+	var2 = p * ((double)cp->dig_P8) / 32768.0;
+	p = p + (var1 + var2 + ((double)cp->dig_P7)) / 16.0;
+
+	return p;
+}
+
+
+uint32_t bme280_compensate_H_int32(const struct comp_params* cp, int32_t t_fine, int32_t adc_H)
+{
+	int32_t v_x1_u32r;
+
+	v_x1_u32r = (t_fine - ((int32_t)76800));
+	v_x1_u32r = (((((adc_H << 14) - (((int32_t)cp->dig_H4) << 20) - (((int32_t)cp->dig_H5) * v_x1_u32r)) +
+		       ((int32_t)16384)) >> 15) * (((((((v_x1_u32r * ((int32_t)cp->dig_H6)) >> 10) * (((v_x1_u32r * ((int32_t)cp->dig_H3)) >> 11) +
+		       ((int32_t)32768))) >> 10) + ((int32_t)2097152)) * ((int32_t)cp->dig_H2) + 8192) >> 14));
+
+	v_x1_u32r = (v_x1_u32r - (((((v_x1_u32r >> 15) * (v_x1_u32r >> 15)) >> 7) * ((int32_t)cp->dig_H1)) >> 4));
+	v_x1_u32r = (v_x1_u32r < 0 ? 0 : v_x1_u32r);
+        // Cap maximum reported value to 100%
+	v_x1_u32r = (v_x1_u32r > (100<<22) ? (100<<22) : v_x1_u32r);
+
+	return (uint32_t)(v_x1_u32r >> 12);
+}
@@ -0,0 +1,66 @@
+#ifndef BME280_COMPENSATION_H
+#define BME280_COMPENSATION_H
+/*
+ * BME280 compensation formulas, BST-BME280-DS001-11 section 4.2.3 and 8.
+ *
+ * Plain C without SDK dependencies so that the formulas can be verified and benchmarked on host.
+ * Select pressure compensation of the driver with BME280_COMPENSATION_32BIT:
+ *  0: 64-bit integer formula, Q24.8 Pa. Within 0.01 Pa of double precision formula.
+ *  1: 32-bit integer formula, 1 Pa resolution. Avoids 64-bit multiplies and library division on
+ *     Cortex-M4, but error is up to 7 Pa near 1100 hPa, mean error about 1 Pa.
+ * Run benchmark/ on host to verify the figures.
+ */
+
+#include <stdint.h>
+
+#ifndef BME280_COMPENSATION_32BIT
+#define BME280_COMPENSATION_32BIT 0
+#endif
+
+struct comp_params {
+	uint16_t dig_T1;
+	int16_t  dig_T2;
+	int16_t  dig_T3;
+	uint16_t dig_P1;
+	int16_t  dig_P2;
+	int16_t  dig_P3;
+	int16_t  dig_P4;
+	int16_t  dig_P5;
+	int16_t  dig_P6;
+	int16_t  dig_P7;
+	int16_t  dig_P8;
+	int16_t  dig_P9;
+	uint8_t  dig_H1;
+	int16_t  dig_H2;
+	uint8_t  dig_H3;
+	int16_t  dig_H4;
+	int16_t  dig_H5;
+	int8_t   dig_H6;
+};
+
+/**
+ * Returns temperature in 0.01 DegC and stores fine temperature used by pressure and humidity formulas.
+ */
+int32_t bme280_compensate_T_int32(const struct comp_params* cp, int32_t adc_T, int32_t* t_fine);
+
+/**
+ * Returns pressure in Pa as Q24.8, 64-bit integer formula.
+ */
+uint32_t bme280_compensate_P_int64(const struct comp_params* cp, int32_t t_fine, int32_t adc_P);
+
+/**
+ * Returns pressure in Pa, 32-bit integer formula.
+ */
+uint32_t bme280_compensate_P_int32(const struct comp_params* cp, int32_t t_fine, int32_t adc_P);
+
+/**
+ * Returns pressure in Pa, double precision formula. Reference for verification, not used on target.
+ */
+double bme280_compensate_P_double(const struct comp_params* cp, int32_t t_fine, int32_t adc_P);
+
+/**
+ * Returns humidity in %RH as Q22.10, capped to 0...100 %RH.
+ */
+uint32_t bme280_compensate_H_int32(const struct comp_params* cp, int32_t t_fine, int32_t adc_H);
+
+#endif
@@ -0,0 +1,107 @@
+#include "bme280_governor.h"
+#include <stddef.h>
+
+// Register values of oversampling: 0 skip, 1...5 for 1x...16x. IIR register value is coefficient index << 2.
+#define GOVERNOR_OS_SKIP   0
+#define GOVERNOR_OS_1      1
+#define GOVERNOR_OS_MAX    5
+#define GOVERNOR_IIR_MAX   4
+#define GOVERNOR_IIR_SHIFT 2
+
+// Typical currents during measurement, uA
+#define GOVERNOR_CURRENT_TEMPERATURE_UA 350
+#define GOVERNOR_CURRENT_PRESSURE_UA    714
+#define GOVERNOR_CURRENT_HUMIDITY_UA    340
+
+/** RMS noise without IIR filter for oversampling 1x...16x, index is register value - 1 */
+static const uint16_t noise_temperature[GOVERNOR_OS_MAX] = {50, 35, 25, 18, 13};     // 0.0001 C
+static const uint16_t noise_pressure[GOVERNOR_OS_MAX]    = {330, 260, 210, 160, 130}; // 0.01 Pa
+static const uint16_t noise_humidity[GOVERNOR_OS_MAX]    = {20, 14, 10, 7, 5};        // 0.001 %RH
+
+/**
+ * Noise reduction of IIR filter in 1/1000 for coefficients off, 2, 4, 8, 16.
+ * First order filter with coefficient c reduces noise variance by 1 / (2c - 1).
+ */
+static const uint16_t iir_gain[GOVERNOR_IIR_MAX + 1] = {1000, 577, 378, 258, 180};
+
+/** Number of samples taken with given oversampling register value */
+static uint32_t samples(uint8_t os)
+{
+  if(GOVERNOR_OS_SKIP == os) { return 0; }
+  if(GOVERNOR_OS_MAX <= os)  { return 16; }
+  return 1 << (os - 1);
+}
+
+uint32_t bme280_governor_measurement_time_us(uint8_t os_temp, uint8_t os_press, uint8_t os_hum)
+{
+  // t_measure,max = 1.25 + 2.3 * T + (2.3 * P + 0.575) + (2.3 * H + 0.575) ms
+  uint32_t t_us = 1250 + 2300 * samples(os_temp);
+  if(os_press) { t_us += 2300 * samples(os_press) + 575; }
+  if(os_hum)   { t_us += 2300 * samples(os_hum) + 575; }
+  return t_us;
+}
+
+uint32_t bme280_governor_charge_nc(uint8_t os_temp, uint8_t os_press, uint8_t os_hum)
+{
+  // Start-up is accounted at temperature current. uA * us / 1000 = nC
+  uint32_t charge = (1250 + 2300 * samples(os_temp)) * GOVERNOR_CURRENT_TEMPERATURE_UA;
+  if(os_press) { charge += (2300 * samples(os_press) + 575) * GOVERNOR_CURRENT_PRESSURE_UA; }
+  if(os_hum)   { charge += (2300 * samples(os_hum) + 575) * GOVERNOR_CURRENT_HUMIDITY_UA; }
+  return charge / 1000;
+}
+
+/** Lowest oversampling which reaches target after IIR, or maximum oversampling if target cannot be reached */
+static uint8_t select_oversampling(const uint16_t* const noise, const uint32_t gain, const uint32_t target)
+{
+  for(uint8_t os = GOVERNOR_OS_1; os < GOVERNOR_OS_MAX; os++)
+  {
+    if((noise[os - 1] * gain) / 1000 <= target) { return os; }
+  }
+  return GOVERNOR_OS_MAX;
+}
+
+/** Noise after IIR of given channel and oversampling */
+static uint32_t filtered_noise(const uint16_t* const noise, const uint32_t gain, const uint8_t os)
+{
+  return (noise[os - 1] * gain) / 1000;
+}
+
+void bme280_governor_select(const bme280_governor_target_t* const target, const uint32_t interval_ms,
+                            bme280_governor_setting_t* const setting)
+{
+  if(NULL == target || NULL == setting) { return; }
+
+  // Longest filter which settles in time. Coefficient c needs roughly c conversions to respond to a step.
+  uint8_t iir = 0;
+  while(iir < GOVERNOR_IIR_MAX && ((uint32_t)2 << iir) * interval_ms <= target->response_ms) { iir++; }
+  const uint32_t gain = iir_gain[iir];
+
+  uint8_t os_t = select_oversampling(noise_temperature, gain, target->noise_temperature);
+  uint8_t os_p = select_oversampling(noise_pressure, gain, target->noise_pressure);
+  uint8_t os_h = select_oversampling(noise_humidity, 1000, target->noise_humidity);
+
+  bool met = filtered_noise(noise_temperature, gain, os_t) <= target->noise_temperature &&
+             filtered_noise(noise_pressure, gain, os_p)    <= target->noise_pressure &&
+             filtered_noise(noise_humidity, 1000, os_h)    <= target->noise_humidity;
+
+  // Step down the channel which costs most until within budget or all channels are at 1x
+  while(bme280_governor_charge_nc(os_t, os_p, os_h) > target->budget_nc &&
+        (os_t > GOVERNOR_OS_1 || os_p > GOVERNOR_OS_1 || os_h > GOVERNOR_OS_1))
+  {
+    uint32_t cost_t = (os_t > GOVERNOR_OS_1) ? samples(os_t) * GOVERNOR_CURRENT_TEMPERATURE_UA : 0;
+    uint32_t cost_p = (os_p > GOVERNOR_OS_1) ? samples(os_p) * GOVERNOR_CURRENT_PRESSURE_UA : 0;
+    uint32_t cost_h = (os_h > GOVERNOR_OS_1) ? samples(os_h) * GOVERNOR_CURRENT_HUMIDITY_UA : 0;
+    if(cost_p >= cost_t && cost_p >= cost_h) { os_p--; }
+    else if(cost_h >= cost_t)                { os_h--; }
+    else                                     { os_t--; }
+    met = false;
+  }
+
+  setting->oversampling_temp   = os_t;
+  setting->oversampling_press  = os_p;
+  setting->oversampling_hum    = os_h;
+  setting->iir                 = iir << GOVERNOR_IIR_SHIFT;
+  setting->measurement_time_us = bme280_governor_measurement_time_us(os_t, os_p, os_h);
+  setting->charge_nc           = bme280_governor_charge_nc(os_t, os_p, os_h);
+  setting->targets_met         = met;
+}
@@ -0,0 +1,56 @@
+#ifndef BME280_GOVERNOR_H
+#define BME280_GOVERNOR_H
+/*
+ * Selects BME280 oversampling and IIR filter from target noise levels and a charge budget per
+ * measurement, BST-BME280-DS001-11 section 3.5 (noise), 9.1 (measurement time) and table 1 (current).
+ *
+ * IIR filter advances once per conversion, so the longest filter that still settles within
+ * response_ms is selected for the given measurement interval. Then each channel gets the lowest
+ * oversampling which reaches its target noise after filtering. If the result exceeds the charge
+ * budget, the most expensive channel is stepped down until the budget is met.
+ * IIR applies to temperature and pressure only, humidity is not filtered by the sensor.
+ *
+ * Plain C without SDK dependencies so that selections can be checked on host, see benchmark/.
+ * Oversampling and IIR values are register values, i.e. BME280_OVERSAMPLING_* and BME280_IIR_*.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Targets of governor */
+typedef struct {
+  uint16_t noise_temperature; /**< Target RMS noise, 0.0001 C */
+  uint16_t noise_humidity;    /**< Target RMS noise, 0.001 %RH */
+  uint16_t noise_pressure;    /**< Target RMS noise, 0.01 Pa */
+  uint32_t budget_nc;         /**< Maximum charge per measurement, nC (uA * ms) */
+  uint32_t response_ms;       /**< Maximum IIR step response time, ms */
+}bme280_governor_target_t;
+
+/** Selected settings and their estimated cost */
+typedef struct {
+  uint8_t  oversampling_temp;   /**< BME280_OVERSAMPLING_* */
+  uint8_t  oversampling_press;  /**< BME280_OVERSAMPLING_* */
+  uint8_t  oversampling_hum;    /**< BME280_OVERSAMPLING_* */
+  uint8_t  iir;                 /**< BME280_IIR_* */
+  uint32_t measurement_time_us; /**< Maximum conversion time */
+  uint32_t charge_nc;           /**< Charge per conversion */
+  bool     targets_met;         /**< False if budget prevented reaching noise targets */
+}bme280_governor_setting_t;
+
+/**
+ *  Select settings for measurements every interval_ms milliseconds.
+ */
+void bme280_governor_select(const bme280_governor_target_t* const target, const uint32_t interval_ms,
+                            bme280_governor_setting_t* const setting);
+
+/**
+ *  Maximum conversion time in microseconds for given oversampling register values.
+ */
+uint32_t bme280_governor_measurement_time_us(uint8_t os_temp, uint8_t os_press, uint8_t os_hum);
+
+/**
+ *  Charge of one conversion in nC for given oversampling register values.
+ */
+uint32_t bme280_governor_charge_nc(uint8_t os_temp, uint8_t os_press, uint8_t os_hum);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef BME280_REGISTERS_H
+#define BME280_REGISTERS_H
+/*
+ * BME280 register addresses and values, BST-BME280-DS001-11 section 5.
+ * Plain C without SDK dependencies so that register values can be used in host tools.
+ */
+
+#define BME280REG_CALIB_00       (0x88)
+#define BME280REG_ID             (0xD0)
+#define BME280REG_RESET          (0xE0)
+#define BME280REG_CALIB_26       (0xE1)
+#define BME280REG_CTRL_HUM       (0xF2)
+#define BME280REG_STATUS         (0xF3)
+#define BME280REG_CTRL_MEAS      (0xF4)
+#define BME280REG_CONFIG         (0xF5)
+#define BME280REG_PRESS_MSB      (0xF7)
+#define BME280REG_PRESS_LSB      (0xF8)
+#define BME280REG_PRESS_XLSB     (0xF9)
+#define BME280REG_TEMP_MSB       (0xFA)
+#define BME280REG_TEMP_LSB       (0xFB)
+#define BME280REG_TEMP_XLSB      (0xFC)
+#define BME280REG_HUM_MSB        (0xFD)
+#define BME280REG_HUM_LSB        (0xFE)
+
+#define BME280_ID_VALUE          (0x60)
+
+#define BME280_OVERSAMPLING_SKIP (0x00)
+#define BME280_OVERSAMPLING_1    (0x01)
+#define BME280_OVERSAMPLING_2    (0x02)
+#define BME280_OVERSAMPLING_4    (0x03)
+#define BME280_OVERSAMPLING_8    (0x04)
+#define BME280_OVERSAMPLING_16   (0x05)
+
+#define BME280_IIR_MASK          (0x1C)
+#define BME280_IIR_OFF           (0x00)
+#define BME280_IIR_2             (0x04)
+#define BME280_IIR_4             (0x08)
+#define BME280_IIR_8             (0x0C)
+#define BME280_IIR_16            (0x10)
+
+#define BME280_INTERVAL_MASK     (0xE0)
+
+#define BME280_BURST_READ_LENGTH (9) // 8 bytes + address
+#define BME280_CALIB_00_LENGTH   (27) // 0x88 - 0xA1 + address
+#define BME280_CALIB_26_LENGTH   (8)  // 0xE1 - 0xE7 + address
+#define BME280_MAX_READ_LENGTH   BME280_CALIB_00_LENGTH
+
+enum BME280_INTERVAL {
+	BME280_STANDBY_0_5_MS  = 0x0,
+	BME280_STANDBY_62_5_MS = 0x20,
+	BME280_STANDBY_125_MS  = 0x40,
+	BME280_STANDBY_500_MS  = 0x80,
+	BME280_STANDBY_1000_MS = 0xA0
+};
+
+#endif
@@ -2,67 +2,124 @@
 #include "ruuvi_endpoints.h"
 #include "nrf_error.h"
 #include "bme280.h"
+#include "dsp.h"
 #include "nrf_delay.h"
 
+#include "app_timer_appsh.h"
+#include "init.h" // timer prescaler
+
 #define NRF_LOG_MODULE_NAME "BME280_TEMPERATURE_HANDLER"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 
-/** Data target handlers **/
-static message_handler p_ble_adv_handler = NULL;
-static message_handler p_ble_gatt_handler = NULL;
-static message_handler p_ble_mesh_handler = NULL;
-static message_handler p_proprietary_handler = NULL;
-static message_handler p_nfc_handler = NULL;
-static message_handler p_ram_handler = NULL;
-static message_handler p_flash_handler = NULL;
+/** Indices of endpoints in state array **/
+#define BME280_HANDLER_TEMPERATURE 0
+#define BME280_HANDLER_HUMIDITY    1
+#define BME280_HANDLER_PRESSURE    2
+#define BME280_HANDLER_NUM         3
+
+/** Maximum supported sample rate, sample timer cannot run faster than this **/
+#define BME280_HANDLER_MAX_RATE    200
+
+/** Endpoint of each state, in order of indices **/
+static const ruuvi_endpoint_t m_endpoints[BME280_HANDLER_NUM] = {TEMPERATURE, HUMIDITY, PRESSURE};
+/** Data type of each endpoint, in order of indices **/
+static const ruuvi_message_type_t m_types[BME280_HANDLER_NUM] = {INT32, UINT32, UINT32};
 
 /** State variables **/
-static ruuvi_sensor_configuration_t m_configuration = {0};
-static ruuvi_endpoint_t m_destination_endpoint = PLAINTEXT_MESSAGE; //TODO: use something 
+static message_handler_state_t m_states[BME280_HANDLER_NUM] = {0};
+static message_handler_state_t* p_state = NULL;  // State of endpoint currently being handled
+static uint8_t m_index = 0;                      // Index of endpoint currently being handled
+static int32_t m_latest[BME280_HANDLER_NUM] = {0};      // Latest sample of each endpoint
+static uint8_t m_dsp_counter[BME280_HANDLER_NUM] = {0}; // Samples since last DSP-rate transmission
+
+/** Sample timer is shared, as one sensor measures all endpoints **/
+APP_TIMER_DEF(bme280_sample_timer);
+static bool m_timer_created = false;
+static uint8_t m_sample_rate = SAMPLE_RATE_STOP;
 
-//TODO: Add timer interrupt to sample rate to read samples 
-/**     This must be called as last function, as this function may bring BME280 out of sleep which prevents further configuration  **/
+static void sample_timer_handler(void* p_context);
+
+/**  This must be called as last function, as this function may bring BME280 out of sleep which prevents further configuration  **/
 static ret_code_t set_sample_rate(uint8_t sample_rate)
 {
   ret_code_t err_code = BME280_RET_OK;
-  if(SAMPLE_RATE_NO_CHANGE == sample_rate) { return ENDPOINT_SUCCESS; }
-  else if(SAMPLE_RATE_STOP == sample_rate)
-  { 
-    err_code |= bme280_set_mode(BME280_MODE_SLEEP); 
-    if(BME280_RET_OK == err_code) { m_configuration.sample_rate = sample_rate; }
+  //Sensor was put to sleep for configuration, resume previous rate
+  if(SAMPLE_RATE_NO_CHANGE == sample_rate) { sample_rate = m_sample_rate; }
+  if(!m_timer_created)
+  {
+    err_code |= app_timer_create(&bme280_sample_timer, APP_TIMER_MODE_REPEATED, sample_timer_handler);
+    if(NRF_SUCCESS != err_code) { return ENDPOINT_HANDLER_ERROR; }
+    m_timer_created = true;
+  }
+  //Configuration may be called while streaming, stop timer until sensor is configured
+  app_timer_stop(bme280_sample_timer);
+
+  if(SAMPLE_RATE_STOP == sample_rate)
+  {
+    // Timer is stopped, stream has stopped even if sensor could not be put to sleep
+    err_code |= bme280_set_mode(BME280_MODE_SLEEP);
+    m_sample_rate = SAMPLE_RATE_STOP;
     return err_code;
   }
   else if(SAMPLE_RATE_SINGLE == sample_rate)
-  { 
-    err_code |= bme280_set_mode(BME280_MODE_FORCED); 
-    if(BME280_RET_OK == err_code) { m_configuration.sample_rate = SAMPLE_RATE_STOP; } //Sampling stops after one-shot
+  {
+    err_code |= bme280_set_mode(BME280_MODE_FORCED);
+    if(BME280_RET_OK == err_code) { m_sample_rate = SAMPLE_RATE_STOP; } //Sampling stops after one-shot
     return err_code;
   }
-  
+
   //Round sample rate down.
   if(sample_rate == 1){ err_code |= bme280_set_interval(BME280_STANDBY_1000_MS); }
   else if(sample_rate == 2)  { err_code |= bme280_set_interval(BME280_STANDBY_500_MS); }
   else if(sample_rate <= 8)  { err_code |= bme280_set_interval(BME280_STANDBY_125_MS); }
-  else if(sample_rate <= 16) { err_code |= bme280_set_interval(BME280_STANDBY_62_5_MS);}  
-  else if(sample_rate <= 200){ err_code |= bme280_set_interval(BME280_STANDBY_0_5_MS); }  
-  else { err_code |= BME280_RET_ILLEGAL; }
-	err_code |= bme280_set_mode(BME280_MODE_NORMAL);
-  if(BME280_RET_OK == err_code) { m_configuration.sample_rate = sample_rate; }
-	
-	return err_code;
+  else if(sample_rate <= 16) { err_code |= bme280_set_interval(BME280_STANDBY_62_5_MS);}
+  else if(sample_rate <= BME280_HANDLER_MAX_RATE){ err_code |= bme280_set_interval(BME280_STANDBY_0_5_MS); }
+  else { return ENDPOINT_INVALID; }
+  err_code |= bme280_set_mode(BME280_MODE_NORMAL);
+
+  //Read latest measurement from sensor at sample rate
+  uint32_t ticks = APP_TIMER_TICKS(1000 / sample_rate, RUUVITAG_APP_TIMER_PRESCALER);
+  if(APP_TIMER_MIN_TIMEOUT_TICKS > ticks) { ticks = APP_TIMER_MIN_TIMEOUT_TICKS; }
+  if(BME280_RET_OK == err_code) { err_code |= app_timer_start(bme280_sample_timer, ticks, NULL); }
+  if(BME280_RET_OK == err_code) { m_sample_rate = sample_rate; }
+  // Do not leave sensor converting without a reader
+  else
+  {
+    bme280_set_mode(BME280_MODE_SLEEP);
+    m_sample_rate = SAMPLE_RATE_STOP;
+  }
 
+  return err_code;
 }
 
 static ret_code_t set_transmission_rate(uint8_t transmission_rate)
 {
-  return ENDPOINT_NOT_IMPLEMENTED; //TODO: implement 
+  ret_code_t err_code = ENDPOINT_SUCCESS;
+  NRF_LOG_DEBUG("Setting transmission_rate %d\r\n", transmission_rate);
+  switch(transmission_rate)
+  {
+    case TRANSMISSION_RATE_STOP:
+    case TRANSMISSION_RATE_SAMPLERATE:
+    case TRANSMISSION_RATE_DSPRATE:
+      m_dsp_counter[m_index] = 0;
+      break;
+
+    case TRANSMISSION_RATE_NO_CHANGE:
+      return ENDPOINT_SUCCESS;
+
+    default:
+      // Transmission at fixed interval independent of sample rate is not supported
+      return ENDPOINT_NOT_IMPLEMENTED;
+  }
+  p_state->configuration.transmission_rate = transmission_rate;
+  return err_code;
 }
 
 static ret_code_t set_resolution(uint8_t resolution)
 {
   // BME280 has only one resolution for each sensor, return success on valid value, mark as MAX
-  m_configuration.resolution = RESOLUTION_MAX;
+  p_state->configuration.resolution = RESOLUTION_MAX;
   if(RESOLUTION_MIN       == resolution) { return ENDPOINT_SUCCESS; }
   if(RESOLUTION_MAX       == resolution) { return ENDPOINT_SUCCESS; }
   if(RESOLUTION_NO_CHANGE == resolution) { return ENDPOINT_SUCCESS; }
@@ -72,27 +129,42 @@ static ret_code_t set_resolution(uint8_t resolution)
 static ret_code_t set_scale(uint8_t scale)
 {
   // BME280 has only one scale for each sensor, return success on valid value, mark as MAX
-  m_configuration.scale = SCALE_MAX;
+  p_state->configuration.scale = SCALE_MAX;
   if(SCALE_MIN       == scale) { return ENDPOINT_SUCCESS; }
   if(SCALE_MAX       == scale) { return ENDPOINT_SUCCESS; }
   if(SCALE_NO_CHANGE == scale) { return ENDPOINT_SUCCESS; }
   return ENDPOINT_NOT_SUPPORTED; //Scale cannot be changed, return error
 }
 
-static ret_code_t set_dsp_function(uint8_t dsp_function)
+/**
+ *  Setup DSP function. Function and parameter are set together, as parameter
+ *  defines the length of filter.
+ */
+static ret_code_t set_dsp(uint8_t dsp_function, uint8_t dsp_parameter)
 {
-  if(DSP_LAST == dsp_function)
+  dsp_filter_t* p_filter = &(p_state->dsp[0]);
+  switch(dsp_function)
   {
-    m_configuration.dsp_function = DSP_LAST;
-    return ENDPOINT_SUCCESS; 
-  }
-  return ENDPOINT_NOT_IMPLEMENTED; //TODO
-}
+    case DSP_LAST:
+      if(dsp_is_init(p_filter)) { dsp_uninit(p_filter); }
+      p_state->configuration.dsp_function  = DSP_LAST;
+      p_state->configuration.dsp_parameter = 1;
+      break;
 
-static ret_code_t set_dsp_parameter(uint8_t dsp_parameter)
-{
-  m_configuration.dsp_parameter = 1;
-  return ENDPOINT_NOT_IMPLEMENTED; //TODO
+    case DSP_AVERAGE:
+    case DSP_STDEV:
+      if(0 == dsp_parameter) { return ENDPOINT_INVALID; }
+      if(dsp_is_init(p_filter)) { dsp_uninit(p_filter); }
+      *p_filter = dsp_init(dsp_function, dsp_parameter);
+      p_state->configuration.dsp_function  = dsp_function;
+      p_state->configuration.dsp_parameter = dsp_parameter;
+      break;
+
+    default:
+      return ENDPOINT_NOT_IMPLEMENTED;
+  }
+  m_dsp_counter[m_index] = 0;
+  return ENDPOINT_SUCCESS;
 }
 
 static ret_code_t set_target(uint8_t target)
@@ -101,48 +173,81 @@ static ret_code_t set_target(uint8_t target)
   if(TRANSMISSION_TARGET_NO_CHANGE == target) { return ENDPOINT_SUCCESS; }
   if(TRANSMISSION_TARGET_STOP == target)
   {
-    //Stop application timers - TODO
-  
     //NULL handlers
-    p_ble_adv_handler = NULL;
-    p_ble_gatt_handler = NULL;
-    p_ble_mesh_handler = NULL;
-    p_proprietary_handler = NULL;
-    p_nfc_handler = NULL;
-    p_ram_handler = NULL;
-    p_flash_handler = NULL;
-    m_configuration.target = target;
+    p_state->p_ble_adv_handler = NULL;
+    p_state->p_ble_gatt_handler = NULL;
+    p_state->p_ble_mesh_handler = NULL;
+    p_state->p_proprietary_handler = NULL;
+    p_state->p_nfc_handler = NULL;
+    p_state->p_ram_handler = NULL;
+    p_state->p_flash_handler = NULL;
+    p_state->configuration.target = target;
     return ENDPOINT_SUCCESS;
   }
   if(TRANSMISSION_TARGET_BLE_GATT & target)
   {
-  p_ble_gatt_handler = get_ble_gatt_handler();
+  p_state->p_ble_gatt_handler = get_ble_gatt_handler();
   NRF_LOG_INFO("Setting up GATT handler\r\n");
   }
-  if(TRANSMISSION_TARGET_BLE_ADV & target){p_ble_adv_handler = get_ble_adv_handler();}
-  if(TRANSMISSION_TARGET_BLE_MESH & target){p_ble_mesh_handler = get_ble_mesh_handler();}
-  if(TRANSMISSION_TARGET_PROPRIETARY & target){ p_proprietary_handler = get_proprietary_handler(); }
-  if(TRANSMISSION_TARGET_NFC & target){ p_nfc_handler = get_nfc_handler(); }
-  if(TRANSMISSION_TARGET_RAM == target){ p_ram_handler = get_ram_handler(); }
-  if(TRANSMISSION_TARGET_FLASH == target){ p_flash_handler = get_flash_handler(); }
+  if(TRANSMISSION_TARGET_BLE_ADV & target){p_state->p_ble_adv_handler = get_ble_adv_handler();}
+  if(TRANSMISSION_TARGET_BLE_MESH & target){p_state->p_ble_mesh_handler = get_ble_mesh_handler();}
+  if(TRANSMISSION_TARGET_PROPRIETARY & target){ p_state->p_proprietary_handler = get_proprietary_handler(); }
+  if(TRANSMISSION_TARGET_NFC & target){ p_state->p_nfc_handler = get_nfc_handler(); }
+  if(TRANSMISSION_TARGET_RAM == target){ p_state->p_ram_handler = get_ram_handler(); }
+  if(TRANSMISSION_TARGET_FLASH == target){ p_state->p_flash_handler = get_flash_handler(); }
+  p_state->configuration.target = target;
 
   return ENDPOINT_SUCCESS;
 }
-/** Send transmission to all data endpoints. 
+
+/**
+ *  Send transmission to all data endpoints and to chained channel.
  */
 static ret_code_t transmit(const ruuvi_standard_message_t message)
 {
-  NRF_LOG_INFO("Transmitting to all data points\r\n");  
+  NRF_LOG_DEBUG("Transmitting to all data points\r\n");
   ret_code_t err_code = ENDPOINT_SUCCESS;
-  if(p_ble_adv_handler)     { err_code |= p_ble_adv_handler(message); }
-  if(p_ble_gatt_handler)    { err_code |= p_ble_gatt_handler(message); }
-  if(p_proprietary_handler) { err_code |= p_proprietary_handler(message); }
-  if(p_nfc_handler)         { err_code |= p_nfc_handler(message); }
-  if(p_ram_handler)         { err_code |= p_ram_handler(message); }
-  if(p_flash_handler)       { err_code |= p_flash_handler(message); }
+  if(p_state->p_ble_adv_handler)     { err_code |= p_state->p_ble_adv_handler(message); }
+  if(p_state->p_ble_gatt_handler)    { err_code |= p_state->p_ble_gatt_handler(message); }
+  if(p_state->p_proprietary_handler) { err_code |= p_state->p_proprietary_handler(message); }
+  if(p_state->p_nfc_handler)         { err_code |= p_state->p_nfc_handler(message); }
+  if(p_state->p_ram_handler)         { err_code |= p_state->p_ram_handler(message); }
+  if(p_state->p_flash_handler)       { err_code |= p_state->p_flash_handler(message); }
+  if(p_state->p_chain_handler)
+  {
+    ruuvi_standard_message_t chainmsg;
+    memcpy(&chainmsg, &message, sizeof(ruuvi_standard_message_t));
+    //Send message upstream to chain
+    chainmsg.destination_endpoint = p_state->downstream_endpoint;
+    NRF_LOG_DEBUG("Chaining to %d\r\n", chainmsg.destination_endpoint);
+    err_code |= p_state->p_chain_handler(chainmsg);
+  }
   return err_code;
 }
 
+/**
+ *  Build typed message of current endpoint. First value is output of DSP filter,
+ *  second value is the latest sample. DSP output is latest sample until filter has been filled.
+ */
+static ruuvi_standard_message_t typed_message(uint8_t destination)
+{
+  int32_t values[2];
+  values[0] = m_latest[m_index];
+  values[1] = m_latest[m_index];
+  dsp_filter_t* p_filter = &(p_state->dsp[0]);
+  if(dsp_is_init(p_filter) && ringbuffer_full(&(p_filter->z)))
+  {
+    float filtered = p_filter->read(&(p_filter->z), p_filter->dsp_parameter);
+    values[0] = (UINT32 == m_types[m_index]) ? (int32_t)(uint32_t)filtered : (int32_t)filtered;
+  }
+  ruuvi_standard_message_t message = {.destination_endpoint = destination,
+                                      .source_endpoint = m_endpoints[m_index],
+                                      .type = m_types[m_index],
+                                      .payload = {0}};
+  memcpy(message.payload, values, sizeof(message.payload));
+  return message;
+}
+
 //prevent recursing into BME280 config functions with lock bit.
 static bool synch_lock = false;
 static ret_code_t configure_sensor(const ruuvi_standard_message_t message)
@@ -152,7 +257,6 @@ static ret_code_t configure_sensor(const ruuvi_standard_message_t message)
   NRF_LOG_HEXDUMP_INFO((uint8_t*)&(message.destination_endpoint), sizeof(message));
   NRF_LOG_INFO("\r\n");
   bme280_set_mode(BME280_MODE_SLEEP); // Sleep sensor while configuring
-                                      // TODO: Pass message to BME280 pressure, humidity handlers  
 
   //Return codes are truncated to 8 bits.
   ruuvi_sensor_configuration_t result = {0};
@@ -161,106 +265,241 @@ static ret_code_t configure_sensor(const ruuvi_standard_message_t message)
   NRF_LOG_HEXDUMP_INFO((uint8_t*)payload, sizeof(ruuvi_sensor_configuration_t));
   NRF_LOG_DEBUG("Transmission rate\r\n");
   result.transmission_rate = set_transmission_rate(payload->transmission_rate);
-  NRF_LOG_DEBUG("Resolution\r\n");  
+  NRF_LOG_DEBUG("Resolution\r\n");
   result.resolution = set_resolution(payload->resolution);
-  NRF_LOG_DEBUG("Scale\r\n");  
+  NRF_LOG_DEBUG("Scale\r\n");
   result.scale = set_scale(payload->scale);
-  NRF_LOG_DEBUG("DSP\r\n");  
-  result.dsp_function = set_dsp_function(payload->dsp_function);
-  NRF_LOG_DEBUG("DSP_Param\r\n");  
-  result.dsp_parameter = set_dsp_parameter(payload->dsp_parameter);
-  NRF_LOG_DEBUG("Target %d\r\n", payload->target);  
-  result.target = set_target(message.payload[6]);
+  NRF_LOG_DEBUG("DSP\r\n");
+  result.dsp_function = set_dsp(payload->dsp_function, payload->dsp_parameter);
+  result.dsp_parameter = result.dsp_function;
+  NRF_LOG_DEBUG("Target %d\r\n", payload->target);
+  result.target = set_target(payload->target);
   //Call sample rate as last as this may bring sensor out of sleep
-  NRF_LOG_DEBUG("Sample rate\r\n");    
+  NRF_LOG_DEBUG("Sample rate\r\n");
   result.sample_rate = set_sample_rate(payload->sample_rate);
-  
+
   //Store endpoint request came from, even if message will not be processed due to error (TODO?)
-  m_destination_endpoint = message.source_endpoint;
+  p_state->destination_endpoint = message.source_endpoint;
 
   ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
                                      .source_endpoint      = message.destination_endpoint,
                                      .type                 = ACKNOWLEDGEMENT,
-                                     .payload              = {*((uint8_t*)&result)}}; //TODO: Check cast (value of address of configuration casted to uint8_t)
+                                     .payload              = {0}};
+  memcpy(reply.payload, &result, sizeof(reply.payload));
   synch_lock = false;
-  NRF_LOG_INFO("Configuration done\r\n");  
+  NRF_LOG_INFO("Configuration done\r\n");
   //Return error if cannot reply
   ret_code_t err_code = ENDPOINT_HANDLER_ERROR;
   message_handler p_reply_handler = get_reply_handler();
-  if(p_reply_handler) 
-  {  
+  if(p_reply_handler)
+  {
     NRF_LOG_INFO("Sending reply from configuration\r\n");
     err_code = p_reply_handler(reply);
   }
   return err_code; //Error codes from configuration are in payload of reply
 }
 
+/**
+ *  Reply current configuration of endpoint. Sample rate is shared by all endpoints.
+ */
+static ret_code_t query_sensor(const ruuvi_standard_message_t message)
+{
+  ruuvi_sensor_configuration_t configuration = p_state->configuration;
+  configuration.sample_rate = m_sample_rate;
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = message.destination_endpoint,
+                                     .type                 = SENSOR_CONFIGURATION,
+                                     .payload              = {0}};
+  memcpy(reply.payload, &configuration, sizeof(reply.payload));
+  message_handler p_reply_handler = get_reply_handler();
+  if(!p_reply_handler) { return ENDPOINT_HANDLER_ERROR; }
+  return p_reply_handler(reply);
+}
+
+/**
+ *  Copy function pointer address to which to send the data to be chained
+ */
+static ret_code_t configure_chain_downstream(const ruuvi_standard_message_t message)
+{
+  ret_code_t err_code = ENDPOINT_SUCCESS;
+  ruuvi_chain_configuration_t* config = (void*)&message.payload;
+  // Stop transmitting if transmission rate is 0
+  if(TRANSMISSION_RATE_STOP == config->transmission_rate)
+  {
+    p_state->downstream_endpoint = 0;
+    p_state->p_chain_handler = NULL;
+  }
+  //Else configure data chain
+  else
+  {
+    p_state->p_chain_handler      = get_chain_handler();
+    p_state->downstream_endpoint  = message.source_endpoint;
+  }
+
+  //Reply via reply handler if applicable
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler)
+  {
+    ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                       .source_endpoint      = message.destination_endpoint,
+                                       .type                 = ACKNOWLEDGEMENT,
+                                       .payload              = { 0 }};
+    NRF_LOG_DEBUG("Sending reply after configuring Downstream Endpoint %d\r\n", p_state->downstream_endpoint);
+    err_code = p_reply_handler(reply);
+  }
+  return err_code;
+}
+
+/**
+ *  Format latest value of current endpoint as plain text, payload is 8 characters without terminating NULL.
+ */
+static void format_ascii(uint8_t* const payload)
+{
+  char ascii[9] = {0};
+  int32_t value = m_latest[m_index];
+  switch(m_endpoints[m_index])
+  {
+    case TEMPERATURE:
+    {
+      char sign = (value < 0) ? '-' : ' ';
+      if(value < 0) { value = -value; }
+      snprintf(ascii, sizeof(ascii), "%c%ld.%02ldC", sign, (long)(value/100), (long)(value%100));
+      break;
+    }
+    case HUMIDITY:
+      snprintf(ascii, sizeof(ascii), "%lu.%02lu%%", (unsigned long)((uint32_t)value >> 10), (unsigned long)((((uint32_t)value & 0x3FF) * 100) >> 10));
+      break;
+
+    case PRESSURE:
+      snprintf(ascii, sizeof(ascii), "%luPa", (unsigned long)((uint32_t)value >> 8));
+      break;
+
+    default:
+      break;
+  }
+  memcpy(payload, ascii, 8);
+}
+
 static ret_code_t read_sensor(const ruuvi_standard_message_t message)
 {
   ret_code_t err_code = ENDPOINT_SUCCESS;
-  err_code |= bme280_read_measurements(); // Read measured values from BME - TODO separate error codes for driver / endpoint.
-  //Take temperature
-  int32_t temperature = bme280_get_temperature();
-  NRF_LOG_INFO("Sending reply from temperature: %d\r\n", (uint32_t)temperature);
+  // Read measured values from BME unless they are being streamed
+  if(SAMPLE_RATE_STOP == m_sample_rate)
+  {
+    bme280_data_t data;
+    err_code |= bme280_read_measurements();
+    err_code |= bme280_get_data(&data);
+    m_latest[BME280_HANDLER_TEMPERATURE] = data.temperature;
+    m_latest[BME280_HANDLER_HUMIDITY]    = (int32_t)data.humidity;
+    m_latest[BME280_HANDLER_PRESSURE]    = (int32_t)data.pressure;
+  }
+
   // Plaintext reply if message came from PLAINTEXT endpoint
   if(PLAINTEXT_MESSAGE == message.source_endpoint)
   {
-    char ascii[8] = {0};
-    sprintf(ascii, "%ld.%ld C", temperature/100, temperature%100); // TODO Check decimals on negative values
     ruuvi_standard_message_t reply = {.destination_endpoint = message.source_endpoint,
-                                      .source_endpoint = TEMPERATURE,
+                                      .source_endpoint = m_endpoints[m_index],
                                       .type = ASCII,
                                       .payload = {0}};
-    memcpy(&(reply.payload[0]), &(ascii[0]), sizeof(reply.payload));                                  
-    NRF_LOG_INFO("Sending plain text %s\r\n", (uint32_t)reply.payload);  
+    format_ascii(reply.payload);
     err_code |= transmit(reply);
   }
-  //Else INT64 reply
-  else 
+  //Else typed reply
+  else
   {
-    int64_t rvalue = temperature;
-    uint8_t* cast  = (void*)&rvalue;
-    NRF_LOG_INFO("Sending raw reply\r\n");  
-    ruuvi_standard_message_t reply = {.destination_endpoint = message.source_endpoint,
-                                      .source_endpoint = TEMPERATURE,
-                                      .type = ASCII,
-                                      .payload = {cast[0]}}; //TODO: Check the casts
-    err_code |= transmit(reply);
+    NRF_LOG_INFO("Sending raw reply\r\n");
+    err_code |= transmit(typed_message(message.source_endpoint));
   }
   return err_code;
 }
 
-ret_code_t bme280_temperature_handler(const ruuvi_standard_message_t message)
+/**
+ *  Process new sample of given endpoint, transmit if configured to transmit at sample rate
+ *  or if DSP filter has received a new set of samples.
+ */
+static void process(const uint8_t index, const int32_t value)
+{
+  m_index = index;
+  p_state = &(m_states[index]);
+  m_latest[index] = value;
+
+  dsp_filter_t* p_filter = &(p_state->dsp[0]);
+  if(dsp_is_init(p_filter))
+  {
+    float next = (UINT32 == m_types[index]) ? (float)(uint32_t)value : (float)value;
+    p_filter->process(&(p_filter->z), p_filter->dsp_parameter, next);
+  }
+
+  bool send = false;
+  if(TRANSMISSION_RATE_SAMPLERATE == p_state->configuration.transmission_rate) { send = true; }
+  else if(TRANSMISSION_RATE_DSPRATE == p_state->configuration.transmission_rate)
+  {
+    if(++m_dsp_counter[index] >= p_state->configuration.dsp_parameter)
+    {
+      m_dsp_counter[index] = 0;
+      send = true;
+    }
+  }
+  if(send) { transmit(typed_message(p_state->destination_endpoint)); }
+}
+
+/** Timer handler, called in scheduler context. Reads sensor and processes all endpoints **/
+static void sample_timer_handler(void* p_context)
+{
+  if(synch_lock) { return; }
+  bme280_data_t data;
+  if(BME280_RET_OK != bme280_read_measurements()) { return; }
+  if(BME280_RET_OK != bme280_get_data(&data)) { return; }
+  process(BME280_HANDLER_TEMPERATURE, data.temperature);
+  process(BME280_HANDLER_HUMIDITY,    (int32_t)data.humidity);
+  process(BME280_HANDLER_PRESSURE,    (int32_t)data.pressure);
+}
+
+/**
+ *  Common handler for all BME280 endpoints.
+ */
+static ret_code_t handler(const uint8_t index, const ruuvi_standard_message_t message)
 {
   //Return if message was not meant for this endpoint.
   NRF_LOG_INFO("Message type is %d\r\n", message.type);
-  if(TEMPERATURE != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  if(m_endpoints[index] != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  m_index = index;
+  p_state = &(m_states[index]);
   switch(message.type)
   {
-  
     case SENSOR_CONFIGURATION:
       NRF_LOG_INFO("Configuring\r\n");
       return configure_sensor(message);
       break;
-      
-    case STATUS_QUERY: 
-      return unknown_handler(message);
-      //return query_sensor(message); TODO
+
+    case STATUS_QUERY:
+      NRF_LOG_INFO("Querying status\r\n");
+      return query_sensor(message);
       break;
-      
+
     case DATA_QUERY:
       NRF_LOG_INFO("Querying\r\n");
       return read_sensor(message);
       break;
-      
+
+    case CHAIN_DOWNSTREAM_CONFIGURATION:
+      NRF_LOG_INFO("Setting up message chain\r\n");
+      return configure_chain_downstream(message);
+      break;
+
+    case CHAIN_UPSTREAM_CONFIGURATION:
+      NRF_LOG_ERROR("Sensor cannot be upstream target\r\n");
+      return ENDPOINT_INVALID;
+      break;
+
     case LOG_QUERY:
       return unknown_handler(message);
       break;
-      
+
     case CAPABILITY_QUERY:
       return unknown_handler(message);
       break;
-      
+
     default:
       return unknown_handler(message);
       break;
@@ -268,3 +507,22 @@ ret_code_t bme280_temperature_handler(const ruuvi_standard_message_t message)
   return ENDPOINT_HANDLER_ERROR; // Should not be reached
 }
 
+bool bme280_stream_active(void)
+{
+  return SAMPLE_RATE_STOP != m_sample_rate;
+}
+
+ret_code_t bme280_temperature_handler(const ruuvi_standard_message_t message)
+{
+  return handler(BME280_HANDLER_TEMPERATURE, message);
+}
+
+ret_code_t bme280_humidity_handler(const ruuvi_standard_message_t message)
+{
+  return handler(BME280_HANDLER_HUMIDITY, message);
+}
+
+ret_code_t bme280_pressure_handler(const ruuvi_standard_message_t message)
+{
+  return handler(BME280_HANDLER_PRESSURE, message);
+}
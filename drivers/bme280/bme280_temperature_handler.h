@@ -1,6 +1,28 @@
 #ifndef BME280_TEMPERATURE_HANDLER_H
 #define BME280_TEMPERATURE_HANDLER_H
+#include <stdbool.h>
 #include "ruuvi_endpoints.h"
 #include "nrf_error.h"
+
+/**
+ *  Endpoint handlers for BME280 temperature, humidity and pressure.
+ *
+ *  All three endpoints share one sensor and therefore one sample rate, the latest configured
+ *  sample rate applies to all endpoints. Transmission rate, DSP and targets are per endpoint.
+ *
+ *  Streamed data is sent as two 32-bit values: payload[0...3] is output of DSP filter and
+ *  payload[4...7] is the latest sample. Temperature is INT32 in 0.01 C, humidity UINT32 in
+ *  Q22.10 %RH and pressure UINT32 in Q24.8 Pa.
+ *
+ *  STATUS_QUERY is replied with SENSOR_CONFIGURATION message holding current configuration of endpoint.
+ */
+/**
+ *  Returns true while BME280 is streamed at a continuous sample rate. Stream owns the sensor,
+ *  application must not change mode or configuration of BME280 until stream is stopped.
+ */
+bool bme280_stream_active(void);
+
 ret_code_t bme280_temperature_handler(const ruuvi_standard_message_t message);
+ret_code_t bme280_humidity_handler(const ruuvi_standard_message_t message);
+ret_code_t bme280_pressure_handler(const ruuvi_standard_message_t message);
 #endif
@@ -0,0 +1,161 @@
+#include <string.h>
+#include "bme280_fake.h"
+#include "bme280_registers.h"
+#include "spi.h"
+
+static uint8_t  m_regs[256];
+static bool     m_fail;
+static bool     m_converting;
+static uint32_t m_conversions;
+static uint32_t m_timer_starts;
+static app_timer_id_t m_timer_latest;
+static void (*m_observer)(const uint8_t count);
+
+/** Bosch example calibration, little endian from 0x88 and from 0xE1 */
+static const int32_t m_calib_tp[] = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+
+void fake_reset(void)
+{
+  memset(m_regs, 0, sizeof(m_regs));
+  m_regs[BME280REG_ID] = 0x60;
+  for(size_t ii = 0; ii < sizeof(m_calib_tp) / sizeof(m_calib_tp[0]); ii++)
+  {
+    m_regs[BME280REG_CALIB_00 + 2 * ii]     = (uint8_t)(m_calib_tp[ii] & 0xFF);
+    m_regs[BME280REG_CALIB_00 + 2 * ii + 1] = (uint8_t)((m_calib_tp[ii] >> 8) & 0xFF);
+  }
+  m_regs[0xA1] = 75;                                    // H1
+  m_regs[0xE1] = 362 & 0xFF; m_regs[0xE2] = 362 >> 8;   // H2
+  m_regs[0xE3] = 0;                                     // H3
+  m_regs[0xE4] = 313 >> 4;                              // H4 11:4
+  m_regs[0xE5] = (313 & 0x0F) | ((50 & 0x0F) << 4);     // H4 3:0, H5 3:0
+  m_regs[0xE6] = 50 >> 4;                               // H5 11:4
+  m_regs[0xE7] = 30;                                    // H6
+  m_fail = false;
+  m_converting = false;
+  m_conversions = 0;
+  m_timer_starts = 0;
+  m_timer_latest = NULL;
+}
+
+void fake_spi_fail(const bool fail)
+{
+  m_fail = fail;
+}
+
+void fake_spi_observe(void (*observer)(const uint8_t count))
+{
+  m_observer = observer;
+}
+
+uint8_t fake_bme280_mode(void)
+{
+  return m_regs[BME280REG_CTRL_MEAS] & 0x03;
+}
+
+uint8_t fake_bme280_reg(const uint8_t reg)
+{
+  return m_regs[reg];
+}
+
+uint32_t fake_bme280_conversions(void)
+{
+  return m_conversions;
+}
+
+bool fake_bme280_convert(const int32_t adc_t, const int32_t adc_p, const int32_t adc_h)
+{
+  if(!m_converting) { return false; }
+  m_regs[BME280REG_PRESS_MSB]  = (uint8_t)(adc_p >> 12);
+  m_regs[BME280REG_PRESS_LSB]  = (uint8_t)(adc_p >> 4);
+  m_regs[BME280REG_PRESS_XLSB] = (uint8_t)(adc_p << 4);
+  m_regs[BME280REG_TEMP_MSB]   = (uint8_t)(adc_t >> 12);
+  m_regs[BME280REG_TEMP_LSB]   = (uint8_t)(adc_t >> 4);
+  m_regs[BME280REG_TEMP_XLSB]  = (uint8_t)(adc_t << 4);
+  m_regs[BME280REG_HUM_MSB]    = (uint8_t)(adc_h >> 8);
+  m_regs[BME280REG_HUM_LSB]    = (uint8_t)adc_h;
+  // Forced conversion returns to sleep, normal mode keeps converting
+  if(0x01 == fake_bme280_mode() || 0x02 == fake_bme280_mode())
+  {
+    m_regs[BME280REG_CTRL_MEAS] &= 0xFC;
+    m_converting = false;
+  }
+  return true;
+}
+
+void spi_init(void)
+{
+}
+
+bool spi_isInitialized(void)
+{
+  return true;
+}
+
+SPI_Ret spi_transfer_bme280(uint8_t* const p_toWrite, uint8_t count, uint8_t* const p_toRead)
+{
+  if(m_observer) { m_observer(count); }
+  if(m_fail) { return SPI_RET_ERROR; }
+  // Read: address with MSB set followed by auto-incremented data
+  if(p_toWrite[0] & 0x80)
+  {
+    for(uint8_t ii = 1; ii < count; ii++) { p_toRead[ii] = m_regs[(uint8_t)(p_toWrite[0] + ii - 1)]; }
+    return SPI_RET_OK;
+  }
+  // Multiple write: pairs of address without MSB and data
+  for(uint8_t ii = 0; ii + 1 < count; ii += 2)
+  {
+    const uint8_t reg = p_toWrite[ii] | 0x80;
+    m_regs[reg] = p_toWrite[ii + 1];
+    if(BME280REG_CTRL_MEAS == reg)
+    {
+      m_converting = (0x00 != fake_bme280_mode());
+      if(m_converting) { m_conversions++; }
+    }
+  }
+  return SPI_RET_OK;
+}
+
+uint32_t app_timer_create(app_timer_id_t const* p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler)
+{
+  app_timer_t* timer = *p_timer_id;
+  if(timer->created) { return NRF_ERROR_INVALID_STATE; }
+  timer->created = true;
+  timer->running = false;
+  timer->mode    = mode;
+  timer->handler = timeout_handler;
+  return NRF_SUCCESS;
+}
+
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void* p_context)
+{
+  if(!timer_id->created || APP_TIMER_MIN_TIMEOUT_TICKS > timeout_ticks) { return NRF_ERROR_INVALID_STATE; }
+  timer_id->running = true;
+  timer_id->ticks   = timeout_ticks;
+  m_timer_starts++;
+  m_timer_latest = timer_id;
+  return NRF_SUCCESS;
+}
+
+uint32_t app_timer_stop(app_timer_id_t timer_id)
+{
+  timer_id->running = false;
+  return NRF_SUCCESS;
+}
+
+bool fake_timer_fire(const app_timer_id_t timer_id)
+{
+  if(!timer_id->running) { return false; }
+  if(APP_TIMER_MODE_SINGLE_SHOT == timer_id->mode) { timer_id->running = false; }
+  timer_id->handler(NULL);
+  return true;
+}
+
+uint32_t fake_timer_starts(void)
+{
+  return m_timer_starts;
+}
+
+app_timer_id_t fake_timer_latest(void)
+{
+  return m_timer_latest;
+}
@@ -0,0 +1,50 @@
+#ifndef BME280_FAKE_H
+#define BME280_FAKE_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_timer_appsh.h"
+
+/**
+ *  Host fakes of BME280 on SPI bus and of app timer.
+ *
+ *  Register file answers reads and takes multiple writes like the sensor. Writing FORCED to
+ *  CTRL_MEAS starts a conversion which completes when test calls fake_bme280_convert(),
+ *  sensor then returns to sleep. Calibration is the example of Bosch reference code.
+ */
+
+/** Raw values of 25.08 C, 1006.5 hPa and 55 %RH with fake calibration */
+#define FAKE_ADC_T 519888
+#define FAKE_ADC_P 415148
+#define FAKE_ADC_H 30000
+
+/** Reset sensor registers and all timers */
+void fake_reset(void);
+
+/** Fail every SPI transfer while set */
+void fake_spi_fail(const bool fail);
+
+/** Call observer with byte count of every SPI transfer, NULL to stop */
+void fake_spi_observe(void (*observer)(const uint8_t count));
+
+/** Mode bits of CTRL_MEAS */
+uint8_t fake_bme280_mode(void);
+
+/** Register value */
+uint8_t fake_bme280_reg(const uint8_t reg);
+
+/** Number of conversions started by writes to CTRL_MEAS */
+uint32_t fake_bme280_conversions(void);
+
+/** Complete conversion with given raw values. Returns false if no conversion was running. */
+bool fake_bme280_convert(const int32_t adc_t, const int32_t adc_p, const int32_t adc_h);
+
+/** Run handler of timer as if it expired, returns false if timer was not running */
+bool fake_timer_fire(const app_timer_id_t timer_id);
+
+/** Number of timers started since reset */
+uint32_t fake_timer_starts(void);
+
+/** Latest started timer, NULL if none since reset */
+app_timer_id_t fake_timer_latest(void);
+
+#endif
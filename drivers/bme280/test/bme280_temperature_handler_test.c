@@ -0,0 +1,158 @@
+#include <stdio.h>
+#include <string.h>
+#include "bme280.h"
+#include "bme280_fake.h"
+#include "init.h"
+#include "bme280_temperature_handler.h"
+
+static int failures = 0;
+
+static void check(const bool ok, const char* const what, const long long value)
+{
+  if(ok) { return; }
+  failures++;
+  printf("FAIL %s: %lld\n", what, value);
+}
+
+/** Replies and GATT transmissions of handler, endpoint library is replaced by these */
+static ruuvi_standard_message_t m_reply;
+static int m_replies = 0;
+static ruuvi_standard_message_t m_gatt;
+static int m_gatt_messages = 0;
+
+static ret_code_t reply_handler(const ruuvi_standard_message_t message)
+{
+  m_reply = message;
+  m_replies++;
+  return ENDPOINT_SUCCESS;
+}
+
+static ret_code_t gatt_handler(const ruuvi_standard_message_t message)
+{
+  m_gatt = message;
+  m_gatt_messages++;
+  return ENDPOINT_SUCCESS;
+}
+
+message_handler get_reply_handler(void)       { return reply_handler; }
+message_handler get_ble_gatt_handler(void)    { return gatt_handler; }
+message_handler get_ble_adv_handler(void)     { return NULL; }
+message_handler get_ble_mesh_handler(void)    { return NULL; }
+message_handler get_proprietary_handler(void) { return NULL; }
+message_handler get_nfc_handler(void)         { return NULL; }
+message_handler get_ram_handler(void)         { return NULL; }
+message_handler get_flash_handler(void)       { return NULL; }
+message_handler get_chain_handler(void)       { return NULL; }
+ret_code_t unknown_handler(const ruuvi_standard_message_t message) { return ENDPOINT_UNKNOWN; }
+
+/** Only DSP_LAST is used, filters are never initialised */
+dsp_filter_t dsp_init(uint8_t type, uint8_t dsp_parameter)
+{
+  dsp_filter_t filter;
+  memset(&filter, 0, sizeof(filter));
+  return filter;
+}
+
+int dsp_is_init(dsp_filter_t* filter)
+{
+  return ringbuffer_is_init(&(filter->z));
+}
+
+void dsp_uninit(dsp_filter_t* filter)
+{
+  ringbuffer_uninit(&(filter->z));
+}
+
+static ruuvi_standard_message_t configuration(const uint8_t sample_rate)
+{
+  ruuvi_sensor_configuration_t config = { .sample_rate       = sample_rate,
+                                          .transmission_rate = TRANSMISSION_RATE_SAMPLERATE,
+                                          .resolution        = RESOLUTION_NO_CHANGE,
+                                          .scale             = SCALE_NO_CHANGE,
+                                          .dsp_function      = DSP_LAST,
+                                          .dsp_parameter     = 1,
+                                          .target            = TRANSMISSION_TARGET_BLE_GATT };
+  ruuvi_standard_message_t message = { .destination_endpoint = TEMPERATURE,
+                                       .source_endpoint      = PLAINTEXT_MESSAGE + 1,
+                                       .type                 = SENSOR_CONFIGURATION,
+                                       .payload              = {0}};
+  memcpy(message.payload, &config, sizeof(config));
+  return message;
+}
+
+/** Send configuration, check that all fields are acknowledged without error */
+static void configure(const uint8_t sample_rate)
+{
+  m_replies = 0;
+  ret_code_t err_code = bme280_temperature_handler(configuration(sample_rate));
+  check(ENDPOINT_SUCCESS == err_code, "configuration reply", err_code);
+  check(1 == m_replies && ACKNOWLEDGEMENT == m_reply.type, "acknowledgement", m_reply.type);
+  for(size_t ii = 0; ii < sizeof(ruuvi_sensor_configuration_t); ii++)
+  {
+    check(0 == m_reply.payload[ii], "acknowledged error", ii * 1000 + m_reply.payload[ii]);
+  }
+}
+
+/** STATUS_QUERY is replied with current configuration including sample rate */
+static void check_status(const uint8_t sample_rate)
+{
+  ruuvi_standard_message_t query = { .destination_endpoint = TEMPERATURE,
+                                     .source_endpoint      = PLAINTEXT_MESSAGE + 1,
+                                     .type                 = STATUS_QUERY,
+                                     .payload              = {0}};
+  m_replies = 0;
+  check(ENDPOINT_SUCCESS == bme280_temperature_handler(query), "status query", 0);
+  check(1 == m_replies && SENSOR_CONFIGURATION == m_reply.type, "status reply", m_reply.type);
+  ruuvi_sensor_configuration_t status;
+  memcpy(&status, m_reply.payload, sizeof(status));
+  check(sample_rate == status.sample_rate, "status sample rate", status.sample_rate);
+  check(TRANSMISSION_RATE_SAMPLERATE == status.transmission_rate, "status transmission rate", status.transmission_rate);
+  check(TRANSMISSION_TARGET_BLE_GATT == status.target, "status target", status.target);
+}
+
+static void check_stream(void)
+{
+  configure(10);
+  app_timer_id_t timer = fake_timer_latest();
+  check(NULL != timer && timer->running, "sample timer running", NULL != timer);
+  if(NULL == timer) { return; }
+  check(APP_TIMER_MODE_REPEATED == timer->mode, "sample timer mode", timer->mode);
+  check(APP_TIMER_TICKS(100, RUUVITAG_APP_TIMER_PRESCALER) == timer->ticks, "sample timer ticks", timer->ticks);
+  check(BME280_MODE_NORMAL == fake_bme280_mode(), "normal mode", fake_bme280_mode());
+  check(bme280_stream_active(), "stream active", 0);
+  check_status(10);
+
+  // Every timeout transmits latest conversion of normal mode
+  for(int sample = 0; sample < 3; sample++)
+  {
+    m_gatt_messages = 0;
+    check(fake_bme280_convert(FAKE_ADC_T + 16 * sample, FAKE_ADC_P, FAKE_ADC_H), "normal mode conversion", sample);
+    check(fake_timer_fire(timer), "sample timer fire", sample);
+    check(1 == m_gatt_messages, "streamed messages", m_gatt_messages);
+    int32_t values[2];
+    memcpy(values, m_gatt.payload, sizeof(values));
+    check(TEMPERATURE == m_gatt.source_endpoint && INT32 == m_gatt.type, "streamed type", m_gatt.type);
+    check(bme280_get_temperature() == values[1] && 2500 < values[1], "streamed temperature", values[1]);
+  }
+  check(timer->running, "sample timer repeats", 0);
+
+  configure(SAMPLE_RATE_STOP);
+  check(!timer->running, "sample timer stopped", 0);
+  check(BME280_MODE_SLEEP == fake_bme280_mode(), "sleep after stream", fake_bme280_mode());
+  check(!bme280_stream_active(), "stream stopped", 0);
+  check_status(SAMPLE_RATE_STOP);
+}
+
+int main(void)
+{
+  fake_reset();
+  BME280_Ret err_code = bme280_init();
+  check(BME280_RET_OK == err_code, "init", err_code);
+  check(!bme280_stream_active(), "stream before configuration", 0);
+
+  check_stream();
+  // Stream can be restarted after stop
+  check_stream();
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include "bme280.h"
+#include "bme280_fake.h"
+#include "init.h"
+
+static int failures = 0;
+
+static void check(const bool ok, const char* const what, const long long value)
+{
+  if(ok) { return; }
+  failures++;
+  printf("FAIL %s: %lld\n", what, value);
+}
+
+APP_TIMER_DEF(conversion_timer);
+static int conversion_timeouts = 0;
+
+static void conversion_timer_handler(void* p_context)
+{
+  conversion_timeouts++;
+}
+
+static const bme280_config_t config = { .oversampling_temp  = BME280_OVERSAMPLING_1,
+                                        .oversampling_press = BME280_OVERSAMPLING_1,
+                                        .oversampling_hum   = BME280_OVERSAMPLING_1,
+                                        .iir                = BME280_IIR_OFF,
+                                        .interval           = BME280_STANDBY_1000_MS,
+                                        .mode               = BME280_MODE_SLEEP
+                                      };
+
+/** Every mode transition must succeed and be tracked, configuration is only allowed in sleep */
+static void check_modes(void)
+{
+  const enum BME280_MODE modes[] = {BME280_MODE_NORMAL, BME280_MODE_SLEEP, BME280_MODE_FORCED, BME280_MODE_SLEEP};
+  for(size_t ii = 0; ii < sizeof(modes) / sizeof(modes[0]); ii++)
+  {
+    BME280_Ret err_code = bme280_set_mode(modes[ii]);
+    check(BME280_RET_OK == err_code, "set mode", err_code);
+    check(modes[ii] == fake_bme280_mode(), "mode register", fake_bme280_mode());
+    err_code = bme280_configure(&config);
+    check((BME280_MODE_SLEEP == modes[ii]) == (BME280_RET_OK == err_code), "configure after mode", err_code);
+  }
+  check(BME280_RET_ILLEGAL == bme280_set_mode(0x02), "invalid mode", 0x02);
+
+  // Main loop reconfiguration after normal mode configuration: sleep, then configure
+  bme280_config_t normal = config;
+  normal.mode = BME280_MODE_NORMAL;
+  check(BME280_RET_OK == bme280_configure(&normal), "configure normal", 0);
+  check(BME280_MODE_NORMAL == fake_bme280_mode(), "normal mode register", fake_bme280_mode());
+  check(BME280_RET_ILLEGAL == bme280_configure(&normal), "configure while normal", 0);
+  check(BME280_RET_OK == bme280_set_mode(BME280_MODE_SLEEP), "sleep after normal", 0);
+  check(BME280_RET_OK == bme280_configure(&config), "reconfigure after sleep", 0);
+
+  fake_spi_fail(true);
+  check(BME280_RET_ERROR == bme280_set_mode(BME280_MODE_NORMAL), "mode with SPI error", 0);
+  fake_spi_fail(false);
+  check(BME280_RET_OK == bme280_configure(&config), "mode unchanged after SPI error", 0);
+}
+
+/** Forced conversion arms timer which expires after conversion time, results are read from conversion */
+static void check_forced_conversion(void)
+{
+  const uint32_t conversions = fake_bme280_conversions();
+  BME280_Ret err_code = bme280_start_forced_conversion(conversion_timer);
+  check(BME280_RET_OK == err_code, "start forced conversion", err_code);
+  check(BME280_MODE_FORCED == fake_bme280_mode(), "forced mode register", fake_bme280_mode());
+  check(conversions + 1 == fake_bme280_conversions(), "conversion started", fake_bme280_conversions() - conversions);
+  check(conversion_timer->running, "conversion timer armed", conversion_timer->running);
+  // Timer must not expire before maximum conversion time
+  const uint64_t timeout_us = (uint64_t)conversion_timer->ticks * (RUUVITAG_APP_TIMER_PRESCALER + 1) * 1000000 / APP_TIMER_CLOCK_FREQ;
+  check(timeout_us >= bme280_get_measurement_time_us(), "conversion timeout us", timeout_us);
+  check(timeout_us <= bme280_get_measurement_time_us() + 2000, "conversion timeout us", timeout_us);
+
+  check(fake_bme280_convert(FAKE_ADC_T, FAKE_ADC_P, FAKE_ADC_H), "conversion running", 0);
+  check(fake_timer_fire(conversion_timer), "timer fire", 0);
+  check(1 == conversion_timeouts, "timeouts", conversion_timeouts);
+  check(!conversion_timer->running, "single shot timer", conversion_timer->running);
+
+  err_code = bme280_read_measurements();
+  check(BME280_RET_OK == err_code, "read measurements", err_code);
+  check(FAKE_ADC_T == bme280.adc_t, "adc_t", bme280.adc_t);
+  check(FAKE_ADC_P == bme280.adc_p, "adc_p", bme280.adc_p);
+  check(FAKE_ADC_H == bme280.adc_h, "adc_h", bme280.adc_h);
+  check(2508 == bme280_get_temperature(), "temperature", bme280_get_temperature());
+  // Sensor is in sleep after forced results are read, configuration is allowed
+  check(BME280_RET_OK == bme280_configure(&config), "configure after forced read", 0);
+
+  // Conversion that cannot be started does not arm timer
+  const uint32_t starts = fake_timer_starts();
+  fake_spi_fail(true);
+  err_code = bme280_start_forced_conversion(conversion_timer);
+  fake_spi_fail(false);
+  check(BME280_RET_ERROR == err_code, "forced conversion with SPI error", err_code);
+  check(starts == fake_timer_starts() && !conversion_timer->running, "timer after SPI error", fake_timer_starts() - starts);
+}
+
+int main(void)
+{
+  fake_reset();
+  BME280_Ret err_code = bme280_init();
+  check(BME280_RET_OK == err_code, "init", err_code);
+  check(bme280.sensor_available, "sensor available", bme280.sensor_available);
+  app_timer_create(&conversion_timer, APP_TIMER_MODE_SINGLE_SHOT, conversion_timer_handler);
+  check(BME280_RET_OK == bme280_configure(&config), "configure", 0);
+
+  check_modes();
+  check_forced_conversion();
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
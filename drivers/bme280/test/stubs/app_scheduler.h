@@ -0,0 +1,4 @@
+/* Empty host stub of SDK header. */
+#ifndef STUB_APP_SCHEDULER_H
+#define STUB_APP_SCHEDULER_H
+#endif
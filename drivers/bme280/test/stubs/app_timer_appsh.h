@@ -0,0 +1,40 @@
+/* Host stub of SDK app timer, implemented by test fake. */
+#ifndef STUB_APP_TIMER_APPSH_H
+#define STUB_APP_TIMER_APPSH_H
+#include <stdbool.h>
+#include <stdint.h>
+#include "nrf_error.h"
+
+#define APP_TIMER_CLOCK_FREQ        32768
+#define APP_TIMER_MIN_TIMEOUT_TICKS 5
+#define APP_TIMER_TICKS(MS, PRESCALER) \
+  ((uint32_t)((((MS) * (uint64_t)APP_TIMER_CLOCK_FREQ) + (((PRESCALER) + 1) * 500)) / (((PRESCALER) + 1) * 1000)))
+
+typedef void (*app_timer_timeout_handler_t)(void* p_context);
+
+typedef enum
+{
+  APP_TIMER_MODE_SINGLE_SHOT,
+  APP_TIMER_MODE_REPEATED
+} app_timer_mode_t;
+
+typedef struct
+{
+  app_timer_timeout_handler_t handler;
+  app_timer_mode_t mode;
+  bool     created;
+  bool     running;
+  uint32_t ticks;
+} app_timer_t;
+
+typedef app_timer_t* app_timer_id_t;
+
+#define APP_TIMER_DEF(timer_id) \
+  static app_timer_t timer_id##_data; \
+  static const app_timer_id_t timer_id = &timer_id##_data
+
+uint32_t app_timer_create(app_timer_id_t const* p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler);
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void* p_context);
+uint32_t app_timer_stop(app_timer_id_t timer_id);
+
+#endif
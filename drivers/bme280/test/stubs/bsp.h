@@ -0,0 +1,4 @@
+/* Empty host stub of SDK header. */
+#ifndef STUB_BSP_H
+#define STUB_BSP_H
+#endif
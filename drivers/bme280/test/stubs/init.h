@@ -0,0 +1,8 @@
+/* Host stub of drivers/init/init.h, timer prescaler only. */
+#ifndef STUB_INIT_H
+#define STUB_INIT_H
+#include "app_timer_appsh.h"
+
+#define RUUVITAG_APP_TIMER_PRESCALER 15
+
+#endif
@@ -0,0 +1,4 @@
+/* Empty host stub of SDK header. */
+#ifndef STUB_NORDIC_COMMON_H
+#define STUB_NORDIC_COMMON_H
+#endif
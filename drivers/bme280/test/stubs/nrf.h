@@ -0,0 +1,4 @@
+/* Empty host stub of SDK header. */
+#ifndef STUB_NRF_H
+#define STUB_NRF_H
+#endif
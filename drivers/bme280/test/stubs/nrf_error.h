@@ -0,0 +1,10 @@
+/* Host stub of SDK header. */
+#ifndef STUB_NRF_ERROR_H
+#define STUB_NRF_ERROR_H
+#include <stdint.h>
+
+#define NRF_SUCCESS             0
+#define NRF_ERROR_INVALID_STATE 8
+typedef uint32_t ret_code_t;
+
+#endif
@@ -0,0 +1,13 @@
+/* Host stub of SDK header, logging is compiled out. */
+#ifndef STUB_NRF_LOG_H
+#define STUB_NRF_LOG_H
+#include <stdio.h>
+
+#define NRF_LOG_ERROR(...)
+#define NRF_LOG_WARNING(...)
+#define NRF_LOG_INFO(...)
+#define NRF_LOG_DEBUG(...)
+#define NRF_LOG_HEXDUMP_INFO(...)
+#define NRF_LOG_HEXDUMP_DEBUG(...)
+
+#endif
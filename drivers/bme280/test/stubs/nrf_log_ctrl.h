@@ -0,0 +1,4 @@
+/* Empty host stub of SDK header. */
+#ifndef STUB_NRF_LOG_CTRL_H
+#define STUB_NRF_LOG_CTRL_H
+#endif
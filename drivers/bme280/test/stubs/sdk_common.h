@@ -0,0 +1,8 @@
+/* Host stub of SDK header. */
+#ifndef STUB_SDK_COMMON_H
+#define STUB_SDK_COMMON_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "nrf_error.h"
+#endif
@@ -28,6 +28,7 @@
 #include "nfc.h"
 #include "pin_interrupt.h"
 #include "pwm.h"
+#include "rtc.h"
 #include "watchdog.h"
 
 //Libraries
@@ -52,7 +53,11 @@
 init_err_code_t init_log(void)
 {
     init_err_code_t err_code;
+#if NRF_LOG_USES_TIMESTAMP
+    err_code = NRF_LOG_INIT(rtc_log_timestamp);
+#else
     err_code = NRF_LOG_INIT(NULL);
+#endif
     APP_ERROR_CHECK(err_code);
     NRF_LOG_DEBUG("Logging init\r\n");
     return (NRF_SUCCESS == err_code) ? INIT_SUCCESS : INIT_ERR_UNKNOWN;
@@ -214,6 +219,8 @@ init_err_code_t init_bme280(void)
     {
         NRF_LOG_DEBUG("BME280 init Done, setting up message handlers\r\n");
         set_temperature_handler(bme280_temperature_handler);
+        set_humidity_handler(bme280_humidity_handler);
+        set_pressure_handler(bme280_pressure_handler);
     }
     else
     {
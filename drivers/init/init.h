@@ -28,7 +28,14 @@
 #define APP_TIMER_PRESCALER             RUUVITAG_APP_TIMER_PRESCALER      /**< Value of the RTC1 PRESCALER register. */
 #define APP_TIMER_OP_QUEUE_SIZE         RUUVITAG_APP_TIMER_OP_QUEUE_SIZE  /**< Size of timer operation queues. */
 // Scheduler settings                                         
-#define SCHED_MAX_EVENT_DATA_SIZE       MAX(APP_TIMER_SCHED_EVT_SIZE, sizeof(ruuvi_standard_message_t))
+// Scheduler profile queues handler in front of event data, enabled in Makefile with the wrap of app_sched_event_put
+#if SCHED_PROFILE_ENABLED
+  #include "sched_profile_nrf.h"
+  #define SCHED_EVENT_OVERHEAD          SCHED_PROFILE_EVENT_OVERHEAD
+#else
+  #define SCHED_EVENT_OVERHEAD          0
+#endif
+#define SCHED_MAX_EVENT_DATA_SIZE       (MAX(APP_TIMER_SCHED_EVT_SIZE, sizeof(ruuvi_standard_message_t)) + SCHED_EVENT_OVERHEAD)
 #define SCHED_QUEUE_SIZE                RUUVITAG_APP_TIMER_OP_QUEUE_SIZE
 
 #define ERROR_BLINK_INTERVAL 250u   //toggle interval of error led
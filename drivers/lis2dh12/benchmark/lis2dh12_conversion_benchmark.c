@@ -0,0 +1,114 @@
+/**
+ *  Host harness for LIS2DH12 block conversion.
+ *
+ *  Compares lis2dh12_convert_to_mg against the per-sample conversion which lis2dh12_read_samples
+ *  used before, for every raw value at every scale and resolution, and times conversion of a
+ *  full FIFO read of 32 samples, 96 values.
+ */
+#include "lis2dh12_conversion.h"
+#include "lis2dh12_registers.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define FIFO_VALUES 96
+#define ROUNDS      200000
+
+static const uint8_t scales[]      = { LIS2DH12_FS_2G, LIS2DH12_FS_4G, LIS2DH12_FS_8G, LIS2DH12_FS_16G };
+static const uint8_t resolutions[] = { 8, 6, 4 };
+
+/** State of driver, read by per-sample path on every call */
+static uint8_t state_scale = LIS2DH12_FS_2G;
+static uint8_t state_resolution = 6;
+
+/** Per-sample reference, rawToMg of lis2dh12.c with ST conversion functions */
+__attribute__((noinline)) static int16_t reference(const uint8_t scale, const uint8_t resolution, const int16_t lsb)
+{
+  static const int16_t hr[] = {1, 2, 4, 12};
+  static const int16_t nm[] = {4, 8, 16, 48};
+  static const int16_t lp[] = {16, 32, 64, 192};
+  switch(resolution)
+  {
+    case 4: return (lsb / 16) * hr[scale >> 4];
+    case 6: return (lsb / 64) * nm[scale >> 4];
+    case 8: return (lsb / 256) * lp[scale >> 4];
+    default: return (int16_t)0x8000;
+  }
+}
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+int main(void)
+{
+  unsigned mismatches = 0;
+  int16_t values[FIFO_VALUES];
+  lis2dh12_conversion_t conversion;
+
+  for(size_t s = 0; s < sizeof(scales); s++)
+  {
+    for(size_t r = 0; r < sizeof(resolutions); r++)
+    {
+      lis2dh12_conversion_select(scales[s], resolutions[r], &conversion);
+      for(int32_t raw = INT16_MIN; raw <= INT16_MAX; raw += FIFO_VALUES)
+      {
+        for(int ii = 0; ii < FIFO_VALUES; ii++) { values[ii] = (int16_t)(raw + ii); }
+        lis2dh12_convert_to_mg(conversion, values, FIFO_VALUES);
+        for(int ii = 0; ii < FIFO_VALUES && raw + ii <= INT16_MAX; ii++)
+        {
+          int16_t expected = reference(scales[s], resolutions[r], (int16_t)(raw + ii));
+          if(values[ii] != expected && mismatches++ < 10)
+          {
+            printf("Mismatch: scale %x, resolution %u, raw %d: %d, expected %d\n",
+                   scales[s], resolutions[r], (int)(raw + ii), values[ii], expected);
+          }
+        }
+      }
+    }
+  }
+  if(lis2dh12_conversion_select(0x40, 6, &conversion) || lis2dh12_conversion_select(LIS2DH12_FS_2G, 5, &conversion))
+  {
+    printf("Invalid parameters accepted\n");
+    mismatches++;
+  }
+  values[0] = 1000;
+  lis2dh12_convert_to_mg(conversion, values, 1);
+  if(LIS2DH12_CONVERSION_INVALID != values[0]) { printf("Invalid conversion did not mark values\n"); mismatches++; }
+  printf("Bit-exact check over all raw values, 12 scale/resolution pairs: %u mismatches\n", mismatches);
+
+  // Timing, 10-bit 2 G. Raw values are copied in as from SPI.
+  struct timespec start, end;
+  volatile int16_t sink = 0;
+  int16_t raw[FIFO_VALUES];
+  for(int ii = 0; ii < FIFO_VALUES; ii++) { raw[ii] = (int16_t)(ii * 683); }
+  lis2dh12_conversion_select(state_scale, state_resolution, &conversion);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(int round = 0; round < ROUNDS; round++)
+  {
+    memcpy(values, raw, sizeof(values));
+    for(int ii = 0; ii < FIFO_VALUES; ii++) { values[ii] = reference(state_scale, state_resolution, values[ii]); }
+    sink += values[round % FIFO_VALUES];
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double per_sample = seconds(&start, &end);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(int round = 0; round < ROUNDS; round++)
+  {
+    memcpy(values, raw, sizeof(values));
+    lis2dh12_conversion_select(state_scale, state_resolution, &conversion);
+    lis2dh12_convert_to_mg(conversion, values, FIFO_VALUES);
+    sink += values[round % FIFO_VALUES];
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double block = seconds(&start, &end);
+
+  printf("%d values: per-sample %.1f ns, block %.1f ns per FIFO read\n",
+         FIFO_VALUES, per_sample * 1e9 / ROUNDS, block * 1e9 / ROUNDS);
+  (void)sink;
+  return mismatches ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/**
+ *  Host error report and benchmark of LIS2DH12 integer magnitude.
+ *
+ *  Compares every accuracy level against double precision sqrt on a grid over the +-16 g range,
+ *  24 576 mg per axis at 16 G scale, and over int16 extremes. Times a block of 32 samples,
+ *  one full FIFO, against libm sqrt as used by the acceleration handler before.
+ */
+#include "lis2dh12_magnitude.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define RANGE_MG     24576
+#define GRID_STEP    192
+#define FIFO_SAMPLES 32
+#define RELATIVE_MIN 256    // Relative error below this is dominated by 1 mg resolution
+#define ROUNDS       100000
+
+static const char* const names[] = {"exact", "refined", "approximate"};
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** Sweep grid, print maximum absolute and relative error. Returns maximum relative error. */
+static double report(const lis2dh12_magnitude_accuracy_t accuracy, const int32_t range, const int32_t step)
+{
+  double max_abs = 0, max_rel = 0, sum_rel = 0;
+  long points = 0;
+  for(int32_t x = -range; x <= range; x += step)
+  {
+    for(int32_t y = -range; y <= range; y += step)
+    {
+      for(int32_t z = -range; z <= range; z += step)
+      {
+        double exact = sqrt((double)x * x + (double)y * y + (double)z * z);
+        double error = lis2dh12_magnitude(x, y, z, accuracy) - exact;
+        if(fabs(error) > max_abs) { max_abs = fabs(error); }
+        if(exact >= RELATIVE_MIN)
+        {
+          double rel = fabs(error) / exact;
+          if(rel > max_rel) { max_rel = rel; }
+          sum_rel += rel;
+          points++;
+        }
+      }
+    }
+  }
+  printf("%-12s range %6d step %4d: max error %7.1f mg, above %d mg max %6.3f %%, mean %6.3f %%\n",
+         names[accuracy], (int)range, (int)step, max_abs, RELATIVE_MIN, 100 * max_rel, 100 * sum_rel / points);
+  return max_rel;
+}
+
+int main(void)
+{
+  int failures = 0;
+
+  // Exact level must equal floor of exact magnitude, including INT16_MIN.
+  const int16_t edges[] = {INT16_MIN, INT16_MIN + 1, -24576, -1, 0, 1, 24576, INT16_MAX};
+  for(size_t ii = 0; ii < sizeof(edges) / sizeof(edges[0]); ii++)
+  {
+    for(size_t jj = 0; jj < sizeof(edges) / sizeof(edges[0]); jj++)
+    {
+      for(size_t kk = 0; kk < sizeof(edges) / sizeof(edges[0]); kk++)
+      {
+        int16_t x = edges[ii], y = edges[jj], z = edges[kk];
+        uint16_t expected = (uint16_t)floor(sqrt((double)x * x + (double)y * y + (double)z * z));
+        if(lis2dh12_magnitude(x, y, z, LIS2DH12_MAGNITUDE_EXACT) != expected)
+        {
+          printf("Exact magnitude of %d %d %d was %u, expected %u\n", x, y, z,
+                 lis2dh12_magnitude(x, y, z, LIS2DH12_MAGNITUDE_EXACT), expected);
+          failures++;
+        }
+      }
+    }
+  }
+  srand(1);
+  for(int ii = 0; ii < 1000000; ii++)
+  {
+    int16_t x = (int16_t)(rand() & 0xFFFF), y = (int16_t)(rand() & 0xFFFF), z = (int16_t)(rand() & 0xFFFF);
+    uint16_t expected = (uint16_t)floor(sqrt((double)x * x + (double)y * y + (double)z * z));
+    if(lis2dh12_magnitude(x, y, z, LIS2DH12_MAGNITUDE_EXACT) != expected && failures++ < 10)
+    {
+      printf("Exact magnitude of %d %d %d mismatch\n", x, y, z);
+    }
+  }
+  printf("Exact level against floor(sqrt()), int16 extremes and 1M random samples: %d mismatches\n\n", failures);
+
+  for(int accuracy = LIS2DH12_MAGNITUDE_EXACT; accuracy <= LIS2DH12_MAGNITUDE_APPROXIMATE; accuracy++)
+  {
+    report(accuracy, RANGE_MG, GRID_STEP);
+    report(accuracy, 2048, 16);
+  }
+  printf("\n");
+
+  // Timing of one FIFO read
+  int16_t xyz[3 * FIFO_SAMPLES];
+  uint16_t magnitude[FIFO_SAMPLES];
+  volatile uint32_t sink = 0;
+  struct timespec start, end;
+  for(int ii = 0; ii < 3 * FIFO_SAMPLES; ii++) { xyz[ii] = (int16_t)((ii * 7919) % (2 * RANGE_MG) - RANGE_MG); }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for(int round = 0; round < ROUNDS; round++)
+  {
+    xyz[round % (3 * FIFO_SAMPLES)] ^= 1;
+    for(int ii = 0; ii < FIFO_SAMPLES; ii++)
+    {
+      int32_t x = xyz[3 * ii], y = xyz[3 * ii + 1], z = xyz[3 * ii + 2];
+      magnitude[ii] = sqrt(x * x + y * y + z * z);
+    }
+    sink += magnitude[round % FIFO_SAMPLES];
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  printf("%-12s %7.1f ns per %d samples\n", "libm sqrt", seconds(&start, &end) * 1e9 / ROUNDS, FIFO_SAMPLES);
+
+  for(int accuracy = LIS2DH12_MAGNITUDE_EXACT; accuracy <= LIS2DH12_MAGNITUDE_APPROXIMATE; accuracy++)
+  {
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(int round = 0; round < ROUNDS; round++)
+    {
+      xyz[round % (3 * FIFO_SAMPLES)] ^= 1;
+      lis2dh12_magnitude_block(xyz, magnitude, FIFO_SAMPLES, accuracy);
+      sink += magnitude[round % FIFO_SAMPLES];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-12s %7.1f ns per %d samples\n", names[accuracy], seconds(&start, &end) * 1e9 / ROUNDS, FIFO_SAMPLES);
+  }
+  (void)sink;
+  return failures ? 1 : 0;
+}
@@ -13,6 +13,7 @@ For a detailed description see the detailed description in @ref LIS2DH12.h
 /* INCLUDES ***************************************************************************************/
 #include "lis2dh12.h"
 #include "lis2dh12_registers.h"
+#include "lis2dh12_conversion.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -25,6 +26,7 @@ For a detailed description see the detailed description in @ref LIS2DH12.h
 #include "bsp.h"
 #include "boards.h"
 #include "init.h" //Timer ticks - todo: refactor
+#include "probe.h"
 
 #define NRF_LOG_MODULE_NAME "LIS2DH12"
 #include "nrf_log.h"
@@ -50,7 +52,6 @@ For a detailed description see the detailed description in @ref LIS2DH12.h
 /* PROTOTYPES *************************************************************************************/
 static lis2dh12_ret_t selftest(void);
 void timer_lis2dh12_event_handler(void* p_context);
-static int16_t rawToMg(int16_t raw_acceleration);
 static uint8_t scale_interrupt_threshold(int16_t threshold_mg);
 
 /* VARIABLES **************************************************************************************/
@@ -293,17 +294,16 @@ lis2dh12_ret_t lis2dh12_set_fifo_mode(lis2dh12_fifo_mode_t mode)
 
 lis2dh12_ret_t lis2dh12_read_samples(lis2dh12_sensor_buffer_t* buffer, size_t count)
 {
+     PROBE_START(PROBE_LIS2DH12_READ);
      lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
      size_t bytes_to_read = count*sizeof(lis2dh12_sensor_buffer_t);
      NRF_LOG_DEBUG("Reading %d bytes \r\n", bytes_to_read);
      err_code |= lis2dh12_read_register(LIS2DH12_OUT_X_L, (uint8_t*)buffer, count*sizeof(lis2dh12_sensor_buffer_t));
-     // Use constant bitshift, so we don't have to adjust mgpb with resolution
-     for(int ii = 0; ii < count; ii++)
-     {
-        buffer[ii].sensor.x = rawToMg(buffer[ii].sensor.x);
-        buffer[ii].sensor.y = rawToMg(buffer[ii].sensor.y);
-        buffer[ii].sensor.z = rawToMg(buffer[ii].sensor.z);
-     }
+     // Resolve scale and resolution once, then convert all axes of all samples as one block
+     lis2dh12_conversion_t conversion;
+     lis2dh12_conversion_select(state_scale, state_resolution, &conversion);
+     lis2dh12_convert_to_mg(conversion, (int16_t*)buffer, count * sizeof(acceleration_t) / sizeof(int16_t));
+     PROBE_STOP(PROBE_LIS2DH12_READ);
      return err_code;
 }
 
@@ -330,6 +330,18 @@ lis2dh12_ret_t lis2dh12_set_fifo_watermark(size_t count)
     return err_code;
 }
 
+lis2dh12_ret_t lis2dh12_set_fifo_trigger(uint8_t pin)
+{
+    if(1 != pin && 2 != pin) { return LIS2DH12_RET_INVALID; }
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    uint8_t ctrl[1] = {0};
+    err_code |= lis2dh12_read_register(LIS2DH12_FIFO_CTRL_REG, ctrl, 1);
+    ctrl[0] &= ~LIS2DH12_TR_MASK;
+    if(2 == pin) { ctrl[0] |= LIS2DH12_TR_MASK; }
+    err_code |= lis2dh12_write_register(LIS2DH12_FIFO_CTRL_REG, ctrl, 1);
+    return err_code;
+}
+
 /**
  * Enable activity detection interrupt on pin 2. Interrupt is high for samples where high-passed acceleration exceeds mg
  */
@@ -375,6 +387,26 @@ lis2dh12_ret_t lis2dh12_set_activity_interrupt_pin_2(uint16_t mg)
     return LIS2DH12_RET_OK;
 }
 
+/**
+ * Set threshold of activity / inactivity function. 0 disables the function.
+ */
+lis2dh12_ret_t lis2dh12_set_activity_threshold(uint8_t bits)
+{
+    uint8_t ctrl[1] = {0};
+    ctrl[0] = bits & LIS2DH12_ACTH_MASK;
+    return lis2dh12_write_register(LIS2DH12_ACT_THS, ctrl, 1);
+}
+
+/**
+ * Set duration of activity / inactivity function, (8 * duration + 1) / ODR seconds.
+ */
+lis2dh12_ret_t lis2dh12_set_activity_duration(uint8_t duration)
+{
+    uint8_t ctrl[1] = {0};
+    ctrl[0] = duration;
+    return lis2dh12_write_register(LIS2DH12_ACT_DUR, ctrl, 1);
+}
+
 /**
  *  Set interrupt on pin. Write "0" To disable interrupt on pin. 
  *  NOTE: pin 1 and pin 2 DO NOT support identical configurations.
@@ -513,153 +545,6 @@ static lis2dh12_ret_t selftest(void)
     return (LIS2DH12_I_AM_MASK == value[0]) ? LIS2DH12_RET_OK : LIS2DH12_RET_ERROR;
 }
 
-/**
- * Conversion functions from 
- * https://github.com/STMicroelectronics/STMems_Standard_C_drivers/blob/3e3b7528dfacb223aea250daf4e512e335f17509/lis2dh12_STdC/driver/lis2dh12_reg.c#L104
- */
-static inline int16_t lis2dh12_from_fs2_hr_to_mg(int16_t lsb)
-{
-  return (lsb / 16 ) * 1;
-}
-
-static inline int16_t lis2dh12_from_fs4_hr_to_mg(int16_t lsb)
-{
-  return (lsb / 16 ) * 2;
-}
-
-static inline int16_t lis2dh12_from_fs8_hr_to_mg(int16_t lsb)
-{
-  return (lsb / 16 ) * 4;
-}
-
-static inline int16_t lis2dh12_from_fs16_hr_to_mg(int16_t lsb)
-{
-  return (lsb / 16) * 12;
-}
-
-static inline int16_t lis2dh12_from_fs2_nm_to_mg(int16_t lsb)
-{
-  return (lsb / 64) * 4;
-}
-
-static inline int16_t lis2dh12_from_fs4_nm_to_mg(int16_t lsb)
-{
-  return (lsb / 64) * 8;
-}
-
-static inline int16_t lis2dh12_from_fs8_nm_to_mg(int16_t lsb)
-{
-  return (lsb / 64) * 16;
-}
-
-static inline int16_t lis2dh12_from_fs16_nm_to_mg(int16_t lsb)
-{
-  return (lsb / 64) * 48;
-}
-
-static inline int16_t lis2dh12_from_fs2_lp_to_mg(int16_t lsb)
-{
-  return (lsb / 256) * 16;
-}
-
-static inline int16_t lis2dh12_from_fs4_lp_to_mg(int16_t lsb)
-{
-  return (lsb / 256) * 32;
-}
-
-static inline int16_t lis2dh12_from_fs8_lp_to_mg(int16_t lsb)
-{
-  return (lsb / 256) * 64;
-}
-
-static inline int16_t lis2dh12_from_fs16_lp_to_mg(int16_t lsb)
-{
-  return (lsb / 256) * 192;
-}
-
-
-/**
- * Convert raw value to acceleration in mg. Reads scale and resolution from state variables.
- *
- * @param raw_acceleration raw ADC value from LIS2DH12
- * @return int16_t representing acceleration in milli-G. 
- */
-static int16_t rawToMg(int16_t raw_acceleration)
-{
-  switch(state_scale)
-  {
-    case LIS2DH12_SCALE2G:
-      switch(state_resolution)
-      {
-        case LIS2DH12_RES8BIT:
-          return lis2dh12_from_fs2_lp_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES10BIT:
-          return  lis2dh12_from_fs2_nm_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES12BIT:
-          return  lis2dh12_from_fs2_hr_to_mg(raw_acceleration);
-
-        default:
-          break;
-      }
-      break;
-
-    case LIS2DH12_SCALE4G:
-      switch(state_resolution)
-      {
-        case LIS2DH12_RES8BIT:
-          return  lis2dh12_from_fs4_lp_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES10BIT:
-          return  lis2dh12_from_fs4_nm_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES12BIT:
-          return  lis2dh12_from_fs4_hr_to_mg(raw_acceleration);
-      }
-      break;
-
-    case LIS2DH12_SCALE8G:
-      switch(state_resolution)
-      {
-        case LIS2DH12_RES8BIT:
-          return  lis2dh12_from_fs8_lp_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES10BIT:
-          return  lis2dh12_from_fs8_nm_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES12BIT:
-          return  lis2dh12_from_fs8_hr_to_mg(raw_acceleration);
-
-        default:
-          break;
-      }
-    break;
-
-    case LIS2DH12_SCALE16G:
-      switch(state_resolution)
-      {
-        case LIS2DH12_RES8BIT:
-          return  lis2dh12_from_fs16_lp_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES10BIT:
-          return  lis2dh12_from_fs16_nm_to_mg(raw_acceleration);
-
-        case LIS2DH12_RES12BIT:
-          return  lis2dh12_from_fs16_hr_to_mg(raw_acceleration);
-
-        default:
-          break;
-      }
-    break;
-
-    default:
-      break;
-  }
-  // reached only in case of an error, return "smallest representable value"
-  return 0x8000;
-}
-
 /**
  * Return correct threshold setting for activity interrupt at
  * given threshold. Scales threshold upwards to next value.
@@ -53,33 +53,6 @@ typedef enum
   LIS2DH12_RET_ERROR = 16    		/**< Not otherwise specified error */
 }lis2dh12_ret_t;
 
-/** Available Scales */
-typedef enum{
-  LIS2DH12_SCALE2G = LIS2DH12_FS_2G,  /**< Scale Selection: +/- 2g */
-  LIS2DH12_SCALE4G = LIS2DH12_FS_4G,	/**< Scale Selection: +/- 4g */
-  LIS2DH12_SCALE8G = LIS2DH12_FS_8G,	/**< Scale Selection: +/- 8g */
-  LIS2DH12_SCALE16G = LIS2DH12_FS_16G	/**< Scale Selection: +/- 16g */
-}lis2dh12_scale_t;
-
-/** Available Resolutions */
-typedef enum{
-  LIS2DH12_RES8BIT = 8,		/**< 8 extra bits */
-  LIS2DH12_RES10BIT = 6,		/**< 6 extra bits */
-  LIS2DH12_RES12BIT = 4		/**< 4 extra bits */
-}lis2dh12_resolution_t;
-
-/** Available sample rates */
-typedef enum{
-  LIS2DH12_RATE_0   = 0,		/**< Power down */
-  LIS2DH12_RATE_1   = 1<<4,	/**< 1 Hz */
-  LIS2DH12_RATE_10  = 2<<4,	/**< 10 Hz*/
-  LIS2DH12_RATE_25  = 3<<4,		
-  LIS2DH12_RATE_50  = 4<<4,		
-  LIS2DH12_RATE_100 = 5<<4,		
-  LIS2DH12_RATE_200 = 6<<4,		
-  LIS2DH12_RATE_400 = 7<<4    /** 1k+ rates not implemented */		
-}lis2dh12_sample_rate_t;
-
 /** Available modes */
 typedef enum{
   LIS2DH12_MODE_BYPASS = 0,                                              /**< FIFO off */
@@ -176,6 +149,15 @@ lis2dh12_ret_t lis2dh12_get_fifo_sample_number(size_t* count);
  */
 lis2dh12_ret_t lis2dh12_set_fifo_watermark(size_t count);
 
+/**
+ *  Select interrupt signal which triggers stream-to-FIFO mode to switch to FIFO mode.
+ *  Trigger is the interrupt signal routed to the pin, e.g. activity interrupt on pin 2.
+ *
+ *  @param pin 1 or 2, others are invalid
+ *  @return LIS2DH12_RET_INVALID if pin was not valid, error code from SPI stack otherwise.
+ */
+lis2dh12_ret_t lis2dh12_set_fifo_trigger(uint8_t pin);
+
 /**
  *  Set interrupt on pin. Write "0" To disable interrupt on pin. 
  *
@@ -207,15 +189,23 @@ lis2dh12_ret_t lis2dh12_set_interrupt_configuration(uint8_t cfg, uint8_t functio
 lis2dh12_ret_t lis2dh12_set_threshold(uint8_t bits, uint8_t pin);
 
 /**
- *  Setup number of LSBs needed to trigger activity interrupt.
- *  Note: this targets only pin 2, and only if activity interrupt is enabled.
+ *  Setup number of LSBs of activity / inactivity function (ACT_THS), scaled as interrupt thresholds.
+ *  Device enters 10 Hz low-power mode when acceleration stays below threshold for activity duration.
+ *  Note: state is signaled only on pin 2, and only if P2_ACT is enabled. 0 disables the function.
  *
- *  @param bits number of LSBs required to trigger the interrupt
+ *  @param bits number of LSBs required to stay active
  *
  *  @return error code from stack
  */
 lis2dh12_ret_t lis2dh12_set_activity_threshold(uint8_t bits);
 
+/**
+ *  Setup time to inactivity (ACT_DUR), (8 * duration + 1) / ODR seconds.
+ *
+ *  @return error code from stack
+ */
+lis2dh12_ret_t lis2dh12_set_activity_duration(uint8_t duration);
+
 /**
  * Enable activity detection interrupt on pin 2. Interrupt is high for samples where high-passed acceleration exceeds mg
  */
@@ -2,15 +2,36 @@
 #include "ruuvi_endpoints.h"
 #include "nrf_error.h"
 #include "lis2dh12.h"
-#include "math.h"
+#include "lis2dh12_magnitude.h"
+#include "lis2dh12_timestamp.h"
+#include "rtc.h"
+#include "rtc_sync.h"
 
 #define NRF_LOG_MODULE_NAME "LIS2DH12_HANDLER"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 
 
+// Watermark interrupt is raised when FIFO has this many samples
+#define FIFO_WATERMARK 30
+
 static message_handler_state_t m_state = {0};
 
+/** Magnitude is reported in int16 payload with axes, saturate at 16 G scale */
+static int16_t saturate_magnitude(const uint16_t magnitude)
+{
+  return (magnitude > INT16_MAX) ? INT16_MAX : (int16_t)magnitude;
+}
+
+/** Restart sample timestamps at nominal period of current ODR */
+static void reset_timestamps(void)
+{
+  lis2dh12_sample_rate_t rate = LIS2DH12_RATE_0;
+  lis2dh12_get_sample_rate(&rate);
+  const int hz = lis2dh12_odr_to_hz(rate);
+  lis2dh12_timestamp_reset(hz ? 1000000000u / hz : 0, FIFO_WATERMARK);
+}
+
 static ret_code_t set_sample_rate(uint8_t sample_rate)
 {
   ret_code_t err_code = LIS2DH12_RET_OK;
@@ -21,6 +42,7 @@ static ret_code_t set_sample_rate(uint8_t sample_rate)
     err_code |= lis2dh12_set_sample_rate(LIS2DH12_RATE_0);
     lis2dh12_set_fifo_mode(LIS2DH12_MODE_BYPASS);
     if(LIS2DH12_RET_OK == err_code) { m_state.configuration.sample_rate = sample_rate; }
+    lis2dh12_timestamp_reset(0, FIFO_WATERMARK);
     return err_code;
   }
 
@@ -41,6 +63,7 @@ static ret_code_t set_sample_rate(uint8_t sample_rate)
   if(LIS2DH12_RET_OK == err_code) 
   { 
     m_state.configuration.sample_rate = sample_rate; 
+    reset_timestamps();
   }
   
   return err_code;
@@ -57,7 +80,7 @@ static ret_code_t set_transmission_rate(uint8_t transmission_rate)
         break;
     case TRANSMISSION_RATE_SAMPLERATE:
         NRF_LOG_DEBUG("Enabling LIS interrupts\r\n");
-        err_code |= lis2dh12_set_fifo_watermark(30);
+        err_code |= lis2dh12_set_fifo_watermark(FIFO_WATERMARK);
         err_code |= lis2dh12_set_interrupts(LIS2DH12_I1_WTM, 1);
         break;
 
@@ -210,6 +233,19 @@ static ret_code_t set_target(uint8_t target)
 
   return ENDPOINT_SUCCESS;
 }
+/**
+ *  Send message upstream to chain, if any.
+ */
+static ret_code_t transmit_chain(const ruuvi_standard_message_t message)
+{
+  if(NULL == m_state.p_chain_handler) { return ENDPOINT_SUCCESS; }
+  ruuvi_standard_message_t chainmsg;
+  memcpy(&chainmsg, &message, sizeof(ruuvi_standard_message_t));
+  chainmsg.destination_endpoint = m_state.downstream_endpoint;
+  NRF_LOG_DEBUG("Chaining to %d\r\n", chainmsg.destination_endpoint);
+  return m_state.p_chain_handler(chainmsg);
+}
+
 /** 
  *  Send transmission to all data endpoints.
  *  TODO: Can a function pointer / other code deduplication be used?
@@ -224,15 +260,7 @@ static ret_code_t transmit(const ruuvi_standard_message_t message)
   if(m_state.p_nfc_handler)         { err_code |= m_state.p_nfc_handler(message); }
   if(m_state.p_ram_handler)         { err_code |= m_state.p_ram_handler(message); }
   if(m_state.p_flash_handler)       { err_code |= m_state.p_flash_handler(message); }
-  if(m_state.p_chain_handler)
-  { 
-    ruuvi_standard_message_t chainmsg;
-    memcpy(&chainmsg, &message, sizeof(ruuvi_standard_message_t));
-    //Send message upstream to chain
-    chainmsg.destination_endpoint = m_state.downstream_endpoint;
-    NRF_LOG_DEBUG("Chaining to %d\r\n", chainmsg.destination_endpoint);
-    err_code |= m_state.p_chain_handler(chainmsg);
-  }
+  err_code |= transmit_chain(message);
   
   return err_code;
 }
@@ -297,15 +325,16 @@ static ret_code_t read_sensor(const ruuvi_standard_message_t message)
   
     lis2dh12_sensor_buffer_t buffer; 
     err_code |= lis2dh12_read_samples(&buffer, 1);
-    uint16_t rvalue[4];
+    // Axes are signed, reply with INT16 like scheduled reads
+    int16_t rvalue[4];
     rvalue[0] = buffer.sensor.x;
     rvalue[1] = buffer.sensor.y;
     rvalue[2] = buffer.sensor.z;
-    rvalue[3] = sqrt(rvalue[0]*rvalue[0] + rvalue[1]*rvalue[1] + rvalue[2]*rvalue[2]);
+    rvalue[3] = saturate_magnitude(lis2dh12_magnitude(rvalue[0], rvalue[1], rvalue[2], LIS2DH12_MAGNITUDE_ACCURACY));
     NRF_LOG_DEBUG("Sending raw reply\r\n");  
     ruuvi_standard_message_t reply = {.destination_endpoint = message.source_endpoint,
                                     .source_endpoint = ACCELERATION,
-                                    .type = UINT16,
+                                    .type = INT16,
                                     .payload = { 0 }};
     memcpy(reply.payload, rvalue, sizeof(reply.payload));
     err_code |= transmit(reply);
@@ -412,6 +441,25 @@ static void process(const ruuvi_standard_message_t message)
   }
 }
 
+/**
+ *  Send time of batch before its samples. Chain always gets it for DSP,
+ *  data targets only if TRANSMISSION_TARGET_TIMESTAMP is set.
+ */
+static void process_timestamp(const lis2dh12_batch_time_t* const batch)
+{
+  if(TRANSMISSION_RATE_SAMPLERATE != m_state.configuration.transmission_rate) { return; }
+  uint64_t time_ms = batch->first_us / 1000;
+  rtc_sync_epoch_ms(time_ms, &time_ms); // Unix time if synchronised over RTC endpoint
+  ruuvi_timestamp_payload_t timestamp = { .time_ms = time_ms, .period_ns = batch->period_ns };
+  ruuvi_standard_message_t message = {.destination_endpoint = m_state.destination_endpoint,
+                                      .source_endpoint = ACCELERATION,
+                                      .type = TIMESTAMP,
+                                      .payload = {0}};
+  memcpy(message.payload, &timestamp, sizeof(timestamp));
+  if(TRANSMISSION_TARGET_TIMESTAMP & m_state.configuration.target) { transmit(message); }
+  else { transmit_chain(message); }
+}
+
 /** Scheduler handler to read accelerometer buffer **/
 void lis2dh12_scheduler_event_handler(void *p_event_data, uint16_t event_size)
 {
@@ -421,14 +469,22 @@ void lis2dh12_scheduler_event_handler(void *p_event_data, uint16_t event_size)
     lis2dh12_sensor_buffer_t buffer[32];
     memset(buffer, 0, sizeof(buffer));
     lis2dh12_read_samples(buffer, count);
-    NRF_LOG_DEBUG("Sending raw UINT16 reply\r\n");
+    lis2dh12_batch_time_t batch;
+    if(lis2dh12_timestamp_batch(count, &batch))
+    {
+      NRF_LOG_DEBUG("%d samples from %d ms, period %d ns\r\n", count, (uint32_t)(batch.first_us / 1000), batch.period_ns);
+      process_timestamp(&batch);
+    }
+    uint16_t magnitude[32];
+    lis2dh12_magnitude_block((int16_t*)buffer, magnitude, count, LIS2DH12_MAGNITUDE_ACCURACY);
+    NRF_LOG_DEBUG("Sending raw INT16 reply\r\n");
     for(int ii = 0; ii < count; ii++)
     {
         int16_t rvalue[4];
         rvalue[0] = buffer[ii].sensor.x;
         rvalue[1] = buffer[ii].sensor.y;
         rvalue[2] = buffer[ii].sensor.z;
-        rvalue[3] = sqrt(rvalue[0]*rvalue[0] + rvalue[1]*rvalue[1] + rvalue[2]*rvalue[2]);
+        rvalue[3] = saturate_magnitude(magnitude[ii]);
         ruuvi_standard_message_t reply = {.destination_endpoint = m_state.destination_endpoint,
                                         .source_endpoint = ACCELERATION,
                                         .type = INT16,
@@ -450,6 +506,10 @@ void lis2dh12_scheduler_event_handler(void *p_event_data, uint16_t event_size)
 ret_code_t lis2dh12_int1_handler(const ruuvi_standard_message_t message)
 {
     NRF_LOG_DEBUG("Accelerometer interrupt\r\n");
+    // Pin may be shared with other interrupt sources, FIFO is read only while watermark interrupt is enabled
+    if(TRANSMISSION_RATE_SAMPLERATE != m_state.configuration.transmission_rate) { return NRF_SUCCESS; }
+    // Time of interrupt is time of watermark sample, scheduler adds jitter
+    lis2dh12_timestamp_interrupt(micros());
 
     app_sched_event_put ((void*)(&message),
                          sizeof(message),
@@ -44,9 +44,11 @@
 ret_code_t lis2dh12_acceleration_handler(const ruuvi_standard_message_t message);
 
 /**
- *  Initialization assings this function, user should not need to care about the implementation.
+ *  Handler of INT1 pin, FIFO watermark interrupt. Takes time of watermark sample for TIMESTAMP
+ *  and schedules reading accelerometer. Interrupts are ignored while acceleration is not streamed.
  *
- *  Schedules reading accelerometer
+ *  Each pin has only one interrupt handler. If INT1 pin is shared, e.g. with
+ *  lis2dh12_events_interrupt_handler, call this first from the pin handler.
  */
 ret_code_t lis2dh12_int1_handler(const ruuvi_standard_message_t message);
 
@@ -0,0 +1,205 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_capture.c
+
+Implementation of LIS2DH12 pre-trigger impact capture.
+
+For a detailed description see the detailed description in @ref lis2dh12_capture.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_capture.h"
+#include "lis2dh12.h"
+#include "lis2dh12_registers.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "app_scheduler.h"
+#include "app_timer_appsh.h"
+#include "init.h"
+#include "rtc.h"
+#include "rtc_sync.h"
+
+#define NRF_LOG_MODULE_NAME "LIS2DH12_CAPTURE"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/* CONSTANTS **************************************************************************************/
+/** Poll FIFO when half full during post-event window */
+#define CAPTURE_POLL_SAMPLES (LIS2DH12_FIFO_MAX_LENGTH / 2)
+#define CAPTURE_MIN_RATE_HZ  10
+
+/* VARIABLES **************************************************************************************/
+typedef struct __attribute__((packed)){
+  lis2dh12_capture_header_t header;
+  acceleration_t samples[LIS2DH12_CAPTURE_MAX_SAMPLES];
+}capture_t;
+
+APP_TIMER_DEF(m_poll_timer);
+static bool m_timer_created = false;
+static lis2dh12_capture_config_t m_config;
+static lis2dh12_capture_handler_t p_capture_handler = NULL;
+static lis2dh12_capture_state_t m_state = LIS2DH12_CAPTURE_DISABLED;
+static capture_t m_capture = {0};
+static uint16_t m_sequence = 0;
+static size_t m_collected = 0;                 // Samples in buffer of ongoing capture
+static volatile uint64_t m_trigger_ms = 0;     // Set in interrupt context
+static volatile bool m_trigger_pending = false;
+
+/* INTERNAL FUNCTIONS *****************************************************************************/
+
+/** Unread samples in FIFO. FSS counts up to 31, overrun flag is set at 32. */
+static lis2dh12_ret_t fifo_count(size_t* const count)
+{
+    uint8_t fifo_src = 0;
+    lis2dh12_ret_t err_code = lis2dh12_read_register(LIS2DH12_FIFO_SRC_REG, &fifo_src, 1);
+    *count = (fifo_src & LIS2DH12_OVRN_FIFO_MASK) ? LIS2DH12_FIFO_MAX_LENGTH : (fifo_src & LIS2DH12_FSS_MASK);
+    return err_code;
+}
+
+/** Read up to max samples from FIFO to capture buffer */
+static lis2dh12_ret_t drain(const size_t max)
+{
+    size_t count = 0;
+    lis2dh12_ret_t err_code = fifo_count(&count);
+    if(count > max) { count = max; }
+    if(LIS2DH12_RET_OK == err_code && count)
+    {
+        err_code |= lis2dh12_read_samples((lis2dh12_sensor_buffer_t*)&(m_capture.samples[m_collected]), count);
+        m_collected += count;
+    }
+    return err_code;
+}
+
+/** Reset FIFO and stream to it until activity interrupt on pin 2 */
+static lis2dh12_ret_t arm(void)
+{
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    m_trigger_pending = false;
+    m_state = LIS2DH12_CAPTURE_ARMED;
+    // Bypass clears FIFO
+    err_code |= lis2dh12_set_fifo_mode(LIS2DH12_MODE_BYPASS);
+    err_code |= lis2dh12_set_fifo_trigger(2);
+    err_code |= lis2dh12_set_fifo_mode(LIS2DH12_MODE_STREAM_TO_FIFO);
+    return err_code;
+}
+
+/** Store header of completed capture, notify and arm for next impact */
+static void complete(void)
+{
+    app_timer_stop(m_poll_timer);
+    m_capture.header.sequence = ++m_sequence;
+    m_capture.header.sample_rate = lis2dh12_odr_to_hz(m_config.sample_rate);
+    m_capture.header.trigger_ms = m_trigger_ms;
+    uint64_t unix_ms = 0;
+    rtc_sync_epoch_ms(m_trigger_ms, &unix_ms);
+    m_capture.header.trigger_unix_ms = unix_ms;
+    m_capture.header.post_samples = m_collected - m_capture.header.pre_samples;
+    NRF_LOG_INFO("Capture %d: %d + %d samples, gap %d ms\r\n", m_capture.header.sequence, m_capture.header.pre_samples,
+                 m_capture.header.post_samples, m_capture.header.gap_ms);
+    arm();
+    if(NULL != p_capture_handler) { p_capture_handler(&(m_capture.header)); }
+}
+
+/** Collect post-event samples, runs in scheduler context */
+static void poll_timer_handler(void* p_context)
+{
+    if(LIS2DH12_CAPTURE_POST != m_state) { return; }
+    const size_t target = m_capture.header.pre_samples + m_config.post_samples;
+    drain(target - m_collected);
+    if(m_collected >= target) { complete(); }
+}
+
+/** FIFO has frozen samples before trigger, read them and restart FIFO for post-event samples */
+static void scheduler_event_handler(void *p_event_data, uint16_t event_size)
+{
+    if(LIS2DH12_CAPTURE_ARMED != m_state) { return; }
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    m_state = LIS2DH12_CAPTURE_POST;
+    m_collected = 0;
+    err_code |= drain(LIS2DH12_CAPTURE_PRE_SAMPLES);
+    m_capture.header.pre_samples = m_collected;
+    err_code |= lis2dh12_set_fifo_mode(LIS2DH12_MODE_BYPASS);
+    err_code |= lis2dh12_set_fifo_mode(LIS2DH12_MODE_STREAM);
+    uint64_t gap = millis() - m_trigger_ms;
+    m_capture.header.gap_ms = (gap > UINT16_MAX) ? UINT16_MAX : gap;
+    if(LIS2DH12_RET_OK != err_code)
+    {
+        NRF_LOG_ERROR("Capture failed: %d\r\n", err_code);
+        arm();
+        return;
+    }
+
+    if(0 == m_config.post_samples) { complete(); return; }
+    uint32_t interval_ms = (CAPTURE_POLL_SAMPLES * 1000) / lis2dh12_odr_to_hz(m_config.sample_rate);
+    uint32_t ticks = APP_TIMER_TICKS(interval_ms, RUUVITAG_APP_TIMER_PRESCALER);
+    if(APP_TIMER_MIN_TIMEOUT_TICKS > ticks) { ticks = APP_TIMER_MIN_TIMEOUT_TICKS; }
+    if(NRF_SUCCESS != app_timer_start(m_poll_timer, ticks, NULL)) { complete(); }
+}
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+lis2dh12_ret_t lis2dh12_capture_configure(const lis2dh12_capture_config_t* const config, lis2dh12_capture_handler_t handler)
+{
+    if(NULL == config) { return LIS2DH12_RET_NULL; }
+    if(LIS2DH12_CAPTURE_MAX_POST < config->post_samples ||
+       CAPTURE_MIN_RATE_HZ > lis2dh12_odr_to_hz(config->sample_rate))
+    {
+        return LIS2DH12_RET_INVALID;
+    }
+    if(!m_timer_created)
+    {
+        if(NRF_SUCCESS != app_timer_create(&m_poll_timer, APP_TIMER_MODE_REPEATED, poll_timer_handler))
+        {
+            return LIS2DH12_RET_ERROR;
+        }
+        m_timer_created = true;
+    }
+    app_timer_stop(m_poll_timer);
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    m_config = *config;
+    p_capture_handler = handler;
+    err_code |= lis2dh12_set_sample_rate(m_config.sample_rate);
+    err_code |= lis2dh12_set_resolution(m_config.resolution);
+    err_code |= lis2dh12_set_activity_interrupt_pin_2(m_config.threshold_mg);
+    err_code |= arm();
+    return err_code;
+}
+
+lis2dh12_ret_t lis2dh12_capture_disable(void)
+{
+    if(LIS2DH12_CAPTURE_DISABLED == m_state) { return LIS2DH12_RET_OK; }
+    app_timer_stop(m_poll_timer);
+    m_state = LIS2DH12_CAPTURE_DISABLED;
+    m_trigger_pending = false;
+    return lis2dh12_set_fifo_mode(LIS2DH12_MODE_BYPASS);
+}
+
+ret_code_t lis2dh12_capture_interrupt_handler(const ruuvi_standard_message_t message)
+{
+    // Impact keeps triggering after FIFO has frozen, schedule read once per capture. SPI is not used in interrupt context.
+    if(LIS2DH12_CAPTURE_ARMED != m_state || m_trigger_pending) { return NRF_SUCCESS; }
+    m_trigger_ms = millis();
+    m_trigger_pending = true;
+    return app_sched_event_put(NULL, 0, scheduler_event_handler);
+}
+
+lis2dh12_capture_state_t lis2dh12_capture_get_state(void)
+{
+    return m_state;
+}
+
+lis2dh12_ret_t lis2dh12_capture_get(const uint8_t** data, size_t* length)
+{
+    if(NULL == data || NULL == length) { return LIS2DH12_RET_NULL; }
+    *data = (const uint8_t*)&m_capture;
+    *length = 0;
+    // Buffer is overwritten while post-event samples are collected
+    if(0 == m_capture.header.sequence || LIS2DH12_CAPTURE_POST == m_state) { return LIS2DH12_RET_INVALID; }
+    *length = sizeof(lis2dh12_capture_header_t) +
+              (m_capture.header.pre_samples + m_capture.header.post_samples) * sizeof(acceleration_t);
+    return LIS2DH12_RET_OK;
+}
@@ -0,0 +1,117 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_capture.h
+
+Pre-trigger impact capture of LIS2DH12.
+
+Sensor runs in stream-to-FIFO mode with activity interrupt of lis2dh12_set_activity_interrupt_pin_2
+as trigger. FIFO keeps 32 latest samples until acceleration exceeds threshold, then switches to FIFO
+mode and freezes the samples before the impact. On trigger the frozen samples are read to RAM, FIFO
+is restarted in stream mode and polled until configured number of post-event samples is collected.
+Capture is then complete and sensor is armed again for the next impact.
+
+Samples between trigger and restart of FIFO, i.e. scheduler latency and SPI read of 32 samples, are
+lost. The time is reported as gap_ms in capture header. If trigger comes less than 32 samples after
+arming, FIFO fills up after trigger and the last pre-event samples are after trigger.
+
+Activity interrupt uses interrupt function 2 and pin 2, capture cannot be used together with
+6D orientation of lis2dh12_events or lis2dh12_motion which change them.
+
+Usage:
+  lis2dh12_capture_config_t config = LIS2DH12_CAPTURE_CONFIG_DEFAULT;
+  config.post_samples = 64;
+  lis2dh12_capture_configure(&config, my_capture_handler);
+  pin_interrupt_enable(INT_ACC2_PIN, NRF_GPIOTE_POLARITY_LOTOHI, NRF_GPIO_PIN_NOPULL, lis2dh12_capture_interrupt_handler);
+
+Configure scale before capture, threshold is converted with it.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_CAPTURE_H
+#define LIS2DH12_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lis2dh12.h"
+#include "ruuvi_endpoints.h"
+
+/** Samples before trigger, FIFO depth */
+#define LIS2DH12_CAPTURE_PRE_SAMPLES  LIS2DH12_FIFO_MAX_LENGTH
+/** Maximum samples after trigger */
+#define LIS2DH12_CAPTURE_MAX_POST     96
+#define LIS2DH12_CAPTURE_MAX_SAMPLES  (LIS2DH12_CAPTURE_PRE_SAMPLES + LIS2DH12_CAPTURE_MAX_POST)
+
+/** State of capture */
+typedef enum{
+  LIS2DH12_CAPTURE_DISABLED = 0, /**< Capture not in use */
+  LIS2DH12_CAPTURE_ARMED,        /**< Streaming to FIFO, waiting for trigger */
+  LIS2DH12_CAPTURE_POST          /**< Triggered, collecting post-event samples */
+}lis2dh12_capture_state_t;
+
+/** Configuration of capture */
+typedef struct{
+  lis2dh12_sample_rate_t sample_rate; /**< Sample rate of capture, 10 Hz or more */
+  lis2dh12_resolution_t  resolution;  /**< Resolution of capture, FIFO is 10 bits */
+  uint16_t threshold_mg;              /**< High-passed acceleration to trigger */
+  uint8_t  post_samples;              /**< Samples after trigger, up to LIS2DH12_CAPTURE_MAX_POST */
+}lis2dh12_capture_config_t;
+
+/** Header of capture, followed by pre_samples + post_samples acceleration_t in mg, oldest first */
+typedef struct __attribute__((packed)){
+  uint16_t sequence;        /**< Number of capture since configuration, 0 if there is no capture */
+  uint16_t sample_rate;     /**< Hz */
+  uint32_t trigger_ms;      /**< millis() at trigger interrupt */
+  uint16_t gap_ms;          /**< Time from trigger to start of post-event samples */
+  uint8_t  pre_samples;     /**< Samples frozen in FIFO at trigger */
+  uint8_t  post_samples;    /**< Samples after gap */
+  uint64_t trigger_unix_ms; /**< Unix time at trigger interrupt, 0 if clock is not synchronised over RTC endpoint */
+}lis2dh12_capture_header_t;
+
+/** Capture handler, called in scheduler context when capture is complete */
+typedef void(*lis2dh12_capture_handler_t)(const lis2dh12_capture_header_t* const header);
+
+#define LIS2DH12_CAPTURE_CONFIG_DEFAULT { .sample_rate = LIS2DH12_RATE_100,     \
+                                          .resolution = LIS2DH12_RES10BIT,      \
+                                          .threshold_mg = 1000,                 \
+                                          .post_samples = 64 }
+
+/**
+ *  Configure sample rate, resolution and activity interrupt, and arm capture.
+ *  Previous capture is kept until a new one completes. Handler may be NULL.
+ *
+ *  @return error code from SPI, LIS2DH12_RET_NULL if config is NULL,
+ *          LIS2DH12_RET_INVALID if sample rate is below 10 Hz or post_samples too large.
+ */
+lis2dh12_ret_t lis2dh12_capture_configure(const lis2dh12_capture_config_t* const config, lis2dh12_capture_handler_t handler);
+
+/**
+ *  Stop capture and FIFO. Activity interrupt is left on pin 2, sample rate is left at current value.
+ *  Latest capture is kept.
+ *
+ *  @return error code from SPI.
+ */
+lis2dh12_ret_t lis2dh12_capture_disable(void);
+
+/**
+ *  Pin interrupt handler for INT2 pin, schedules reading of pre-event samples. Runs in interrupt context.
+ */
+ret_code_t lis2dh12_capture_interrupt_handler(const ruuvi_standard_message_t message);
+
+/**
+ *  Current state.
+ */
+lis2dh12_capture_state_t lis2dh12_capture_get_state(void);
+
+/**
+ *  Latest complete capture as header followed by samples.
+ *  Data stays valid until next capture completes, copy it for asynchronous use.
+ *
+ *  @param data set to point to capture
+ *  @param length set to number of bytes, 0 if there is no capture yet
+ *
+ *  @return LIS2DH12_RET_NULL if a parameter is NULL, LIS2DH12_RET_INVALID if there is no capture yet.
+ */
+lis2dh12_ret_t lis2dh12_capture_get(const uint8_t** data, size_t* length);
+
+#endif
@@ -0,0 +1,68 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_conversion.c
+
+Implementation of LIS2DH12 block conversion.
+
+For a detailed description see the detailed description in @ref lis2dh12_conversion.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_conversion.h"
+#include "lis2dh12_registers.h"
+
+/* CONSTANTS **************************************************************************************/
+#define CONVERSION_SCALES        4
+#define CONVERSION_RESOLUTIONS   3
+#define CONVERSION_SHIFT_12BIT   4
+#define CONVERSION_SHIFT_8BIT    8
+
+/**
+ * mg per LSB, index by scale (FS bits >> 4) and resolution ((shift - 4) / 2), i.e. 12, 10, 8 bits.
+ * From conversion functions of ST standard C driver, lis2dh12_reg.c
+ */
+static const int16_t mg_per_lsb[CONVERSION_SCALES][CONVERSION_RESOLUTIONS] = {
+    {  1,  4,  16 },  // 2 G
+    {  2,  8,  32 },  // 4 G
+    {  4, 16,  64 },  // 8 G
+    { 12, 48, 192 }   // 16 G
+};
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+bool lis2dh12_conversion_select(const uint8_t scale, const uint8_t resolution, lis2dh12_conversion_t* const conversion)
+{
+    if(NULL == conversion) { return false; }
+    conversion->shift = 0;
+    conversion->multiplier = 0;
+    if((scale & ~LIS2DH12_FS_MASK) ||
+       resolution < CONVERSION_SHIFT_12BIT || resolution > CONVERSION_SHIFT_8BIT || (resolution & 1))
+    {
+        return false;
+    }
+    conversion->shift = resolution;
+    conversion->multiplier = mg_per_lsb[scale >> 4][(resolution - CONVERSION_SHIFT_12BIT) / 2];
+    return true;
+}
+
+void lis2dh12_convert_to_mg(const lis2dh12_conversion_t conversion, int16_t* const values, const size_t count)
+{
+    if(NULL == values) { return; }
+    if(0 == conversion.multiplier)
+    {
+        for(size_t ii = 0; ii < count; ii++) { values[ii] = LIS2DH12_CONVERSION_INVALID; }
+        return;
+    }
+    const int16_t shift = conversion.shift;
+    const int16_t bias = (1 << shift) - 1;
+    const int16_t multiplier = conversion.multiplier;
+    // Arithmetic shift rounds down, add bias to negative values to round towards zero like division.
+    for(size_t ii = 0; ii < count; ii++)
+    {
+        const int16_t raw = values[ii];
+        values[ii] = (int16_t)(((raw + ((raw >> 15) & bias)) >> shift) * multiplier);
+    }
+}
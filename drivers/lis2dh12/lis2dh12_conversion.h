@@ -0,0 +1,51 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_conversion.h
+
+Block conversion of LIS2DH12 raw samples to mg.
+
+Output registers are left-justified, the number of unused low bits is given by resolution.
+Scale and resolution are resolved once per block to a shift and a multiplier from a lookup table,
+then all values of the block are converted in one loop without branches. Results are identical
+to the conversion functions of ST standard C drivers, i.e. (raw / 2^shift) * mg_per_lsb with
+division rounding towards zero.
+
+Plain C without SDK dependencies so that conversion can be verified on host, see benchmark/.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_CONVERSION_H
+#define LIS2DH12_CONVERSION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Returned for every value if scale or resolution is invalid */
+#define LIS2DH12_CONVERSION_INVALID ((int16_t)0x8000)
+
+/** Conversion resolved from scale and resolution */
+typedef struct{
+  uint8_t shift;      /**< Unused low bits of raw value */
+  int16_t multiplier; /**< mg per LSB after shift, 0 if invalid */
+}lis2dh12_conversion_t;
+
+/**
+ *  Resolve conversion.
+ *
+ *  @param scale LIS2DH12_FS_2G ... LIS2DH12_FS_16G, i.e. lis2dh12_scale_t
+ *  @param resolution unused bits, 8, 6 or 4, i.e. lis2dh12_resolution_t
+ *  @param conversion output, multiplier is 0 if parameters are invalid
+ *
+ *  @return false if scale or resolution is invalid
+ */
+bool lis2dh12_conversion_select(const uint8_t scale, const uint8_t resolution, lis2dh12_conversion_t* const conversion);
+
+/**
+ *  Convert count raw values to mg in place, e.g. 96 values of a full FIFO read.
+ *  Values are converted as a flat array, axes do not matter.
+ */
+void lis2dh12_convert_to_mg(const lis2dh12_conversion_t conversion, int16_t* const values, const size_t count);
+
+#endif
@@ -0,0 +1,206 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_events.c
+
+Implementation of LIS2DH12 hardware event engine.
+
+For a detailed description see the detailed description in @ref lis2dh12_events.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_events.h"
+#include "lis2dh12.h"
+#include "lis2dh12_registers.h"
+
+#include <stddef.h>
+#include "app_scheduler.h"
+
+#define NRF_LOG_MODULE_NAME "LIS2DH12_EVENTS"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/* CONSTANTS **************************************************************************************/
+/** Burst from INT1_SRC to CLICK_SRC */
+#define EVENT_BURST_START    LIS2DH12_INT1_SOURCE
+#define EVENT_BURST_LENGTH   (LIS2DH12_CLICK_SRC - LIS2DH12_INT1_SOURCE + 1)
+#define EVENT_INT1_SRC_INDEX (LIS2DH12_INT1_SOURCE - EVENT_BURST_START)
+#define EVENT_INT2_SRC_INDEX (LIS2DH12_INT2_SOURCE - EVENT_BURST_START)
+#define EVENT_CLICK_SRC_INDEX (LIS2DH12_CLICK_SRC - EVENT_BURST_START)
+
+/** Threshold and duration registers are 7 bits */
+#define EVENT_REGISTER_MAX   0x7F
+/** Latch click interrupt until CLICK_SRC is read */
+#define EVENT_LIR_CLICK      0x80
+
+#define EVENT_AXES_MASK      (LIS2DH12_ZH_MASK | LIS2DH12_ZL_MASK | LIS2DH12_YH_MASK | \
+                              LIS2DH12_YL_MASK | LIS2DH12_XH_MASK | LIS2DH12_XL_MASK)
+
+/* VARIABLES **************************************************************************************/
+static lis2dh12_event_handler_t p_event_handler = NULL;
+static uint8_t enabled_events = LIS2DH12_EVENT_NONE;
+
+/* INTERNAL FUNCTIONS *****************************************************************************/
+
+/** Convert mg to threshold register value at current scale, at least 1 LSB */
+static uint8_t mg_to_threshold(const uint16_t mg)
+{
+    int bits = (128 * mg) / lis2dh12_get_full_scale();
+    if(bits > EVENT_REGISTER_MAX) { bits = EVENT_REGISTER_MAX; }
+    if(bits < 1) { bits = 1; }
+    return (uint8_t)bits;
+}
+
+/** Convert ms to duration register value at current sample rate */
+static uint8_t ms_to_duration(const uint16_t ms)
+{
+    lis2dh12_sample_rate_t sample_rate = LIS2DH12_RATE_0;
+    lis2dh12_get_sample_rate(&sample_rate);
+    int samples = (ms * lis2dh12_odr_to_hz(sample_rate)) / 1000;
+    if(samples > EVENT_REGISTER_MAX) { samples = EVENT_REGISTER_MAX; }
+    return (uint8_t)samples;
+}
+
+/** Call handler with event */
+static void post(const uint8_t type, const uint8_t axes, const uint8_t negative, const uint8_t orientation)
+{
+    lis2dh12_event_t event = { .type = type, .axes = axes, .negative = negative, .orientation = orientation };
+    NRF_LOG_DEBUG("Event %d, axes %x\r\n", type, axes);
+    if(NULL != p_event_handler) { p_event_handler(&event); }
+}
+
+/** Scheduler handler for events */
+static void scheduler_event_handler(void *p_event_data, uint16_t event_size)
+{
+    lis2dh12_events_process();
+}
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+lis2dh12_ret_t lis2dh12_events_configure(const lis2dh12_event_config_t* const config, lis2dh12_event_handler_t handler)
+{
+    if(NULL == config) { return LIS2DH12_RET_NULL; }
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    uint8_t value = 0;
+    uint8_t int1_pin = 0;   // CTRL_REG3
+    uint8_t int2_pin = 0;   // CTRL_REG6
+    uint8_t latch = 0;      // CTRL_REG5
+    uint8_t highpass = 0;   // CTRL_REG2
+
+    p_event_handler = handler;
+    enabled_events = config->events;
+
+    // Pin 1 routing is overwritten by tap configuration, store it first.
+    uint8_t ctrl_reg3 = 0;
+    err_code |= lis2dh12_read_register(LIS2DH12_CTRL_REG3, &ctrl_reg3, 1);
+
+    // Click engine on INT1. Configures threshold, timing and highpass, pin routing is written below.
+    uint8_t click_cfg = 0;
+    if(LIS2DH12_EVENT_TAP & config->events)        { click_cfg |= LIS2DH12_XS_MASK | LIS2DH12_YS_MASK | LIS2DH12_ZS_MASK; }
+    if(LIS2DH12_EVENT_DOUBLE_TAP & config->events) { click_cfg |= LIS2DH12_XD_MASK | LIS2DH12_YD_MASK | LIS2DH12_ZD_MASK; }
+    if(click_cfg)
+    {
+        err_code |= lis2dh12_set_tap_interrupt(click_cfg, config->tap_threshold_mg, config->tap_time_limit_ms,
+                                               config->tap_latency_ms, config->tap_window_ms, 1);
+        err_code |= lis2dh12_read_register(LIS2DH12_CLICK_THS, &value, 1);
+        value |= EVENT_LIR_CLICK;
+        err_code |= lis2dh12_write_register(LIS2DH12_CLICK_THS, &value, 1);
+        int1_pin |= LIS2DH12_I1_CLICK;
+    }
+    else
+    {
+        value = 0;
+        err_code |= lis2dh12_write_register(LIS2DH12_CLICK_CFG, &value, 1);
+    }
+
+    // Free-fall on function 1: AND of all axes low, not high-passed.
+    if(LIS2DH12_EVENT_FREE_FALL & config->events)
+    {
+        err_code |= lis2dh12_set_interrupt_configuration(LIS2DH12_AOI_MASK | LIS2DH12_XLIE_MASK |
+                                                         LIS2DH12_YLIE_MASK | LIS2DH12_ZLIE_MASK, 1);
+        err_code |= lis2dh12_set_threshold(mg_to_threshold(config->free_fall_threshold_mg), 1);
+        value = ms_to_duration(config->free_fall_duration_ms);
+        err_code |= lis2dh12_write_register(LIS2DH12_INT1_DURATION, &value, 1);
+        int1_pin |= LIS2DH12_I1_IA1;
+        latch |= LIS2DH12_LIR_INT1_MASK;
+    }
+    else
+    {
+        err_code |= lis2dh12_set_interrupt_configuration(0, 1);
+    }
+
+    // 6D position on function 2, not high-passed. Activity interrupt is left as is if orientation is not used.
+    err_code |= lis2dh12_read_register(LIS2DH12_CTRL_REG2, &highpass, 1);
+    highpass &= ~LIS2DH12_HPIS1_MASK;
+    if(LIS2DH12_EVENT_ORIENTATION & config->events)
+    {
+        highpass &= ~LIS2DH12_HPIS2_MASK;
+        err_code |= lis2dh12_set_interrupt_configuration(LIS2DH12_AOI_MASK | LIS2DH12_6D_MASK | EVENT_AXES_MASK, 2);
+        err_code |= lis2dh12_set_threshold(mg_to_threshold(config->orientation_threshold_mg), 2);
+        value = ms_to_duration(config->orientation_duration_ms);
+        err_code |= lis2dh12_write_register(LIS2DH12_INT2_DURATION, &value, 1);
+        int2_pin |= LIS2DH12_I2C_INT2_MASK;
+        latch |= LIS2DH12_LIR_INT2_MASK;
+        err_code |= lis2dh12_set_interrupts(int2_pin, 2);
+    }
+    err_code |= lis2dh12_write_register(LIS2DH12_CTRL_REG2, &highpass, 1);
+
+    // Latches, keep FIFO enable and 4D bits
+    err_code |= lis2dh12_read_register(LIS2DH12_CTRL_REG5, &value, 1);
+    value &= ~(LIS2DH12_LIR_INT1_MASK | LIS2DH12_LIR_INT2_MASK);
+    value |= latch;
+    err_code |= lis2dh12_write_register(LIS2DH12_CTRL_REG5, &value, 1);
+
+    // Route INT1 pin. Keep FIFO interrupts of acceleration handler.
+    ctrl_reg3 &= ~(LIS2DH12_I1_CLICK | LIS2DH12_I1_IA1);
+    ctrl_reg3 |= int1_pin;
+    err_code |= lis2dh12_set_interrupts(ctrl_reg3, 1);
+
+    // Clear latches which may be pending from earlier configuration
+    uint8_t sources[EVENT_BURST_LENGTH];
+    err_code |= lis2dh12_read_register(EVENT_BURST_START, sources, sizeof(sources));
+
+    return err_code;
+}
+
+lis2dh12_ret_t lis2dh12_events_process(void)
+{
+    uint8_t sources[EVENT_BURST_LENGTH] = {0};
+    lis2dh12_ret_t err_code = lis2dh12_read_register(EVENT_BURST_START, sources, sizeof(sources));
+    if(LIS2DH12_RET_OK != err_code) { return err_code; }
+
+    const uint8_t click_src = sources[EVENT_CLICK_SRC_INDEX];
+    const uint8_t int1_src  = sources[EVENT_INT1_SRC_INDEX];
+    const uint8_t int2_src  = sources[EVENT_INT2_SRC_INDEX];
+
+    if(click_src & LIS2DH12_CLK_IA_MASK)
+    {
+        const uint8_t axes = click_src & (LIS2DH12_X_CLICK_MASK | LIS2DH12_Y_CLICK_MASK | LIS2DH12_Z_CLICK_MASK);
+        const uint8_t negative = (click_src & LIS2DH12_SIGN_MASK) ? 1 : 0;
+        if((click_src & LIS2DH12_SCLICK_MASK) && (LIS2DH12_EVENT_TAP & enabled_events))
+        {
+            post(LIS2DH12_EVENT_TAP, axes, negative, LIS2DH12_ORIENTATION_UNKNOWN);
+        }
+        if((click_src & LIS2DH12_DCLICK_MASK) && (LIS2DH12_EVENT_DOUBLE_TAP & enabled_events))
+        {
+            post(LIS2DH12_EVENT_DOUBLE_TAP, axes, negative, LIS2DH12_ORIENTATION_UNKNOWN);
+        }
+    }
+    if((int1_src & LIS2DH12_INT_IA_MASK) && (LIS2DH12_EVENT_FREE_FALL & enabled_events))
+    {
+        post(LIS2DH12_EVENT_FREE_FALL, int1_src & EVENT_AXES_MASK, 0, LIS2DH12_ORIENTATION_UNKNOWN);
+    }
+    if((int2_src & LIS2DH12_INT_IA_MASK) && (LIS2DH12_EVENT_ORIENTATION & enabled_events))
+    {
+        post(LIS2DH12_EVENT_ORIENTATION, int2_src & EVENT_AXES_MASK, 0, int2_src & EVENT_AXES_MASK);
+    }
+    return err_code;
+}
+
+ret_code_t lis2dh12_events_interrupt_handler(const ruuvi_standard_message_t message)
+{
+    // SPI is not used in interrupt context
+    return app_sched_event_put(NULL, 0, scheduler_event_handler);
+}
@@ -0,0 +1,113 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_events.h
+
+Hardware event engine of LIS2DH12: single tap, double tap, free-fall and 6D orientation change.
+
+Events are detected by the sensor, CPU wakes only on interrupt:
+ - Click engine (tap, double tap) and interrupt function 1 (free-fall) are routed to INT1 pin.
+ - Interrupt function 2 (6D orientation) is routed to INT2 pin. Orientation detection replaces
+   the activity interrupt of lis2dh12_set_activity_interrupt_pin_2, as both use function 2.
+All event sources are latched. On interrupt INT1_SRC...CLICK_SRC are read in one SPI burst,
+which clears the latches, and one typed event is posted for each active source.
+
+Usage:
+  lis2dh12_event_config_t config = LIS2DH12_EVENT_CONFIG_DEFAULT;
+  config.events = LIS2DH12_EVENT_DOUBLE_TAP | LIS2DH12_EVENT_FREE_FALL;
+  lis2dh12_events_configure(&config, my_event_handler);
+  pin_interrupt_enable(INT_ACC1_PIN, NRF_GPIOTE_POLARITY_LOTOHI, NRF_GPIO_PIN_NOPULL, lis2dh12_events_interrupt_handler);
+
+Each pin has only one interrupt handler. If INT2 pin already has a handler, call
+lis2dh12_events_interrupt_handler from it rather than enabling the pin again.
+
+Configure scale and sample rate before events, thresholds and times are converted with them.
+Tap detection is reliable at 400 Hz, see lis2dh12_set_tap_interrupt.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_EVENTS_H
+#define LIS2DH12_EVENTS_H
+
+#include <stdint.h>
+#include "lis2dh12.h"
+#include "ruuvi_endpoints.h"
+
+/** Event types, combine as bitmask for configuration */
+typedef enum{
+  LIS2DH12_EVENT_NONE        = 0,
+  LIS2DH12_EVENT_TAP         = 1,  /**< Single tap on any axis */
+  LIS2DH12_EVENT_DOUBLE_TAP  = 2,  /**< Double tap on any axis */
+  LIS2DH12_EVENT_FREE_FALL   = 4,  /**< All axes below threshold for duration */
+  LIS2DH12_EVENT_ORIENTATION = 8   /**< Tag has turned to a new 6D position */
+}lis2dh12_event_type_t;
+
+/** 6D position, i.e. axis pointing up. Values match INT2_SRC axis bits. */
+typedef enum{
+  LIS2DH12_ORIENTATION_UNKNOWN = 0,
+  LIS2DH12_ORIENTATION_X_DOWN  = LIS2DH12_XL_MASK,
+  LIS2DH12_ORIENTATION_X_UP    = LIS2DH12_XH_MASK,
+  LIS2DH12_ORIENTATION_Y_DOWN  = LIS2DH12_YL_MASK,
+  LIS2DH12_ORIENTATION_Y_UP    = LIS2DH12_YH_MASK,
+  LIS2DH12_ORIENTATION_Z_DOWN  = LIS2DH12_ZL_MASK,
+  LIS2DH12_ORIENTATION_Z_UP    = LIS2DH12_ZH_MASK
+}lis2dh12_orientation_t;
+
+/** Decoded event */
+typedef struct{
+  uint8_t type;        /**< lis2dh12_event_type_t */
+  uint8_t axes;        /**< Tap: LIS2DH12_X|Y|Z_CLICK_MASK, free-fall: axes below threshold */
+  uint8_t negative;    /**< Tap: 1 if tap was in negative direction */
+  uint8_t orientation; /**< Orientation: lis2dh12_orientation_t */
+}lis2dh12_event_t;
+
+/** Event handler, called in scheduler context once per decoded event */
+typedef void(*lis2dh12_event_handler_t)(const lis2dh12_event_t* const event);
+
+/** Declarative event configuration */
+typedef struct{
+  uint8_t  events;                   /**< Bitmask of lis2dh12_event_type_t */
+  uint16_t tap_threshold_mg;         /**< High-passed acceleration to detect tap */
+  uint16_t tap_time_limit_ms;        /**< Maximum duration of tap */
+  uint16_t tap_latency_ms;           /**< Dead time after first tap of double tap */
+  uint16_t tap_window_ms;            /**< Time after latency to detect second tap */
+  uint16_t free_fall_threshold_mg;   /**< All axes below this to detect free-fall */
+  uint16_t free_fall_duration_ms;    /**< Free-fall must last at least this long */
+  uint16_t orientation_threshold_mg; /**< Axis must exceed this to detect position */
+  uint16_t orientation_duration_ms;  /**< Position must be held at least this long */
+}lis2dh12_event_config_t;
+
+/** Defaults from ST application notes AN5005 and DM00365457 */
+#define LIS2DH12_EVENT_CONFIG_DEFAULT { .events = LIS2DH12_EVENT_NONE,        \
+                                        .tap_threshold_mg = 1000,             \
+                                        .tap_time_limit_ms = 100,             \
+                                        .tap_latency_ms = 100,                \
+                                        .tap_window_ms = 400,                 \
+                                        .free_fall_threshold_mg = 350,        \
+                                        .free_fall_duration_ms = 30,          \
+                                        .orientation_threshold_mg = 700,      \
+                                        .orientation_duration_ms = 100 }
+
+/**
+ *  Configure event engine. Events not in config->events are disabled.
+ *  Handler is called for each decoded event, NULL disables callbacks.
+ *
+ *  @return error code from SPI, LIS2DH12_RET_NULL if config is NULL.
+ */
+lis2dh12_ret_t lis2dh12_events_configure(const lis2dh12_event_config_t* const config, lis2dh12_event_handler_t handler);
+
+/**
+ *  Read event sources in one burst and call handler for each active event.
+ *  Called from scheduler by lis2dh12_events_interrupt_handler, may be called directly to poll.
+ *
+ *  @return error code from SPI.
+ */
+lis2dh12_ret_t lis2dh12_events_process(void);
+
+/**
+ *  Pin interrupt handler for INT1 and INT2 pins, schedules lis2dh12_events_process.
+ *  Runs in interrupt context.
+ */
+ret_code_t lis2dh12_events_interrupt_handler(const ruuvi_standard_message_t message);
+
+#endif
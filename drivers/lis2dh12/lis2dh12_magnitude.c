@@ -0,0 +1,105 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_magnitude.c
+
+Implementation of integer magnitude.
+
+For a detailed description see the detailed description in @ref lis2dh12_magnitude.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_magnitude.h"
+
+/* CONSTANTS **************************************************************************************/
+/**
+ * Coefficients of max, mid and min axis, 1/256. Minimise maximum relative error over all
+ * directions, 241 / 256 = 0.941, 101 / 256 = 0.395, 73 / 256 = 0.285.
+ */
+#define MAGNITUDE_ALPHA 241
+#define MAGNITUDE_BETA  101
+#define MAGNITUDE_GAMMA 73
+#define MAGNITUDE_SHIFT 8
+
+/* INTERNAL FUNCTIONS *****************************************************************************/
+
+/** Floor of square root, one result bit per iteration starting from highest set bit pair */
+static uint32_t isqrt(uint32_t value)
+{
+    if(0 == value) { return 0; }
+    uint32_t root = 0;
+    uint32_t bit = 1UL << ((31 - __builtin_clz(value)) & ~1UL);
+    while(bit)
+    {
+        if(value >= root + bit)
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/** Absolute value without overflow at INT16_MIN */
+static uint32_t absolute(const int16_t value)
+{
+    return (value < 0) ? (uint32_t)(-(int32_t)value) : (uint32_t)value;
+}
+
+/** Alpha max plus beta mid plus gamma min */
+static uint32_t approximate(uint32_t a, uint32_t b, uint32_t c)
+{
+    uint32_t swap;
+    if(a < b) { swap = a; a = b; b = swap; }
+    if(b < c) { swap = b; b = c; c = swap; }
+    if(a < b) { swap = a; a = b; b = swap; }
+    return (MAGNITUDE_ALPHA * a + MAGNITUDE_BETA * b + MAGNITUDE_GAMMA * c) >> MAGNITUDE_SHIFT;
+}
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+uint16_t lis2dh12_magnitude(const int16_t x, const int16_t y, const int16_t z, const lis2dh12_magnitude_accuracy_t accuracy)
+{
+    const uint32_t ax = absolute(x);
+    const uint32_t ay = absolute(y);
+    const uint32_t az = absolute(z);
+    // At most 3 * 32768^2 < 2^32
+    const uint32_t squares = ax * ax + ay * ay + az * az;
+    uint32_t root = 0;
+
+    switch(accuracy)
+    {
+        case LIS2DH12_MAGNITUDE_APPROXIMATE:
+            root = approximate(ax, ay, az);
+            break;
+
+        case LIS2DH12_MAGNITUDE_REFINED:
+            // Newton step from either side lands above exact root, error is square of approximation error.
+            root = approximate(ax, ay, az);
+            if(root) { root = (root + squares / root) / 2; }
+            break;
+
+        case LIS2DH12_MAGNITUDE_EXACT:
+        default:
+            root = isqrt(squares);
+            break;
+    }
+    return (root > UINT16_MAX) ? UINT16_MAX : (uint16_t)root;
+}
+
+void lis2dh12_magnitude_block(const int16_t* const xyz, uint16_t* const magnitude, const size_t count,
+                              const lis2dh12_magnitude_accuracy_t accuracy)
+{
+    if(NULL == xyz || NULL == magnitude) { return; }
+    for(size_t ii = 0; ii < count; ii++)
+    {
+        magnitude[ii] = lis2dh12_magnitude(xyz[3 * ii], xyz[3 * ii + 1], xyz[3 * ii + 2], accuracy);
+    }
+}
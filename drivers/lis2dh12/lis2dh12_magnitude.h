@@ -0,0 +1,53 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_magnitude.h
+
+Integer magnitude of 3-axis acceleration, sqrt(x^2 + y^2 + z^2) without floating point.
+
+Accuracy levels:
+ - EXACT:       Integer square root of sum of squares, equal to floor of exact magnitude.
+ - REFINED:     Approximation below refined with one Newton step, within 0.4 %. One division.
+ - APPROXIMATE: Alpha max plus beta mid plus gamma min, within 7 %. Multiplies and shifts only.
+Relative errors are for magnitudes above 256 mg, below that 1 mg resolution dominates.
+
+Axes are signed, any int16 value is valid. Magnitude of int16 axes is at most 56755,
+result is unsigned 16-bit. Sum of squares is computed in 32 bits and cannot overflow.
+
+Plain C without SDK dependencies so that accuracy and speed can be checked on host, see benchmark/.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_MAGNITUDE_H
+#define LIS2DH12_MAGNITUDE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Accuracy levels, see above */
+typedef enum{
+  LIS2DH12_MAGNITUDE_EXACT = 0,
+  LIS2DH12_MAGNITUDE_REFINED,
+  LIS2DH12_MAGNITUDE_APPROXIMATE
+}lis2dh12_magnitude_accuracy_t;
+
+/** Accuracy used by acceleration handler. Refined is within 0.4 % at a fraction of the cost of exact */
+#ifndef LIS2DH12_MAGNITUDE_ACCURACY
+#define LIS2DH12_MAGNITUDE_ACCURACY LIS2DH12_MAGNITUDE_REFINED
+#endif
+
+/**
+ *  Magnitude of one sample.
+ */
+uint16_t lis2dh12_magnitude(const int16_t x, const int16_t y, const int16_t z, const lis2dh12_magnitude_accuracy_t accuracy);
+
+/**
+ *  Magnitudes of count samples.
+ *
+ *  @param xyz interleaved axes, x, y, z of first sample followed by next sample, 3 * count values
+ *  @param magnitude output, count values
+ */
+void lis2dh12_magnitude_block(const int16_t* const xyz, uint16_t* const magnitude, const size_t count,
+                              const lis2dh12_magnitude_accuracy_t accuracy);
+
+#endif
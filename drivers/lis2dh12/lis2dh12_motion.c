@@ -0,0 +1,176 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_motion.c
+
+Implementation of LIS2DH12 wake-on-motion power mode switching.
+
+For a detailed description see the detailed description in @ref lis2dh12_motion.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_motion.h"
+#include "lis2dh12.h"
+#include "lis2dh12_registers.h"
+
+#include <stddef.h>
+#include "app_scheduler.h"
+#include "boards.h"
+#include "nrf_gpio.h"
+#include "rtc.h"
+
+#define NRF_LOG_MODULE_NAME "LIS2DH12_MOTION"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/* CONSTANTS **************************************************************************************/
+/** Idle configuration */
+#define MOTION_IDLE_SAMPLE_RATE  LIS2DH12_RATE_1
+#define MOTION_IDLE_RESOLUTION   LIS2DH12_RES8BIT
+
+/** ACT_DUR is 8 bits, ACT_THS 7 bits */
+#define MOTION_DURATION_MAX      0xFF
+
+/* VARIABLES **************************************************************************************/
+static lis2dh12_motion_config_t m_config;
+static lis2dh12_motion_handler_t p_state_handler = NULL;
+static lis2dh12_motion_state_t m_state = LIS2DH12_MOTION_DISABLED;
+static lis2dh12_motion_statistics_t m_statistics = {0};
+static uint64_t m_state_entered = 0;
+
+/* INTERNAL FUNCTIONS *****************************************************************************/
+
+/** Convert mg to ACT_THS value at current scale, at least 1 LSB as 0 disables the function */
+static uint8_t mg_to_threshold(const uint16_t mg)
+{
+    int bits = (128 * mg) / lis2dh12_get_full_scale();
+    if(bits > LIS2DH12_ACTH_MASK) { bits = LIS2DH12_ACTH_MASK; }
+    if(bits < 1) { bits = 1; }
+    return (uint8_t)bits;
+}
+
+/** Convert ms to ACT_DUR value at active sample rate, (8 * ACT_DUR + 1) / ODR */
+static uint8_t ms_to_duration(const uint32_t ms)
+{
+    uint32_t samples = (ms * lis2dh12_odr_to_hz(m_config.active_sample_rate)) / 1000;
+    uint32_t duration = (samples > 1) ? (samples - 1) / 8 : 0;
+    if(duration > MOTION_DURATION_MAX) { duration = MOTION_DURATION_MAX; }
+    return (uint8_t)duration;
+}
+
+/** Add time of current state to statistics and enter new state */
+static void transition(const lis2dh12_motion_state_t state)
+{
+    uint64_t now = millis();
+    if(LIS2DH12_MOTION_IDLE == m_state)   { m_statistics.idle_ms += now - m_state_entered; }
+    if(LIS2DH12_MOTION_ACTIVE == m_state) { m_statistics.active_ms += now - m_state_entered; }
+    if(LIS2DH12_MOTION_ACTIVE == state)   { m_statistics.wakeups++; }
+    m_state_entered = now;
+    m_state = state;
+    NRF_LOG_DEBUG("Motion state %d\r\n", state);
+    if(NULL != p_state_handler && LIS2DH12_MOTION_DISABLED != state) { p_state_handler(state); }
+}
+
+/** Disarm inactivity detection and return to 1 Hz low-power */
+static lis2dh12_ret_t enter_idle(void)
+{
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    err_code |= lis2dh12_set_activity_threshold(0);
+    err_code |= lis2dh12_set_interrupts(LIS2DH12_I2C_INT2_MASK, 2);
+    err_code |= lis2dh12_set_resolution(MOTION_IDLE_RESOLUTION);
+    err_code |= lis2dh12_set_sample_rate(MOTION_IDLE_SAMPLE_RATE);
+    transition(LIS2DH12_MOTION_IDLE);
+    return err_code;
+}
+
+/** Restore active sample rate and resolution, arm inactivity detection */
+static lis2dh12_ret_t enter_active(void)
+{
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    err_code |= lis2dh12_set_sample_rate(m_config.active_sample_rate);
+    err_code |= lis2dh12_set_resolution(m_config.active_resolution);
+    err_code |= lis2dh12_set_activity_duration(ms_to_duration(m_config.sleep_delay_ms));
+    err_code |= lis2dh12_set_activity_threshold(mg_to_threshold(m_config.sleep_threshold_mg));
+    err_code |= lis2dh12_set_interrupts(LIS2DH12_I2C_INT2_MASK | LIS2DH12_P2_ACT_MASK, 2);
+    transition(LIS2DH12_MOTION_ACTIVE);
+    return err_code;
+}
+
+/**
+ * Evaluate state. In idle only activity is routed to INT2, so an interrupt always means activity.
+ * In active state inactivity keeps pin high, activity only for the sample which exceeded threshold.
+ */
+static lis2dh12_ret_t evaluate(const bool interrupt)
+{
+    if(LIS2DH12_MOTION_DISABLED == m_state) { return LIS2DH12_RET_OK; }
+    uint8_t int2_src = 0;
+    lis2dh12_ret_t err_code = lis2dh12_read_register(LIS2DH12_INT2_SOURCE, &int2_src, 1);
+    if(LIS2DH12_RET_OK != err_code) { return err_code; }
+    const bool activity = int2_src & LIS2DH12_INT_IA_MASK;
+
+    if(LIS2DH12_MOTION_IDLE == m_state && (interrupt || activity))
+    {
+        err_code |= enter_active();
+    }
+    else if(LIS2DH12_MOTION_ACTIVE == m_state && !activity && nrf_gpio_pin_read(INT_ACC2_PIN))
+    {
+        err_code |= enter_idle();
+    }
+    return err_code;
+}
+
+/** Scheduler handler for INT2 */
+static void scheduler_event_handler(void *p_event_data, uint16_t event_size)
+{
+    evaluate(true);
+}
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+lis2dh12_ret_t lis2dh12_motion_configure(const lis2dh12_motion_config_t* const config, lis2dh12_motion_handler_t handler)
+{
+    if(NULL == config) { return LIS2DH12_RET_NULL; }
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    m_config = *config;
+    p_state_handler = handler;
+    err_code |= lis2dh12_set_activity_interrupt_pin_2(m_config.wake_threshold_mg);
+    err_code |= enter_idle();
+    return err_code;
+}
+
+lis2dh12_ret_t lis2dh12_motion_disable(void)
+{
+    lis2dh12_ret_t err_code = LIS2DH12_RET_OK;
+    if(LIS2DH12_MOTION_DISABLED == m_state) { return err_code; }
+    err_code |= lis2dh12_set_activity_threshold(0);
+    err_code |= lis2dh12_set_interrupts(LIS2DH12_I2C_INT2_MASK, 2);
+    transition(LIS2DH12_MOTION_DISABLED);
+    return err_code;
+}
+
+lis2dh12_ret_t lis2dh12_motion_process(void)
+{
+    return evaluate(false);
+}
+
+ret_code_t lis2dh12_motion_interrupt_handler(const ruuvi_standard_message_t message)
+{
+    // SPI is not used in interrupt context
+    return app_sched_event_put(NULL, 0, scheduler_event_handler);
+}
+
+lis2dh12_motion_state_t lis2dh12_motion_get_state(void)
+{
+    return m_state;
+}
+
+void lis2dh12_motion_get_statistics(lis2dh12_motion_statistics_t* const statistics)
+{
+    if(NULL == statistics) { return; }
+    *statistics = m_statistics;
+    uint64_t elapsed = millis() - m_state_entered;
+    if(LIS2DH12_MOTION_IDLE == m_state)   { statistics->idle_ms += elapsed; }
+    if(LIS2DH12_MOTION_ACTIVE == m_state) { statistics->active_ms += elapsed; }
+}
@@ -0,0 +1,106 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_motion.h
+
+Wake-on-motion power mode switching of LIS2DH12.
+
+While the tag is still, sensor runs at 1 Hz in 8-bit low-power mode with the activity interrupt of
+lis2dh12_set_activity_interrupt_pin_2 armed. On activity the configured sample rate and resolution
+are restored and the activity / inactivity function (ACT_THS, ACT_DUR) is armed. When acceleration
+has stayed below sleep threshold for sleep delay, sensor signals inactivity on INT2 and is returned
+to 1 Hz low-power mode.
+
+Both activity (IA2, high for 1/ODR) and inactivity (P2_ACT, high while inactive) are signaled on
+INT2 pin. Inactivity is recognized as INT2 pin high without interrupt function 2 being active.
+Interrupt function 2 is used for wake-up, 6D orientation of lis2dh12_events cannot be used at the same time.
+
+Usage:
+  lis2dh12_motion_config_t config = LIS2DH12_MOTION_CONFIG_DEFAULT;
+  config.active_sample_rate = LIS2DH12_RATE_10;
+  lis2dh12_motion_configure(&config, my_state_handler);
+  pin_interrupt_enable(INT_ACC2_PIN, NRF_GPIOTE_POLARITY_LOTOHI, NRF_GPIO_PIN_NOPULL, lis2dh12_motion_interrupt_handler);
+
+Configure scale before motion detection, thresholds are converted with it.
+Call lis2dh12_motion_process periodically to recover from INT2 edges lost while pin was already high.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_MOTION_H
+#define LIS2DH12_MOTION_H
+
+#include <stdint.h>
+#include "lis2dh12.h"
+#include "ruuvi_endpoints.h"
+
+/** Power state of accelerometer */
+typedef enum{
+  LIS2DH12_MOTION_DISABLED = 0, /**< Motion gating not in use */
+  LIS2DH12_MOTION_IDLE,         /**< 1 Hz low-power, waiting for activity */
+  LIS2DH12_MOTION_ACTIVE        /**< Configured sample rate and resolution */
+}lis2dh12_motion_state_t;
+
+/** Configuration of motion gating */
+typedef struct{
+  lis2dh12_sample_rate_t active_sample_rate; /**< Sample rate while moving */
+  lis2dh12_resolution_t  active_resolution;  /**< Resolution while moving */
+  uint16_t wake_threshold_mg;                /**< High-passed acceleration to wake */
+  uint16_t sleep_threshold_mg;               /**< ACT_THS, acceleration to stay active */
+  uint32_t sleep_delay_ms;                   /**< ACT_DUR, time below sleep threshold to return to idle */
+}lis2dh12_motion_config_t;
+
+/** Time in states since configuration */
+typedef struct{
+  uint64_t idle_ms;   /**< Time at 1 Hz low-power */
+  uint64_t active_ms; /**< Time at active sample rate */
+  uint32_t wakeups;   /**< Number of transitions to active */
+}lis2dh12_motion_statistics_t;
+
+/** State handler, called in scheduler context after each transition */
+typedef void(*lis2dh12_motion_handler_t)(const lis2dh12_motion_state_t state);
+
+#define LIS2DH12_MOTION_CONFIG_DEFAULT { .active_sample_rate = LIS2DH12_RATE_10,  \
+                                         .active_resolution = LIS2DH12_RES10BIT,  \
+                                         .wake_threshold_mg = 64,                 \
+                                         .sleep_threshold_mg = 64,                \
+                                         .sleep_delay_ms = 30000 }
+
+/**
+ *  Configure motion gating and enter idle state. Handler is called on state changes, may be NULL.
+ *
+ *  @return error code from SPI, LIS2DH12_RET_NULL if config is NULL.
+ */
+lis2dh12_ret_t lis2dh12_motion_configure(const lis2dh12_motion_config_t* const config, lis2dh12_motion_handler_t handler);
+
+/**
+ *  Stop motion gating. Activity / inactivity function is disarmed, activity interrupt is left on pin 2
+ *  and sample rate is left at current value. Statistics are kept.
+ *
+ *  @return error code from SPI.
+ */
+lis2dh12_ret_t lis2dh12_motion_disable(void);
+
+/**
+ *  Check INT2 source and pin state and switch state if needed.
+ *  Called from scheduler by lis2dh12_motion_interrupt_handler, may be called directly to poll.
+ *
+ *  @return error code from SPI.
+ */
+lis2dh12_ret_t lis2dh12_motion_process(void);
+
+/**
+ *  Pin interrupt handler for INT2 pin, schedules state evaluation. Runs in interrupt context.
+ */
+ret_code_t lis2dh12_motion_interrupt_handler(const ruuvi_standard_message_t message);
+
+/**
+ *  Current state.
+ */
+lis2dh12_motion_state_t lis2dh12_motion_get_state(void);
+
+/**
+ *  Time spent in each state, including the ongoing state.
+ */
+void lis2dh12_motion_get_statistics(lis2dh12_motion_statistics_t* const statistics);
+
+#endif
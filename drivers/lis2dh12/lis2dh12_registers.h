@@ -208,5 +208,32 @@
 // ACT_DUR masks
 // None
 
+// Settings of driver as register values, plain C so that they can be used in host tools.
+/** Available Scales */
+typedef enum{
+  LIS2DH12_SCALE2G = LIS2DH12_FS_2G,  /**< Scale Selection: +/- 2g */
+  LIS2DH12_SCALE4G = LIS2DH12_FS_4G,	/**< Scale Selection: +/- 4g */
+  LIS2DH12_SCALE8G = LIS2DH12_FS_8G,	/**< Scale Selection: +/- 8g */
+  LIS2DH12_SCALE16G = LIS2DH12_FS_16G	/**< Scale Selection: +/- 16g */
+}lis2dh12_scale_t;
+
+/** Available Resolutions */
+typedef enum{
+  LIS2DH12_RES8BIT = 8,		/**< 8 extra bits */
+  LIS2DH12_RES10BIT = 6,		/**< 6 extra bits */
+  LIS2DH12_RES12BIT = 4		/**< 4 extra bits */
+}lis2dh12_resolution_t;
+
+/** Available sample rates */
+typedef enum{
+  LIS2DH12_RATE_0   = 0,		/**< Power down */
+  LIS2DH12_RATE_1   = 1<<4,	/**< 1 Hz */
+  LIS2DH12_RATE_10  = 2<<4,	/**< 10 Hz*/
+  LIS2DH12_RATE_25  = 3<<4,		
+  LIS2DH12_RATE_50  = 4<<4,		
+  LIS2DH12_RATE_100 = 5<<4,		
+  LIS2DH12_RATE_200 = 6<<4,		
+  LIS2DH12_RATE_400 = 7<<4    /** 1k+ rates not implemented */		
+}lis2dh12_sample_rate_t;
 
 #endif /* _LIS2DH12REG_H_ */
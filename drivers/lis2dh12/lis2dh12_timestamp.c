@@ -0,0 +1,100 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_timestamp.c
+
+Implementation of LIS2DH12 FIFO sample timestamps.
+
+For a detailed description see the detailed description in @ref lis2dh12_timestamp.h
+
+* @}
+***************************************************************************************************/
+
+/* INCLUDES ***************************************************************************************/
+#include "lis2dh12_timestamp.h"
+
+/* VARIABLES **************************************************************************************/
+static uint32_t m_nominal_ns = 0;
+static uint32_t m_period_ns = 0;
+static uint8_t m_trigger_level = 1;
+static uint32_t m_samples = 0;           // Samples read since reset
+static bool m_anchored = false;          // Time of anchor sample is known
+static uint32_t m_anchor_sample = 0;
+static uint64_t m_anchor_us = 0;
+static volatile uint64_t m_irq_us = 0;   // Set in interrupt context
+static volatile bool m_irq_pending = false;
+
+/* INTERNAL FUNCTIONS *****************************************************************************/
+
+/** Read time of interrupt, retry if interrupt updated it during read */
+static uint64_t irq_time(void)
+{
+    uint64_t time_us;
+    do
+    {
+        m_irq_pending = false;
+        time_us = m_irq_us;
+    } while(m_irq_pending);
+    return time_us;
+}
+
+/** Update period estimate with time between interrupts, reject observations far from nominal */
+static void track_period(const uint32_t sample, const uint64_t time_us)
+{
+    if(!m_anchored || sample <= m_anchor_sample || time_us <= m_anchor_us) { return; }
+    const int64_t observed = (int64_t)((time_us - m_anchor_us) * 1000 / (sample - m_anchor_sample));
+    const int64_t tolerance = m_nominal_ns / 4;
+    if(observed < (int64_t)m_nominal_ns - tolerance || observed > (int64_t)m_nominal_ns + tolerance) { return; }
+    m_period_ns += (observed - (int64_t)m_period_ns) / (1 << LIS2DH12_TIMESTAMP_FILTER_SHIFT);
+}
+
+/* PUBLIC FUNCTIONS *******************************************************************************/
+
+void lis2dh12_timestamp_reset(const uint32_t nominal_period_ns, const uint8_t trigger_level)
+{
+    m_nominal_ns = nominal_period_ns;
+    m_period_ns = nominal_period_ns;
+    m_trigger_level = (0 == trigger_level) ? 1 : trigger_level;
+    m_samples = 0;
+    m_anchored = false;
+    m_irq_pending = false;
+}
+
+void lis2dh12_timestamp_interrupt(const uint64_t time_us)
+{
+    m_irq_us = time_us;
+    m_irq_pending = true;
+}
+
+bool lis2dh12_timestamp_batch(const size_t count, lis2dh12_batch_time_t* const batch)
+{
+    if(NULL == batch || 0 == m_nominal_ns) { return false; }
+    // Interrupt was raised when sample number trigger_level of this batch was stored.
+    // Interrupts of other sources on the pin leave fewer samples in FIFO, they are not anchors.
+    if(m_irq_pending)
+    {
+        const uint64_t time_us = irq_time();
+        const uint32_t sample = m_samples + m_trigger_level - 1;
+        if(count >= m_trigger_level)
+        {
+            track_period(sample, time_us);
+            m_anchor_sample = sample;
+            m_anchor_us = time_us;
+            m_anchored = true;
+        }
+    }
+    const uint32_t first = m_samples;
+    m_samples += count;
+    if(!m_anchored) { return false; }
+
+    const int64_t offset_ns = ((int64_t)first - (int64_t)m_anchor_sample) * m_period_ns;
+    batch->first_us = m_anchor_us + offset_ns / 1000;
+    batch->period_ns = m_period_ns;
+    batch->count = count;
+    return true;
+}
+
+uint32_t lis2dh12_timestamp_period_ns(void)
+{
+    return m_period_ns;
+}
@@ -0,0 +1,67 @@
+/**
+@addtogroup LIS2DH12Driver LIS2DH12 Acceleration Sensor Driver
+@{
+@file       lis2dh12_timestamp.h
+
+Time of samples read from LIS2DH12 FIFO.
+
+Watermark interrupt is handled through scheduler, so the time of FIFO read has jitter of scheduler
+latency. Instead time is taken in the interrupt, when sample number trigger_level is stored to FIFO.
+Samples are counted over batches, so every interrupt gives time of one known sample:
+
+  t(n) = t_irq + (n - n_irq) * period
+
+Sample period of the sensor differs from nominal ODR by up to +-10 %. Period is estimated from
+time and sample count between consecutive interrupts and low-pass filtered. Observations further
+than 1/4 from nominal period, e.g. after a lost interrupt, are rejected.
+
+Samples lost to FIFO overrun shift timestamps of the batch by the lost samples until next interrupt.
+Interrupts followed by a batch smaller than trigger_level were not raised by watermark and are ignored.
+
+Plain C without SDK dependencies, caller provides time of interrupt.
+
+* @}
+***************************************************************************************************/
+#ifndef LIS2DH12_TIMESTAMP_H
+#define LIS2DH12_TIMESTAMP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Weight of new period observation is 1 / 2^LIS2DH12_TIMESTAMP_FILTER_SHIFT */
+#define LIS2DH12_TIMESTAMP_FILTER_SHIFT 3
+
+/** Time of a batch of samples, sample i was taken at first_us + i * period_ns / 1000 */
+typedef struct{
+  uint64_t first_us;  /**< Time of oldest sample in batch */
+  uint32_t period_ns; /**< Estimated sample period */
+  uint16_t count;     /**< Samples in batch */
+}lis2dh12_batch_time_t;
+
+/**
+ *  Start counting samples from 0 with nominal period. Call on ODR or FIFO changes.
+ *
+ *  @param nominal_period_ns period of configured ODR, 0 disables timestamps
+ *  @param trigger_level samples in FIFO when watermark interrupt is raised, 1 ... 32
+ */
+void lis2dh12_timestamp_reset(const uint32_t nominal_period_ns, const uint8_t trigger_level);
+
+/**
+ *  Store time of watermark interrupt. Call in interrupt context.
+ */
+void lis2dh12_timestamp_interrupt(const uint64_t time_us);
+
+/**
+ *  Compute time of count samples read from FIFO after latest interrupt.
+ *
+ *  @return false if there has been no interrupt since reset, batch time is not valid
+ */
+bool lis2dh12_timestamp_batch(const size_t count, lis2dh12_batch_time_t* const batch);
+
+/**
+ *  Current estimate of sample period, nominal period until two interrupts have been seen.
+ */
+uint32_t lis2dh12_timestamp_period_ns(void);
+
+#endif
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lis2dh12_timestamp.h"
+
+#define NOMINAL_NS 10000000u // 100 Hz
+#define WATERMARK  30
+#define FIFO_SIZE  32
+
+static int failures = 0;
+
+static void check(const bool ok, const char* const what, const long long value)
+{
+  if(ok) { return; }
+  failures++;
+  printf("FAIL %s: %lld\n", what, value);
+}
+
+/** Sensor sampling at true period, FIFO read on watermark interrupt after scheduler latency */
+typedef struct{
+  uint64_t period_ns;     // True sample period
+  uint64_t start_ns;      // Time of sample 0
+  uint32_t produced;      // Samples stored by sensor
+  uint32_t read;          // Samples read from FIFO
+}sensor_t;
+
+static uint64_t sample_ns(const sensor_t* const s, const uint32_t sample)
+{
+  return s->start_ns + (uint64_t)sample * s->period_ns;
+}
+
+/** Sensor stores samples until watermark, interrupt is taken with jitter and FIFO read later */
+static bool watermark_batch(sensor_t* const s, const bool interrupt, const uint32_t extra, lis2dh12_batch_time_t* const batch,
+                            int64_t* const first_error_us)
+{
+  const uint32_t watermark_sample = s->read + WATERMARK - 1;
+  s->produced = watermark_sample + 1 + extra;
+  if(interrupt) { lis2dh12_timestamp_interrupt(sample_ns(s, watermark_sample) / 1000 + rand() % 40); }
+  // Stream mode keeps newest samples on overrun
+  uint32_t count = s->produced - s->read;
+  if(count > FIFO_SIZE)
+  {
+    s->read = s->produced - FIFO_SIZE;
+    count = FIFO_SIZE;
+  }
+  const uint32_t first = s->read;
+  s->read += count;
+  if(!lis2dh12_timestamp_batch(count, batch)) { return false; }
+  *first_error_us = (int64_t)batch->first_us - (int64_t)(sample_ns(s, first) / 1000);
+  return true;
+}
+
+/** Time of samples comes from interrupt of the batch: first sample is watermark - 1 periods before */
+static void check_anchor(void)
+{
+  sensor_t s = { .period_ns = NOMINAL_NS, .start_ns = 1000000000ull };
+  lis2dh12_batch_time_t batch;
+  int64_t error_us = 0;
+  lis2dh12_timestamp_reset(NOMINAL_NS, WATERMARK);
+  check(!lis2dh12_timestamp_batch(5, &batch), "batch before interrupt", 0);
+  s.read = 5;
+  lis2dh12_timestamp_interrupt(sample_ns(&s, s.read + WATERMARK - 1) / 1000);
+  check(lis2dh12_timestamp_batch(WATERMARK + 1, &batch), "batch after interrupt", 0);
+  check(sample_ns(&s, 5) / 1000 == batch.first_us, "anchor first sample us", (long long)batch.first_us - sample_ns(&s, 5) / 1000);
+  check(NOMINAL_NS == batch.period_ns && WATERMARK + 1 == batch.count, "nominal period", batch.period_ns);
+  s.read += WATERMARK + 1;
+  // Batch without interrupt continues from anchor
+  check(lis2dh12_timestamp_batch(3, &batch), "batch without interrupt", 0);
+  check(sample_ns(&s, s.read) / 1000 == batch.first_us, "continued first sample us", (long long)batch.first_us - sample_ns(&s, s.read) / 1000);
+  s.read += 3;
+  check(watermark_batch(&s, true, 0, &batch, &error_us), "watermark batch", 0);
+  check(error_us > -50 && error_us < 50, "watermark batch error us", error_us);
+  check(!lis2dh12_timestamp_batch(0, NULL), "NULL batch", 0);
+  lis2dh12_timestamp_reset(0, WATERMARK);
+  lis2dh12_timestamp_interrupt(1000);
+  check(!lis2dh12_timestamp_batch(WATERMARK, &batch), "disabled", 0);
+}
+
+/** Period converges to true ODR within +-10 % of nominal, timestamps follow */
+static void check_convergence(const int32_t odr_error_ppm)
+{
+  sensor_t s = { .period_ns = (uint64_t)NOMINAL_NS * (1000000 + odr_error_ppm) / 1000000, .start_ns = 5000000000ull };
+  lis2dh12_batch_time_t batch;
+  int64_t error_us = 0;
+  srand(odr_error_ppm);
+  lis2dh12_timestamp_reset(NOMINAL_NS, WATERMARK);
+  for(int ii = 0; ii < 100; ii++) { watermark_batch(&s, true, rand() % 3, &batch, &error_us); }
+  const int64_t period_error = (int64_t)lis2dh12_timestamp_period_ns() - (int64_t)s.period_ns;
+  printf("ODR error %6d ppm: period %8u ns, error %6lld ns, first sample error %4lld us\n",
+         odr_error_ppm, lis2dh12_timestamp_period_ns(), (long long)period_error, (long long)error_us);
+  // Interrupt jitter of 40 us over 30 samples
+  check(period_error > -2000 && period_error < 2000, "period error ns", period_error);
+  check(error_us > -100 && error_us < 100, "first sample error us", error_us);
+}
+
+/** Lost interrupt and interrupts of other sources must not disturb the estimate */
+static void check_rejection(void)
+{
+  const int32_t odr_error_ppm = 50000;
+  sensor_t s = { .period_ns = (uint64_t)NOMINAL_NS * (1000000 + odr_error_ppm) / 1000000, .start_ns = 5000000000ull };
+  lis2dh12_batch_time_t batch;
+  int64_t error_us = 0;
+  lis2dh12_timestamp_reset(NOMINAL_NS, WATERMARK);
+  for(int ii = 0; ii < 100; ii++) { watermark_batch(&s, true, 0, &batch, &error_us); }
+  const uint32_t period = lis2dh12_timestamp_period_ns();
+
+  // Missed interrupt: FIFO overruns, samples between interrupts are lost
+  watermark_batch(&s, false, WATERMARK, &batch, &error_us);
+  watermark_batch(&s, true, 0, &batch, &error_us);
+  int64_t change = (int64_t)lis2dh12_timestamp_period_ns() - period;
+  check(change > -1000 && change < 1000, "period change after missed interrupt ns", change);
+  check(error_us > -100 && error_us < 100, "first sample error after missed interrupt us", error_us);
+
+  // Tap interrupt on shared pin schedules an early read of a few samples
+  s.produced = s.read + 4;
+  lis2dh12_timestamp_interrupt(sample_ns(&s, s.produced - 1) / 1000);
+  const uint32_t first = s.read;
+  check(lis2dh12_timestamp_batch(4, &batch), "batch after other interrupt", 0);
+  s.read += 4;
+  error_us = (int64_t)batch.first_us - (int64_t)(sample_ns(&s, first) / 1000);
+  check(error_us > -100 && error_us < 100, "first sample error after other interrupt us", error_us);
+  watermark_batch(&s, true, 0, &batch, &error_us);
+  change = (int64_t)lis2dh12_timestamp_period_ns() - period;
+  check(change > -1000 && change < 1000, "period change after other interrupt ns", change);
+  check(error_us > -100 && error_us < 100, "first sample error after other interrupt us", error_us);
+}
+
+int main(void)
+{
+  check_anchor();
+  const int32_t odr_errors[] = {0, 30000, -30000, 90000, -90000};
+  for(size_t ii = 0; ii < sizeof(odr_errors) / sizeof(odr_errors[0]); ii++) { check_convergence(odr_errors[ii]); }
+  check_rejection();
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -49,6 +49,7 @@
 #include "fstorage.h"
 #include "nrf_delay.h"
 #include "nrf_error.h"
+#include "counters.h"
 
 #if defined(FDS_CRC_ENABLED)
     #include "crc16.h"
@@ -83,8 +84,11 @@ static void fds_evt_handler(fds_evt_t const * p_evt)
             if (p_evt->result == FDS_SUCCESS)
             {
                 NRF_LOG_INFO("Record written\r\n");
-                m_fds_processing = false;
+                COUNTER_INC(COUNTER_FLASH_WRITES);
             }
+            else { COUNTER_INC(COUNTER_FLASH_ERRORS); }
+            // Release writer also on error, it would wait forever otherwise
+            m_fds_processing = false;
         } break;
 
         case FDS_EVT_UPDATE:
@@ -92,8 +96,10 @@ static void fds_evt_handler(fds_evt_t const * p_evt)
             if (p_evt->result == FDS_SUCCESS)
             {
                 NRF_LOG_INFO("Record updated\r\n");
-                m_fds_processing = false;
+                COUNTER_INC(COUNTER_FLASH_WRITES);
             }
+            else { COUNTER_INC(COUNTER_FLASH_ERRORS); }
+            m_fds_processing = false;
         } break;
 
         case FDS_EVT_DEL_RECORD:
@@ -193,6 +199,7 @@ ret_code_t flash_free_size_get(size_t* size)
     if(FDS_SUCCESS != err_code) 
     { 
       m_fds_processing = false;
+      COUNTER_INC(COUNTER_FLASH_ERRORS);
       return err_code; 
     }
 
@@ -210,6 +217,7 @@ ret_code_t flash_free_size_get(size_t* size)
     if(FDS_SUCCESS != err_code) 
     { 
       m_fds_processing = false;
+      COUNTER_INC(COUNTER_FLASH_ERRORS);
       return err_code; 
     }
     /* Wait for process to complete */
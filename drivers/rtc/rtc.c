@@ -1,5 +1,7 @@
 #include "rtc.h"
+#include "rtc_clock.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "nrf_drv_rtc.h"
@@ -15,8 +17,6 @@
 
 const nrf_drv_rtc_t rtc = NRF_DRV_RTC_INSTANCE(APP_RTC_INSTANCE); /**< Declaring an instance of nrf_drv_rtc for RTC2. */
 
-static uint64_t overflows = 0;
-
 static void rtc_handler(nrf_drv_rtc_int_type_t int_type)
 {
     if (int_type == NRF_DRV_RTC_INT_COMPARE0)
@@ -29,7 +29,7 @@ static void rtc_handler(nrf_drv_rtc_int_type_t int_type)
     }
     else if (int_type == NRF_DRV_RTC_INT_OVERFLOW)
     {
-      overflows++;
+      rtc_clock_overflow();
     }
 }
 
@@ -39,10 +39,14 @@ uint32_t init_rtc(void)
 
   //Initialize RTC instance
   nrf_drv_rtc_config_t config = NRF_DRV_RTC_DEFAULT_CONFIG;
-  config.prescaler = 32;
+  // Count at 32768 Hz, conversions to time are shifts
+  config.prescaler = 0;
   err_code = nrf_drv_rtc_init(&rtc, &config, rtc_handler);
   APP_ERROR_CHECK(err_code);
 
+  // Counter overflows every 512 s, count overflows for 64-bit time
+  nrf_drv_rtc_overflow_enable(&rtc, true);
+
   //Enable tick event & interrupt - consumes horrendous amount of power on quick ticks
   //nrf_drv_rtc_tick_enable(&rtc,true);
 
@@ -56,12 +60,32 @@ uint32_t init_rtc(void)
   return err_code;
 }
 
+uint32_t rtc_clock_hw_counter(void)
+{
+  return nrf_drv_rtc_counter_get(&rtc);
+}
+
+bool rtc_clock_hw_overflow_pending(void)
+{
+  return nrf_rtc_event_pending(rtc.p_reg, NRF_RTC_EVENT_OVERFLOW);
+}
+
+uint64_t rtc_ticks(void)
+{
+  return rtc_clock_ticks();
+}
+
+uint64_t micros(void)
+{
+  return rtc_clock_ticks_to_us(rtc_clock_ticks());
+}
+
 uint64_t millis(void)
 {
-  uint64_t ms = nrf_drv_rtc_counter_get(&rtc);
-  ms += overflows<<24;
-  //Compensate tick roundoff
-  ms*=32000;
-  ms/=32768;
-  return ms;
+  return rtc_clock_ticks_to_ms(rtc_clock_ticks());
+}
+
+uint32_t rtc_log_timestamp(void)
+{
+  return millis();
 }
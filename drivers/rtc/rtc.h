@@ -5,6 +5,16 @@
 
 uint32_t init_rtc(void);
 
+/** Milliseconds since init_rtc() */
 uint64_t millis(void);
 
+/** Microseconds since init_rtc(), resolution is one tick of 30.5 us */
+uint64_t micros(void);
+
+/** Ticks of 1 / 32768 s since init_rtc(), monotonic and overflow-safe */
+uint64_t rtc_ticks(void);
+
+/** Timestamp of log lines, milliseconds since init_rtc(). RTC endpoint logs synchronisations to Unix time. */
+uint32_t rtc_log_timestamp(void);
+
 #endif
@@ -0,0 +1,25 @@
+#include "rtc_clock.h"
+
+// Incremented in RTC interrupt, 32-bit reads are atomic
+static volatile uint32_t overflows = 0;
+
+void rtc_clock_overflow(void)
+{
+  overflows++;
+}
+
+uint64_t rtc_clock_ticks(void)
+{
+  uint32_t count;
+  uint32_t counter;
+  bool pending;
+  do
+  {
+    count = overflows;
+    counter = rtc_clock_hw_counter();
+    pending = rtc_clock_hw_overflow_pending();
+    // Counter has wrapped but interrupt has not counted it yet. Read again, first value may be from before wrap.
+    if(pending) { counter = rtc_clock_hw_counter(); }
+  } while(count != overflows); // Interrupt counted an overflow during read
+  return ((uint64_t)(count + pending) << RTC_CLOCK_COUNTER_BITS) | counter;
+}
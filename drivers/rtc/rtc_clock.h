@@ -0,0 +1,49 @@
+#ifndef RTC_CLOCK_H
+#define RTC_CLOCK_H
+/*
+ * Monotonic clock from 24-bit RTC counter and a software count of counter overflows.
+ *
+ * RTC runs at 32768 Hz without prescaler, so conversions to time are a multiply by a constant and a shift:
+ *   ms = ticks * 1000 / 32768 = ticks * 125 >> 12
+ *   us = ticks * 1000000 / 32768 = ticks * 15625 >> 9
+ * Products stay below 2^64 for 1000 years of ticks.
+ *
+ * Counter overflows every 512 s. Overflow can happen between reading the overflow count and the counter,
+ * or be pending while the RTC interrupt has not run yet, e.g. when read with interrupts disabled.
+ * rtc_clock_ticks() retries if the overflow count changed during the read and adds a pending overflow
+ * to the count, so the clock never jumps back or forward by 512 s.
+ * Reads from an interrupt of higher priority than RTC interrupt may miss an overflow which RTC interrupt
+ * has cleared but not counted yet.
+ *
+ * Plain C, hardware access is provided by the platform so that wrap handling can be checked on host, see test/.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RTC_CLOCK_HZ           32768
+#define RTC_CLOCK_COUNTER_BITS 24
+
+/** Counter value, implemented by platform */
+uint32_t rtc_clock_hw_counter(void);
+
+/** True if counter has overflowed and overflow has not been counted with rtc_clock_overflow(), implemented by platform */
+bool rtc_clock_hw_overflow_pending(void);
+
+/** Count one overflow, call from RTC overflow interrupt */
+void rtc_clock_overflow(void);
+
+/** Ticks since start of RTC */
+uint64_t rtc_clock_ticks(void);
+
+static inline uint64_t rtc_clock_ticks_to_ms(const uint64_t ticks)
+{
+  return (ticks * 125) >> 12;
+}
+
+static inline uint64_t rtc_clock_ticks_to_us(const uint64_t ticks)
+{
+  return (ticks * 15625) >> 9;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "rtc_sync.h"
+
+#include <stddef.h>
+
+static bool m_synced = false;
+static uint64_t m_anchor_epoch = 0;   // Offset, epoch time at anchor_local
+static uint64_t m_anchor_local = 0;
+static bool m_filtered_known = false;
+static int32_t m_filtered_ppb = 0;     // Filtered drift of completed baselines
+static int32_t m_drift_ppb = 0;
+static uint64_t m_reference_epoch = 0; // Raw synchronisation at start of baseline
+static uint64_t m_reference_local = 0;
+
+/** Start drift baseline at this synchronisation */
+static void move_reference(const uint64_t epoch_ms, const uint64_t local_ms)
+{
+  m_reference_epoch = epoch_ms;
+  m_reference_local = local_ms;
+}
+
+/**
+ *  Observe drift over baseline from reference. Later observations of the same baseline replace earlier
+ *  ones, as latency jitter is divided by a longer interval. Completed baselines are low-pass filtered.
+ */
+static void track_drift(const uint64_t epoch_ms, const uint64_t local_ms)
+{
+  if(local_ms < m_reference_local + RTC_SYNC_DRIFT_MIN_INTERVAL_MS) { return; }
+  const int64_t elapsed = local_ms - m_reference_local;
+  const int64_t difference = (int64_t)(epoch_ms - m_reference_epoch) - elapsed;
+  // |difference| / elapsed > 500 ppm, also keeps product below 2^63. Restart baseline.
+  const int64_t magnitude = (difference < 0) ? -difference : difference;
+  if(magnitude > elapsed / (1000000000 / RTC_SYNC_MAX_DRIFT_PPB))
+  {
+    move_reference(epoch_ms, local_ms);
+    return;
+  }
+  const int32_t observed = difference * 1000000000 / elapsed;
+  if(!m_filtered_known) { m_drift_ppb = observed; }
+  else { m_drift_ppb = m_filtered_ppb + (observed - m_filtered_ppb) / (1 << RTC_SYNC_DRIFT_FILTER_SHIFT); }
+  if(elapsed >= RTC_SYNC_DRIFT_BASELINE_MS)
+  {
+    m_filtered_ppb = m_drift_ppb;
+    m_filtered_known = true;
+    move_reference(epoch_ms, local_ms);
+  }
+}
+
+void rtc_sync_reset(void)
+{
+  m_synced = false;
+  m_filtered_known = false;
+  m_filtered_ppb = 0;
+  m_drift_ppb = 0;
+}
+
+int64_t rtc_sync_set(const uint64_t epoch_ms, const uint64_t local_ms)
+{
+  uint64_t predicted;
+  if(!rtc_sync_epoch_ms(local_ms, &predicted))
+  {
+    m_anchor_epoch = m_reference_epoch = epoch_ms;
+    m_anchor_local = m_reference_local = local_ms;
+    m_synced = true;
+    return 0;
+  }
+  track_drift(epoch_ms, local_ms);
+  int64_t correction = (int64_t)(epoch_ms - predicted);
+  if(correction < RTC_SYNC_STEP_MS && correction > -RTC_SYNC_STEP_MS) { correction /= 2; }
+  m_anchor_epoch = predicted + correction;
+  m_anchor_local = local_ms;
+  return correction;
+}
+
+bool rtc_sync_epoch_ms(const uint64_t local_ms, uint64_t* const epoch_ms)
+{
+  if(!m_synced || NULL == epoch_ms) { return false; }
+  const int64_t elapsed = local_ms - m_anchor_local;
+  *epoch_ms = m_anchor_epoch + elapsed + elapsed * m_drift_ppb / 1000000000;
+  return true;
+}
+
+uint32_t rtc_sync_age_s(const uint64_t local_ms)
+{
+  if(!m_synced) { return RTC_SYNC_AGE_NEVER; }
+  const uint64_t age = (local_ms - m_anchor_local) / 1000;
+  return (age >= RTC_SYNC_AGE_NEVER) ? RTC_SYNC_AGE_NEVER - 1 : age;
+}
+
+int32_t rtc_sync_drift_ppb(void)
+{
+  return m_drift_ppb;
+}
@@ -0,0 +1,61 @@
+#ifndef RTC_SYNC_H
+#define RTC_SYNC_H
+/*
+ * Wall clock from local monotonic milliseconds and synchronisations to Unix epoch time given by a client.
+ *
+ * Each synchronisation is a pair (epoch ms, local ms). Time between synchronisations is extrapolated
+ * from the latest anchor, corrected by drift of the local clock:
+ *   epoch = anchor_epoch + elapsed + elapsed * drift_ppb / 1e9
+ *
+ * Offset: error of extrapolated time against a new synchronisation is halved to average out latency
+ * of the connection. Errors over RTC_SYNC_STEP_MS, e.g. the first sync after a long outage or a client
+ * with a different clock, set the time directly.
+ *
+ * Drift: observed from raw epoch and local time since the start of a baseline, at least
+ * RTC_SYNC_DRIFT_MIN_INTERVAL_MS apart. Each observation covers the whole baseline, so latency jitter
+ * shrinks as the baseline grows instead of accumulating in a filter of short observations. Baselines
+ * are restarted every RTC_SYNC_DRIFT_BASELINE_MS and low-pass filtered to follow temperature.
+ * Observations over RTC_SYNC_MAX_DRIFT_PPB are rejected and restart the baseline, crystal is within
+ * +-40 ppm over temperature.
+ *
+ * Plain C, caller provides local time so that filter can be checked on host, see test/.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define RTC_SYNC_STEP_MS               1000
+#define RTC_SYNC_DRIFT_MIN_INTERVAL_MS (60 * 60 * 1000)
+#define RTC_SYNC_DRIFT_BASELINE_MS     (24 * 60 * 60 * 1000)
+#define RTC_SYNC_MAX_DRIFT_PPB         500000
+/** Weight of new baseline is 1 / 2^RTC_SYNC_DRIFT_FILTER_SHIFT */
+#define RTC_SYNC_DRIFT_FILTER_SHIFT    2
+/** Sync age if clock has not been synchronised */
+#define RTC_SYNC_AGE_NEVER             UINT32_MAX
+
+/** Forget synchronisation and drift */
+void rtc_sync_reset(void);
+
+/**
+ *  Synchronise to epoch time.
+ *
+ *  @param epoch_ms Unix time in milliseconds
+ *  @param local_ms local monotonic time at which epoch_ms was valid
+ *  @return correction applied to extrapolated time in ms, 0 on first synchronisation
+ */
+int64_t rtc_sync_set(const uint64_t epoch_ms, const uint64_t local_ms);
+
+/**
+ *  Convert local time to epoch time.
+ *
+ *  @return false if clock has not been synchronised, epoch_ms is not changed
+ */
+bool rtc_sync_epoch_ms(const uint64_t local_ms, uint64_t* const epoch_ms);
+
+/** Seconds since latest synchronisation, RTC_SYNC_AGE_NEVER if not synchronised */
+uint32_t rtc_sync_age_s(const uint64_t local_ms);
+
+/** Estimated drift of local clock against epoch in parts per billion, positive if local clock is slow */
+int32_t rtc_sync_drift_ppb(void);
+
+#endif
@@ -0,0 +1,88 @@
+#include "rtc_time_handler.h"
+#include "rtc.h"
+#include "rtc_sync.h"
+
+#include <string.h>
+
+#define NRF_LOG_MODULE_NAME "RTC_TIME_HANDLER"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/**
+ *  Send reply to source of message.
+ */
+static ret_code_t reply(const ruuvi_standard_message_t message, const ruuvi_message_type_t type,
+                        const void* const payload, const size_t length)
+{
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = RTC,
+                                     .type                 = type,
+                                     .payload              = {0}};
+  memcpy(reply.payload, payload, length);
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler) { return p_reply_handler(reply); }
+  return ENDPOINT_HANDLER_ERROR;
+}
+
+static ret_code_t query_status(const ruuvi_standard_message_t message)
+{
+  ruuvi_rtc_status_payload_t status = { .sync_age_s = rtc_sync_age_s(millis()),
+                                        .drift_ppb  = rtc_sync_drift_ppb() };
+  return reply(message, ACKNOWLEDGEMENT, &status, sizeof(status));
+}
+
+/**
+ *  Synchronise to Unix time in payload. Time is taken when message is handled,
+ *  scheduler and connection latency are averaged out by sync filter.
+ */
+static ret_code_t set_time(const ruuvi_standard_message_t message)
+{
+  uint64_t epoch_ms;
+  memcpy(&epoch_ms, message.payload, sizeof(epoch_ms));
+  const uint64_t local_ms = millis();
+  if(0 == epoch_ms)
+  {
+    NRF_LOG_INFO("Wall clock synchronisation cleared\r\n");
+    rtc_sync_reset();
+  }
+  else
+  {
+    const int32_t correction = rtc_sync_set(epoch_ms, local_ms);
+    // Log timestamps are local ms, this line maps them to wall clock
+    NRF_LOG_INFO("Synchronised to %d s + %d ms at %d ms\r\n", (uint32_t)(epoch_ms / 1000), (uint32_t)(epoch_ms % 1000),
+                 (uint32_t)local_ms);
+    NRF_LOG_INFO("Correction %d ms, drift %d ppb\r\n", correction, rtc_sync_drift_ppb());
+  }
+  return query_status(message);
+}
+
+static ret_code_t read_time(const ruuvi_standard_message_t message)
+{
+  uint64_t epoch_ms = 0;
+  rtc_sync_epoch_ms(millis(), &epoch_ms);
+  return reply(message, UINT64, &epoch_ms, sizeof(epoch_ms));
+}
+
+/**
+ *  Handles incoming messages.
+ */
+ret_code_t rtc_time_handler(const ruuvi_standard_message_t message)
+{
+  //Return if message was not meant for this endpoint.
+  if(RTC != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  switch(message.type)
+  {
+    case UINT64:
+      return set_time(message);
+
+    case STATUS_QUERY:
+      return query_status(message);
+
+    case DATA_QUERY:
+      return read_time(message);
+
+    default:
+      return unknown_handler(message);
+  }
+  return ENDPOINT_HANDLER_ERROR; // Should not be reached
+}
@@ -0,0 +1,35 @@
+#ifndef RTC_TIME_HANDLER_H
+#define RTC_TIME_HANDLER_H
+
+/**
+ *  Handler for wall clock of RTC endpoint.
+ *  Is used with Ruuvi endpoints, client such as a gateway synchronises the tag to Unix time over NUS.
+ *  Tag tracks offset and drift of its RTC against the synchronisations, see rtc_sync.h, and
+ *  timestamps sample batches and impact captures with wall clock time.
+ *
+ *  Messages to RTC endpoint:
+ *   - UINT64: Unix time in ms, little endian. 0 forgets synchronisation.
+ *     Reply is ACKNOWLEDGEMENT with ruuvi_rtc_status_payload_t.
+ *   - DATA_QUERY: Reply is UINT64 Unix time in ms, 0 if not synchronised.
+ *   - STATUS_QUERY: Reply is ACKNOWLEDGEMENT with ruuvi_rtc_status_payload_t. Clients should resynchronise
+ *     when sync age grows, error grows by drift uncertainty of a few ppm, i.e. about 0.3 s per day.
+ */
+
+#include "ruuvi_endpoints.h"
+#include "nrf_error.h"
+
+/**
+ *  Handle messages with "RTC" as destination endpoint. This should not be called directly, but rather
+ *  through ruuvi_endpoints function route_message.
+ *
+ *  Usage:
+ *  ruuvi_standard_message_t sync = { .destination_endpoint = RTC, .source_endpoint = 0x60, .type = UINT64 };
+ *  uint64_t now_ms = 1577836800000; // 2020-01-01 00:00:00
+ *  memcpy(sync.payload, &now_ms, sizeof(now_ms));
+ *  route_message(sync);
+ *
+ *  Returns error code from endpoint, i.e. ENDPOINT_SUCCESS if message was understood.
+ */
+ret_code_t rtc_time_handler(const ruuvi_standard_message_t message);
+
+#endif
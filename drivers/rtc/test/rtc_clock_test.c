@@ -0,0 +1,149 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "rtc_clock.h"
+
+#define COUNTER_MASK ((1u << RTC_CLOCK_COUNTER_BITS) - 1)
+#define NEVER        UINT32_MAX
+
+// Simulated RTC
+static uint64_t true_ticks;      // Ticks since start, hardware counter is lowest 24 bits
+static bool     overflow_event;  // Overflow event not handled by interrupt
+static uint32_t step;            // Ticks per hardware access
+static uint32_t accesses;        // Hardware accesses since interrupt was armed
+static uint32_t interrupt_at;    // Run interrupt before this access, NEVER if interrupts are disabled
+
+/** Interrupt clears event and counts overflow */
+static void rtc_interrupt(void)
+{
+  if(!overflow_event) { return; }
+  overflow_event = false;
+  rtc_clock_overflow();
+}
+
+/** Advance time, run pending interrupt when it is due */
+static void hardware_access(void)
+{
+  if(accesses++ == interrupt_at) { rtc_interrupt(); }
+  const uint64_t next = true_ticks + step;
+  if((next >> RTC_CLOCK_COUNTER_BITS) != (true_ticks >> RTC_CLOCK_COUNTER_BITS)) { overflow_event = true; }
+  true_ticks = next;
+}
+
+uint32_t rtc_clock_hw_counter(void)
+{
+  hardware_access();
+  return true_ticks & COUNTER_MASK;
+}
+
+bool rtc_clock_hw_overflow_pending(void)
+{
+  hardware_access();
+  return overflow_event;
+}
+
+/** Jump to start, overflows on the way are handled by interrupt */
+static void run_to(const uint64_t start)
+{
+  for(uint64_t wraps = (start >> RTC_CLOCK_COUNTER_BITS) - (true_ticks >> RTC_CLOCK_COUNTER_BITS); wraps; wraps--)
+  {
+    rtc_clock_overflow();
+  }
+  true_ticks = start;
+}
+
+/** Every case starts next to a new wrap, before or after it */
+static int check_wraps(void)
+{
+  int failures = 0;
+  uint64_t checks = 0;
+  for(step = 1; step <= 4; step++)
+  {
+    for(uint32_t delay = 0; delay <= 8; delay++)
+    {
+      for(int64_t offset = -12; offset <= 4; offset++)
+      {
+        const uint64_t wrap_tick = ((true_ticks >> RTC_CLOCK_COUNTER_BITS) + 2) << RTC_CLOCK_COUNTER_BITS;
+        run_to(wrap_tick + offset);
+        interrupt_at = (8 == delay) ? NEVER : delay;
+        accesses = 0;
+        uint64_t previous = 0;
+        for(int read = 0; read < 4; read++)
+        {
+          const uint64_t before = true_ticks;
+          const uint64_t ticks = rtc_clock_ticks();
+          const uint64_t after = true_ticks;
+          checks++;
+          if(ticks < before || ticks > after || ticks < previous)
+          {
+            if(failures++ < 10)
+            {
+              printf("FAIL step %u interrupt %u offset %lld: %llu not in [%llu, %llu], previous %llu\n",
+                     step, delay, (long long)offset, (unsigned long long)ticks, (unsigned long long)before,
+                     (unsigned long long)after, (unsigned long long)previous);
+            }
+          }
+          previous = ticks;
+        }
+        // Let interrupt catch up before next case
+        rtc_interrupt();
+      }
+    }
+  }
+  printf("Wraps: %llu reads, %d failures\n", (unsigned long long)checks, failures);
+  return failures;
+}
+
+/** Exact ticks * scale / RTC_CLOCK_HZ without 64-bit overflow */
+static uint64_t reference(const uint64_t ticks, const uint64_t scale)
+{
+  return (ticks / RTC_CLOCK_HZ) * scale + (ticks % RTC_CLOCK_HZ) * scale / RTC_CLOCK_HZ;
+}
+
+static int check_conversions(void)
+{
+  int failures = 0;
+  srand(1);
+  for(uint32_t ii = 0; ii < 1000000; ii++)
+  {
+    // Up to 2^47 ticks, 136 years
+    const uint64_t ticks = (ii < 100000) ? ii : (((uint64_t)rand() << 16) ^ rand()) & ((1ull << 47) - 1);
+    if(rtc_clock_ticks_to_ms(ticks) != reference(ticks, 1000) ||
+       rtc_clock_ticks_to_us(ticks) != reference(ticks, 1000000))
+    {
+      if(failures++ < 10) { printf("FAIL conversion of %llu\n", (unsigned long long)ticks); }
+    }
+  }
+  printf("Conversions: %d failures\n", failures);
+  return failures;
+}
+
+static double seconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void time_conversions(void)
+{
+  const uint32_t rounds = 10000000;
+  volatile uint64_t divisor = 32768; // Keep division from being turned into a shift
+  volatile uint64_t sink = 0;
+  double start = seconds();
+  for(uint64_t ii = 0; ii < rounds; ii++) { sink += ii * 32000 / divisor; }
+  const double division = seconds() - start;
+  start = seconds();
+  for(uint64_t ii = 0; ii < rounds; ii++) { sink += rtc_clock_ticks_to_ms(ii); }
+  const double shift = seconds() - start;
+  printf("Host ms conversion: division %.1f ns, multiply and shift %.1f ns\n",
+         division * 1e9 / rounds, shift * 1e9 / rounds);
+}
+
+int main(void)
+{
+  int failures = check_wraps() + check_conversions();
+  time_conversions();
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "rtc_sync.h"
+
+#define EPOCH_START 1600000000000ull // Unix ms at start of simulation
+#define HOUR_MS     (60 * 60 * 1000ull)
+
+static int failures = 0;
+
+static void check(const bool ok, const char* const what, const long long value)
+{
+  if(ok) { return; }
+  failures++;
+  printf("FAIL %s: %lld\n", what, value);
+}
+
+/** Local ms when true epoch time has advanced by true_ms, local clock runs slow by drift_ppb */
+static uint64_t local_at(const uint64_t true_ms, const int32_t drift_ppb)
+{
+  return true_ms - (int64_t)true_ms * drift_ppb / 1000000000;
+}
+
+/** Error of extrapolated time at true time true_ms */
+static int64_t error_at(const uint64_t true_ms, const int32_t drift_ppb)
+{
+  uint64_t epoch = 0;
+  if(!rtc_sync_epoch_ms(local_at(true_ms, drift_ppb), &epoch)) { return INT64_MAX; }
+  return (int64_t)(epoch - (EPOCH_START + true_ms));
+}
+
+/** Synchronise every 30 minutes for 3 days with 0 ... max_latency ms of connection latency */
+static void synchronise(const int32_t drift_ppb, const int max_latency, uint64_t* const true_ms_out)
+{
+  rtc_sync_reset();
+  srand(drift_ppb);
+  uint64_t true_ms = 5000;
+  for(int sync = 0; sync < 3 * 48; sync++)
+  {
+    const uint64_t latency = max_latency ? rand() % max_latency : 0;
+    // Client sends its time, tag handles message after latency
+    rtc_sync_set(EPOCH_START + true_ms, local_at(true_ms + latency, drift_ppb));
+    true_ms += HOUR_MS / 2;
+  }
+  *true_ms_out = true_ms;
+}
+
+/** Track drift over latency jitter, then extrapolate over an outage */
+static void check_tracking(const int32_t drift_ppb)
+{
+  uint64_t true_ms = 0;
+  synchronise(drift_ppb, 60, &true_ms);
+  const int32_t drift_error = rtc_sync_drift_ppb() - drift_ppb;
+  const int64_t outage_error = error_at(true_ms + 7 * 24 * HOUR_MS, drift_ppb);
+  printf("Drift %6d ppb: estimate %6d ppb, error after 7 days without sync %5lld ms\n",
+         drift_ppb, rtc_sync_drift_ppb(), (long long)outage_error);
+  check(drift_error < 2000 && drift_error > -2000, "drift estimate", drift_error);
+  // 2 ppm over 7 days is 1.2 s, plus latency
+  check(outage_error < 1300 && outage_error > -1300, "error after outage", outage_error);
+}
+
+/** Perfect clock without latency must not drift, jitter of 60 ms over a day baseline is under 1 ppm */
+static void check_perfect_clock(void)
+{
+  uint64_t true_ms = 0;
+  synchronise(0, 0, &true_ms);
+  check(0 == rtc_sync_drift_ppb(), "perfect clock drift", rtc_sync_drift_ppb());
+  const int64_t outage_error = error_at(true_ms + 7 * 24 * HOUR_MS, 0);
+  check(0 == outage_error, "perfect clock error after outage", outage_error);
+  synchronise(0, 60, &true_ms);
+  check(rtc_sync_drift_ppb() < 1000 && rtc_sync_drift_ppb() > -1000, "perfect clock drift with latency", rtc_sync_drift_ppb());
+}
+
+static void check_basics(void)
+{
+  uint64_t epoch = 0;
+  rtc_sync_reset();
+  check(!rtc_sync_epoch_ms(1000, &epoch), "epoch before sync", epoch);
+  check(RTC_SYNC_AGE_NEVER == rtc_sync_age_s(1000), "age before sync", rtc_sync_age_s(1000));
+  check(0 == rtc_sync_set(EPOCH_START, 1000), "first correction", 0);
+  check(rtc_sync_epoch_ms(4000, &epoch) && EPOCH_START + 3000 == epoch, "epoch after sync", epoch - EPOCH_START);
+  check(3 == rtc_sync_age_s(4000), "age", rtc_sync_age_s(4000));
+
+  // Small error is halved, large error steps
+  int64_t correction = rtc_sync_set(EPOCH_START + 10040, 11000);
+  check(20 == correction, "halved correction", correction);
+  check(0 == rtc_sync_age_s(11000), "age after sync", rtc_sync_age_s(11000));
+  correction = rtc_sync_set(EPOCH_START + 60000, 12000);
+  check(60000 - 11000 - 20 == correction, "step", correction);
+  check(rtc_sync_epoch_ms(12000, &epoch) && EPOCH_START + 60000 == epoch, "epoch after step", epoch - EPOCH_START);
+
+  // Observation of 1 % is not a clock drift
+  rtc_sync_set(EPOCH_START + 60000 + HOUR_MS * 101 / 100, 12000 + HOUR_MS);
+  check(0 == rtc_sync_drift_ppb(), "rejected drift", rtc_sync_drift_ppb());
+}
+
+int main(void)
+{
+  check_basics();
+  check_perfect_clock();
+  const int32_t drifts[] = {0, 20000, -20000, 40000, -40000};
+  for(size_t ii = 0; ii < sizeof(drifts) / sizeof(drifts[0]); ii++) { check_tracking(drifts[ii]); }
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -22,6 +22,7 @@ For a detailed description see the detailed description in @ref spi.h
 #include "nrf_delay.h"
 #include "app_util_platform.h"
 #include "boards.h"
+#include "counters.h"
 
 #define NRF_LOG_MODULE_NAME "SPI"
 #include "nrf_log.h"
@@ -93,6 +94,7 @@ extern SPI_Ret spi_transfer_bme280(uint8_t* const p_toWrite, uint8_t count, uint
   if ((true == spi_xfer_done) && (SPI_RET_OK == retVal))
 	{
         spi_xfer_done = false;
+        COUNTER_INC(COUNTER_SPI_TRANSACTIONS);
 
         nrf_gpio_pin_clear(SPIM0_SS_HUMI_PIN);
         APP_ERROR_CHECK(nrf_drv_spi_transfer(&spi, p_toWrite, count, p_toRead, count));
@@ -109,6 +111,7 @@ extern SPI_Ret spi_transfer_bme280(uint8_t* const p_toWrite, uint8_t count, uint
 	else
 	{
 	    retVal = SPI_RET_BUSY;
+	    COUNTER_INC(COUNTER_SPI_BUSY);
 	}
 
   return retVal;
@@ -126,6 +129,7 @@ extern SPI_Ret spi_transfer_lis2dh12(uint8_t* const p_toWrite, uint8_t count, ui
     if ((true == spi_xfer_done) && (SPI_RET_OK == retVal))
     {
         spi_xfer_done = false;
+        COUNTER_INC(COUNTER_SPI_TRANSACTIONS);
 
         nrf_gpio_pin_clear(SPIM0_SS_ACC_PIN);
         nrf_drv_spi_transfer(&spi, p_toWrite, count, p_toRead, count);
@@ -141,11 +145,17 @@ extern SPI_Ret spi_transfer_lis2dh12(uint8_t* const p_toWrite, uint8_t count, ui
     else
     {
         retVal = SPI_RET_BUSY;
+        COUNTER_INC(COUNTER_SPI_BUSY);
     }
 
     return retVal;
 }
 
+extern uint32_t spi_get_transaction_count(void)
+{
+    return counters_get(COUNTER_SPI_TRANSACTIONS);
+}
+
 
 /* INTERNAL FUNCTIONS *****************************************************************************/
 
@@ -77,6 +77,13 @@ extern SPI_Ret spi_transfer_bme280(uint8_t* const p_toWrite, uint8_t count, uint
  */
 extern SPI_Ret spi_transfer_lis2dh12(uint8_t* const p_toWrite, uint8_t count, uint8_t* const p_toRead);
 
+/**
+ * Get number of SPI transactions started since boot. Each transaction toggles chip select once.
+ *
+ * @return number of transactions, wraps around at UINT32_MAX
+ */
+extern uint32_t spi_get_transaction_count(void);
+
 #ifdef __cplusplus
 }
 #endif
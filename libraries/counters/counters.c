@@ -0,0 +1,46 @@
+#include "counters.h"
+
+#include <string.h>
+
+volatile uint32_t counters_table[COUNTER_COUNT];
+
+uint32_t counters_get(const counter_id_t id)
+{
+  return (COUNTER_COUNT > id) ? counters_table[id] : 0;
+}
+
+void counters_reset(void)
+{
+  for(size_t ii = 0; ii < COUNTER_COUNT; ii++) { counters_table[ii] = 0; }
+}
+
+size_t counters_snapshot(uint8_t* const buffer, const size_t size, const uint32_t uptime_s)
+{
+  if(NULL == buffer || counters_snapshot_size() > size) { return 0; }
+  counters_header_t header = { .counters = COUNTER_COUNT, .reserved = 0, .reserved2 = 0, .uptime_s = uptime_s };
+  memcpy(buffer, &header, sizeof(header));
+  for(size_t ii = 0; ii < COUNTER_COUNT; ii++)
+  {
+    const uint32_t value = counters_table[ii];
+    memcpy(buffer + sizeof(header) + ii * sizeof(value), &value, sizeof(value));
+  }
+  return counters_snapshot_size();
+}
+
+size_t counters_snapshot_size(void)
+{
+  return sizeof(counters_header_t) + COUNTER_COUNT * sizeof(uint32_t);
+}
+
+size_t counters_encode_adv(uint8_t* const buffer, const size_t size)
+{
+  if(NULL == buffer || COUNTERS_ADV_LENGTH > size) { return 0; }
+  buffer[0] = COUNTERS_ADV_FORMAT;
+  for(size_t ii = 0; ii < COUNTER_COUNT; ii++)
+  {
+    const uint32_t value = counters_table[ii];
+    buffer[1 + 2 * ii] = (value >> 8) & 0xFF;
+    buffer[2 + 2 * ii] = value & 0xFF;
+  }
+  return COUNTERS_ADV_LENGTH;
+}
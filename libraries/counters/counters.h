@@ -0,0 +1,76 @@
+#ifndef COUNTERS_H
+#define COUNTERS_H
+/**
+ *  Event counters since boot for fleet telemetry.
+ *
+ *  COUNTER_INC(id) is a single increment of a 32-bit word, cheap enough for every SPI transfer or
+ *  advertisement update. Increment is not atomic: increment interrupted by increment of the same counter
+ *  from a higher priority may be lost, which is acceptable for telemetry. Counters wrap around at UINT32_MAX.
+ *
+ *  Snapshot is a counters_header_t followed by uint32_t of each counter in order of counter_id_t, little endian.
+ *  Advertisement frame is COUNTERS_ADV_FORMAT followed by low 16 bits of each counter, big endian as in Ruuvi
+ *  data formats. Receivers compute differences modulo 2^16 between frames.
+ *
+ *  Plain C, firmware serves counters with counters_handler.c, see README.md.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** Keep order, snapshots and advertisement frames are parsed by index. Add new counters before COUNTER_COUNT. */
+typedef enum{
+  COUNTER_MEASUREMENTS = 0,  // Runs of main sensor task
+  COUNTER_ADV_UPDATES,       // Updates of primary advertisement data
+  COUNTER_ADV_SLOT_SWAPS,    // Interleaved advertisement slots put on air
+  COUNTER_SPI_TRANSACTIONS,  // SPI transfers started
+  COUNTER_SPI_BUSY,          // SPI transfers refused with SPI_RET_BUSY
+  COUNTER_FLASH_WRITES,      // Flash records written or updated
+  COUNTER_FLASH_ERRORS,      // Flash record writes which failed to start or complete
+  COUNTER_NUS_RECEIVED,      // Messages received over NUS
+  COUNTER_NUS_DROPPED,       // Messages refused or overwritten by full NUS transmit queues
+  COUNTER_SD_RESOURCES,      // NUS packets refused by SoftDevice for lack of TX buffers
+  COUNTER_WATCHDOG_FEEDS,
+  COUNTER_COUNT
+}counter_id_t;
+
+#define COUNTERS_ADV_FORMAT      0xF0  // Not used by Ruuvi sensor data formats
+#define COUNTERS_ADV_LENGTH      (1 + 2 * COUNTER_COUNT)
+
+typedef struct __attribute__((packed)){
+  uint8_t  counters;   // COUNTER_COUNT
+  uint8_t  reserved;
+  uint16_t reserved2;
+  uint32_t uptime_s;
+}counters_header_t;
+
+/** Counter table, use through macros */
+extern volatile uint32_t counters_table[COUNTER_COUNT];
+
+#define COUNTER_INC(id)    (counters_table[(id)]++)
+#define COUNTER_ADD(id, n) (counters_table[(id)] += (n))
+
+/** Value of counter, 0 for invalid id */
+uint32_t counters_get(const counter_id_t id);
+
+/** Clear all counters */
+void counters_reset(void);
+
+/**
+ *  Copy header and all counters to buffer.
+ *
+ *  @param uptime_s seconds since boot, stored in header
+ *  @return bytes written, 0 if buffer is too small
+ */
+size_t counters_snapshot(uint8_t* const buffer, const size_t size, const uint32_t uptime_s);
+
+/** Size of snapshot */
+size_t counters_snapshot_size(void);
+
+/**
+ *  Encode advertisement frame to buffer, COUNTERS_ADV_LENGTH bytes.
+ *
+ *  @return bytes written, 0 if buffer is too small
+ */
+size_t counters_encode_adv(uint8_t* const buffer, const size_t size);
+
+#endif
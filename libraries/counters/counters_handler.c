@@ -0,0 +1,60 @@
+#include "counters_handler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "ble_bulk_transfer.h"
+#include "rtc.h"
+
+#define NRF_LOG_MODULE_NAME "COUNTERS"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+/**
+ *  Reply uptime, queue snapshot to NUS. Bulk transfer frees the snapshot after sending.
+ */
+static ret_code_t query_status(const ruuvi_standard_message_t message)
+{
+  ret_code_t err_code = ENDPOINT_SUCCESS;
+  const uint32_t summary[2] = { millis() / 1000, COUNTER_COUNT };
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = COUNTERS,
+                                     .type                 = UINT32,
+                                     .payload              = {0}};
+  memcpy(reply.payload, summary, sizeof(reply.payload));
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler) { err_code |= p_reply_handler(reply); }
+
+  const size_t length = counters_snapshot_size();
+  uint8_t* snapshot = malloc(length);
+  if(NULL == snapshot) { return ENDPOINT_HANDLER_ERROR; }
+  counters_snapshot(snapshot, length, summary[0]);
+  NRF_LOG_INFO("%d measurements, %d SPI transactions, %d NUS dropped, %d SoftDevice out of buffers\r\n",
+               counters_get(COUNTER_MEASUREMENTS), counters_get(COUNTER_SPI_TRANSACTIONS),
+               counters_get(COUNTER_NUS_DROPPED), counters_get(COUNTER_SD_RESOURCES));
+  if(TX_SUCCESS != ble_bulk_transfer_asynchronous(COUNTERS, snapshot, length))
+  {
+    free(snapshot);
+    return ENDPOINT_HANDLER_ERROR;
+  }
+  err_code |= ble_message_queue_process();
+  return err_code;
+}
+
+/**
+ *  Handles incoming messages.
+ */
+ret_code_t counters_handler(const ruuvi_standard_message_t message)
+{
+  //Return if message was not meant for this endpoint.
+  if(COUNTERS != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  switch(message.type)
+  {
+    case STATUS_QUERY:
+      return query_status(message);
+
+    default:
+      return unknown_handler(message);
+  }
+  return ENDPOINT_HANDLER_ERROR; // Should not be reached
+}
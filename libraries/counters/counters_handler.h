@@ -0,0 +1,19 @@
+#ifndef COUNTERS_HANDLER_H
+#define COUNTERS_HANDLER_H
+/**
+ *  Counters over NUS.
+ *
+ *  STATUS_QUERY to COUNTERS endpoint is replied with UINT32 uptime in seconds and number of counters.
+ *  Snapshot of counters_header_t and all counters follows as bulk transfer over NUS.
+ */
+
+#include "counters.h"
+#include "ruuvi_endpoints.h"
+
+/**
+ *  Handle messages with "COUNTERS" as destination endpoint. This should not be called directly, but rather
+ *  through ruuvi_endpoints function route_message.
+ */
+ret_code_t counters_handler(const ruuvi_standard_message_t message);
+
+#endif
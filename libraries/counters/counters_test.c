@@ -0,0 +1,51 @@
+/**
+ *  Host check of counter snapshot and advertisement frame layout.
+ */
+#include "counters.h"
+
+#include <stdio.h>
+#include <string.h>
+
+static int check(const char* name, const int passed)
+{
+  if(!passed) { printf("FAIL %s\n", name); }
+  return passed ? 0 : 1;
+}
+
+int main(void)
+{
+  int failures = 0;
+  counters_reset();
+  for(uint32_t ii = 0; ii < 1000; ii++) { COUNTER_INC(COUNTER_SPI_TRANSACTIONS); }
+  COUNTER_INC(COUNTER_WATCHDOG_FEEDS);
+  COUNTER_ADD(COUNTER_MEASUREMENTS, 0x12345678);
+  failures += check("get", 1000 == counters_get(COUNTER_SPI_TRANSACTIONS) && 1 == counters_get(COUNTER_WATCHDOG_FEEDS) &&
+                           0 == counters_get(COUNTER_FLASH_WRITES) && 0 == counters_get(COUNTER_COUNT));
+
+  uint8_t snapshot[sizeof(counters_header_t) + COUNTER_COUNT * sizeof(uint32_t)];
+  failures += check("snapshot size", sizeof(snapshot) == counters_snapshot_size() &&
+                                     0 == counters_snapshot(snapshot, sizeof(snapshot) - 1, 0) &&
+                                     sizeof(snapshot) == counters_snapshot(snapshot, sizeof(snapshot), 3600));
+  counters_header_t header;
+  uint32_t value;
+  memcpy(&header, snapshot, sizeof(header));
+  memcpy(&value, snapshot + sizeof(header) + COUNTER_SPI_TRANSACTIONS * sizeof(value), sizeof(value));
+  failures += check("snapshot", COUNTER_COUNT == header.counters && 3600 == header.uptime_s && 1000 == value);
+
+  // Advertisement must fit 24 bytes of manufacturer data after company identifier
+  uint8_t adv[24];
+  failures += check("adv size", COUNTERS_ADV_LENGTH <= sizeof(adv) &&
+                                0 == counters_encode_adv(adv, COUNTERS_ADV_LENGTH - 1) &&
+                                COUNTERS_ADV_LENGTH == counters_encode_adv(adv, sizeof(adv)));
+  failures += check("adv", COUNTERS_ADV_FORMAT == adv[0] &&
+                           0x56 == adv[1 + 2 * COUNTER_MEASUREMENTS] && 0x78 == adv[2 + 2 * COUNTER_MEASUREMENTS] &&
+                           0x03 == adv[1 + 2 * COUNTER_SPI_TRANSACTIONS] && 0xE8 == adv[2 + 2 * COUNTER_SPI_TRANSACTIONS]);
+
+  counters_reset();
+  failures += check("reset", 0 == counters_get(COUNTER_SPI_TRANSACTIONS));
+
+  printf("%u counters, snapshot %zu bytes, advertisement %u bytes\n", (unsigned)COUNTER_COUNT, counters_snapshot_size(),
+         (unsigned)COUNTERS_ADV_LENGTH);
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+#include "average.h"
+
+void dsp_process_average(ringbuffer_t* values, const uint8_t parameter, const float next)
+{
+  //Only push latest sample to buffer
+  ringbuffer_push(values, (void*)&next);
+}
+
+float dsp_read_average(ringbuffer_t* values, const uint8_t parameter)
+{
+  // Average over stored samples, buffer holds up to parameter samples
+  size_t count = ringbuffer_get_count(values);
+  if(0 == count) { return 0.0f; }
+  float sum = 0.0f;
+  for(size_t ii = 0; ii < count; ii++)
+  {
+    float value;
+    ringbuffer_peek_at(values, ii, &value);
+    sum += value;
+  }
+  return sum / count;
+}
@@ -0,0 +1,9 @@
+#ifndef AVERAGE_H
+#define AVERAGE_H
+
+#include "dsp.h"
+
+void dsp_process_average(ringbuffer_t* values, const uint8_t parameter, const float next);
+float dsp_read_average(ringbuffer_t* values, const uint8_t parameter);
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ *  Host accuracy report and benchmark of fixed-point FFT spectrum features.
+ *
+ *  Compares Q15 real FFT against double precision DFT, then analyses synthetic tones with offset
+ *  and noise at 64, 128 and 256 points sampled at 100 and 400 Hz. Reports frequency, amplitude and
+ *  band RMS errors, time and memory per block.
+ */
+#include "fft.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() __rdtsc()
+#else
+#define CYCLES() 0ULL
+#endif
+
+#define ROUNDS          20000
+#define OFFSET          1000    // Gravity on analysed axis, mg
+#define NOISE           4       // Uniform noise, +- mg
+#define FFT_ERROR_MAX   3       // LSB of DFT / N
+#define FREQUENCY_MAX   0.05    // bins
+#define AMPLITUDE_MAX   0.03    // relative, 50 mg tones are limited by 1 mg resolution and noise
+#define RMS_MAX         0.03    // relative
+
+static double seconds(const struct timespec* start, const struct timespec* end)
+{
+  return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static double uniform(void)
+{
+  return (double)rand() / RAND_MAX;
+}
+
+/** Maximum error of Q15 FFT against DFT / N of random input within documented range */
+static int check_fft(const size_t points)
+{
+  int16_t data[DSP_FFT_MAX_POINTS];
+  double input[DSP_FFT_MAX_POINTS];
+  double max_error = 0;
+  for(int round = 0; round < 20; round++)
+  {
+    for(size_t ii = 0; ii < points; ii++)
+    {
+      data[ii] = (int16_t)((uniform() * 2 - 1) * 8191);
+      input[ii] = data[ii];
+    }
+    dsp_fft_real_q15(data, points);
+    for(size_t kk = 0; kk <= points / 2; kk++)
+    {
+      double re = 0, im = 0;
+      for(size_t nn = 0; nn < points; nn++)
+      {
+        re += input[nn] * cos(2 * M_PI * kk * nn / points);
+        im -= input[nn] * sin(2 * M_PI * kk * nn / points);
+      }
+      re /= points; im /= points;
+      double error;
+      if(0 == kk)               { error = fabs(data[0] - re); }
+      else if(points / 2 == kk) { error = fabs(data[1] - re); }
+      else { error = fmax(fabs(data[2 * kk] - re), fabs(data[2 * kk + 1] - im)); }
+      if(error > max_error) { max_error = error; }
+    }
+  }
+  printf("FFT %3zu points: max error against DFT / N %.2f LSB\n", points, max_error);
+  return max_error > FFT_ERROR_MAX;
+}
+
+/** Analyse tones over band, return number of failures */
+static int check_tones(const size_t points, const float sample_rate)
+{
+  int16_t samples[DSP_FFT_MAX_POINTS];
+  const float band_edges[DSP_FFT_BANDS + 1] = {0, sample_rate / 4, sample_rate / 2};
+  const double bin = sample_rate / points;
+  const double amplitudes[] = {50, 500, 5000};
+  double max_frequency = 0, max_amplitude = 0, max_rms = 0;
+  for(size_t aa = 0; aa < sizeof(amplitudes) / sizeof(amplitudes[0]); aa++)
+  {
+    // Frequencies between bins, away from DC and Nyquist, not on band edge
+    for(double frequency = 3.3 * bin; frequency < sample_rate / 2 - 3 * bin; frequency += 2.37 * bin)
+    {
+      if(fabs(frequency - sample_rate / 4) < 2 * bin) { continue; }
+      const double phase = uniform() * 2 * M_PI;
+      for(size_t nn = 0; nn < points; nn++)
+      {
+        const double tone = amplitudes[aa] * sin(2 * M_PI * frequency * nn / sample_rate + phase);
+        samples[nn] = (int16_t)lround(OFFSET + tone + (uniform() * 2 - 1) * NOISE);
+      }
+      const double rms = amplitudes[aa] / sqrt(2);
+      dsp_fft_features_t features;
+      dsp_fft_analyse(samples, points, sample_rate, band_edges, &features);
+      const size_t band = (frequency < sample_rate / 4) ? 0 : 1;
+      const double frequency_error = fabs(features.peak_frequency - frequency) / bin;
+      const double amplitude_error = fabs(features.peak_amplitude - amplitudes[aa]) / amplitudes[aa];
+      const double rms_error = fabs(features.band_rms[band] - rms) / rms;
+      if(frequency_error > max_frequency) { max_frequency = frequency_error; }
+      if(amplitude_error > max_amplitude) { max_amplitude = amplitude_error; }
+      if(rms_error > max_rms) { max_rms = rms_error; }
+    }
+  }
+  printf("%3zu points at %3.0f Hz, bin %5.2f Hz: max error frequency %.3f bins, amplitude %5.2f %%, band RMS %5.2f %%\n",
+         points, sample_rate, bin, max_frequency, 100 * max_amplitude, 100 * max_rms);
+  return (max_frequency > FREQUENCY_MAX) + (max_amplitude > AMPLITUDE_MAX) + (max_rms > RMS_MAX);
+}
+
+/** Time analysis of one block, input is restored each round as analysis works in place */
+static void benchmark(const size_t points)
+{
+  int16_t block[DSP_FFT_MAX_POINTS];
+  int16_t work[DSP_FFT_MAX_POINTS];
+  const float band_edges[DSP_FFT_BANDS + 1] = {0, 25, 50};
+  for(size_t nn = 0; nn < points; nn++)
+  {
+    block[nn] = (int16_t)lround(OFFSET + 300 * sin(2 * M_PI * 13.7 * nn / points));
+  }
+  dsp_fft_features_t features;
+  volatile float sink = 0;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  unsigned long long cycles = CYCLES();
+  for(int round = 0; round < ROUNDS; round++)
+  {
+    memcpy(work, block, points * sizeof(int16_t));
+    dsp_fft_analyse(work, points, 100, band_edges, &features);
+    sink += features.peak_frequency;
+  }
+  cycles = CYCLES() - cycles;
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  (void)sink;
+  printf("%3zu points: %7.0f ns, %7.0f host cycles per block; ring buffer %4zu B\n",
+         points, 1e9 * seconds(&start, &end) / ROUNDS, (double)cycles / ROUNDS, points * sizeof(int16_t));
+}
+
+int main(void)
+{
+  int failures = 0;
+  const size_t sizes[] = {64, 128, 256};
+  const float rates[] = {100, 400};
+  srand(1);
+
+  for(size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++) { failures += check_fft(sizes[ii]); }
+  for(size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++)
+  {
+    for(size_t jj = 0; jj < sizeof(rates) / sizeof(rates[0]); jj++) { failures += check_tones(sizes[ii], rates[jj]); }
+  }
+  for(size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ii++) { benchmark(sizes[ii]); }
+  printf("Twiddle table %zu B, shared work buffer %zu B\n", (size_t)(65 * sizeof(int16_t)),
+         (size_t)(DSP_FFT_MAX_POINTS * sizeof(int16_t)));
+
+  printf("%s\n", failures ? "FAILED" : "OK");
+  return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
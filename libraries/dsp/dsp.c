@@ -1,5 +1,7 @@
 #include "dsp.h"
 #include "stdev.h"
+#include "average.h"
+#include "spectrum.h"
 #include "ruuvi_endpoints.h"
 #include "ringbuffer.h"
 
@@ -21,6 +23,25 @@ dsp_filter_t dsp_init(ruuvi_dsp_function_t type, uint8_t dsp_parameter)
       filter.dsp_parameter = dsp_parameter;
       ringbuffer_init(&filter.z, dsp_parameter, sizeof(float));
       break;
+
+    case DSP_AVERAGE:
+      filter.process = dsp_process_average;
+      filter.read = dsp_read_average;
+      filter.dsp_parameter = dsp_parameter;
+      ringbuffer_init(&filter.z, dsp_parameter, sizeof(float));
+      break;
+
+    case DSP_FFT:
+      if(DSP_FFT_MIN_LOG2 > dsp_parameter || DSP_FFT_MAX_LOG2 < dsp_parameter)
+      {
+        NRF_LOG_ERROR("Invalid FFT size\r\n");
+        break;
+      }
+      filter.process = dsp_process_fft;
+      filter.read = dsp_read_fft;
+      filter.dsp_parameter = dsp_parameter;
+      ringbuffer_init(&filter.z, 1 << dsp_parameter, sizeof(int16_t));
+      break;
     
     default:
       NRF_LOG_ERROR("Unknown filter type\r\n");
@@ -0,0 +1,205 @@
+#include "fft.h"
+#include <math.h>
+#include <string.h>
+
+// Angles are given as index of 1/256 turn
+#define TURN          256
+#define QUARTER_TURN  64
+// Input is normalised to below 2^13, so that even + j odd stays below 2^13.5
+#define NORMALISED_BITS 13
+// Products and halving are rounded to nearest, truncation would bias every stage by half LSB
+#define Q15_HALF (1 << 14)
+// Window power gain of Hann is 3/8, one-sided spectrum is half of power: RMS^2 = 16/3 * sum |X / N|^2
+#define HANN_RMS_GAIN (16.0f / 3.0f)
+// Amplitude of sinusoid at bin centre is 1/4 of DFT / N with Hann window
+#define HANN_AMPLITUDE_GAIN 4.0f
+
+/** sin(2 pi i / 256) * 32767 for i = 0 ... 64 */
+static const int16_t sin_q15[QUARTER_TURN + 1] = {
+      0,   804,  1608,  2410,  3212,  4011,  4808,  5602,
+   6393,  7179,  7962,  8739,  9512, 10278, 11039, 11793,
+  12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+  18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+  23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+  27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+  30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+  32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+  32767
+};
+
+static int32_t sin_lookup(uint32_t angle)
+{
+  angle %= TURN;
+  if(angle <= QUARTER_TURN)     { return sin_q15[angle]; }
+  if(angle <= 2 * QUARTER_TURN) { return sin_q15[2 * QUARTER_TURN - angle]; }
+  if(angle <= 3 * QUARTER_TURN) { return -sin_q15[angle - 2 * QUARTER_TURN]; }
+  return -sin_q15[TURN - angle];
+}
+
+static int32_t cos_lookup(uint32_t angle)
+{
+  return sin_lookup(angle + QUARTER_TURN);
+}
+
+static bool valid_points(const size_t points)
+{
+  return points >= (1 << DSP_FFT_MIN_LOG2) && points <= DSP_FFT_MAX_POINTS && 0 == (points & (points - 1));
+}
+
+/** In-place radix-2 decimation in time FFT of m complex Q15 values, halved at each stage */
+static void fft_complex_q15(int16_t* const data, const size_t m)
+{
+  // Bit reversal
+  for(size_t ii = 1, jj = 0; ii < m; ii++)
+  {
+    size_t bit = m >> 1;
+    for(; jj & bit; bit >>= 1) { jj ^= bit; }
+    jj ^= bit;
+    if(ii < jj)
+    {
+      int16_t swap;
+      swap = data[2 * ii];     data[2 * ii] = data[2 * jj];         data[2 * jj] = swap;
+      swap = data[2 * ii + 1]; data[2 * ii + 1] = data[2 * jj + 1]; data[2 * jj + 1] = swap;
+    }
+  }
+
+  for(size_t span = 1; span < m; span <<= 1)
+  {
+    const uint32_t step = TURN / (2 * span);
+    for(size_t kk = 0; kk < span; kk++)
+    {
+      // W = exp(-j 2 pi k / (2 span))
+      const int32_t wr = cos_lookup(kk * step);
+      const int32_t wi = -sin_lookup(kk * step);
+      for(size_t ii = kk; ii < m; ii += 2 * span)
+      {
+        const size_t jj = ii + span;
+        const int32_t tr = (wr * data[2 * jj] - wi * data[2 * jj + 1] + Q15_HALF) >> 15;
+        const int32_t ti = (wr * data[2 * jj + 1] + wi * data[2 * jj] + Q15_HALF) >> 15;
+        const int32_t ur = data[2 * ii];
+        const int32_t ui = data[2 * ii + 1];
+        data[2 * ii]     = (int16_t)((ur + tr + 1) >> 1);
+        data[2 * ii + 1] = (int16_t)((ui + ti + 1) >> 1);
+        data[2 * jj]     = (int16_t)((ur - tr + 1) >> 1);
+        data[2 * jj + 1] = (int16_t)((ui - ti + 1) >> 1);
+      }
+    }
+  }
+}
+
+/** Bin k of real spectrum from Z[k] and conj(Z[m - k]): X = (E - j W^k O) / 4, E = A + B, O = A - B */
+static void split_bin(const int32_t ar, const int32_t ai, const int32_t br, const int32_t bi,
+                      const uint32_t angle, int16_t* const xr, int16_t* const xi)
+{
+  const int32_t even_r = ar + br, even_i = ai + bi;
+  const int32_t odd_r = ar - br, odd_i = ai - bi;
+  const int32_t c = cos_lookup(angle);
+  const int32_t s = sin_lookup(angle);
+  // -j W^k O = (-s Or + c Oi) + j (-s Oi - c Or)
+  *xr = (int16_t)((even_r + ((-s * odd_r + c * odd_i + Q15_HALF) >> 15) + 2) >> 2);
+  *xi = (int16_t)((even_i + ((-s * odd_i - c * odd_r + Q15_HALF) >> 15) + 2) >> 2);
+}
+
+void dsp_fft_real_q15(int16_t* const data, const size_t points)
+{
+  if(NULL == data || !valid_points(points)) { return; }
+  const size_t m = points / 2;
+  const uint32_t step = TURN / points;
+  // Even samples are real part, odd samples imaginary part of m point complex FFT
+  fft_complex_q15(data, m);
+
+  const int32_t z0r = data[0], z0i = data[1];
+  data[0] = (int16_t)((z0r + z0i + 1) >> 1); // DC
+  data[1] = (int16_t)((z0r - z0i + 1) >> 1); // Nyquist
+  for(size_t kk = 1; kk <= m / 2; kk++)
+  {
+    const size_t mk = m - kk;
+    const int32_t ar = data[2 * kk], ai = data[2 * kk + 1];
+    const int32_t br = data[2 * mk], bi = data[2 * mk + 1];
+    split_bin(ar, ai, br, -bi, kk * step, &data[2 * kk], &data[2 * kk + 1]);
+    if(mk != kk) { split_bin(br, bi, ar, -ai, mk * step, &data[2 * mk], &data[2 * mk + 1]); }
+  }
+}
+
+/** Hann window response at offset delta bins from bin centre, 1 at centre */
+static float hann_response(const float delta)
+{
+  if(fabsf(delta) < 1e-6f) { return 1.0f; }
+  const float x = (float)M_PI * delta;
+  return (sinf(x) / x) / (1.0f - delta * delta);
+}
+
+bool dsp_fft_analyse(int16_t* const samples, const size_t points, const float sample_rate,
+                     const float band_edges[DSP_FFT_BANDS + 1], dsp_fft_features_t* const features)
+{
+  if(NULL == samples || NULL == band_edges || NULL == features || !valid_points(points)) { return false; }
+  memset(features, 0, sizeof(dsp_fft_features_t));
+
+  // Remove mean and normalise with a power of two
+  int32_t sum = 0;
+  for(size_t ii = 0; ii < points; ii++) { sum += samples[ii]; }
+  const int32_t mean = sum / (int32_t)points;
+  uint32_t max = 0;
+  for(size_t ii = 0; ii < points; ii++)
+  {
+    const int32_t value = samples[ii] - mean;
+    const uint32_t magnitude = (value < 0) ? -value : value;
+    if(magnitude > max) { max = magnitude; }
+  }
+  if(0 == max) { return true; }
+  int shift = NORMALISED_BITS;
+  while(max) { max >>= 1; shift--; }
+
+  // Window, w = (1 - cos) / 2
+  const uint32_t step = TURN / points;
+  for(size_t ii = 0; ii < points; ii++)
+  {
+    int32_t value = samples[ii] - mean;
+    value = (shift >= 0) ? (value << shift) : (value >> -shift);
+    const int32_t window = (32767 - cos_lookup(ii * step)) >> 1;
+    samples[ii] = (int16_t)((value * window + Q15_HALF) >> 15);
+  }
+
+  dsp_fft_real_q15(samples, points);
+
+  // Peak, DC and Nyquist excluded
+  const size_t bins = points / 2;
+  size_t peak = 1;
+  uint32_t peak_power = 0;
+  uint64_t band_power[DSP_FFT_BANDS] = {0};
+  const float bin_width = sample_rate / points;
+  for(size_t kk = 1; kk < bins; kk++)
+  {
+    const int32_t re = samples[2 * kk], im = samples[2 * kk + 1];
+    const uint32_t power = (uint32_t)(re * re) + (uint32_t)(im * im);
+    if(power > peak_power) { peak_power = power; peak = kk; }
+    const float frequency = kk * bin_width;
+    for(size_t band = 0; band < DSP_FFT_BANDS; band++)
+    {
+      if(frequency >= band_edges[band] && frequency < band_edges[band + 1]) { band_power[band] += power; }
+    }
+  }
+
+  // Interpolate between peak and larger neighbour, exact for Hann: delta = (2a - 1) / (a + 1)
+  const float scale = ldexpf(1.0f, -shift);
+  const float m0 = sqrtf((float)peak_power);
+  float delta = 0.0f;
+  if(m0 > 0.0f && peak > 1 && peak < bins - 1)
+  {
+    const int32_t lr = samples[2 * (peak - 1)], li = samples[2 * (peak - 1) + 1];
+    const int32_t rr = samples[2 * (peak + 1)], ri = samples[2 * (peak + 1) + 1];
+    const float left  = sqrtf((float)lr * lr + (float)li * li);
+    const float right = sqrtf((float)rr * rr + (float)ri * ri);
+    const float ratio = (right > left) ? right / m0 : left / m0;
+    delta = (2.0f * ratio - 1.0f) / (ratio + 1.0f);
+    if(delta < 0.0f) { delta = 0.0f; }
+    if(right <= left) { delta = -delta; }
+  }
+  features->peak_frequency = (peak + delta) * bin_width;
+  features->peak_amplitude = HANN_AMPLITUDE_GAIN * m0 / hann_response(delta) * scale;
+  for(size_t band = 0; band < DSP_FFT_BANDS; band++)
+  {
+    features->band_rms[band] = sqrtf(HANN_RMS_GAIN * (float)band_power[band]) * scale;
+  }
+  return true;
+}
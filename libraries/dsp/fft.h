@@ -0,0 +1,52 @@
+#ifndef FFT_H
+#define FFT_H
+/*
+ * Fixed-point real FFT and vibration spectrum features.
+ *
+ * Block of N real samples, N = 16 ... 256, is analysed as follows:
+ *  1. Mean is removed and block is normalised to 13 bits with a power of two, block floating point.
+ *  2. Hann window.
+ *  3. N / 2 point complex Q15 FFT of even and odd samples, halved at every stage so it cannot overflow,
+ *     then split to N / 2 bins of real spectrum. Result is DFT / N.
+ *  4. Peak bin with interpolation exact for Hann window, amplitude corrected for scalloping loss.
+ *     Band RMS from sum of bin powers, corrected for window power gain 3 / 8.
+ *
+ * Plain C without SDK dependencies so that accuracy and speed can be checked on host, see benchmark/.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DSP_FFT_MIN_LOG2   4
+#define DSP_FFT_MAX_LOG2   8
+#define DSP_FFT_MAX_POINTS (1 << DSP_FFT_MAX_LOG2)
+#define DSP_FFT_BANDS      2
+
+/** Spectrum features of a block */
+typedef struct{
+  float peak_frequency;          // Frequency of strongest bin, interpolated, Hz
+  float peak_amplitude;          // Amplitude of sinusoid at peak, input units
+  float band_rms[DSP_FFT_BANDS]; // RMS of frequencies in bands, input units
+}dsp_fft_features_t;
+
+/**
+ *  In-place real FFT of Q15 data, points is power of two between 2^DSP_FFT_MIN_LOG2 and 2^DSP_FFT_MAX_LOG2.
+ *  Output is points / 2 complex bins as re, im pairs, scaled by 1 / points.
+ *  Nyquist bin is real and stored in imaginary part of DC bin.
+ *  Input magnitude must be below 2^13.5 for complex pairs to stay within int16.
+ */
+void dsp_fft_real_q15(int16_t* const data, const size_t points);
+
+/**
+ *  Compute spectrum features of samples. Samples are used as work buffer and overwritten.
+ *
+ *  @param sample_rate Sample rate of block, Hz
+ *  @param band_edges  DSP_FFT_BANDS + 1 edges in Hz, band i is [band_edges[i], band_edges[i + 1])
+ *
+ *  @return false if points is not supported
+ */
+bool dsp_fft_analyse(int16_t* const samples, const size_t points, const float sample_rate,
+                     const float band_edges[DSP_FFT_BANDS + 1], dsp_fft_features_t* const features);
+
+#endif
@@ -0,0 +1,33 @@
+#include "spectrum.h"
+
+// Shared work buffer, FFT is computed in place. Reads run in scheduler context one at a time.
+static int16_t m_work[DSP_FFT_MAX_POINTS];
+
+void dsp_process_fft(ringbuffer_t* values, const uint8_t parameter, const float next)
+{
+  //Store samples as int16 to fit 256 samples in 512 bytes
+  int16_t sample = (next > INT16_MAX) ? INT16_MAX : (next < INT16_MIN) ? INT16_MIN : (int16_t)next;
+  ringbuffer_push(values, &sample);
+}
+
+bool dsp_read_fft_features(ringbuffer_t* values, const uint8_t parameter, const float sample_rate,
+                           const float band_edges[DSP_FFT_BANDS + 1], dsp_fft_features_t* features)
+{
+  const size_t points = 1 << parameter;
+  if(parameter > DSP_FFT_MAX_LOG2 || ringbuffer_get_count(values) < points) { return false; }
+  for(size_t ii = 0; ii < points; ii++)
+  {
+    ringbuffer_peek_at(values, ii, &(m_work[ii]));
+  }
+  return dsp_fft_analyse(m_work, points, sample_rate, band_edges, features);
+}
+
+float dsp_read_fft(ringbuffer_t* values, const uint8_t parameter)
+{
+  // Sample rate of points gives frequencies in bins
+  const float points = (float)(1 << parameter);
+  const float band_edges[DSP_FFT_BANDS + 1] = {0.0f, points / 4, points / 2};
+  dsp_fft_features_t features;
+  if(!dsp_read_fft_features(values, parameter, points, band_edges, &features)) { return 0.0f; }
+  return features.peak_frequency;
+}
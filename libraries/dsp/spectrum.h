@@ -0,0 +1,23 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include "dsp.h"
+#include "fft.h"
+
+/** DSP_FFT: buffer holds 2^parameter int16 samples. **/
+void dsp_process_fft(ringbuffer_t* values, const uint8_t parameter, const float next);
+
+/** Peak frequency in bins, multiply by sample rate / 2^parameter for Hz. 0 until buffer is full. **/
+float dsp_read_fft(ringbuffer_t* values, const uint8_t parameter);
+
+/**
+ *  Spectrum features of buffered samples.
+ *
+ *  @param sample_rate of samples in Hz
+ *  @param band_edges  DSP_FFT_BANDS + 1 edges in Hz
+ *  @return false if buffer is not full yet.
+ */
+bool dsp_read_fft_features(ringbuffer_t* values, const uint8_t parameter, const float sample_rate,
+                           const float band_edges[DSP_FFT_BANDS + 1], dsp_fft_features_t* features);
+
+#endif
@@ -0,0 +1,114 @@
+#include "energy_model.h"
+
+#include <string.h>
+
+/**
+ *  Defaults from datasheets, see comments. Verify with a power profiler before relying on
+ *  absolute numbers, relative differences between modes are more reliable.
+ */
+const energy_constants_t energy_default_constants =
+{
+  .tx_event_nc         = 6000.0f,   // 3 x radio ramp-up 140 us and SoftDevice processing
+  .tx_byte_nc          = 60.0f,     // 8 us per byte at 1 Mbps, 7.5 mA TX at +4 dBm with DC/DC
+  .cpu_active_ua       = 3700.0f,   // 64 MHz from flash with cache and DC/DC
+  .cpu_wakeup_nc       = 50.0f,     // HFCLK start and wakeup from System ON
+  .spi_transaction_nc  = 40.0f,     // 20 us of SPIM start and stop, chip select
+  .spi_byte_nc         = 4.0f,      // 1 us per byte at 8 MHz
+  .bme280_measure_ua   = 450.0f,    // 3.6 uA at 1 Hz with 1x oversampling, 8 ms typical conversion
+  .saadc_sample_nc     = 120.0f,    // 8x oversampled burst of 10 us acquisition and 2 us conversion, HFCLK running
+  .flash_word_nc       = 200.0f,    // 41 us per word
+  .flash_page_erase_nc = 340000.0f, // 85 ms per page
+  .sleep_ua            = 2.0f,      // System ON, RTC, RAM retention, BME280 in sleep or standby
+  .lis2dh12_ua         = 4.0f       // Normal mode at 10 Hz
+};
+
+void energy_model_init(energy_model_t* model, const energy_constants_t* constants)
+{
+  memset(&model->counters, 0, sizeof(model->counters));
+  model->constants = (NULL == constants) ? energy_default_constants : *constants;
+}
+
+void energy_count_tx(energy_model_t* model, uint32_t bytes_on_air)
+{
+  model->counters.tx_events++;
+  model->counters.tx_bytes += 3 * bytes_on_air;
+}
+
+void energy_count_cpu(energy_model_t* model, uint8_t task, uint32_t active_us)
+{
+  if(ENERGY_MODEL_MAX_TASKS <= task) { task = ENERGY_MODEL_MAX_TASKS - 1; }
+  model->counters.cpu_wakeups++;
+  model->counters.task_calls[task]++;
+  model->counters.cpu_us[task] += active_us;
+}
+
+void energy_count_spi(energy_model_t* model, energy_spi_device_t device, uint32_t bytes)
+{
+  if(ENERGY_SPI_DEVICES <= device) { return; }
+  model->counters.spi_transactions[device]++;
+  model->counters.spi_bytes[device] += bytes;
+}
+
+/**
+ *  Typical conversion time: 1 ms + 2 ms per temperature sample + 2 ms per pressure sample + 0.5 ms
+ *  + 2 ms per humidity sample + 0.5 ms. Skipped measurements take no time.
+ */
+uint32_t energy_bme280_measurement_time_us(uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h)
+{
+  uint32_t time = 1000 + 2000 * osrs_t;
+  if(osrs_p) { time += 2000 * osrs_p + 500; }
+  if(osrs_h) { time += 2000 * osrs_h + 500; }
+  return time;
+}
+
+void energy_count_bme280_conversion(energy_model_t* model, uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h)
+{
+  model->counters.bme280_conversions++;
+  model->counters.bme280_measure_us += energy_bme280_measurement_time_us(osrs_t, osrs_p, osrs_h);
+}
+
+void energy_count_saadc(energy_model_t* model)
+{
+  model->counters.saadc_samples++;
+}
+
+void energy_count_flash(energy_model_t* model, uint32_t words, uint32_t page_erases)
+{
+  model->counters.flash_words += words;
+  model->counters.flash_page_erases += page_erases;
+}
+
+double energy_model_average_ua(const energy_model_t* model, uint64_t elapsed_us, energy_breakdown_t* breakdown)
+{
+  const energy_constants_t* k = &model->constants;
+  const energy_counters_t*  c = &model->counters;
+  energy_breakdown_t b;
+  memset(&b, 0, sizeof(b));
+  if(0 == elapsed_us) { return 0; }
+
+  b.tx_nc = (double)c->tx_events * k->tx_event_nc + (double)c->tx_bytes * k->tx_byte_nc;
+  b.cpu_nc = (double)c->cpu_wakeups * k->cpu_wakeup_nc;
+  for(int ii = 0; ii < ENERGY_MODEL_MAX_TASKS; ii++)
+  {
+    b.cpu_nc += (double)c->cpu_us[ii] * k->cpu_active_ua / 1000.0;
+  }
+  for(int ii = 0; ii < ENERGY_SPI_DEVICES; ii++)
+  {
+    b.spi_nc += (double)c->spi_transactions[ii] * k->spi_transaction_nc + (double)c->spi_bytes[ii] * k->spi_byte_nc;
+  }
+  b.bme280_nc = (double)c->bme280_measure_us * k->bme280_measure_ua / 1000.0;
+  b.saadc_nc  = (double)c->saadc_samples * k->saadc_sample_nc;
+  b.flash_nc  = (double)c->flash_words * k->flash_word_nc + (double)c->flash_page_erases * k->flash_page_erase_nc;
+  b.static_nc = (double)elapsed_us * (k->sleep_ua + k->lis2dh12_ua) / 1000.0;
+  b.total_nc  = b.tx_nc + b.cpu_nc + b.spi_nc + b.bme280_nc + b.saadc_nc + b.flash_nc + b.static_nc;
+
+  if(NULL != breakdown) { *breakdown = b; }
+  // nC / us = mA, * 1000 = uA
+  return b.total_nc * 1000.0 / (double)elapsed_us;
+}
+
+double energy_battery_life_days(double average_ua, double capacity_mah)
+{
+  if(0 >= average_ua) { return 0; }
+  return capacity_mah * 1000.0 / average_ua / 24.0;
+}
@@ -0,0 +1,117 @@
+#ifndef ENERGY_MODEL_H
+#define ENERGY_MODEL_H
+
+/**
+ *  Energy accounting model of RuuviTag. Events are counted as they happen and converted into charge
+ *  with per-event constants, which can be calibrated against power profiler measurements.
+ *  Has no SDK dependencies so that it can be fed by firmware or by a host simulation.
+ *
+ *  Units: charge in nanocoulombs (nC), current in microamperes (uA), time in microseconds (us).
+ *  1 uA for 1 us is 1 pC, so charge of a current is uA * us / 1000 nC.
+ */
+
+#include <stdint.h>
+
+#define ENERGY_MODEL_MAX_TASKS 8
+
+typedef enum
+{
+  ENERGY_SPI_BME280 = 0,
+  ENERGY_SPI_LIS2DH12,
+  ENERGY_SPI_DEVICES
+}energy_spi_device_t;
+
+/** Charge of each event, calibrate against measurements */
+typedef struct
+{
+  float tx_event_nc;            // Fixed charge of one advertising event on 3 channels, radio ramp-up and SoftDevice
+  float tx_byte_nc;             // Charge of one byte on air on one channel
+  float cpu_active_ua;          // Current of CPU running from flash
+  float cpu_wakeup_nc;          // Charge of waking up from System ON sleep
+  float spi_transaction_nc;     // Chip select, SPIM start and stop
+  float spi_byte_nc;            // Charge of one byte transferred
+  float bme280_measure_ua;      // Current of BME280 while converting
+  float saadc_sample_nc;        // Battery measurement
+  float flash_word_nc;          // Write of one 32-bit word
+  float flash_page_erase_nc;    // Erase of one 4 kB page
+  float sleep_ua;               // System ON sleep with RTC, sensors in sleep
+  float lis2dh12_ua;            // Accelerometer current at configured sample rate
+}energy_constants_t;
+
+/** Counted events */
+typedef struct
+{
+  uint32_t tx_events;
+  uint64_t tx_bytes;                               // Bytes on air, summed over channels
+  uint32_t cpu_wakeups;
+  uint64_t cpu_us[ENERGY_MODEL_MAX_TASKS];         // CPU active time per task
+  uint32_t task_calls[ENERGY_MODEL_MAX_TASKS];
+  uint32_t spi_transactions[ENERGY_SPI_DEVICES];
+  uint64_t spi_bytes[ENERGY_SPI_DEVICES];
+  uint32_t bme280_conversions;
+  uint64_t bme280_measure_us;                      // Conversion time, depends on oversampling
+  uint32_t saadc_samples;
+  uint32_t flash_words;
+  uint32_t flash_page_erases;
+}energy_counters_t;
+
+/** Charge consumed by each part of the system */
+typedef struct
+{
+  double tx_nc;
+  double cpu_nc;
+  double spi_nc;
+  double bme280_nc;
+  double saadc_nc;
+  double flash_nc;
+  double static_nc;    // Sleep and accelerometer
+  double total_nc;
+}energy_breakdown_t;
+
+typedef struct
+{
+  energy_constants_t constants;
+  energy_counters_t  counters;
+}energy_model_t;
+
+/** Datasheet-based default constants for nRF52832 with DC/DC at +4 dBm, BME280 and LIS2DH12 at 10 Hz */
+extern const energy_constants_t energy_default_constants;
+
+/** Clear counters and set constants. NULL uses energy_default_constants */
+void energy_model_init(energy_model_t* model, const energy_constants_t* constants);
+
+/** Count advertising event with given number of bytes on air per channel, sent on 3 channels */
+void energy_count_tx(energy_model_t* model, uint32_t bytes_on_air);
+
+/** Count CPU wakeup and active time of task. Tasks are numbered by caller, 0 ... ENERGY_MODEL_MAX_TASKS - 1 */
+void energy_count_cpu(energy_model_t* model, uint8_t task, uint32_t active_us);
+
+/** Count SPI transaction of given length to device */
+void energy_count_spi(energy_model_t* model, energy_spi_device_t device, uint32_t bytes);
+
+/**
+ *  Count BME280 conversion. Oversampling is given as number of samples, 1, 2, 4, 8 or 16, and 0 if
+ *  measurement is skipped.
+ */
+void energy_count_bme280_conversion(energy_model_t* model, uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h);
+
+/** Typical BME280 conversion time in microseconds as per datasheet appendix B */
+uint32_t energy_bme280_measurement_time_us(uint8_t osrs_t, uint8_t osrs_p, uint8_t osrs_h);
+
+/** Count battery measurement */
+void energy_count_saadc(energy_model_t* model);
+
+/** Count flash write of given number of words and page erases */
+void energy_count_flash(energy_model_t* model, uint32_t words, uint32_t page_erases);
+
+/**
+ *  Compute charge consumed over elapsed time.
+ *  @param breakdown charge of each part, may be NULL
+ *  @return average current in uA
+ */
+double energy_model_average_ua(const energy_model_t* model, uint64_t elapsed_us, energy_breakdown_t* breakdown);
+
+/** Battery life in days with given average current and battery capacity in mAh */
+double energy_battery_life_days(double average_ua, double capacity_mah);
+
+#endif
@@ -0,0 +1,287 @@
+/**
+ *  Host simulation of the main loop of ruuvi_firmware. Replays timers, advertising, sensor
+ *  reads and battery measurements of each mode into the energy model and prints projected
+ *  average current and battery life.
+ *
+ *  This is a static estimate, not a run of main.c: the sequence of events per main loop and
+ *  CPU time of tasks are written here. BME280 driver runs against the fake sensor of
+ *  drivers/bme280/test, its SPI transfers are counted as issued. LIS2DH12 reads are counted
+ *  as in main_sensor_task.
+ *
+ *  Intervals and sensor settings are taken from bluetooth_application_config.h and
+ *  application_config.h of the firmware.
+ *
+ *  Usage: energy_simulation [simulated hours]
+ */
+#include "energy_model.h"
+#include "bluetooth_application_config.h"
+#include "application_config.h"
+#include "bme280.h"
+#include "bme280_fake.h"
+#include "bme280_governor.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BATTERY_CAPACITY_MAH         1000.0  // CR2477
+#define MAX_ADVERTISING_DELAY_US     10000u  // Random delay added to each advertising event
+#define MODE_RECORD_WORDS            4       // FDS record header and tag mode, written by store_mode
+
+// CPU time estimates of tasks, microseconds
+#define TASK_SENSOR                  0
+#define TASK_RADIO_IRQ               1
+#define TASK_TIMER_IRQ               2
+#define TASK_BATTERY                 3
+#define SENSOR_TASK_US               1200    // SPI waits, encoding and ble_advdata_set
+#define RADIO_IRQ_US                 15
+#define TIMER_IRQ_US                 30
+#define BATTERY_US                   15      // Start sample in radio interrupt, filter in SAADC interrupt
+
+static const char* task_names[] = { "sensor", "radio irq", "timer irq", "battery" };
+
+typedef struct
+{
+  const char* name;
+  uint32_t main_loop_ms;
+  uint32_t advertising_ms;
+  uint32_t payload_length;
+  uint8_t  lis2dh12_rate;      // Sample rate while moving, LIS2DH12_RATE_*
+  bool     lis2dh12_gated;     // Wake-on-motion idles accelerometer while still
+}simulated_mode_t;
+
+// Wake-on-motion in RAWv2 modes, orientation events which also disable it are not modelled.
+#define MOTION_GATED (LIS2DH12_MOTION_ENABLED && !LIS2DH12_CAPTURE_ENABLED)
+
+static const simulated_mode_t modes[] =
+{
+  { "RAWv1",      MAIN_LOOP_INTERVAL_RAW,      ADVERTISING_INTERVAL_RAW,      RAWv1_DATA_LENGTH, LIS2DH12_SAMPLERATE_RAWv1, false },
+  { "RAWv2_FAST", MAIN_LOOP_INTERVAL_RAW,      ADVERTISING_INTERVAL_RAW,      RAWv2_DATA_LENGTH, LIS2DH12_SAMPLERATE_RAWv2, MOTION_GATED },
+  { "RAWv2_SLOW", MAIN_LOOP_INTERVAL_RAW_SLOW, ADVERTISING_INTERVAL_RAW_SLOW, RAWv2_DATA_LENGTH, LIS2DH12_SAMPLERATE_RAWv2, MOTION_GATED }
+};
+
+/**
+ *  LIS2DH12 current in uA at LIS2DH12_RATE_* and LIS2DH12_RES*, datasheet table 12.
+ *  8-bit resolution is low-power mode, 10 and 12 bits are accounted as normal mode.
+ */
+static float lis2dh12_current_ua(uint8_t rate, uint8_t resolution)
+{
+  static const float normal_ua[]    = { 0.5f, 2.0f, 4.0f, 6.0f, 11.0f, 20.0f, 38.0f, 73.0f };
+  static const float low_power_ua[] = { 0.5f, 2.0f, 3.0f, 4.0f,  6.0f, 10.0f, 18.0f, 36.0f };
+  uint8_t index = (rate >> 4) & 0x07;
+  return (LIS2DH12_RES8BIT == resolution) ? low_power_ua[index] : normal_ua[index];
+}
+
+/**
+ *  Accelerometer current of mode. Wake-on-motion runs at 1 Hz 8-bit while still, see lis2dh12_motion.c,
+ *  and at sample rate of mode and LIS2DH12_RESOLUTION while moving.
+ */
+static float lis2dh12_mode_ua(const simulated_mode_t* mode, bool still)
+{
+  if(mode->lis2dh12_gated && still) { return lis2dh12_current_ua(LIS2DH12_RATE_1, LIS2DH12_RES8BIT); }
+  return lis2dh12_current_ua(mode->lis2dh12_rate, LIS2DH12_RESOLUTION);
+}
+
+/** Number of samples of BME280_OVERSAMPLING_* register value */
+static uint8_t oversampling_samples(uint8_t oversampling)
+{
+  if(BME280_OVERSAMPLING_SKIP == oversampling) { return 0; }
+  return 1 << (oversampling - 1);
+}
+
+/**
+ *  BME280 configuration of mode. Governor selects oversampling from main loop interval
+ *  as configure_bme280 of firmware does, otherwise fixed oversampling of application_config.h is used.
+ */
+static bme280_config_t select_configuration(const simulated_mode_t* mode)
+{
+  bme280_config_t config = { .oversampling_temp  = BME280_TEMPERATURE_OVERSAMPLING,
+                             .oversampling_press = BME280_PRESSURE_OVERSAMPLING,
+                             .oversampling_hum   = BME280_HUMIDITY_OVERSAMPLING,
+                             .iir                = BME280_IIR,
+                             .interval           = BME280_DELAY,
+                             .mode               = BME280_FORCED_MODE ? BME280_MODE_FORCED : BME280_MODE_NORMAL
+                           };
+  if(BME280_GOVERNOR_ENABLED)
+  {
+    const bme280_governor_target_t target = { .noise_temperature = BME280_GOVERNOR_NOISE_TEMPERATURE,
+                                              .noise_humidity    = BME280_GOVERNOR_NOISE_HUMIDITY,
+                                              .noise_pressure    = BME280_GOVERNOR_NOISE_PRESSURE,
+                                              .budget_nc         = BME280_GOVERNOR_BUDGET_NC,
+                                              .response_ms       = BME280_GOVERNOR_RESPONSE_MS
+                                            };
+    bme280_governor_setting_t setting;
+    bme280_governor_select(&target, BME280_FORCED_MODE ? mode->main_loop_ms : BME280_DELAY_MS, &setting);
+    config.oversampling_temp  = setting.oversampling_temp;
+    config.oversampling_press = setting.oversampling_press;
+    config.oversampling_hum   = setting.oversampling_hum;
+    config.iir                = setting.iir;
+  }
+  return config;
+}
+
+/** Model of the running simulation, BME280 driver SPI transfers and timer interrupts are counted into it */
+static energy_model_t* m_model = NULL;
+APP_TIMER_DEF(bme280_timer);
+
+static void count_bme280_spi(const uint8_t count)
+{
+  energy_count_spi(m_model, ENERGY_SPI_BME280, count);
+}
+
+static void bme280_timer_handler(void* p_context)
+{
+  energy_count_cpu(m_model, TASK_TIMER_IRQ, TIMER_IRQ_US);
+}
+
+/** Preamble, access address, header, advertiser address, flags, manufacturer data header and CRC */
+static uint32_t bytes_on_air(uint32_t payload_length)
+{
+  return 1 + 4 + 2 + 6 + 3 + 4 + payload_length + 3;
+}
+
+/**
+ *  Run main loop of firmware for given time.
+ *  @param still true if tag does not move, adaptive advertising backs off to its ceiling.
+ */
+static double simulate(energy_model_t* model, const simulated_mode_t* mode, bool still, uint64_t duration_us)
+{
+  energy_constants_t constants = energy_default_constants;
+  constants.lis2dh12_ua = lis2dh12_mode_ua(mode, still);
+  energy_model_init(model, &constants);
+
+  // Mode is stored to flash when entered. Garbage collection erases a page once per hundreds of mode changes.
+  energy_count_flash(model, MODE_RECORD_WORDS, 0);
+
+  // BME280 is put to sleep and configured for mode, as on mode change of firmware.
+  m_model = model;
+  const bme280_config_t config = select_configuration(mode);
+  bme280_set_mode(BME280_MODE_SLEEP);
+  bme280_configure(&config);
+  const uint8_t osrs_t = oversampling_samples(config.oversampling_temp);
+  const uint8_t osrs_p = oversampling_samples(config.oversampling_press);
+  const uint8_t osrs_h = oversampling_samples(config.oversampling_hum);
+  uint64_t advertising_us = (uint64_t)mode->advertising_ms * 1000;
+  if(ADAPTIVE_ADVERTISING_ENABLED && still && ADAPTIVE_ADVERTISING_CEILING * 1000ULL > advertising_us)
+  {
+    advertising_us = ADAPTIVE_ADVERTISING_CEILING * 1000ULL;
+  }
+  const uint64_t main_loop_us = (uint64_t)mode->main_loop_ms * 1000;
+  const uint64_t bme280_us = energy_bme280_measurement_time_us(osrs_t, osrs_p, osrs_h) + BME280_DELAY_MS * 1000ULL;
+  uint64_t next_advertisement = 0;
+  uint64_t next_main_loop = main_loop_us;
+  uint64_t next_bme280 = BME280_FORCED_MODE ? UINT64_MAX : 0;
+  uint64_t last_battery = 0;
+  srand(1);
+
+  for(uint64_t now = 0; now < duration_us;)
+  {
+    if(next_advertisement <= next_main_loop && next_advertisement <= next_bme280)
+    {
+      now = next_advertisement;
+      energy_count_tx(model, bytes_on_air(mode->payload_length));
+      energy_count_cpu(model, TASK_RADIO_IRQ, RADIO_IRQ_US);
+      energy_count_cpu(model, TASK_RADIO_IRQ, RADIO_IRQ_US);
+      if(now - last_battery > APPLICATION_BATTERY_INTERVAL * 1000ULL)
+      {
+        // Idle sample before and loaded sample after TX, CPU sleeps during conversions
+        for(int ii = 0; ii < 2; ii++)
+        {
+          energy_count_saadc(model);
+          energy_count_cpu(model, TASK_BATTERY, BATTERY_US);
+        }
+        last_battery = now;
+      }
+      next_advertisement += advertising_us + (rand() % MAX_ADVERTISING_DELAY_US);
+    }
+    else if(next_main_loop <= next_bme280)
+    {
+      now = next_main_loop;
+      energy_count_cpu(model, TASK_TIMER_IRQ, TIMER_IRQ_US);
+      // main_timer_handler: forced conversion, sensor task is run from timer once it is ready
+      if(BME280_FORCED_MODE && BME280_RET_OK == bme280_start_forced_conversion(bme280_timer))
+      {
+        energy_count_bme280_conversion(model, osrs_t, osrs_p, osrs_h);
+        fake_bme280_convert(FAKE_ADC_T, FAKE_ADC_P, FAKE_ADC_H);
+        fake_timer_fire(bme280_timer);
+      }
+      // main_sensor_task: bme280_read_measurements, lis2dh12_read_samples of one sample is address + 6 bytes
+      bme280_read_measurements();
+      energy_count_spi(model, ENERGY_SPI_LIS2DH12, 1 + 6);
+      energy_count_cpu(model, TASK_SENSOR, SENSOR_TASK_US);
+      next_main_loop += main_loop_us;
+    }
+    else
+    {
+      now = next_bme280;
+      energy_count_bme280_conversion(model, osrs_t, osrs_p, osrs_h);
+      fake_bme280_convert(FAKE_ADC_T, FAKE_ADC_P, FAKE_ADC_H);
+      next_bme280 += bme280_us;
+    }
+  }
+  return energy_model_average_ua(model, duration_us, NULL);
+}
+
+static void print_result(const energy_model_t* model, const simulated_mode_t* mode, bool still, uint64_t duration_us)
+{
+  energy_breakdown_t b;
+  double average = energy_model_average_ua(model, duration_us, &b);
+  double to_ua = 1000.0 / duration_us;
+  printf("%-11s %-6s %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %7.2f %8.0f %6.2f\n",
+         mode->name, still ? "still" : "moving", average,
+         b.tx_nc * to_ua, b.cpu_nc * to_ua, b.spi_nc * to_ua, b.bme280_nc * to_ua,
+         (b.saadc_nc + b.flash_nc) * to_ua, b.static_nc * to_ua,
+         energy_battery_life_days(average, BATTERY_CAPACITY_MAH),
+         energy_battery_life_days(average, BATTERY_CAPACITY_MAH) / 365.0);
+}
+
+int main(int argc, char** argv)
+{
+  double hours = (argc > 1) ? atof(argv[1]) : 24.0;
+  uint64_t duration_us = (uint64_t)(hours * 3600.0 * 1e6);
+  energy_model_t model;
+
+  fake_reset();
+  app_timer_create(&bme280_timer, APP_TIMER_MODE_SINGLE_SHOT, bme280_timer_handler);
+  if(BME280_RET_OK != bme280_init())
+  {
+    printf("BME280 driver initialisation failed\n");
+    return 1;
+  }
+  // Initialisation is not part of any mode, count transfers from here on
+  fake_spi_observe(count_bme280_spi);
+
+  printf("Simulated %.1f h, %.0f mAh battery. Currents in uA.\n", hours, BATTERY_CAPACITY_MAH);
+  printf("%-11s %-6s %7s %7s %7s %7s %7s %7s %7s %8s %6s\n",
+         "mode", "motion", "average", "radio", "cpu", "spi", "bme280", "other", "static", "days", "years");
+  for(size_t ii = 0; ii < sizeof(modes) / sizeof(modes[0]); ii++)
+  {
+    for(int still = 0; still < 2; still++)
+    {
+      simulate(&model, &modes[ii], still, duration_us);
+      print_result(&model, &modes[ii], still, duration_us);
+    }
+  }
+
+  printf("\nLIS2DH12 current (moving still), uA:\n");
+  for(size_t ii = 0; ii < sizeof(modes) / sizeof(modes[0]); ii++)
+  {
+    printf("%-11s %5.1f %5.1f\n", modes[ii].name, lis2dh12_mode_ua(&modes[ii], false), lis2dh12_mode_ua(&modes[ii], true));
+  }
+
+  printf("\nBME280 oversampling (T P H):\n");
+  for(size_t ii = 0; ii < sizeof(modes) / sizeof(modes[0]); ii++)
+  {
+    const bme280_config_t config = select_configuration(&modes[ii]);
+    printf("%-11s %2u %2u %2u\n", modes[ii].name, oversampling_samples(config.oversampling_temp),
+           oversampling_samples(config.oversampling_press), oversampling_samples(config.oversampling_hum));
+  }
+
+  simulate(&model, &modes[1], false, duration_us);
+  printf("\nCPU time per task in RAWv2_FAST:\n");
+  for(size_t ii = 0; ii < sizeof(task_names) / sizeof(task_names[0]); ii++)
+  {
+    printf("%-10s %8u calls %10.3f s\n", task_names[ii], model.counters.task_calls[ii], model.counters.cpu_us[ii] / 1e6);
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include "probe.h"
+
+#include <string.h>
+#if defined(NRF52)
+#include "nrf.h"
+#endif
+
+static probe_stats_t m_stats[PROBE_COUNT];
+
+static const char* const m_names[PROBE_COUNT] = {
+  "encode_raw5",
+  "lis2dh12_read",
+  "bme280_read",
+  "route_message"
+};
+
+void probe_init(void)
+{
+  #if defined(NRF52)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  #endif
+  probe_reset();
+}
+
+void probe_reset(void)
+{
+  memset(m_stats, 0, sizeof(m_stats));
+  for(size_t ii = 0; ii < PROBE_COUNT; ii++) { m_stats[ii].min = UINT32_MAX; }
+}
+
+void probe_record(const probe_id_t id, const uint32_t ticks)
+{
+  if(PROBE_COUNT <= id) { return; }
+  probe_stats_t* const stats = &m_stats[id];
+  stats->count++;
+  stats->sum += ticks;
+  if(ticks < stats->min) { stats->min = ticks; }
+  if(ticks > stats->max) { stats->max = ticks; }
+}
+
+probe_stats_t probe_get(const probe_id_t id)
+{
+  probe_stats_t stats = {0};
+  if(PROBE_COUNT <= id || 0 == m_stats[id].count) { return stats; }
+  return m_stats[id];
+}
+
+const char* probe_name(const probe_id_t id)
+{
+  return (PROBE_COUNT > id) ? m_names[id] : "unknown";
+}
+
+size_t probe_snapshot(uint8_t* const buffer, const size_t size)
+{
+  if(NULL == buffer || probe_snapshot_size() > size) { return 0; }
+  probe_header_t header = { .probes = PROBE_COUNT, .reserved = 0, .ticks_per_us = PROBE_TICKS_PER_US };
+  memcpy(buffer, &header, sizeof(header));
+  for(size_t ii = 0; ii < PROBE_COUNT; ii++)
+  {
+    const probe_stats_t stats = probe_get(ii);
+    memcpy(buffer + sizeof(header) + ii * sizeof(stats), &stats, sizeof(stats));
+  }
+  return probe_snapshot_size();
+}
+
+size_t probe_snapshot_size(void)
+{
+  return sizeof(probe_header_t) + PROBE_COUNT * sizeof(probe_stats_t);
+}
@@ -0,0 +1,107 @@
+#ifndef PROBE_H
+#define PROBE_H
+/**
+ *  Named timing probes for hot paths.
+ *
+ *  PROBE_START(id) and PROBE_STOP(id) bracket a block within one scope, the run time between them is
+ *  accumulated into count, min, max and sum of the probe in a static table. Clock is DWT cycle counter on
+ *  nRF52 and clock_gettime(CLOCK_MONOTONIC) in nanoseconds on host, see PROBE_TICKS_PER_US.
+ *
+ *  Probes are compiled out when PROBE_ENABLED is 0 or undefined, nothing is read or stored and probe.c
+ *  does not need to be linked, so probes can stay in production code.
+ *
+ *  Table is updated without locking. Use probes in scheduler context only, a probe interrupted by the same
+ *  probe may lose one of the runs.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef PROBE_ENABLED
+#define PROBE_ENABLED 0
+#endif
+
+typedef enum{
+  PROBE_ENCODE_RAW5 = 0,  // encodeToRawFormat5Sequence
+  PROBE_LIS2DH12_READ,    // lis2dh12_read_samples, SPI read and conversion
+  PROBE_BME280_READ,      // bme280_read_measurements, SPI burst read
+  PROBE_ROUTE_MESSAGE,    // route_message, including endpoint handler
+  PROBE_COUNT
+}probe_id_t;
+
+/** Statistics of one probe in clock ticks */
+typedef struct __attribute__((packed)){
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+}probe_stats_t;
+
+/** Snapshot starts with header, followed by probe_stats_t of each probe in order of probe_id_t */
+typedef struct __attribute__((packed)){
+  uint8_t  probes;        // PROBE_COUNT
+  uint8_t  reserved;
+  uint16_t ticks_per_us;  // PROBE_TICKS_PER_US
+}probe_header_t;
+
+#if defined(NRF52)
+  #define PROBE_TICKS_PER_US 64  // CPU cycles at 64 MHz
+#else
+  #define PROBE_TICKS_PER_US 1000
+#endif
+
+#if PROBE_ENABLED
+
+#if defined(NRF52)
+  #include "nrf.h"
+  static inline uint32_t probe_clock(void)
+  {
+    return DWT->CYCCNT;
+  }
+#else
+  #include <time.h>
+  /** Nanoseconds modulo 2^32, differences are valid for runs under 4.2 s */
+  static inline uint32_t probe_clock(void)
+  {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)now.tv_sec * 1000000000u + (uint32_t)now.tv_nsec;
+  }
+#endif
+
+  #define PROBE_START(id) const uint32_t probe_start_##id = probe_clock()
+  #define PROBE_STOP(id)  probe_record((id), probe_clock() - probe_start_##id)
+
+#else
+
+  #define PROBE_START(id)
+  #define PROBE_STOP(id)
+
+#endif
+
+/** Start clock and clear table */
+void probe_init(void);
+
+/** Clear table */
+void probe_reset(void);
+
+/** Accumulate one run of ticks to probe */
+void probe_record(const probe_id_t id, const uint32_t ticks);
+
+/** Statistics of probe, count is 0 if probe has not run */
+probe_stats_t probe_get(const probe_id_t id);
+
+/** Name of probe for logs */
+const char* probe_name(const probe_id_t id);
+
+/**
+ *  Copy header and statistics of all probes to buffer.
+ *
+ *  @return bytes written, 0 if buffer is too small
+ */
+size_t probe_snapshot(uint8_t* const buffer, const size_t size);
+
+/** Size of snapshot */
+size_t probe_snapshot_size(void);
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ *  Built with PROBE_ENABLED=0 and without probe.c, links only if disabled probes compile out.
+ */
+#include "probe.h"
+
+#include <stdio.h>
+
+static uint32_t work(const uint32_t n)
+{
+  PROBE_START(PROBE_ENCODE_RAW5);
+  uint32_t sum = 0;
+  for(uint32_t ii = 0; ii < n; ii++) { sum += ii; }
+  PROBE_STOP(PROBE_ENCODE_RAW5);
+  return sum;
+}
+
+int main(void)
+{
+  const int passed = (45 == work(10));
+  printf("%s\n", passed ? "OK" : "FAIL");
+  return passed ? 0 : 1;
+}
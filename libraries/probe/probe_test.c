@@ -0,0 +1,81 @@
+/**
+ *  Host check of probes.
+ *
+ *  Accumulation is checked with recorded values, clock with probes around a busy loop and a sleep.
+ *  probe_disabled_test.c is built with PROBE_ENABLED=0 and without probe.c, so it links only if
+ *  disabled probes compile out.
+ */
+#include "probe.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BUSY_RUNS  100
+#define SLEEP_US   2000
+
+static volatile uint32_t m_sink = 0;
+
+static void busy(void)
+{
+  PROBE_START(PROBE_ROUTE_MESSAGE);
+  for(uint32_t ii = 0; ii < 10000; ii++) { m_sink += ii; }
+  PROBE_STOP(PROBE_ROUTE_MESSAGE);
+}
+
+static void sleep_us(const uint32_t us)
+{
+  PROBE_START(PROBE_BME280_READ);
+  const struct timespec duration = { .tv_sec = 0, .tv_nsec = us * 1000L };
+  nanosleep(&duration, NULL);
+  PROBE_STOP(PROBE_BME280_READ);
+}
+
+static int check(const char* name, const int passed)
+{
+  if(!passed) { printf("FAIL %s\n", name); }
+  return passed ? 0 : 1;
+}
+
+int main(void)
+{
+  int failures = 0;
+  probe_init();
+
+  const uint32_t values[] = { 70, 30, 500, 30 };
+  for(size_t ii = 0; ii < sizeof(values) / sizeof(values[0]); ii++) { probe_record(PROBE_ENCODE_RAW5, values[ii]); }
+  probe_stats_t stats = probe_get(PROBE_ENCODE_RAW5);
+  failures += check("record", 4 == stats.count && 30 == stats.min && 500 == stats.max && 630 == stats.sum);
+  stats = probe_get(PROBE_LIS2DH12_READ);
+  failures += check("unused", 0 == stats.count && 0 == stats.min && 0 == stats.max && 0 == stats.sum);
+  probe_record(PROBE_COUNT, 1);
+
+  for(uint32_t ii = 0; ii < BUSY_RUNS; ii++) { busy(); }
+  stats = probe_get(PROBE_ROUTE_MESSAGE);
+  failures += check("busy", BUSY_RUNS == stats.count && 0 < stats.min && stats.min <= stats.max &&
+                            stats.sum >= (uint64_t)stats.min * BUSY_RUNS && stats.sum <= (uint64_t)stats.max * BUSY_RUNS);
+  printf("%-14s %6u runs, min %u max %u avg %u ns\n", probe_name(PROBE_ROUTE_MESSAGE), (unsigned)stats.count,
+         (unsigned)stats.min, (unsigned)stats.max, (unsigned)(stats.sum / stats.count));
+
+  sleep_us(SLEEP_US);
+  stats = probe_get(PROBE_BME280_READ);
+  failures += check("sleep", 1 == stats.count && stats.min >= SLEEP_US * PROBE_TICKS_PER_US);
+  printf("%-14s %6u runs, min %u ns\n", probe_name(PROBE_BME280_READ), (unsigned)stats.count, (unsigned)stats.min);
+
+  uint8_t buffer[sizeof(probe_header_t) + PROBE_COUNT * sizeof(probe_stats_t)];
+  failures += check("snapshot size", sizeof(buffer) == probe_snapshot_size() &&
+                                     0 == probe_snapshot(buffer, sizeof(buffer) - 1) &&
+                                     sizeof(buffer) == probe_snapshot(buffer, sizeof(buffer)));
+  probe_header_t header;
+  memcpy(&header, buffer, sizeof(header));
+  memcpy(&stats, buffer + sizeof(header) + PROBE_ENCODE_RAW5 * sizeof(stats), sizeof(stats));
+  failures += check("snapshot", PROBE_COUNT == header.probes && PROBE_TICKS_PER_US == header.ticks_per_us &&
+                                4 == stats.count && 630 == stats.sum);
+
+  probe_reset();
+  stats = probe_get(PROBE_ROUTE_MESSAGE);
+  failures += check("reset", 0 == stats.count);
+
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
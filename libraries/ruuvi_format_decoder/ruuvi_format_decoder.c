@@ -0,0 +1,257 @@
+#include "ruuvi_format_decoder.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+// Scale of RAWv2 fields to physical units. Offsets are added in integer domain before scaling
+// so that scalar and SIMD paths round identically.
+#define RAW2_TEMPERATURE_SCALE   0.005f
+#define RAW2_HUMIDITY_SCALE      0.0025f
+#define ACCELERATION_SCALE       0.001f
+#define VOLTAGE_SCALE            0.001f
+#define RAW1_HUMIDITY_SCALE      0.5f
+#define RAW1_TEMPERATURE_SCALE   0.01f
+
+int ruuvi_decoder_batch_init(ruuvi_decoded_batch_t* batch, size_t capacity)
+{
+  memset(batch, 0, sizeof(*batch));
+  batch->capacity         = capacity;
+  batch->format           = malloc(capacity * sizeof(*batch->format));
+  batch->temperature      = malloc(capacity * sizeof(*batch->temperature));
+  batch->humidity         = malloc(capacity * sizeof(*batch->humidity));
+  batch->pressure         = malloc(capacity * sizeof(*batch->pressure));
+  batch->acceleration_x   = malloc(capacity * sizeof(*batch->acceleration_x));
+  batch->acceleration_y   = malloc(capacity * sizeof(*batch->acceleration_y));
+  batch->acceleration_z   = malloc(capacity * sizeof(*batch->acceleration_z));
+  batch->voltage          = malloc(capacity * sizeof(*batch->voltage));
+  batch->tx_power         = malloc(capacity * sizeof(*batch->tx_power));
+  batch->movement_counter = malloc(capacity * sizeof(*batch->movement_counter));
+  batch->sequence         = malloc(capacity * sizeof(*batch->sequence));
+  batch->mac              = malloc(capacity * sizeof(*batch->mac));
+  if(!batch->format || !batch->temperature || !batch->humidity || !batch->pressure ||
+     !batch->acceleration_x || !batch->acceleration_y || !batch->acceleration_z ||
+     !batch->voltage || !batch->tx_power || !batch->movement_counter || !batch->sequence || !batch->mac)
+  {
+    ruuvi_decoder_batch_uninit(batch);
+    return 1;
+  }
+  return 0;
+}
+
+void ruuvi_decoder_batch_uninit(ruuvi_decoded_batch_t* batch)
+{
+  free(batch->format);
+  free(batch->temperature);
+  free(batch->humidity);
+  free(batch->pressure);
+  free(batch->acceleration_x);
+  free(batch->acceleration_y);
+  free(batch->acceleration_z);
+  free(batch->voltage);
+  free(batch->tx_power);
+  free(batch->movement_counter);
+  free(batch->sequence);
+  free(batch->mac);
+  memset(batch, 0, sizeof(*batch));
+}
+
+void ruuvi_decoder_batch_clear(ruuvi_decoded_batch_t* batch)
+{
+  batch->count = 0;
+}
+
+static inline int16_t read_int16(const uint8_t* p)
+{
+  return (int16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint16_t read_uint16(const uint8_t* p)
+{
+  return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline float acceleration_to_g(int16_t value)
+{
+  return (RAW2_ACCELERATION_INVALID == value) ? NAN : (float)value * ACCELERATION_SCALE;
+}
+
+/** Fields of RAWv2 which are decoded by scalar code in both paths */
+static void decode_raw2_tail(ruuvi_decoded_batch_t* batch, size_t index, const uint8_t* p)
+{
+  uint8_t power = p[14] & 0x1F;
+  batch->format[index]           = RAW_FORMAT_2;
+  batch->tx_power[index]         = (RAW2_TX_POWER_INVALID == power) ? RUUVI_DECODER_TX_POWER_INVALID : (int8_t)(power * 2 - RAW2_TX_POWER_OFFSET);
+  batch->movement_counter[index] = p[15];
+  batch->sequence[index]         = read_uint16(&p[16]);
+  uint64_t mac = 0;
+  for(size_t ii = 0; ii < RAW2_MAC_LENGTH; ii++)
+  {
+    mac = (mac << 8) | p[RAW2_MAC_OFFSET + ii];
+  }
+  batch->mac[index] = mac;
+}
+
+static void decode_raw2(ruuvi_decoded_batch_t* batch, size_t index, const uint8_t* p)
+{
+  int16_t  temperature = read_int16(&p[1]);
+  uint16_t humidity    = read_uint16(&p[3]);
+  uint16_t pressure    = read_uint16(&p[5]);
+  uint16_t voltage     = read_uint16(&p[13]) >> 5;
+  batch->temperature[index]    = (RAW2_TEMPERATURE_INVALID == temperature) ? NAN : (float)temperature * RAW2_TEMPERATURE_SCALE;
+  batch->humidity[index]       = (RAW2_HUMIDITY_INVALID == humidity) ? NAN : (float)humidity * RAW2_HUMIDITY_SCALE;
+  batch->pressure[index]       = (RAW2_PRESSURE_INVALID == pressure) ? NAN : (float)(pressure + RAW_PRESSURE_OFFSET);
+  batch->acceleration_x[index] = acceleration_to_g(read_int16(&p[7]));
+  batch->acceleration_y[index] = acceleration_to_g(read_int16(&p[9]));
+  batch->acceleration_z[index] = acceleration_to_g(read_int16(&p[11]));
+  batch->voltage[index]        = (RAW2_VOLTAGE_INVALID == voltage) ? NAN : (float)(voltage + RAW2_VOLTAGE_OFFSET) * VOLTAGE_SCALE;
+  decode_raw2_tail(batch, index, p);
+}
+
+/** RAWv1 has no invalid values, sign of temperature is in MSB of integer part. */
+static void decode_raw1(ruuvi_decoded_batch_t* batch, size_t index, const uint8_t* p)
+{
+  int32_t temperature = (p[2] & 0x7F) * 100 + p[3];
+  if(p[2] & 0x80) { temperature = -temperature; }
+  batch->format[index]           = SENSOR_TAG_DATA_FORMAT;
+  batch->humidity[index]         = (float)p[1] * RAW1_HUMIDITY_SCALE;
+  batch->temperature[index]      = (float)temperature * RAW1_TEMPERATURE_SCALE;
+  batch->pressure[index]         = (float)(read_uint16(&p[4]) + RAW_PRESSURE_OFFSET);
+  batch->acceleration_x[index]   = (float)read_int16(&p[6]) * ACCELERATION_SCALE;
+  batch->acceleration_y[index]   = (float)read_int16(&p[8]) * ACCELERATION_SCALE;
+  batch->acceleration_z[index]   = (float)read_int16(&p[10]) * ACCELERATION_SCALE;
+  batch->voltage[index]          = (float)read_uint16(&p[12]) * VOLTAGE_SCALE;
+  batch->tx_power[index]         = RUUVI_DECODER_TX_POWER_INVALID;
+  batch->movement_counter[index] = 0;
+  batch->sequence[index]         = 0;
+  batch->mac[index]              = 0;
+}
+
+size_t ruuvi_decode_batch(ruuvi_decoded_batch_t* batch, const uint8_t* const* payloads, const size_t* lengths, size_t count)
+{
+  size_t decoded = 0;
+  for(size_t ii = 0; ii < count && batch->count < batch->capacity; ii++)
+  {
+    const uint8_t* p = payloads[ii];
+    if(NULL == p || 0 == lengths[ii]) { continue; }
+    if(RAW_FORMAT_2 == p[0] && RAW_2_ENCODED_DATA_LENGTH <= lengths[ii])
+    {
+      decode_raw2(batch, batch->count++, p);
+      decoded++;
+    }
+    else if(SENSOR_TAG_DATA_FORMAT == p[0] && SENSORTAG_ENCODED_DATA_LENGTH <= lengths[ii])
+    {
+      decode_raw1(batch, batch->count++, p);
+      decoded++;
+    }
+  }
+  return decoded;
+}
+
+size_t ruuvi_decode_raw2_packed_reference(ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count)
+{
+  size_t decoded = 0;
+  for(size_t ii = 0; ii < count && batch->count < batch->capacity; ii++)
+  {
+    const uint8_t* p = data + ii * RAW_2_ENCODED_DATA_LENGTH;
+    if(RAW_FORMAT_2 != p[0]) { continue; }
+    decode_raw2(batch, batch->count++, p);
+    decoded++;
+  }
+  return decoded;
+}
+
+#if defined(__SSSE3__)
+
+/** Store values as float, replacing lanes equal to invalid with NAN */
+static inline void store_field(float* target, __m128i value, __m128i invalid, __m128 scale)
+{
+  __m128 mask   = _mm_castsi128_ps(_mm_cmpeq_epi32(value, invalid));
+  __m128 result = _mm_mul_ps(_mm_cvtepi32_ps(value), scale);
+  result = _mm_or_ps(_mm_andnot_ps(mask, result), _mm_and_ps(mask, _mm_set1_ps(NAN)));
+  _mm_storeu_ps(target, result);
+}
+
+static inline __m128i sign_extend_lo(__m128i v) { return _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16); }
+static inline __m128i sign_extend_hi(__m128i v) { return _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16); }
+static inline __m128i zero_extend_lo(__m128i v) { return _mm_unpacklo_epi16(v, _mm_setzero_si128()); }
+static inline __m128i zero_extend_hi(__m128i v) { return _mm_unpackhi_epi16(v, _mm_setzero_si128()); }
+
+/**
+ *  Decode 4 RAWv2 records. Big-endian fields at bytes 1...14 of each record are byte-swapped into
+ *  16-bit lanes, transposed so that each register holds one field of 4 records and converted to float.
+ */
+static void decode_raw2_x4(ruuvi_decoded_batch_t* batch, size_t index, const uint8_t* p)
+{
+  const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  __m128i r0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 0 * RAW_2_ENCODED_DATA_LENGTH + 1)), swap);
+  __m128i r1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 1 * RAW_2_ENCODED_DATA_LENGTH + 1)), swap);
+  __m128i r2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 2 * RAW_2_ENCODED_DATA_LENGTH + 1)), swap);
+  __m128i r3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(p + 3 * RAW_2_ENCODED_DATA_LENGTH + 1)), swap);
+
+  __m128i t0 = _mm_unpacklo_epi16(r0, r1);
+  __m128i t1 = _mm_unpacklo_epi16(r2, r3);
+  __m128i t2 = _mm_unpackhi_epi16(r0, r1);
+  __m128i t3 = _mm_unpackhi_epi16(r2, r3);
+  __m128i temperature_humidity = _mm_unpacklo_epi32(t0, t1);
+  __m128i pressure_x           = _mm_unpackhi_epi32(t0, t1);
+  __m128i y_z                  = _mm_unpacklo_epi32(t2, t3);
+  __m128i power                = _mm_unpackhi_epi32(t2, t3);
+
+  const __m128i signed_invalid = _mm_set1_epi32(RAW2_TEMPERATURE_INVALID);
+  const __m128  acceleration_scale = _mm_set1_ps(ACCELERATION_SCALE);
+  store_field(&batch->temperature[index], sign_extend_lo(temperature_humidity), signed_invalid, _mm_set1_ps(RAW2_TEMPERATURE_SCALE));
+  store_field(&batch->humidity[index], zero_extend_hi(temperature_humidity), _mm_set1_epi32(RAW2_HUMIDITY_INVALID), _mm_set1_ps(RAW2_HUMIDITY_SCALE));
+  // Offset is applied after the invalid check, compare against offset invalid value.
+  __m128i pressure = _mm_add_epi32(zero_extend_lo(pressure_x), _mm_set1_epi32(RAW_PRESSURE_OFFSET));
+  store_field(&batch->pressure[index], pressure, _mm_set1_epi32(RAW2_PRESSURE_INVALID + RAW_PRESSURE_OFFSET), _mm_set1_ps(1.0f));
+  store_field(&batch->acceleration_x[index], sign_extend_hi(pressure_x), signed_invalid, acceleration_scale);
+  store_field(&batch->acceleration_y[index], sign_extend_lo(y_z), signed_invalid, acceleration_scale);
+  store_field(&batch->acceleration_z[index], sign_extend_hi(y_z), signed_invalid, acceleration_scale);
+  __m128i voltage = _mm_add_epi32(_mm_srli_epi32(zero_extend_lo(power), 5), _mm_set1_epi32(RAW2_VOLTAGE_OFFSET));
+  store_field(&batch->voltage[index], voltage, _mm_set1_epi32(RAW2_VOLTAGE_INVALID + RAW2_VOLTAGE_OFFSET), _mm_set1_ps(VOLTAGE_SCALE));
+
+  for(size_t ii = 0; ii < 4; ii++)
+  {
+    decode_raw2_tail(batch, index + ii, p + ii * RAW_2_ENCODED_DATA_LENGTH);
+  }
+}
+
+size_t ruuvi_decode_raw2_packed(ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count)
+{
+  size_t decoded = 0;
+  size_t ii = 0;
+  // Groups of 4 records which all are RAWv2 and fit into batch go through SIMD path
+  while(ii + 4 <= count && batch->count + 4 <= batch->capacity)
+  {
+    const uint8_t* p = data + ii * RAW_2_ENCODED_DATA_LENGTH;
+    if(RAW_FORMAT_2 == p[0] && RAW_FORMAT_2 == p[RAW_2_ENCODED_DATA_LENGTH] &&
+       RAW_FORMAT_2 == p[2 * RAW_2_ENCODED_DATA_LENGTH] && RAW_FORMAT_2 == p[3 * RAW_2_ENCODED_DATA_LENGTH])
+    {
+      decode_raw2_x4(batch, batch->count, p);
+      batch->count += 4;
+      decoded += 4;
+      ii += 4;
+    }
+    else
+    {
+      decoded += ruuvi_decode_raw2_packed_reference(batch, p, 1);
+      ii++;
+    }
+  }
+  decoded += ruuvi_decode_raw2_packed_reference(batch, data + ii * RAW_2_ENCODED_DATA_LENGTH, count - ii);
+  return decoded;
+}
+
+#else
+
+size_t ruuvi_decode_raw2_packed(ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count)
+{
+  return ruuvi_decode_raw2_packed_reference(batch, data, count);
+}
+
+#endif
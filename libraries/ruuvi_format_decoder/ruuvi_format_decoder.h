@@ -0,0 +1,77 @@
+#ifndef RUUVI_FORMAT_DECODER_H
+#define RUUVI_FORMAT_DECODER_H
+
+/**
+ *  Host-side batch decoder for RAWv1 (0x03) and RAWv2 (0x05) manufacturer data.
+ *  Payloads start at the format byte, i.e. the manufacturer ID 0x0499 is stripped by caller.
+ *  Results are stored as struct of arrays in physical units, invalid values are NAN.
+ *
+ *  Format layouts and invalid values are shared with firmware in ruuvi_format_definitions.h
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ruuvi_format_definitions.h"
+
+#define RUUVI_DECODER_TX_POWER_INVALID INT8_MIN
+
+/** Decoded values of a batch of payloads, element i of each array belongs to payload i */
+typedef struct
+{
+  size_t    capacity;           // Max number of elements
+  size_t    count;              // Number of decoded elements
+  uint8_t*  format;             // Data format of payload
+  float*    temperature;        // C
+  float*    humidity;           // %RH
+  float*    pressure;           // Pa
+  float*    acceleration_x;     // g
+  float*    acceleration_y;     // g
+  float*    acceleration_z;     // g
+  float*    voltage;            // V
+  int8_t*   tx_power;           // dBm, RUUVI_DECODER_TX_POWER_INVALID if not available
+  uint8_t*  movement_counter;   // 0 if not available
+  uint16_t* sequence;           // 0 if not available
+  uint64_t* mac;                // 48-bit MAC, 0 if not available
+}ruuvi_decoded_batch_t;
+
+/**
+ *  Allocate arrays for capacity elements.
+ *  @return 0 on success, non-zero if allocation failed
+ */
+int ruuvi_decoder_batch_init(ruuvi_decoded_batch_t* batch, size_t capacity);
+
+/** Free arrays of batch */
+void ruuvi_decoder_batch_uninit(ruuvi_decoded_batch_t* batch);
+
+/** Reset count of batch to 0 so that it can be reused */
+void ruuvi_decoder_batch_clear(ruuvi_decoded_batch_t* batch);
+
+/**
+ *  Decode payloads of mixed formats and lengths, appending to batch.
+ *  Payloads which are not RAWv1 or RAWv2 or are too short are skipped.
+ *
+ *  @param batch batch to append to
+ *  @param payloads array of pointers to payloads
+ *  @param lengths array of lengths of payloads
+ *  @param count number of payloads
+ *  @return number of payloads decoded
+ */
+size_t ruuvi_decode_batch(ruuvi_decoded_batch_t* batch, const uint8_t* const* payloads, const size_t* lengths, size_t count);
+
+/**
+ *  Decode contiguous RAWv2 payloads of RAW_2_ENCODED_DATA_LENGTH bytes each, appending to batch.
+ *  Uses SIMD instructions if available. Records which are not RAWv2 are skipped.
+ *
+ *  @param batch batch to append to
+ *  @param data count * 24 bytes
+ *  @param count number of payloads
+ *  @return number of payloads decoded
+ */
+size_t ruuvi_decode_raw2_packed(ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count);
+
+/**
+ *  Scalar reference of ruuvi_decode_raw2_packed, results are identical.
+ */
+size_t ruuvi_decode_raw2_packed_reference(ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count);
+
+#endif
@@ -0,0 +1,252 @@
+/**
+ *  Verifies that SIMD and scalar RAWv2 decoders give identical results, cross-checks scalar decoder
+ *  against decodeRawFormat5 of firmware, round-trips RAWv1 payloads of encodeToRawFormat3 and
+ *  measures throughput of both RAWv2 decoders on a single core.
+ *
+ *  Usage: ruuvi_format_decoder_benchmark [number of payloads]
+ */
+#include "ruuvi_format_decoder.h"
+#include "sensortag.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_PAYLOADS 1000000
+#define ROUNDS           10
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/** Random payloads, with invalid values and some records of other formats mixed in */
+static void generate_payloads(uint8_t* data, size_t count)
+{
+  srand(5);
+  for(size_t ii = 0; ii < count * RAW_2_ENCODED_DATA_LENGTH; ii++)
+  {
+    data[ii] = rand() & 0xFF;
+  }
+  for(size_t ii = 0; ii < count; ii++)
+  {
+    uint8_t* p = data + ii * RAW_2_ENCODED_DATA_LENGTH;
+    p[0] = (0 == ii % 97) ? SENSOR_TAG_DATA_FORMAT : RAW_FORMAT_2;
+    if(0 == ii % 13) { p[1] = 0x80; p[2] = 0x00; p[7] = 0x80; p[8] = 0x00; }
+    if(0 == ii % 17) { p[3] = 0xFF; p[4] = 0xFF; p[5] = 0xFF; p[6] = 0xFF; }
+    if(0 == ii % 19) { p[13] = 0xFF; p[14] = 0xFF; }
+  }
+}
+
+static int compare_batches(const ruuvi_decoded_batch_t* a, const ruuvi_decoded_batch_t* b)
+{
+  size_t n = a->count;
+  if(n != b->count) { return 1; }
+  return memcmp(a->format, b->format, n * sizeof(*a->format)) ||
+         memcmp(a->temperature, b->temperature, n * sizeof(*a->temperature)) ||
+         memcmp(a->humidity, b->humidity, n * sizeof(*a->humidity)) ||
+         memcmp(a->pressure, b->pressure, n * sizeof(*a->pressure)) ||
+         memcmp(a->acceleration_x, b->acceleration_x, n * sizeof(*a->acceleration_x)) ||
+         memcmp(a->acceleration_y, b->acceleration_y, n * sizeof(*a->acceleration_y)) ||
+         memcmp(a->acceleration_z, b->acceleration_z, n * sizeof(*a->acceleration_z)) ||
+         memcmp(a->voltage, b->voltage, n * sizeof(*a->voltage)) ||
+         memcmp(a->tx_power, b->tx_power, n * sizeof(*a->tx_power)) ||
+         memcmp(a->movement_counter, b->movement_counter, n * sizeof(*a->movement_counter)) ||
+         memcmp(a->sequence, b->sequence, n * sizeof(*a->sequence)) ||
+         memcmp(a->mac, b->mac, n * sizeof(*a->mac));
+}
+
+/** Firmware decoder is linked from sensortag.c, device identity is not used */
+void sensortag_device_address(uint8_t* const mac)
+{
+  memset(mac, 0, RAW2_MAC_LENGTH);
+}
+
+uint32_t sensortag_device_id(void)
+{
+  return 0;
+}
+
+static int differs(const float value, const float expected, const float tolerance)
+{
+  if(isnan(value) || isnan(expected)) { return isnan(value) != isnan(expected); }
+  return fabsf(value - expected) > tolerance;
+}
+
+/**
+ *  Compare batch against decodeRawFormat5 of firmware. Firmware decodes temperature at 0.01 C
+ *  and humidity at 1/1024 %RH, so those are compared within resolution of firmware.
+ */
+static int compare_sensortag(const ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count)
+{
+  size_t index = 0;
+  for(size_t ii = 0; ii < count; ii++)
+  {
+    const uint8_t* p = data + ii * RAW_2_ENCODED_DATA_LENGTH;
+    ruuvi_sensor_t sensor;
+    uint8_t movement = 0;
+    int8_t tx_power = 0;
+    uint16_t sequence = 0;
+    if(!decodeRawFormat5(p, &sensor, &movement, &tx_power, &sequence)) { continue; }
+    if(index >= batch->count) { return 1; }
+    float temperature = (TEMPERATURE_INVALID == sensor.temperature) ? NAN : sensor.temperature * 0.01f;
+    float humidity = (HUMIDITY_INVALID == sensor.humidity) ? NAN : sensor.humidity / 1024.0f;
+    float pressure = (PRESSURE_INVALID == sensor.pressure) ? NAN : (float)(sensor.pressure >> 8);
+    float voltage = (0 == sensor.vbat) ? NAN : sensor.vbat * 0.001f;
+    if(differs(batch->temperature[index], temperature, 0.0051f) ||
+       differs(batch->humidity[index], humidity, 1.0f / 1024 + 0.0001f) ||
+       differs(batch->pressure[index], pressure, 0) ||
+       differs(batch->acceleration_x[index], (ACCELERATION_INVALID == sensor.accX) ? NAN : sensor.accX * 0.001f, 0.000001f) ||
+       differs(batch->acceleration_y[index], (ACCELERATION_INVALID == sensor.accY) ? NAN : sensor.accY * 0.001f, 0.000001f) ||
+       differs(batch->acceleration_z[index], (ACCELERATION_INVALID == sensor.accZ) ? NAN : sensor.accZ * 0.001f, 0.000001f) ||
+       differs(batch->voltage[index], voltage, 0.000001f) ||
+       batch->tx_power[index] != tx_power || batch->movement_counter[index] != movement ||
+       batch->sequence[index] != sequence)
+    {
+      fprintf(stderr, "Payload %zu differs from decodeRawFormat5\n", ii);
+      return 1;
+    }
+    index++;
+  }
+  return index != batch->count;
+}
+
+#define RAW1_ROUND_TRIPS 4096
+
+/**
+ *  Encode a sweep of sensor values with encodeToRawFormat3 of firmware and decode them with
+ *  ruuvi_decode_batch. RAWv1 carries humidity at 0.5 %RH and pressure at 1 Pa, so expected values
+ *  are truncated to that resolution, other fields must match exactly. Temperatures cover both signs,
+ *  including values between -1 C and 0 C where sign is the only thing set in integer part.
+ */
+static int compare_raw1(void)
+{
+  static uint8_t data[RAW1_ROUND_TRIPS][SENSORTAG_ENCODED_DATA_LENGTH];
+  static const uint8_t* payloads[RAW1_ROUND_TRIPS];
+  static size_t lengths[RAW1_ROUND_TRIPS];
+  static ruuvi_sensor_t sensors[RAW1_ROUND_TRIPS];
+  static const int16_t accelerations[] = { -32767, -16000, -1000, -1, 0, 1, 981, 16000, 32767 };
+  const size_t n_accelerations = sizeof(accelerations) / sizeof(accelerations[0]);
+  ruuvi_decoded_batch_t batch;
+  if(ruuvi_decoder_batch_init(&batch, RAW1_ROUND_TRIPS)) { return 1; }
+
+  for(size_t ii = 0; ii < RAW1_ROUND_TRIPS; ii++)
+  {
+    ruuvi_sensor_t* sensor = &sensors[ii];
+    // -40.00 C ... +85.00 C in steps that hit every hundredth of a degree over the sweep
+    sensor->temperature = -4000 + (int32_t)((ii * 3061) % 12501);
+    if(0 == ii % 64) { sensor->temperature = -((int32_t)ii % 100); }
+    sensor->humidity    = (uint32_t)((ii * 257) % (100 * 1024 + 1));
+    // 0xFFFF is the invalid marker of firmware and is encoded as 0 %RH
+    if(HUMIDITY_INVALID == sensor->humidity) { sensor->humidity--; }
+    sensor->pressure    = (uint32_t)(50000 + (ii * 7919) % 65536) << 8 | (ii & 0xFF);
+    sensor->accX        = accelerations[ii % n_accelerations];
+    sensor->accY        = accelerations[(ii / n_accelerations) % n_accelerations];
+    sensor->accZ        = (int16_t)(-(int32_t)sensor->accX);
+    sensor->vbat        = (uint16_t)(1600 + (ii * 13) % 2000);
+    encodeToRawFormat3(data[ii], sensor);
+    payloads[ii] = data[ii];
+    lengths[ii]  = SENSORTAG_ENCODED_DATA_LENGTH;
+  }
+
+  int failed = (RAW1_ROUND_TRIPS != ruuvi_decode_batch(&batch, payloads, lengths, RAW1_ROUND_TRIPS));
+  for(size_t ii = 0; !failed && ii < RAW1_ROUND_TRIPS; ii++)
+  {
+    const ruuvi_sensor_t* sensor = &sensors[ii];
+    if(batch.format[ii] != SENSOR_TAG_DATA_FORMAT ||
+       differs(batch.temperature[ii], (float)sensor->temperature * 0.01f, 0) ||
+       differs(batch.humidity[ii], (float)(sensor->humidity / 512) * 0.5f, 0) ||
+       differs(batch.pressure[ii], (float)(sensor->pressure >> 8), 0) ||
+       differs(batch.acceleration_x[ii], (float)sensor->accX * 0.001f, 0) ||
+       differs(batch.acceleration_y[ii], (float)sensor->accY * 0.001f, 0) ||
+       differs(batch.acceleration_z[ii], (float)sensor->accZ * 0.001f, 0) ||
+       differs(batch.voltage[ii], (float)sensor->vbat * 0.001f, 0))
+    {
+      fprintf(stderr, "RAWv1 payload %zu (temperature %d) does not round-trip\n", ii, (int)sensor->temperature);
+      failed = 1;
+    }
+  }
+  ruuvi_decoder_batch_uninit(&batch);
+  return failed;
+}
+
+typedef size_t (*packed_decoder_t)(ruuvi_decoded_batch_t*, const uint8_t*, size_t);
+
+static double benchmark(packed_decoder_t decoder, ruuvi_decoded_batch_t* batch, const uint8_t* data, size_t count)
+{
+  double best = 1e9;
+  for(int ii = 0; ii < ROUNDS; ii++)
+  {
+    ruuvi_decoder_batch_clear(batch);
+    double start = now();
+    decoder(batch, data, count);
+    double elapsed = now() - start;
+    if(elapsed < best) { best = elapsed; }
+  }
+  return count / best / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+  size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : DEFAULT_PAYLOADS;
+  uint8_t* data = malloc(count * RAW_2_ENCODED_DATA_LENGTH);
+  const uint8_t** payloads = malloc(count * sizeof(*payloads));
+  size_t* lengths = malloc(count * sizeof(*lengths));
+  ruuvi_decoded_batch_t reference, simd;
+  if(!data || !payloads || !lengths || ruuvi_decoder_batch_init(&reference, count) || ruuvi_decoder_batch_init(&simd, count))
+  {
+    fprintf(stderr, "Out of memory\n");
+    return 1;
+  }
+  generate_payloads(data, count);
+  for(size_t ii = 0; ii < count; ii++)
+  {
+    payloads[ii] = data + ii * RAW_2_ENCODED_DATA_LENGTH;
+    lengths[ii]  = RAW_2_ENCODED_DATA_LENGTH;
+  }
+
+  size_t decoded_reference = ruuvi_decode_raw2_packed_reference(&reference, data, count);
+  size_t decoded_simd = ruuvi_decode_raw2_packed(&simd, data, count);
+  if(decoded_reference != decoded_simd || compare_batches(&reference, &simd))
+  {
+    fprintf(stderr, "FAIL: SIMD and scalar decoders differ\n");
+    return 1;
+  }
+  printf("OK: %zu of %zu payloads decoded identically\n", decoded_simd, count);
+  if(compare_sensortag(&reference, data, count))
+  {
+    fprintf(stderr, "FAIL: scalar decoder and decodeRawFormat5 differ\n");
+    return 1;
+  }
+  printf("OK: scalar decoder agrees with decodeRawFormat5\n");
+  if(compare_raw1())
+  {
+    fprintf(stderr, "FAIL: RAWv1 decoder does not round-trip encodeToRawFormat3\n");
+    return 1;
+  }
+  printf("OK: RAWv1 decoder round-trips encodeToRawFormat3\n");
+
+  printf("scalar reference: %8.2f M payloads/s\n", benchmark(ruuvi_decode_raw2_packed_reference, &reference, data, count));
+  printf("packed RAWv2:     %8.2f M payloads/s\n", benchmark(ruuvi_decode_raw2_packed, &simd, data, count));
+  double best = 1e9;
+  for(int ii = 0; ii < ROUNDS; ii++)
+  {
+    ruuvi_decoder_batch_clear(&reference);
+    double start = now();
+    ruuvi_decode_batch(&reference, payloads, lengths, count);
+    double elapsed = now() - start;
+    if(elapsed < best) { best = elapsed; }
+  }
+  printf("mixed formats:    %8.2f M payloads/s\n", count / best / 1e6);
+
+  ruuvi_decoder_batch_uninit(&reference);
+  ruuvi_decoder_batch_uninit(&simd);
+  free(lengths);
+  free(payloads);
+  free(data);
+  return 0;
+}
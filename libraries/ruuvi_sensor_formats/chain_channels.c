@@ -1,6 +1,7 @@
 #include "chain_channels.h"
 #include "ruuvi_endpoints.h"
 #include "dsp.h"
+#include "spectrum.h"
 
 
 //TODO: Refactor had dependency to nRF52 scheduler out of library
@@ -34,9 +35,20 @@ static const app_timer_id_t* p_timers[] = {&ch0_timer, &ch1_timer, &ch2_timer, &
 #include "nrf_log_ctrl.h"
 
 static message_handler_state_t m_states[NUM_CHAIN_CHANNELS];
+static int32_t m_last_32[NUM_CHAIN_CHANNELS][2]; // Latest 32-bit values for channels without DSP filter
 static message_handler_state_t* p_state = NULL;
 static uint8_t m_chain_index = 0;
 
+/** Spectrum configuration of chain channel, DSP_FFT uses only first filter for selected value */
+typedef struct{
+  uint16_t sample_rate;  // Hz
+  uint8_t band_split;    // Hz, 0 for half of Nyquist frequency
+  uint8_t value_index;   // Upstream value to analyse
+  uint16_t new_samples;  // Samples since last transmission at DSP rate
+  uint32_t period_ns;    // Measured sample period of upstream from TIMESTAMP, 0 if not known
+}chain_fft_t;
+static chain_fft_t m_fft[NUM_CHAIN_CHANNELS];
+
 //TODO: Deduplicate
 static ret_code_t set_dsp(uint8_t dsp_function, uint8_t dsp_parameter)
 {
@@ -48,9 +60,10 @@ static ret_code_t set_dsp(uint8_t dsp_function, uint8_t dsp_parameter)
       p_state->configuration.dsp_parameter = 1; //TODO: Store n last samples?
       status = ENDPOINT_SUCCESS; 
       break;
+    case DSP_AVERAGE:
     case DSP_STDEV:
-      NRF_LOG_INFO("Setting up STDEV filtering for chain %d, parameter %d\r\n", m_chain_index, dsp_parameter);
-      p_state->configuration.dsp_function = DSP_STDEV;
+      NRF_LOG_INFO("Setting up DSP %d filtering for chain %d, parameter %d\r\n", dsp_function, m_chain_index, dsp_parameter);
+      p_state->configuration.dsp_function = dsp_function;
       p_state->configuration.dsp_parameter = dsp_parameter;
       for(size_t ii = 0; ii < MAX_DSP_STATES; ii++)
       {
@@ -60,6 +73,30 @@ static ret_code_t set_dsp(uint8_t dsp_function, uint8_t dsp_parameter)
         }
         p_state->dsp[ii] = dsp_init(dsp_function, dsp_parameter);
       }
+      status = ENDPOINT_SUCCESS;
+      break;
+
+    case DSP_FFT:
+      if(0 == m_fft[m_chain_index].sample_rate || 3 < m_fft[m_chain_index].value_index ||
+         DSP_FFT_MIN_LOG2 > dsp_parameter || DSP_FFT_MAX_LOG2 < dsp_parameter)
+      {
+        status = ENDPOINT_INVALID;
+        break;
+      }
+      NRF_LOG_INFO("Setting up %d point FFT for chain %d\r\n", 1 << dsp_parameter, m_chain_index);
+      p_state->configuration.dsp_function = dsp_function;
+      p_state->configuration.dsp_parameter = dsp_parameter;
+      for(size_t ii = 0; ii < MAX_DSP_STATES; ii++)
+      {
+        if(dsp_is_init(&(p_state->dsp[ii])))
+        {
+          dsp_uninit(&(p_state->dsp[ii]));
+        }
+      }
+      // Only one value is analysed, 2^dsp_parameter int16 samples
+      p_state->dsp[0] = dsp_init(dsp_function, dsp_parameter);
+      m_fft[m_chain_index].new_samples = 0;
+      status = ENDPOINT_SUCCESS;
       break;
 
     default: 
@@ -68,6 +105,27 @@ static ret_code_t set_dsp(uint8_t dsp_function, uint8_t dsp_parameter)
   return status;
 }
 
+/**
+ *  Convert sample rate of chain configuration to Hz, rates above CHAIN_SAMPLE_RATE_HZ_MAX
+ *  are sent in steps of CHAIN_SAMPLE_RATE_STEP_HZ.
+ */
+static uint16_t sample_rate_hz(const uint8_t sample_rate)
+{
+  if(CHAIN_SAMPLE_RATE_HZ_MAX >= sample_rate) { return sample_rate; }
+  return CHAIN_SAMPLE_RATE_HZ_MAX + (sample_rate - CHAIN_SAMPLE_RATE_HZ_MAX) * CHAIN_SAMPLE_RATE_STEP_HZ;
+}
+
+/**
+ *  Store spectrum configuration of chain channel, used if DSP function is DSP_FFT.
+ */
+static void set_fft(const ruuvi_chain_configuration_t* const config)
+{
+  m_fft[m_chain_index].sample_rate = sample_rate_hz(config->sample_rate);
+  m_fft[m_chain_index].band_split  = config->band_split;
+  m_fft[m_chain_index].value_index = config->value_index;
+  m_fft[m_chain_index].period_ns   = 0;
+}
+
 /** 
  *  Setup targets to which data will be sent. 
  *  Note: Chaining is done separately.
@@ -116,6 +174,7 @@ static ret_code_t set_target(uint8_t target)
 static ret_code_t set_transmission_rate(const uint8_t rate)
 {
   ret_code_t err_code = ENDPOINT_SUCCESS;
+  p_state->configuration.transmission_rate = rate;
   if(TRANSMISSION_RATE_STOP == rate)
   {
     p_state->p_chain_handler = NULL;
@@ -185,6 +244,7 @@ static ret_code_t configure_chain_upstream(const ruuvi_standard_message_t messag
   NRF_LOG_DEBUG("Transmission rate\r\n");
   result.transmission_rate = set_transmission_rate(payload->transmission_rate);
   NRF_LOG_DEBUG("DSP\r\n");
+  set_fft(payload);
   result.dsp_function = set_dsp(payload->dsp_function, payload->dsp_parameter);
   NRF_LOG_DEBUG("Target %d\r\n", payload->target);
   result.target = set_target(payload->target);
@@ -213,6 +273,35 @@ static ret_code_t configure_chain_upstream(const ruuvi_standard_message_t messag
   return err_code; //Error codes from configuration are in payload of reply
 }
 
+/** Round float to int16, saturating at limits */
+static int16_t saturate_i16(const float value)
+{
+  if(value >= INT16_MAX) { return INT16_MAX; }
+  if(value <= INT16_MIN) { return INT16_MIN; }
+  return (int16_t)lroundf(value);
+}
+
+/**
+ *  Read spectrum features of FFT channel.
+ *  Peak frequency is in 0.1 Hz, amplitude and RMS in upstream units.
+ */
+static void read_fft_i16(int16_t* const values)
+{
+  const chain_fft_t* const p_fft = &(m_fft[m_chain_index]);
+  // Measured rate corrects frequencies for ODR error of upstream sensor
+  const float sample_rate = p_fft->period_ns ? 1e9f / p_fft->period_ns : p_fft->sample_rate;
+  const float nyquist = sample_rate / 2.0f;
+  const float split = (0 == p_fft->band_split) ? nyquist / 2 : p_fft->band_split;
+  const float band_edges[DSP_FFT_BANDS + 1] = {0.0f, split, nyquist};
+  dsp_fft_features_t features = {0};
+  dsp_filter_t* p_filter = &(p_state->dsp[0]);
+  dsp_read_fft_features(&(p_filter->z), p_filter->dsp_parameter, sample_rate, band_edges, &features);
+  values[0] = saturate_i16(features.peak_frequency * 10);
+  values[1] = saturate_i16(features.peak_amplitude);
+  values[2] = saturate_i16(features.band_rms[0]);
+  values[3] = saturate_i16(features.band_rms[1]);
+}
+
 /**
  *  Read current DSP value and transmit it onwards.
  */
@@ -220,7 +309,8 @@ static ret_code_t read_value_i16(const ruuvi_standard_message_t message)
 {
   ret_code_t err_code = ENDPOINT_SUCCESS;
   int16_t values[4];
-  for(size_t ii = 0; ii < 4; ii++)
+  if(DSP_FFT == p_state->configuration.dsp_function) { read_fft_i16(values); }
+  for(size_t ii = 0; ii < 4 && DSP_FFT != p_state->configuration.dsp_function; ii++)
   {
     NRF_LOG_DEBUG("Processing DSP CH %d\r\n", ii);
     dsp_filter_t* p_filter = &(p_state->dsp[ii]);
@@ -241,6 +331,32 @@ static ret_code_t read_value_i16(const ruuvi_standard_message_t message)
 
 
 
+/**
+ *  Read current DSP value of 32-bit data and transmit it onwards.
+ *  Type of transmitted data is type of received data, INT32 or UINT32.
+ */
+static ret_code_t read_value_32(const ruuvi_standard_message_t message)
+{
+  int32_t values[2];
+  for(size_t ii = 0; ii < 2; ii++)
+  {
+    dsp_filter_t* p_filter = &(p_state->dsp[ii]);
+    if(dsp_is_init(p_filter))
+    {
+      float next = p_filter->read(&(p_filter->z), p_filter->dsp_parameter);
+      values[ii] = (UINT32 == p_state->data_type) ? (int32_t)(uint32_t)next : (int32_t)next;
+    }
+    else { values[ii] = m_last_32[m_chain_index][ii]; }
+  }
+
+  ruuvi_standard_message_t reply = {.destination_endpoint = message.destination_endpoint,
+                                    .source_endpoint = (m_chain_index + ENDPOINT_CHAIN_OFFSET),
+                                    .type = p_state->data_type,
+                                    .payload = { 0 }};
+  memcpy(reply.payload, values, sizeof(reply.payload));
+  return transmit(reply);
+}
+
 /**
  *  Configure this endpoint as a downstream endpoint, i.e. receiver of data.
  *  Upstream must be configured separately to send data to this endpoint.
@@ -281,6 +397,25 @@ static ret_code_t process_i16(const ruuvi_standard_message_t message)
 {
   int16_t values[4];
   memcpy(values, message.payload, sizeof(message.payload));
+  if(DSP_FFT == p_state->configuration.dsp_function)
+  {
+    chain_fft_t* const p_fft = &(m_fft[m_chain_index]);
+    dsp_filter_t* p_filter = &(p_state->dsp[0]);
+    if(!dsp_is_init(p_filter)) { return ENDPOINT_HANDLER_ERROR; }
+    p_filter->process(&(p_filter->z), p_filter->dsp_parameter, values[p_fft->value_index]);
+    // Transmit once per block of new samples at DSP rate
+    if(TRANSMISSION_RATE_DSPRATE == p_state->configuration.transmission_rate &&
+       ++(p_fft->new_samples) >= (1 << p_filter->dsp_parameter))
+    {
+      p_fft->new_samples = 0;
+      read_value_i16(message);
+    }
+    else if(TRANSMISSION_RATE_SAMPLERATE == p_state->configuration.transmission_rate)
+    {
+      read_value_i16(message);
+    }
+    return NRF_SUCCESS;
+  }
   for(size_t ii = 0; ii < 4; ii++)
   {
     NRF_LOG_DEBUG("Processing DSP CH %d\r\n", ii);
@@ -298,6 +433,40 @@ static ret_code_t process_i16(const ruuvi_standard_message_t message)
   return NRF_SUCCESS;
 }
 
+/**
+ * Call DSP function for both 32-bit values of message.
+ */
+static ret_code_t process_32(const ruuvi_standard_message_t message)
+{
+  int32_t values[2];
+  memcpy(values, message.payload, sizeof(message.payload));
+  p_state->data_type = message.type;
+  for(size_t ii = 0; ii < 2; ii++)
+  {
+    float next = (UINT32 == message.type) ? (float)(uint32_t)values[ii] : (float)values[ii];
+    dsp_filter_t* p_filter = &(p_state->dsp[ii]);
+    if(dsp_is_init(p_filter)) { p_filter->process(&(p_filter->z), p_filter->dsp_parameter, next); }
+    m_last_32[m_chain_index][ii] = values[ii];
+  }
+  //If we were configured to transmit each sample, trigger transmission now
+  if(TRANSMISSION_RATE_SAMPLERATE == p_state->configuration.transmission_rate)
+  {
+    read_value_32(message);
+  }
+  return NRF_SUCCESS;
+}
+
+/**
+ *  Store measured sample period of upstream batch.
+ */
+static ret_code_t process_timestamp(const ruuvi_standard_message_t message)
+{
+  ruuvi_timestamp_payload_t timestamp;
+  memcpy(&timestamp, message.payload, sizeof(timestamp));
+  m_fft[m_chain_index].period_ns = timestamp.period_ns;
+  return ENDPOINT_SUCCESS;
+}
+
 /**
  *  Handles incoming messages.
  */
@@ -346,8 +515,17 @@ ret_code_t chain_handler(const ruuvi_standard_message_t message)
     //TODO: Separate function for handling data types?
     case INT16:
       NRF_LOG_DEBUG("Processing I16\r\n");
+      p_state->data_type = INT16;
       return process_i16(message);
 
+    case INT32:
+    case UINT32:
+      NRF_LOG_DEBUG("Processing 32-bit data\r\n");
+      return process_32(message);
+
+    case TIMESTAMP:
+      return process_timestamp(message);
+
     default:
       return unknown_handler(message);
   }
@@ -370,10 +548,10 @@ static void chain_transmission_handler(void *p_context)
   m_chain_index = ii;
   ruuvi_standard_message_t message = {.destination_endpoint = p_state->destination_endpoint,
                                       .source_endpoint = (m_chain_index + ENDPOINT_CHAIN_OFFSET),
-                                      .type = INT16,
-                                      .payload = { 0 }};    
-  //XXX generalise                                    
-  read_value_i16(message);
+                                      .type = p_state->data_type,
+                                      .payload = { 0 }};
+  if(INT32 == p_state->data_type || UINT32 == p_state->data_type) { read_value_32(message); }
+  else { read_value_i16(message); }
 }
 
 /**
@@ -1,5 +1,6 @@
 #include "ruuvi_endpoints.h"
 #include "chain_channels.h"
+#include "probe.h"
 
 #define NRF_LOG_MODULE_NAME "ENDPOINTS"
 #include "nrf_log.h"
@@ -9,6 +10,8 @@
 static message_handler p_battery_handler           = NULL;
 static message_handler p_rng_handler               = NULL;
 static message_handler p_rtc_handler               = NULL;
+static message_handler p_scheduler_handler         = NULL;
+static message_handler p_counters_handler          = NULL;
 static message_handler p_temperature_handler       = NULL;
 static message_handler p_humidity_handler          = NULL;
 static message_handler p_pressure_handler          = NULL;
@@ -47,6 +50,7 @@ void ble_gatt_scheduler_event_handler(void *p_event_data, uint16_t event_size)
  **/
 void route_message(const ruuvi_standard_message_t message)
 {
+    PROBE_START(PROBE_ROUTE_MESSAGE);
     NRF_LOG_INFO("Routing message. %x, %x, %x, \r\n",message.destination_endpoint, message.source_endpoint, message.type);
     switch(message.destination_endpoint)
     {
@@ -69,6 +73,16 @@ void route_message(const ruuvi_standard_message_t message)
         else {unknown_handler(message); }
         break;
 
+      case SCHEDULER:
+        if(p_scheduler_handler) {p_scheduler_handler(message); } 
+        else {unknown_handler(message); }
+        break;
+
+      case COUNTERS:
+        if(p_counters_handler) {p_counters_handler(message); } 
+        else {unknown_handler(message); }
+        break;
+
       case TEMPERATURE:
         NRF_LOG_DEBUG("Message is a temperature message.\r\n");
         if(p_temperature_handler) {p_temperature_handler(message); } 
@@ -129,6 +143,27 @@ void route_message(const ruuvi_standard_message_t message)
         }
         break;
     }
+    PROBE_STOP(PROBE_ROUTE_MESSAGE);
+}
+
+void set_battery_handler(message_handler handler)
+{
+  p_battery_handler = handler;
+}
+
+void set_rtc_handler(message_handler handler)
+{
+  p_rtc_handler = handler;
+}
+
+void set_scheduler_handler(message_handler handler)
+{
+  p_scheduler_handler = handler;
+}
+
+void set_counters_handler(message_handler handler)
+{
+  p_counters_handler = handler;
 }
 
 void set_temperature_handler(message_handler handler)
@@ -136,6 +171,16 @@ void set_temperature_handler(message_handler handler)
   p_temperature_handler = handler;
 }
 
+void set_humidity_handler(message_handler handler)
+{
+  p_humidity_handler = handler;
+}
+
+void set_pressure_handler(message_handler handler)
+{
+  p_pressure_handler = handler;
+}
+
 void set_acceleration_handler(message_handler handler)
 {
   p_acceleration_handler = handler;
@@ -14,6 +14,8 @@ typedef enum{
   RNG                     = 0x21, // Random number
   RTC                     = 0x22, // Real time clock 
   NFC                     = 0x23, // NFC message
+  SCHEDULER               = 0x24, // Scheduler execution time profile
+  COUNTERS                = 0x25, // Event counters since boot
   TEMPERATURE             = 0x31, // Temperature message
   HUMIDITY                = 0x32,
   PRESSURE                = 0x33,
@@ -90,6 +92,7 @@ typedef enum {
   DSP_IMPULSE   = 6,
   DSP_LOW_PASS  = 7,
   DSP_HIGH_PASS = 8,
+  DSP_FFT       = 9,  // Spectrum of 2^parameter samples, parameter 4 ... 8
   DSP_VECTOR    = 128
 }ruuvi_dsp_function_t;
 
@@ -129,6 +132,10 @@ typedef struct __attribute__((packed)){
   uint8_t reserved;
 }ruuvi_sensor_configuration_t;
 
+// Chain sample rate is in Hz up to CHAIN_SAMPLE_RATE_HZ_MAX, in CHAIN_SAMPLE_RATE_STEP_HZ steps above it
+#define CHAIN_SAMPLE_RATE_HZ_MAX  200
+#define CHAIN_SAMPLE_RATE_STEP_HZ 10
+
 /**
  *  Configure chained channel with given upstream.
  *  Usage example: both latest and high passed acceleration is wanted.
@@ -137,16 +144,24 @@ typedef struct __attribute__((packed)){
  *  ACCELERATION will transmit *AFTER* its own dsp function the samples to chained channel. The samples are sent at sample
  *  rate of master channel.
  *  Chained channel will transmit the samples to next chained channel after DSP, and to data handlers at a rate given by transmit speed.
+ *
+ *  DSP_FFT analyses one upstream value and transmits INT16 peak frequency in 0.1 Hz, peak amplitude and RMS of
+ *  the low and high bands in upstream units. TRANSMISSION_RATE_DSPRATE transmits once per block of new samples.
+ *
+ *  sample_rate does not fit rates above 255 Hz as such. Values up to CHAIN_SAMPLE_RATE_HZ_MAX are in Hz,
+ *  values above it are in steps of CHAIN_SAMPLE_RATE_STEP_HZ above that, i.e. 201 is 210 Hz, 220 is 400 Hz
+ *  and 255 is 750 Hz. Senders round rates between steps to nearest step, measured period of upstream from
+ *  TIMESTAMP replaces configured rate once it is known.
  */
 typedef struct __attribute__((packed)){
   uint8_t upstream_endpoint;
   uint8_t transmission_rate; // Stop chained transmissions if TRANSMISSION_RATE_0
-  uint8_t reserved0; // Scale, resolution are defined by master
-  uint8_t reserved1;
+  uint8_t sample_rate; // Sample rate of upstream, used by DSP_FFT. Hz up to 200, 10 Hz steps above, see above
+  uint8_t band_split;  // DSP_FFT: Split between RMS bands in Hz, 0 for half of Nyquist frequency
   uint8_t dsp_function;
   uint8_t dsp_parameter;
   uint8_t target;
-  uint8_t reserved2;
+  uint8_t value_index; // DSP_FFT: Index of upstream value to analyse, 0 ... 3
 }ruuvi_chain_configuration_t;
 
 typedef struct __attribute__((packed)){
@@ -156,6 +171,24 @@ typedef struct __attribute__((packed)){
   uint8_t payload[8];
 }ruuvi_standard_message_t;
 
+/**
+ *  Payload of TIMESTAMP message. Sent before a batch of samples, sample i of the batch
+ *  was taken at time_ms + i * period_ns / 1e6. Chain channels use period for DSP.
+ *  Time is Unix time if tag has been synchronised over RTC endpoint, else time since boot.
+ */
+typedef struct __attribute__((packed)){
+  uint32_t time_ms;   // Time of first sample, lowest 32 bits of ms. Wraps at 49 days
+  uint32_t period_ns; // Measured sample period
+}ruuvi_timestamp_payload_t;
+
+/**
+ *  Payload of RTC endpoint status, reply to STATUS_QUERY and to synchronisation.
+ */
+typedef struct __attribute__((packed)){
+  uint32_t sync_age_s; // Seconds since latest synchronisation, 0xFFFFFFFF if not synchronised
+  int32_t  drift_ppb;  // Estimated drift of RTC, positive if RTC is slow
+}ruuvi_rtc_status_payload_t;
+
 // Declare message handler type
 typedef ret_code_t(*message_handler)(const ruuvi_standard_message_t);
 
@@ -175,6 +208,7 @@ typedef struct {
   uint8_t downstream_endpoint; // Use UINT8_t to allow dynamic endpoint selection
 
 /** State variables **/
+  uint8_t data_type; // Type of latest data processed, ruuvi_message_type_t
   ruuvi_sensor_configuration_t configuration;
   ruuvi_endpoint_t destination_endpoint;
   dsp_filter_t dsp[MAX_DSP_STATES];
@@ -188,7 +222,13 @@ void route_message(const ruuvi_standard_message_t message);
 ret_code_t unknown_handler(const ruuvi_standard_message_t message);
 
 // Peripheral handlers
+void set_battery_handler(message_handler handler);
+void set_rtc_handler(message_handler handler);
+void set_scheduler_handler(message_handler handler);
+void set_counters_handler(message_handler handler);
 void set_temperature_handler(message_handler handler);
+void set_humidity_handler(message_handler handler);
+void set_pressure_handler(message_handler handler);
 void set_acceleration_handler(message_handler handler);
 void set_mam_handler(message_handler handler);
 void set_unknown_handler(message_handler handler);
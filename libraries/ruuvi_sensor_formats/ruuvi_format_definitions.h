@@ -0,0 +1,67 @@
+#ifndef RUUVI_FORMAT_DEFINITIONS_H
+#define RUUVI_FORMAT_DEFINITIONS_H
+
+/**
+ *  Definitions of Ruuvi data formats shared by firmware encoders and host-side decoders.
+ *  Must not depend on nRF SDK or drivers.
+ */
+
+/*
+0:   uint8_t     format;          // (0x03 = realtime sensor readings base64)
+1:   uint8_t     humidity;        // one lsb is 0.5%
+2-3: uint16_t    temperature;     // Signed 8.8 fixed-point notation.
+4-5: uint16_t    pressure;        // (-50kPa)
+6-7:   int16_t   acceleration_x;  // mg
+8-9:   int16_t   acceleration_y;  // mg
+10-11: int16_t   acceleration_z;  // mg
+12-13: int16_t   vbat;            // mv
+*/
+#define SENSOR_TAG_DATA_FORMAT          0x03				  /**< raw binary, includes acceleration */
+#define SENSORTAG_ENCODED_DATA_LENGTH   14            /**< 14 bytes  */
+
+/*
+0:     uint8_t   format;          // (0x05 = RAWv2)
+1-2:   int16_t   temperature;     // 0.005 C
+3-4:   uint16_t  humidity;        // 0.0025 %
+5-6:   uint16_t  pressure;        // Pa, -50 kPa
+7-8:   int16_t   acceleration_x;  // mg
+9-10:  int16_t   acceleration_y;  // mg
+11-12: int16_t   acceleration_z;  // mg
+13-14: uint16_t  power_info;      // 11 bits battery voltage mv -1600, 5 bits tx power dBm (+40) / 2
+15:    uint8_t   movement_counter;
+16-17: uint16_t  measurement_sequence;
+18-23: uint8_t   mac[6];
+*/
+#define RAW_FORMAT_2                    0x05          /**< Proposal, please see https://f.ruuvi.com/t/proposed-next-high-precision-data-format/692 */
+#define RAW_2_ENCODED_DATA_LENGTH       24
+
+// Invalid values for data
+#define TEMPERATURE_INVALID       -0x8000
+#define HUMIDITY_INVALID          0xFFFF
+#define PRESSURE_INVALID          0xFFFF
+#define ACCELERATION_INVALID      -0x8000
+#define RAW2_TEMPERATURE_INVALID  TEMPERATURE_INVALID
+#define RAW2_HUMIDITY_INVALID     HUMIDITY_INVALID
+#define RAW2_PRESSURE_INVALID     PRESSURE_INVALID
+#define RAW2_ACCELERATION_INVALID ACCELERATION_INVALID
+#define RAW1_TEMPERATURE_INVALID  0
+#define RAW1_HUMIDITY_INVALID     0
+#define RAW1_PRESSURE_INVALID     0
+#define RAW1_ACCELERATION_INVALID 0
+
+// RAWv2 field ranges. Values outside valid range saturate, the topmost code is reserved as invalid.
+#define RAW2_TEMPERATURE_MAX      0x7FFF       // 163.835 C
+#define RAW2_TEMPERATURE_MIN      -0x7FFF      // -163.835 C
+#define RAW2_HUMIDITY_MAX         0xFFFE       // 163.835 %
+#define RAW2_PRESSURE_MAX         0xFFFE       // 115534 Pa
+#define RAW2_VOLTAGE_OFFSET       1600         // mV
+#define RAW2_VOLTAGE_MAX          0x7FE        // 3646 mV
+#define RAW2_VOLTAGE_INVALID      0x7FF
+#define RAW2_TX_POWER_OFFSET      40           // dBm
+#define RAW2_TX_POWER_MAX         0x1E         // +20 dBm
+#define RAW2_TX_POWER_INVALID     0x1F
+#define RAW2_MAC_OFFSET           18           // Index of MAC address in encoded data
+#define RAW2_MAC_LENGTH           6
+#define RAW_PRESSURE_OFFSET       50000        // Pa, subtracted from pressure in both formats
+
+#endif
@@ -4,74 +4,158 @@
 #include "sensortag.h"
 
 #include <stdint.h>
-#include "nrf52.h"
-#include "nrf52_bitfields.h"
+#include <string.h>
 
 #include "base64.h"
+#include "probe.h"
 
-#define NRF_LOG_MODULE_NAME "SENSORLIB"
-#include "nrf_log.h"
-#include "nrf_log_ctrl.h"
+// Constant bytes of RAWv2 data, copied into each encoded buffer.
+static uint8_t raw5_mac[RAW2_MAC_LENGTH] = { 0 };
+static bool raw5_initialized = false;
+
+/** Saturate value into [min, max]. Compiles into conditional selects, no branches. */
+static inline int32_t saturate(int32_t value, int32_t min, int32_t max)
+{
+  value = (value < min) ? min : value;
+  return (value > max) ? max : value;
+}
+
+/** Select invalid if condition is true, value otherwise, by masking */
+static inline uint32_t select_invalid(bool invalid, uint32_t value, uint32_t invalid_value)
+{
+  uint32_t mask = 0 - (uint32_t)invalid;
+  return (value & ~mask) | (invalid_value & mask);
+}
 
 /**
- *  Parses sensor values into propesed format. 
- *  Note: calling this function has side effect of incrementing packet counter
- *  Changes values in "environmental" as they're paresed to ruuvi format
+ *  Reads the device address once and stores the bytes which are constant in every RAWv2 packet.
  *
- *  @param data_buffer uint8_t array with length of 24 bytes
- *  @param environmental  Environmental data as data comes from BME280, i.e. uint32_t pressure, int32_t temperature, uint32_t humidity
- *  @param acceleration 3 x int16_t having acceleration along X-Y-Z axes in MG. Low pass and last sample are allowed DSP operations
- *  @param acceleration_events counter of acceleration events. Events are configured by application, "value exceeds 1.1 G" recommended.
- *  @param vbatt Voltage of battery in millivolts
- *  @param tx_pwr power in dBm, -40 ... 16
+ *  @param mac 6 bytes of MAC address, MSB first. NULL to use device address of nRF52.
+ */
+void initRawFormat5(const uint8_t* const mac)
+{
+  if(NULL != mac)
+  {
+    memcpy(raw5_mac, mac, sizeof(raw5_mac));
+  }
+  else
+  {
+    sensortag_device_address(raw5_mac);
+  }
+  raw5_initialized = true;
+}
+
+/**
+ *  Parses sensor values into RAWv2 without side effects.
+ *  Every field is computed unconditionally and invalid values are selected with masks, out-of-range
+ *  values saturate to the limits of the format instead of wrapping.
  *
+ *  @param data_buffer uint8_t array with length of 24 bytes
+ *  @param data sensor values to encode
+ *  @param acceleration_events counter of acceleration events, encoded modulo 256.
+ *  @param tx_pwr power in dBm, -40 ... 20. INT8_MIN is encoded as invalid.
+ *  @param measurement_sequence sequence number of measurement, incremented by caller.
  */
-void encodeToRawFormat5(uint8_t* data_buffer, const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr)
+void encodeToRawFormat5Sequence(uint8_t* data_buffer, const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr, uint16_t measurement_sequence)
 {
-    static uint32_t packet_counter = 0;
+    PROBE_START(PROBE_ENCODE_RAW5);
     data_buffer[0] = RAW_FORMAT_2;
-    int32_t temperature = data->temperature;
-    temperature *= 2; //Spec calls for 0.005 degree resolution, bme280 gives 0.01
-    if(data->temperature == TEMPERATURE_INVALID) { temperature = TEMPERATURE_INVALID; }
+    //Spec calls for 0.005 degree resolution, bme280 gives 0.01
+    int32_t temperature = saturate(data->temperature * 2, RAW2_TEMPERATURE_MIN, RAW2_TEMPERATURE_MAX);
+    temperature = select_invalid(TEMPERATURE_INVALID == data->temperature, temperature, RAW2_TEMPERATURE_INVALID);
     data_buffer[1] = (temperature)>>8;
     data_buffer[2] = (temperature)&0xFF;
-    // Humidity is reported as 1/ 400 as per spec.
-    uint32_t humidity = data->humidity * 400 / 1024;
-    if(data->humidity == HUMIDITY_INVALID) { humidity = HUMIDITY_INVALID; }
+    // Humidity is reported as 1/ 400 as per spec. x * 400 / 1024 == x * 25 / 64.
+    uint32_t humidity = (data->humidity * 25) >> 6;
+    humidity = (humidity > RAW2_HUMIDITY_MAX) ? RAW2_HUMIDITY_MAX : humidity;
+    humidity = select_invalid(HUMIDITY_INVALID == data->humidity, humidity, RAW2_HUMIDITY_INVALID);
     data_buffer[3] = humidity>>8;
     data_buffer[4] = humidity&0xFF;
-    NRF_LOG_DEBUG("Humidity is %d\r\n", humidity/400);
-    uint32_t pressure = data->pressure;
-    pressure = (uint16_t)((pressure >> 8) - 50000); //Scale into pa, Shift by -50000 pa as per Ruu.vi interface.
-    if(data->pressure == PRESSURE_INVALID) { pressure = PRESSURE_INVALID; }
+    //Scale into pa, Shift by -50000 pa as per Ruu.vi interface.
+    int32_t pressure = saturate((int32_t)(data->pressure >> 8) - RAW_PRESSURE_OFFSET, 0, RAW2_PRESSURE_MAX);
+    pressure = select_invalid(PRESSURE_INVALID == data->pressure, pressure, RAW2_PRESSURE_INVALID);
     data_buffer[5] = (pressure)>>8;
     data_buffer[6] = (pressure)&0xFF;
+    // Invalid acceleration has same representation in ruuvi_sensor_t and RAWv2
     data_buffer[7] = (data->accX)>>8;
     data_buffer[8] = (data->accX)&0xFF;
     data_buffer[9] = (data->accY)>>8;
     data_buffer[10] = (data->accY)&0xFF;
     data_buffer[11] = (data->accZ)>>8;
     data_buffer[12] = (data->accZ)&0xFF;
-    //Bit-shift vbatt by 4 to fit TX PWR in
-    uint16_t vbatt = data->vbat;
-    vbatt -= 1600; //Bias by 1600 mV
-    vbatt <<= 5;   //Shift by 5 to fit TX PWR in
-    data_buffer[13] = (vbatt)>>8;
-    data_buffer[14] = (vbatt)&0xFF; //Zeroes tx-pwr bits
-    tx_pwr += 40;
-    tx_pwr /= 2;
-    data_buffer[14] |= (tx_pwr)&0x1F; //5 lowest bits for TX pwr
-    data_buffer[15] = acceleration_events % 256; // 0 may indicate a multiple of 256 events, not necessarily no events
-    data_buffer[16] = packet_counter>>8;
-    data_buffer[17] = packet_counter&0xFF;
-    packet_counter++;
-    data_buffer[18] = ((NRF_FICR->DEVICEADDR[1]>>8)&0xFF) | 0xC0; //2 MSB must be 11;
-    data_buffer[19] = ((NRF_FICR->DEVICEADDR[1]>>0)&0xFF);
-    data_buffer[20] = ((NRF_FICR->DEVICEADDR[0]>>24)&0xFF);
-    data_buffer[21] = ((NRF_FICR->DEVICEADDR[0]>>16)&0xFF);
-    data_buffer[22] = ((NRF_FICR->DEVICEADDR[0]>>8)&0xFF);
-    data_buffer[23] = ((NRF_FICR->DEVICEADDR[0]>>0)&0xFF);
+    //Bias vbatt by 1600 mV, shift by 5 to fit TX PWR in
+    uint32_t vbatt = saturate((int32_t)data->vbat - RAW2_VOLTAGE_OFFSET, 0, RAW2_VOLTAGE_MAX);
+    vbatt = select_invalid(0 == data->vbat, vbatt, RAW2_VOLTAGE_INVALID);
+    uint32_t power = saturate(tx_pwr + RAW2_TX_POWER_OFFSET, 0, 2 * RAW2_TX_POWER_MAX) >> 1;
+    power = select_invalid(INT8_MIN == tx_pwr, power, RAW2_TX_POWER_INVALID);
+    uint32_t power_info = (vbatt << 5) | power;
+    data_buffer[13] = power_info>>8;
+    data_buffer[14] = power_info&0xFF;
+    data_buffer[15] = acceleration_events & 0xFF; // 0 may indicate a multiple of 256 events, not necessarily no events
+    data_buffer[16] = measurement_sequence>>8;
+    data_buffer[17] = measurement_sequence&0xFF;
+    memcpy(&data_buffer[RAW2_MAC_OFFSET], raw5_mac, sizeof(raw5_mac));
+    PROBE_STOP(PROBE_ENCODE_RAW5);
+}
+
+/**
+ *  Parses sensor values into propesed format. 
+ *  Note: calling this function has side effect of incrementing packet counter
+ *  Kept for compatibility, prefer encodeToRawFormat5Sequence.
+ *
+ *  @param data_buffer uint8_t array with length of 24 bytes
+ *  @param data sensor values to encode
+ *  @param acceleration_events counter of acceleration events. Events are configured by application, "value exceeds 1.1 G" recommended.
+ *  @param tx_pwr power in dBm, -40 ... 16
+ *
+ */
+void encodeToRawFormat5(uint8_t* data_buffer, const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr)
+{
+    static uint16_t packet_counter = 0;
+    if(!raw5_initialized) { initRawFormat5(NULL); }
+    encodeToRawFormat5Sequence(data_buffer, data, acceleration_events, tx_pwr, packet_counter++);
+}
+
+/**
+ *  Parses RAWv2 data back into sensor values.
+ *  Humidity is rounded up so that encoding the decoded value yields the original bytes.
+ *  Odd temperatures are rounded away from zero, saturated -32767 decodes into -16384 which
+ *  saturates back to -32767. Other odd temperatures re-encode as the next even value.
+ *
+ *  @param data_buffer uint8_t array with length of 24 bytes
+ *  @param data sensor values to fill
+ *  @param acceleration_events movement counter, may be NULL
+ *  @param tx_pwr power in dBm, INT8_MIN if invalid. May be NULL
+ *  @param measurement_sequence sequence number of measurement, may be NULL
+ *  @return false if data is not RAWv2, true otherwise
+ */
+bool decodeRawFormat5(const uint8_t* const data_buffer, ruuvi_sensor_t* const data, uint8_t* const acceleration_events, int8_t* const tx_pwr, uint16_t* const measurement_sequence)
+{
+  if(RAW_FORMAT_2 != data_buffer[0]) { return false; }
+  data->format = RAW_FORMAT_2;
+
+  int16_t temperature = (data_buffer[1]<<8) | data_buffer[2];
+  int32_t rounded = (temperature < 0) ? (temperature - 1) / 2 : (temperature + 1) / 2;
+  data->temperature = (RAW2_TEMPERATURE_INVALID == temperature) ? TEMPERATURE_INVALID : rounded;
+
+  uint32_t humidity = (data_buffer[3]<<8) | data_buffer[4];
+  data->humidity = (RAW2_HUMIDITY_INVALID == humidity) ? HUMIDITY_INVALID : (humidity * 64 + 24) / 25;
+
+  uint32_t pressure = (data_buffer[5]<<8) | data_buffer[6];
+  data->pressure = (RAW2_PRESSURE_INVALID == pressure) ? PRESSURE_INVALID : (pressure + RAW_PRESSURE_OFFSET) << 8;
+
+  data->accX = (int16_t)((data_buffer[7]<<8)  | data_buffer[8]);
+  data->accY = (int16_t)((data_buffer[9]<<8)  | data_buffer[10]);
+  data->accZ = (int16_t)((data_buffer[11]<<8) | data_buffer[12]);
 
+  uint16_t power_info = (data_buffer[13]<<8) | data_buffer[14];
+  uint16_t vbatt = power_info >> 5;
+  uint8_t  power = power_info & 0x1F;
+  data->vbat = (RAW2_VOLTAGE_INVALID == vbatt) ? 0 : vbatt + RAW2_VOLTAGE_OFFSET;
+  if(NULL != tx_pwr)               { *tx_pwr = (RAW2_TX_POWER_INVALID == power) ? INT8_MIN : (power * 2) - RAW2_TX_POWER_OFFSET; }
+  if(NULL != acceleration_events)  { *acceleration_events = data_buffer[15]; }
+  if(NULL != measurement_sequence) { *measurement_sequence = (data_buffer[16]<<8) | data_buffer[17]; }
+  return true;
 }
 
 /**
@@ -129,7 +213,7 @@ void encodeToUrlDataFromat(char* url, uint8_t base_length, ruuvi_sensor_t* data)
 
 
     //Create pseudo-unique name
-    unsigned int mac0 =  NRF_FICR->DEVICEID[0];
+    unsigned int mac0 =  sensortag_device_id();
     uint8_t serial[2];
     serial[0] = mac0      & 0xFF;
     serial[1] = (mac0>>8) & 0xFF;
@@ -4,24 +4,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-#include "bme280.h"
-#include "lis2dh12.h"
-
-/*
-0:   uint8_t     format;          // (0x03 = realtime sensor readings base64)
-1:   uint8_t     humidity;        // one lsb is 0.5%
-2-3: uint16_t    temperature;     // Signed 8.8 fixed-point notation.
-4-5: uint16_t    pressure;        // (-50kPa)
-6-7:   int16_t   acceleration_x;  // mg
-8-9:   int16_t   acceleration_y;  // mg
-10-11: int16_t   acceleration_z;  // mg
-12-13: int16_t   vbat;            // mv
-*/
-#define SENSOR_TAG_DATA_FORMAT          0x03				  /**< raw binary, includes acceleration */
-#define SENSORTAG_ENCODED_DATA_LENGTH   14            /**< 14 bytes  */
-
-#define RAW_FORMAT_2                    0x05          /**< Proposal, please see https://f.ruuvi.com/t/proposed-next-high-precision-data-format/692 */
-#define RAW_2_ENCODED_DATA_LENGTH       24
+#include "ruuvi_format_definitions.h"
 
 #define WEATHER_STATION_URL_FORMAT      0x02				  /**< Base64 */
 #define WEATHER_STATION_URL_ID_FORMAT   0x04				  /**< Base64, with ID byte */
@@ -31,20 +14,6 @@
 
 #define URL_BASE_MAX_LENGTH (EDDYSTONE_URL_MAX_LENGTH - URL_PAYLOAD_LENGTH)
 
-// Invalid values for data
-#define TEMPERATURE_INVALID       -0x8000
-#define HUMIDITY_INVALID          0xFFFF
-#define PRESSURE_INVALID          0xFFFF
-#define ACCELERATION_INVALID      -0x8000
-#define RAW2_TEMPERATURE_INVALID  TEMPERATURE_INVALID
-#define RAW2_HUMIDITY_INVALID     HUMIDITY_INVALID
-#define RAW2_PRESSURE_INVALID     PRESSURE_INVALID
-#define RAW2_ACCELERATION_INVALID ACCELERATION_INVALID
-#define RAW1_TEMPERATURE_INVALID  0
-#define RAW1_HUMIDITY_INVALID     0
-#define RAW1_PRESSURE_INVALID     0
-#define RAW1_ACCELERATION_INVALID 0
-
 // Sensor values
 typedef struct 
 {
@@ -83,6 +52,42 @@ void encodeToRawFormat3(uint8_t* data_buffer, const ruuvi_sensor_t* const data);
  */
 void encodeToRawFormat5(uint8_t* data_buffer,  const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr);
 
+/**
+ *  Precomputes constant bytes of RAWv2 data, i.e. format and MAC address.
+ *  Must be called before encodeToRawFormat5Sequence.
+ *
+ *  @param mac 6 bytes of MAC address, MSB first. NULL to use device address of nRF52.
+ */
+void initRawFormat5(const uint8_t* const mac);
+
+/**
+ *  Parses sensor values into RAWv2 with explicit measurement sequence number.
+ *  Out-of-range values saturate to the limits of the format, invalid values are encoded as
+ *  invalid as per specification. Has no side effects, initRawFormat5 must be called first.
+ *
+ *  @param data_buffer uint8_t array with length of 24 bytes
+ *  @param data sensor values to encode
+ *  @param acceleration_events counter of acceleration events, encoded modulo 256.
+ *  @param tx_pwr power in dBm, -40 ... 20. INT8_MIN is encoded as invalid.
+ *  @param measurement_sequence sequence number of measurement, incremented by caller.
+ */
+void encodeToRawFormat5Sequence(uint8_t* data_buffer, const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr, uint16_t measurement_sequence);
+
+/**
+ *  Parses RAWv2 data back into sensor values. Invalid fields are decoded into invalid values of
+ *  ruuvi_sensor_t, vbat is decoded as 0 if invalid. Decoded values re-encode to identical bytes,
+ *  except odd temperatures which ruuvi_sensor_t cannot hold at 0.01 C resolution. Odd temperatures
+ *  are rounded away from zero, so that saturated limits re-encode identically.
+ *
+ *  @param data_buffer uint8_t array with length of 24 bytes
+ *  @param data sensor values to fill
+ *  @param acceleration_events movement counter, may be NULL
+ *  @param tx_pwr power in dBm, INT8_MIN if invalid. May be NULL
+ *  @param measurement_sequence sequence number of measurement, may be NULL
+ *  @return false if data is not RAWv2, true otherwise
+ */
+bool decodeRawFormat5(const uint8_t* const data_buffer, ruuvi_sensor_t* const data, uint8_t* const acceleration_events, int8_t* const tx_pwr, uint16_t* const measurement_sequence);
+
 
 /**
  *  Encodes sensor data into given char* url. The base url must have the base of url written by caller.
@@ -95,4 +100,15 @@ void encodeToRawFormat5(uint8_t* data_buffer,  const ruuvi_sensor_t* const data,
  */
 void encodeToUrlDataFromat(char* url, uint8_t base_length, ruuvi_sensor_t* data);
 
+/**
+ *  Device identity of platform, sensortag_nrf.c reads it from FICR of nRF52.
+ *  Kept apart so that encoders can be built and tested on host.
+ *
+ *  @param mac 6 bytes of device address, MSB first. 2 MSB are set as required of random static address.
+ */
+void sensortag_device_address(uint8_t* const mac);
+
+/** @return pseudo-unique id of device */
+uint32_t sensortag_device_id(void);
+
 #endif
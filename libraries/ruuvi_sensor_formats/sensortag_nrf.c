@@ -0,0 +1,20 @@
+#include "sensortag.h"
+
+#include <stdint.h>
+#include "nrf52.h"
+#include "nrf52_bitfields.h"
+
+void sensortag_device_address(uint8_t* const mac)
+{
+  mac[0] = ((NRF_FICR->DEVICEADDR[1]>>8)&0xFF) | 0xC0; //2 MSB must be 11;
+  mac[1] = ((NRF_FICR->DEVICEADDR[1]>>0)&0xFF);
+  mac[2] = ((NRF_FICR->DEVICEADDR[0]>>24)&0xFF);
+  mac[3] = ((NRF_FICR->DEVICEADDR[0]>>16)&0xFF);
+  mac[4] = ((NRF_FICR->DEVICEADDR[0]>>8)&0xFF);
+  mac[5] = ((NRF_FICR->DEVICEADDR[0]>>0)&0xFF);
+}
+
+uint32_t sensortag_device_id(void)
+{
+  return NRF_FICR->DEVICEID[0];
+}
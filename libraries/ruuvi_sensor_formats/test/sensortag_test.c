@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <string.h>
+#include "sensortag.h"
+
+static const uint8_t test_mac[RAW2_MAC_LENGTH]   = {0xC1, 0x23, 0x45, 0x67, 0x89, 0xAB};
+static const uint8_t device_mac[RAW2_MAC_LENGTH] = {0xF0, 0x01, 0x02, 0x03, 0x04, 0x05};
+
+static int failures = 0;
+
+static void check(const bool ok, const char* const what, const long value)
+{
+  if(ok) { return; }
+  failures++;
+  printf("FAIL %s: %ld\n", what, value);
+}
+
+void sensortag_device_address(uint8_t* const mac)
+{
+  memcpy(mac, device_mac, sizeof(device_mac));
+}
+
+uint32_t sensortag_device_id(void)
+{
+  return 0x12345678;
+}
+
+/** Encode, decode and re-encode, decoded counters must match */
+static void check_round_trip(const ruuvi_sensor_t* const data, const uint16_t events, const int8_t tx_pwr, const uint16_t sequence)
+{
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  uint8_t reencoded[RAW_2_ENCODED_DATA_LENGTH];
+  ruuvi_sensor_t decoded;
+  uint8_t decoded_events = 0;
+  int8_t decoded_tx_pwr = 0;
+  uint16_t decoded_sequence = 0;
+
+  encodeToRawFormat5Sequence(encoded, data, events, tx_pwr, sequence);
+  if(!decodeRawFormat5(encoded, &decoded, &decoded_events, &decoded_tx_pwr, &decoded_sequence))
+  {
+    check(false, "decoder did not recognise RAWv2", encoded[0]);
+    return;
+  }
+  encodeToRawFormat5Sequence(reencoded, &decoded, decoded_events, decoded_tx_pwr, decoded_sequence);
+  check(!memcmp(encoded, reencoded, sizeof(encoded)), "round trip, temperature", data->temperature);
+  check(decoded_sequence == sequence, "sequence", decoded_sequence);
+  check(decoded_events == (events & 0xFF), "events", decoded_events);
+  check(decoded_tx_pwr == tx_pwr, "tx power", decoded_tx_pwr);
+  check(!memcmp(&encoded[RAW2_MAC_OFFSET], test_mac, sizeof(test_mac)), "mac", encoded[RAW2_MAC_OFFSET]);
+}
+
+static void check_valid_range(void)
+{
+  const ruuvi_sensor_t vectors[] = {
+    { .temperature = 2134,  .humidity = 45 * 1024,  .pressure = 101325 << 8, .accX = 12, .accY = -1000, .accZ = 1016, .vbat = 2977 },
+    { .temperature = -2134, .humidity = 0,          .pressure = 50000 << 8,  .accX = -32767, .accY = 32767, .accZ = 0, .vbat = 1600 },
+    { .temperature = 16383, .humidity = 100 * 1024, .pressure = 115534 << 8, .accX = 0, .accY = 0, .accZ = 0, .vbat = 3646 },
+    { .temperature = -16383, .humidity = 1,         .pressure = (50000 << 8) + 255, .accX = 1, .accY = -1, .accZ = 2, .vbat = 1601 },
+    { .temperature = TEMPERATURE_INVALID, .humidity = HUMIDITY_INVALID, .pressure = PRESSURE_INVALID,
+      .accX = ACCELERATION_INVALID, .accY = ACCELERATION_INVALID, .accZ = ACCELERATION_INVALID, .vbat = 0 }
+  };
+  for(size_t ii = 0; ii < sizeof(vectors) / sizeof(vectors[0]); ii++)
+  {
+    check_round_trip(&vectors[ii], ii * 100, 4, 0xFFFE + ii);
+  }
+  check_round_trip(&vectors[4], 0, INT8_MIN, 0);
+
+  ruuvi_sensor_t sweep = vectors[0];
+  for(int32_t temperature = -16383; temperature <= 16383; temperature++)
+  {
+    sweep.temperature = temperature;
+    sweep.humidity = (temperature + 16383) * 5;
+    check_round_trip(&sweep, temperature, ((temperature & 0xFFFF) % 31) * 2 - 40, temperature);
+  }
+}
+
+/** Out-of-range values saturate to limits of format, limits round-trip */
+static void check_saturation(void)
+{
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  ruuvi_sensor_t data = { .temperature = 20000, .humidity = 200 * 1024, .pressure = 200000 << 8,
+                          .accX = 0, .accY = 0, .accZ = 0, .vbat = 4000 };
+  encodeToRawFormat5Sequence(encoded, &data, 0, 30, 0);
+  check(0x7F == encoded[1] && 0xFF == encoded[2], "temperature max", (encoded[1] << 8) | encoded[2]);
+  check(0xFF == encoded[3] && 0xFE == encoded[4], "humidity max", (encoded[3] << 8) | encoded[4]);
+  check(0xFF == encoded[5] && 0xFE == encoded[6], "pressure max", (encoded[5] << 8) | encoded[6]);
+  check(((RAW2_VOLTAGE_MAX << 5) | RAW2_TX_POWER_MAX) == ((encoded[13] << 8) | encoded[14]), "power info max",
+        (encoded[13] << 8) | encoded[14]);
+  check_round_trip(&data, 0, 20, 0);
+
+  data.temperature = -20000;
+  data.pressure = 40000 << 8;
+  data.vbat = 1000;
+  encodeToRawFormat5Sequence(encoded, &data, 0, -60, 0);
+  check(0x80 == encoded[1] && 0x01 == encoded[2], "temperature min", (encoded[1] << 8) | encoded[2]);
+  check(0x00 == encoded[5] && 0x00 == encoded[6], "pressure min", (encoded[5] << 8) | encoded[6]);
+  check(0x00 == encoded[13] && 0x00 == encoded[14], "power info min", (encoded[13] << 8) | encoded[14]);
+  check_round_trip(&data, 0, -40, 0);
+
+  // Temperature of 0.005 C encoders decodes away from zero, limits saturate back
+  const int16_t odd[] = { 0x7FFF, -0x7FFF, 2135, -2135, 1, -1 };
+  for(size_t ii = 0; ii < sizeof(odd) / sizeof(odd[0]); ii++)
+  {
+    uint8_t reencoded[RAW_2_ENCODED_DATA_LENGTH];
+    ruuvi_sensor_t decoded;
+    encodeToRawFormat5Sequence(encoded, &data, 0, 0, 0);
+    encoded[1] = (uint16_t)odd[ii] >> 8;
+    encoded[2] = (uint16_t)odd[ii] & 0xFF;
+    decodeRawFormat5(encoded, &decoded, NULL, NULL, NULL);
+    encodeToRawFormat5Sequence(reencoded, &decoded, 0, 0, 0);
+    int16_t result = (int16_t)((reencoded[1] << 8) | reencoded[2]);
+    int32_t expected = (odd[ii] == 0x7FFF || odd[ii] == -0x7FFF) ? odd[ii] : odd[ii] + ((odd[ii] < 0) ? -1 : 1);
+    check(result == expected, "odd temperature", odd[ii]);
+  }
+}
+
+/** Stateful encoder uses device address and increments sequence */
+static void check_device_encoder(void)
+{
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  ruuvi_sensor_t data = { .temperature = 0, .humidity = 0, .pressure = 100000 << 8, .accX = 0, .accY = 0, .accZ = 0, .vbat = 3000 };
+  uint16_t first = 0;
+  uint16_t second = 0;
+  ruuvi_sensor_t decoded;
+  initRawFormat5(NULL);
+  encodeToRawFormat5(encoded, &data, 0, 4);
+  check(!memcmp(&encoded[RAW2_MAC_OFFSET], device_mac, sizeof(device_mac)), "device mac", encoded[RAW2_MAC_OFFSET]);
+  decodeRawFormat5(encoded, &decoded, NULL, NULL, &first);
+  encodeToRawFormat5(encoded, &data, 0, 4);
+  decodeRawFormat5(encoded, &decoded, NULL, NULL, &second);
+  check((uint16_t)(first + 1) == second, "sequence increment", second);
+  encoded[0] = SENSOR_TAG_DATA_FORMAT;
+  check(!decodeRawFormat5(encoded, &decoded, NULL, NULL, NULL), "wrong format", encoded[0]);
+}
+
+int main(void)
+{
+  initRawFormat5(test_mac);
+  check_valid_range();
+  check_saturation();
+  check_device_encoder();
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
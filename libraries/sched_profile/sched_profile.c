@@ -0,0 +1,114 @@
+#include "sched_profile.h"
+
+#include <string.h>
+
+typedef struct{
+  sched_profile_handler_t handler;
+  uint32_t calls;
+  uint32_t max_us;
+  uint32_t histogram[SCHED_PROFILE_BUCKETS];
+}profile_t;
+
+static profile_t m_profiles[SCHED_PROFILE_MAX_HANDLERS];
+static uint8_t m_handlers = 0;
+static uint16_t m_queue_high_water = 0;
+static uint32_t m_failed_puts = 0;
+static uint32_t m_queue_histogram[SCHED_PROFILE_QUEUE_BUCKETS];
+
+/** Profile of handler, last entry is shared by handlers which do not fit */
+static profile_t* find(const sched_profile_handler_t handler)
+{
+  for(uint8_t ii = 0; ii < m_handlers; ii++)
+  {
+    if(m_profiles[ii].handler == handler) { return &m_profiles[ii]; }
+  }
+  if(SCHED_PROFILE_MAX_HANDLERS - 1 > m_handlers || (SCHED_PROFILE_MAX_HANDLERS - 1 == m_handlers && NULL == handler))
+  {
+    m_profiles[m_handlers].handler = handler;
+    return &m_profiles[m_handlers++];
+  }
+  return find(NULL);
+}
+
+/** Upper bound of bucket holding 99th percentile, limited by maximum */
+static uint32_t p99_us(const profile_t* const profile)
+{
+  const uint32_t rank = profile->calls - profile->calls / 100;
+  uint32_t cumulative = 0;
+  for(uint8_t ii = 0; ii < SCHED_PROFILE_BUCKETS - 1; ii++)
+  {
+    cumulative += profile->histogram[ii];
+    if(cumulative >= rank) { return ((uint32_t)1 << ii) < profile->max_us ? ((uint32_t)1 << ii) : profile->max_us; }
+  }
+  return profile->max_us;
+}
+
+uint8_t sched_profile_bucket(const uint32_t value)
+{
+  if(0 == value) { return 0; }
+  const uint8_t bucket = 32 - __builtin_clz(value);
+  return bucket < SCHED_PROFILE_BUCKETS ? bucket : SCHED_PROFILE_BUCKETS - 1;
+}
+
+void sched_profile_reset(void)
+{
+  memset(m_profiles, 0, sizeof(m_profiles));
+  memset(m_queue_histogram, 0, sizeof(m_queue_histogram));
+  m_handlers = 0;
+  m_queue_high_water = 0;
+  m_failed_puts = 0;
+}
+
+void sched_profile_execute(const sched_profile_handler_t handler, void* p_event_data, const uint16_t event_size)
+{
+  const uint32_t start = sched_profile_clock_ticks();
+  handler(p_event_data, event_size);
+  const uint32_t elapsed_us = (sched_profile_clock_ticks() - start) / SCHED_PROFILE_TICKS_PER_US;
+
+  profile_t* const profile = find(handler);
+  if(UINT32_MAX > profile->calls) { profile->calls++; }
+  if(elapsed_us > profile->max_us) { profile->max_us = elapsed_us; }
+  profile->histogram[sched_profile_bucket(elapsed_us)]++;
+}
+
+void sched_profile_queue_depth(const uint16_t depth)
+{
+  if(depth > m_queue_high_water) { m_queue_high_water = depth; }
+  const uint8_t bucket = sched_profile_bucket(depth);
+  m_queue_histogram[bucket < SCHED_PROFILE_QUEUE_BUCKETS ? bucket : SCHED_PROFILE_QUEUE_BUCKETS - 1]++;
+}
+
+void sched_profile_put_failed(void)
+{
+  m_failed_puts++;
+}
+
+size_t sched_profile_snapshot_size(void)
+{
+  return sizeof(sched_profile_header_t) + m_handlers * sizeof(sched_profile_entry_t);
+}
+
+size_t sched_profile_snapshot(uint8_t* const buffer, const size_t size)
+{
+  if(NULL == buffer || sizeof(sched_profile_header_t) > size) { return 0; }
+  sched_profile_header_t header = { .handlers = 0,
+                                    .buckets = SCHED_PROFILE_BUCKETS,
+                                    .queue_high_water = m_queue_high_water,
+                                    .failed_puts = m_failed_puts };
+  memcpy(header.queue_histogram, m_queue_histogram, sizeof(header.queue_histogram));
+  size_t length = sizeof(header);
+  for(uint8_t ii = 0; ii < m_handlers && length + sizeof(sched_profile_entry_t) <= size; ii++)
+  {
+    const profile_t* const profile = &m_profiles[ii];
+    sched_profile_entry_t entry = { .handler = (uint32_t)(uintptr_t)profile->handler,
+                                    .calls = profile->calls,
+                                    .max_us = profile->max_us,
+                                    .p99_us = p99_us(profile) };
+    memcpy(entry.histogram, profile->histogram, sizeof(entry.histogram));
+    memcpy(buffer + length, &entry, sizeof(entry));
+    length += sizeof(entry);
+    header.handlers++;
+  }
+  memcpy(buffer, &header, sizeof(header));
+  return length;
+}
@@ -0,0 +1,76 @@
+#ifndef SCHED_PROFILE_H
+#define SCHED_PROFILE_H
+/**
+ *  Execution time profile of scheduler handlers.
+ *
+ *  Each executed event is timed and counted per handler in a log2 histogram of run time:
+ *  bucket 0 is under 1 us, bucket b is [2^(b-1), 2^b) us and the last bucket is open ended.
+ *  Queue depth after each put is counted in a log2 histogram of depth in the same way.
+ *  Histograms have fixed size, p99 is the upper bound of the bucket of the 99th percentile,
+ *  i.e. within a factor of two, limited by the exact maximum.
+ *
+ *  Plain C, platform provides a free-running clock. On nRF52 the clock is DWT cycle counter and
+ *  events are routed through the profile by wrapping app_sched_event_put, see sched_profile_nrf.c.
+ *  Host build runs with a simulated clock, see Makefile.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef SCHED_PROFILE_TICKS_PER_US
+#define SCHED_PROFILE_TICKS_PER_US   64  // CPU cycles at 64 MHz
+#endif
+#define SCHED_PROFILE_MAX_HANDLERS   12  // Further handlers are counted in last entry with handler address 0
+#define SCHED_PROFILE_BUCKETS        16  // Last bucket is 16.4 ms and over
+#define SCHED_PROFILE_QUEUE_BUCKETS  8
+
+typedef void(*sched_profile_handler_t)(void* p_event_data, uint16_t event_size);
+
+/** Profile of one handler */
+typedef struct __attribute__((packed)){
+  uint32_t handler;                              // Address of handler, look up from .map of firmware
+  uint32_t calls;
+  uint32_t max_us;
+  uint32_t p99_us;
+  uint32_t histogram[SCHED_PROFILE_BUCKETS];
+}sched_profile_entry_t;
+
+/** Snapshot starts with header, followed by entries */
+typedef struct __attribute__((packed)){
+  uint8_t  handlers;                             // Number of entries after header
+  uint8_t  buckets;                              // SCHED_PROFILE_BUCKETS
+  uint16_t queue_high_water;                     // Deepest queue after a put
+  uint32_t failed_puts;                          // Puts to full queue
+  uint32_t queue_histogram[SCHED_PROFILE_QUEUE_BUCKETS];
+}sched_profile_header_t;
+
+/** Free-running clock in ticks of 1 / SCHED_PROFILE_TICKS_PER_US us, implemented by platform */
+uint32_t sched_profile_clock_ticks(void);
+
+/** Clear profile */
+void sched_profile_reset(void);
+
+/** Run handler and record its run time */
+void sched_profile_execute(const sched_profile_handler_t handler, void* p_event_data, const uint16_t event_size);
+
+/** Record queue depth after a put */
+void sched_profile_queue_depth(const uint16_t depth);
+
+/** Count a put which failed because queue was full */
+void sched_profile_put_failed(void);
+
+/** Log2 bucket of value */
+uint8_t sched_profile_bucket(const uint32_t value);
+
+/**
+ *  Copy header and handler entries to buffer.
+ *
+ *  @return bytes written, 0 if buffer is too small for header
+ */
+size_t sched_profile_snapshot(uint8_t* const buffer, const size_t size);
+
+/** Size of snapshot with current handlers */
+size_t sched_profile_snapshot_size(void);
+
+#endif
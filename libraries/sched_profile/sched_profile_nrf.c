@@ -0,0 +1,162 @@
+#include "sched_profile.h"
+#include "sched_profile_nrf.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "app_scheduler.h"
+#include "app_util_platform.h"
+#include "ble_bulk_transfer.h"
+#include "init.h"
+#include "nrf.h"
+#include "probe.h"
+
+#define NRF_LOG_MODULE_NAME "SCHED_PROFILE"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+// Puts and executions are counted to get queue depth, puts may come from any interrupt priority
+static uint32_t m_puts = 0;
+static uint32_t m_executed = 0;
+
+uint32_t __real_app_sched_event_put(void const * p_event_data, uint16_t event_size, app_sched_event_handler_t handler);
+
+uint32_t sched_profile_clock_ticks(void)
+{
+  return DWT->CYCCNT;
+}
+
+/** Scheduled instead of every handler, original handler is in front of event data */
+static void trampoline(void* p_event_data, uint16_t event_size)
+{
+  sched_profile_handler_t handler;
+  memcpy(&handler, p_event_data, sizeof(handler));
+  event_size -= sizeof(handler);
+  sched_profile_execute(handler, event_size ? (uint8_t*)p_event_data + sizeof(handler) : NULL, event_size);
+  // Scheduler frees queue entry after handler returns
+  CRITICAL_REGION_ENTER();
+  m_executed++;
+  CRITICAL_REGION_EXIT();
+}
+
+uint32_t __wrap_app_sched_event_put(void const * p_event_data, uint16_t event_size, app_sched_event_handler_t handler)
+{
+  // Scheduler queue is word-aligned, handler keeps event data aligned
+  uint8_t event[SCHED_MAX_EVENT_DATA_SIZE];
+  if(sizeof(handler) + event_size > sizeof(event)) { return NRF_ERROR_INVALID_LENGTH; }
+  memcpy(event, &handler, sizeof(handler));
+  if(event_size) { memcpy(event + sizeof(handler), p_event_data, event_size); }
+
+  uint32_t err_code;
+  CRITICAL_REGION_ENTER();
+  err_code = __real_app_sched_event_put(event, sizeof(handler) + event_size, trampoline);
+  if(NRF_SUCCESS == err_code) { sched_profile_queue_depth(++m_puts - m_executed); }
+  else { sched_profile_put_failed(); }
+  CRITICAL_REGION_EXIT();
+  return err_code;
+}
+
+void sched_profile_init(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  sched_profile_reset();
+}
+
+/**
+ *  Reply summary, queue full snapshot to NUS. Bulk transfer frees the snapshot after sending.
+ */
+static ret_code_t query_status(const ruuvi_standard_message_t message)
+{
+  ret_code_t err_code = ENDPOINT_SUCCESS;
+  const size_t length = sched_profile_snapshot_size();
+  uint8_t* snapshot = malloc(length);
+  if(NULL == snapshot) { return ENDPOINT_HANDLER_ERROR; }
+  sched_profile_snapshot(snapshot, length);
+  sched_profile_header_t header;
+  memcpy(&header, snapshot, sizeof(header));
+  NRF_LOG_INFO("%d handlers, queue high-water %d, %d failed puts\r\n", header.handlers, header.queue_high_water,
+               header.failed_puts);
+
+  const uint16_t summary[4] = { header.handlers, header.queue_high_water, SCHED_QUEUE_SIZE,
+                                (header.failed_puts > UINT16_MAX) ? UINT16_MAX : header.failed_puts };
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = SCHEDULER,
+                                     .type                 = UINT16,
+                                     .payload              = {0}};
+  memcpy(reply.payload, summary, sizeof(reply.payload));
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler) { err_code |= p_reply_handler(reply); }
+
+  if(TX_SUCCESS != ble_bulk_transfer_asynchronous(SCHEDULER, snapshot, length))
+  {
+    free(snapshot);
+    return ENDPOINT_HANDLER_ERROR;
+  }
+  err_code |= ble_message_queue_process();
+  return err_code;
+}
+
+#if PROBE_ENABLED
+/**
+ *  Reply average run time of probes in us, queue snapshot of probe statistics to NUS.
+ */
+static ret_code_t query_probes(const ruuvi_standard_message_t message)
+{
+  ret_code_t err_code = ENDPOINT_SUCCESS;
+  ruuvi_standard_message_t reply = { .destination_endpoint = message.source_endpoint,
+                                     .source_endpoint      = SCHEDULER,
+                                     .type                 = UINT16,
+                                     .payload              = {0}};
+  for(size_t ii = 0; ii < PROBE_COUNT; ii++)
+  {
+    const probe_stats_t stats = probe_get(ii);
+    const uint32_t average_us = stats.count ? (stats.sum / stats.count) / PROBE_TICKS_PER_US : 0;
+    NRF_LOG_INFO("%s: %d runs, min %d max %d avg %d us\r\n", (uint32_t)probe_name(ii), stats.count,
+                 stats.min / PROBE_TICKS_PER_US, stats.max / PROBE_TICKS_PER_US, average_us);
+    if(sizeof(reply.payload) / sizeof(uint16_t) > ii)
+    {
+      const uint16_t value = (average_us > UINT16_MAX) ? UINT16_MAX : average_us;
+      memcpy(reply.payload + ii * sizeof(value), &value, sizeof(value));
+    }
+  }
+  message_handler p_reply_handler = get_reply_handler();
+  if(p_reply_handler) { err_code |= p_reply_handler(reply); }
+
+  const size_t length = probe_snapshot_size();
+  uint8_t* snapshot = malloc(length);
+  if(NULL == snapshot) { return ENDPOINT_HANDLER_ERROR; }
+  probe_snapshot(snapshot, length);
+  if(TX_SUCCESS != ble_bulk_transfer_asynchronous(SCHEDULER, snapshot, length))
+  {
+    free(snapshot);
+    return ENDPOINT_HANDLER_ERROR;
+  }
+  err_code |= ble_message_queue_process();
+  return err_code;
+}
+#endif
+
+/**
+ *  Handles incoming messages.
+ */
+ret_code_t sched_profile_handler(const ruuvi_standard_message_t message)
+{
+  //Return if message was not meant for this endpoint.
+  if(SCHEDULER != message.destination_endpoint){ return ENDPOINT_INVALID; }
+  switch(message.type)
+  {
+    case STATUS_QUERY:
+      return query_status(message);
+
+    #if PROBE_ENABLED
+    case DATA_QUERY:
+      return query_probes(message);
+    #endif
+
+    default:
+      return unknown_handler(message);
+  }
+  return ENDPOINT_HANDLER_ERROR; // Should not be reached
+}
@@ -0,0 +1,30 @@
+#ifndef SCHED_PROFILE_NRF_H
+#define SCHED_PROFILE_NRF_H
+/**
+ *  Scheduler profile on nRF52.
+ *
+ *  Build with SCHED_PROFILE_ENABLED=1 and link with -Wl,--wrap=app_sched_event_put. Every put, including puts of
+ *  app timer and SoftDevice handler, then queues the original handler in front of event data and a trampoline
+ *  which times the handler. Scheduler event size grows by SCHED_PROFILE_EVENT_OVERHEAD, see init.h.
+ *
+ *  STATUS_QUERY to SCHEDULER endpoint is replied with UINT16 summary: handlers, queue high-water,
+ *  queue size and failed puts. Snapshot of sched_profile_header_t and entries follows as bulk transfer over NUS.
+ *  With PROBE_ENABLED=1 DATA_QUERY is replied with UINT16 average run time of probes, see probe.h.
+ */
+
+#include "sched_profile.h"
+#include "ruuvi_endpoints.h"
+#include "nrf_error.h"
+
+#define SCHED_PROFILE_EVENT_OVERHEAD sizeof(sched_profile_handler_t)
+
+/** Start DWT cycle counter and clear profile */
+void sched_profile_init(void);
+
+/**
+ *  Handle messages with "SCHEDULER" as destination endpoint. This should not be called directly, but rather
+ *  through ruuvi_endpoints function route_message.
+ */
+ret_code_t sched_profile_handler(const ruuvi_standard_message_t message);
+
+#endif
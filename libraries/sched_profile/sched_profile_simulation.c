@@ -0,0 +1,149 @@
+/**
+ *  Host build of scheduler profile with a simulated clock. Interrupts put events of firmware tasks to
+ *  a simulated scheduler queue, main loop executes them and each task advances the clock by its run time.
+ *  Checks counts, maximum and p99 of the profile against exact values and prints the snapshot.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sched_profile.h"
+
+#define QUEUE_SIZE     16      // SCHED_QUEUE_SIZE of firmware
+#define MAX_CALLS      100000
+#define SIMULATED_US   (3600ULL * 1000000)
+
+static uint64_t m_ticks = 0;   // Simulated cycle counter
+
+uint32_t sched_profile_clock_ticks(void)
+{
+  return (uint32_t)m_ticks;
+}
+
+typedef struct{
+  const char* name;
+  uint32_t interval_us;        // Average time between puts
+  uint32_t typical_us;         // Run time
+  uint32_t slow_us;            // Run time of 1 in slow_every calls
+  uint32_t slow_every;
+  uint32_t durations[MAX_CALLS];
+  uint32_t calls;
+  uint64_t next_put;
+}task_t;
+
+static task_t m_tasks[] = {
+  { "main_sensor_task",          1000000, 1200,  9000, 200 },  // BME280 forced read now and then
+  { "ble_bulk_scheduler",          50000,  150,  2500, 500 },
+  { "advertising_slot_swap",      100000,   40,   600, 1000 },
+  { "change_mode",              60000000,  300, 85000,    2 },  // Flash write of mode
+  { "reinit_nfc",              120000000,  900,  1500,    5 }
+};
+#define NUM_TASKS (sizeof(m_tasks) / sizeof(m_tasks[0]))
+
+static void run(task_t* const task)
+{
+  uint32_t us = (0 == rand() % task->slow_every) ? task->slow_us : task->typical_us + rand() % (task->typical_us / 4 + 1);
+  if(task->calls < MAX_CALLS) { task->durations[task->calls] = us; }
+  task->calls++;
+  m_ticks += (uint64_t)us * SCHED_PROFILE_TICKS_PER_US;
+}
+
+// Profile is per handler address, each task has its own handler
+#define TASK_HANDLER(index) \
+  static void task_##index(void* p_event_data, uint16_t event_size) { run(&m_tasks[index]); }
+TASK_HANDLER(0)
+TASK_HANDLER(1)
+TASK_HANDLER(2)
+TASK_HANDLER(3)
+TASK_HANDLER(4)
+static const sched_profile_handler_t m_handlers[NUM_TASKS] = { task_0, task_1, task_2, task_3, task_4 };
+
+// Simulated scheduler queue
+static size_t m_queue[QUEUE_SIZE];     // Index of task
+static uint32_t m_head = 0;
+static uint32_t m_tail = 0;
+static uint16_t m_high_water = 0;
+static uint32_t m_failed = 0;
+
+static void put(const size_t task)
+{
+  const uint16_t depth = m_tail - m_head;
+  if(QUEUE_SIZE == depth) { sched_profile_put_failed(); m_failed++; return; }
+  m_queue[m_tail++ % QUEUE_SIZE] = task;
+  sched_profile_queue_depth(depth + 1);
+  if(depth + 1 > m_high_water) { m_high_water = depth + 1; }
+}
+
+/** Interrupts which were due while main loop was busy put their events */
+static void interrupts(const uint64_t now_us)
+{
+  for(size_t ii = 0; ii < NUM_TASKS; ii++)
+  {
+    while(m_tasks[ii].next_put <= now_us)
+    {
+      put(ii);
+      m_tasks[ii].next_put += m_tasks[ii].interval_us / 2 + rand() % m_tasks[ii].interval_us;
+    }
+  }
+}
+
+static int compare(const void* a, const void* b)
+{
+  const uint32_t x = *(const uint32_t*)a;
+  const uint32_t y = *(const uint32_t*)b;
+  return (x > y) - (x < y);
+}
+
+int main(void)
+{
+  int failures = 0;
+  srand(1);
+  sched_profile_reset();
+  for(size_t ii = 0; ii < NUM_TASKS; ii++) { m_tasks[ii].next_put = rand() % m_tasks[ii].interval_us; }
+
+  while(m_ticks / SCHED_PROFILE_TICKS_PER_US < SIMULATED_US)
+  {
+    interrupts(m_ticks / SCHED_PROFILE_TICKS_PER_US);
+    if(m_head == m_tail) { m_ticks += 1000 * SCHED_PROFILE_TICKS_PER_US; continue; } // Sleep until next tick
+    sched_profile_execute(m_handlers[m_queue[m_head % QUEUE_SIZE]], NULL, 0);
+    m_head++;
+  }
+
+  static uint8_t snapshot[sizeof(sched_profile_header_t) + SCHED_PROFILE_MAX_HANDLERS * sizeof(sched_profile_entry_t)];
+  const size_t length = sched_profile_snapshot(snapshot, sizeof(snapshot));
+  sched_profile_header_t header;
+  memcpy(&header, snapshot, sizeof(header));
+  printf("Simulated %llu s, snapshot %zu bytes. Queue high-water %u of %u, %u failed puts\n",
+         (unsigned long long)(SIMULATED_US / 1000000), length, header.queue_high_water, QUEUE_SIZE,
+         (unsigned)header.failed_puts);
+  if(header.queue_high_water != m_high_water || header.failed_puts != m_failed) { failures++; printf("FAIL queue\n"); }
+
+  printf("%-22s %8s %8s %8s %8s\n", "handler", "calls", "max us", "p99 us", "exact");
+  for(uint8_t ii = 0; ii < header.handlers; ii++)
+  {
+    sched_profile_entry_t entry;
+    memcpy(&entry, snapshot + sizeof(header) + ii * sizeof(entry), sizeof(entry));
+    task_t* task = NULL;
+    for(size_t jj = 0; jj < NUM_TASKS; jj++)
+    {
+      if((uint32_t)(uintptr_t)m_handlers[jj] == entry.handler) { task = &m_tasks[jj]; }
+    }
+    if(NULL == task || task->calls != entry.calls || task->calls > MAX_CALLS)
+    {
+      printf("FAIL entry %u\n", ii);
+      failures++;
+      continue;
+    }
+    qsort(task->durations, task->calls, sizeof(uint32_t), compare);
+    const uint32_t exact_p99 = task->durations[task->calls - task->calls / 100 - 1];
+    const uint32_t exact_max = task->durations[task->calls - 1];
+    printf("%-22s %8u %8u %8u %8u\n", task->name, (unsigned)entry.calls, (unsigned)entry.max_us,
+           (unsigned)entry.p99_us, (unsigned)exact_p99);
+    if(entry.max_us != exact_max || entry.p99_us < exact_p99 || entry.p99_us > 2 * exact_p99)
+    {
+      printf("FAIL %s\n", task->name);
+      failures++;
+    }
+  }
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures ? 1 : 0;
+}
@@ -1,12 +1,21 @@
 #ifndef APPLICATION_CONFIG_H
 #define APPLICATION_CONFIG_H
 
+// Host tools such as libraries/energy_model define APPLICATION_CONFIG_HOST and use register values only.
+#ifndef APPLICATION_CONFIG_HOST
 #include "bme280.h"
 #include "lis2dh12.h"
+#include "lis2dh12_events.h"
+#include "lis2dh12_motion.h"
+#include "lis2dh12_capture.h"
+#else
+#include "bme280_registers.h"
+#include "lis2dh12_registers.h"
+#endif
 // Milliseconds before new button press is accepted. Applies both to rising and falling edge
 #define DEBOUNCE_THRESHOLD 100u
-// Milliseconds until new batteryreading is taken on radio interrupt.
-// Use cached value otherse.
+// Milliseconds until new battery readings are taken on radio interrupt, idle before and loaded after TX.
+// Use filtered value otherwise.
 #define APPLICATION_BATTERY_INTERVAL 10000u
 // Milliseconds to hold down the button before reset
 #define BUTTON_RESET_TIME 3000u
@@ -21,6 +30,23 @@
 #define BME280_PRESSURE_OVERSAMPLING    BME280_OVERSAMPLING_1
 #define BME280_IIR                      BME280_IIR_16
 #define BME280_DELAY                    BME280_STANDBY_1000_MS
+// 1: Trigger a forced conversion at start of each main loop and run sensor task once it is ready.
+// 0: Run BME280 in normal mode with BME280_DELAY standby between conversions.
+// IIR filter advances once per conversion, i.e. once per main loop in forced mode.
+#define BME280_FORCED_MODE              1
+// Milliseconds between conversions in normal mode, must match BME280_DELAY.
+#define BME280_DELAY_MS                 1000u
+
+// 1: Select oversampling and IIR at runtime from noise targets and charge budget below,
+//    reselected when main loop interval changes. Fixed oversampling and IIR above are not used.
+// 0: Use fixed oversampling and IIR above.
+// Run drivers/bme280/benchmark "make governor" to see the selections.
+#define BME280_GOVERNOR_ENABLED           1
+#define BME280_GOVERNOR_NOISE_TEMPERATURE 20     // RMS, 0.0001 C
+#define BME280_GOVERNOR_NOISE_HUMIDITY    20     // RMS, 0.001 %RH
+#define BME280_GOVERNOR_NOISE_PRESSURE    60     // RMS, 0.01 Pa
+#define BME280_GOVERNOR_BUDGET_NC         20000u // Charge per conversion, nC (uA * ms)
+#define BME280_GOVERNOR_RESPONSE_MS       60000u // Longest allowed IIR step response
 
 #define LIS2DH12_SCALE              LIS2DH12_SCALE2G
 #define LIS2DH12_RESOLUTION         LIS2DH12_RES10BIT
@@ -30,4 +56,41 @@
 // mg, scaled to bits by driver
 #define LIS2DH12_ACTIVITY_THRESHOLD 64
 
+// Hardware events of LIS2DH12, bitmask of lis2dh12_event_type_t. 0 disables event engine.
+// Every event counts as movement. Tap detection needs a high sample rate to be reliable.
+// LIS2DH12_EVENT_ORIENTATION replaces activity detection on pin 2.
+#define LIS2DH12_EVENTS             (LIS2DH12_EVENT_FREE_FALL)
+
+// Wake-on-motion in RAWv2 modes: accelerometer runs at 1 Hz 8-bit until acceleration exceeds
+// LIS2DH12_ACTIVITY_THRESHOLD, then at LIS2DH12_SAMPLERATE_RAWv2 and LIS2DH12_RESOLUTION until
+// acceleration has stayed below LIS2DH12_MOTION_SLEEP_THRESHOLD for LIS2DH12_MOTION_SLEEP_DELAY_MS.
+// Delay is limited to 2041 samples, 204 s at 10 Hz. Not used with LIS2DH12_EVENT_ORIENTATION.
+#define LIS2DH12_MOTION_ENABLED         1
+#define LIS2DH12_MOTION_SLEEP_THRESHOLD 64     // mg
+#define LIS2DH12_MOTION_SLEEP_DELAY_MS  30000u
+
+// Impact capture in RAWv2 modes: 32 samples before acceleration exceeds LIS2DH12_CAPTURE_THRESHOLD
+// and LIS2DH12_CAPTURE_POST_SAMPLES after it are stored to RAM and offered to ACCELERATION endpoint
+// with bulk transfer when a central connects. Needs APP_GATT_PROFILE_ENABLED for transfer.
+// Replaces wake-on-motion, accelerometer runs at LIS2DH12_CAPTURE_SAMPLERATE and movement counter counts
+// impacts. Not used with LIS2DH12_EVENT_ORIENTATION.
+#define LIS2DH12_CAPTURE_ENABLED       0
+#define LIS2DH12_CAPTURE_SAMPLERATE    LIS2DH12_RATE_100
+#define LIS2DH12_CAPTURE_THRESHOLD     1000   // mg
+#define LIS2DH12_CAPTURE_POST_SAMPLES  64
+
+// Adaptive advertising: interval is shortened to the rate of current mode on movement or
+// on fast environmental change, and doubled after every ADAPTIVE_ADVERTISING_STABLE_LOOPS
+// main loops, but no sooner than one ADAPTIVE_ADVERTISING_WINDOW, without change up to
+// ADAPTIVE_ADVERTISING_CEILING milliseconds. Disabled by default, tag advertises at rate of mode.
+#define ADAPTIVE_ADVERTISING_ENABLED          0
+#define ADAPTIVE_ADVERTISING_CEILING          10000u
+#define ADAPTIVE_ADVERTISING_STABLE_LOOPS     10u
+// Milliseconds over which environmental change is measured
+#define ADAPTIVE_ADVERTISING_WINDOW           60000u
+// Change over window which counts as activity. 0.01 C, 1/1024 %RH, 1/256 Pa
+#define ADAPTIVE_TEMPERATURE_THRESHOLD        50         // 0.5 C
+#define ADAPTIVE_HUMIDITY_THRESHOLD           (2*1024)   // 2 %RH
+#define ADAPTIVE_PRESSURE_THRESHOLD           (50*256)   // 50 Pa
+
 #endif
\ No newline at end of file
@@ -12,6 +12,7 @@
 #include "bluetooth_board_config.h"
 
 #include "ble_bulk_transfer.h"
+#include "counters.h"
 #include "ruuvi_endpoints.h"
 
 #define NRF_LOG_MODULE_NAME "SERVICE"
@@ -25,6 +26,7 @@ static ble_dfu_t m_dfus;    /**< Structure for DFU service. */
 static void nus_data_handler(ble_nus_t * p_nus, uint8_t * p_data, uint16_t length)
 {
   NRF_LOG_INFO("Received %s\r\n", (uint32_t)p_data);
+  COUNTER_INC(COUNTER_NUS_RECEIVED);
   //Assume standard message - TODO: Switch by endpoint
   if(length == 11){
     ruuvi_standard_message_t message = { .destination_endpoint = p_data[0],
@@ -97,6 +99,7 @@ uint32_t application_services_init(void)
     nus_init.data_handler = nus_data_handler;
 
     err_code |= ble_nus_init(&m_nus, &nus_init);
+    ble_bulk_set_nus(&m_nus);
 
     NRF_LOG_INFO("NUS Init status: %s\r\n", (uint32_t)ERR_TO_STR(err_code));
     
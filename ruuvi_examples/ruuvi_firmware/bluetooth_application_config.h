@@ -18,6 +18,17 @@
 #define ADVERTISING_INTERVAL_STARTUP  100u  // Interval of startup advertising
 #define APPLICATION_ADV_INTERVAL      ADVERTISING_INTERVAL_RAW //!< Default value for driver
 
+// Interleaved advertisement slots, sent in place of RAW data once every N advertising events.
+// 0 disables the slot. For example URL 4, TLM 10 and identity 30 serve Eddystone scanners
+// while RAW data is sent on 85 % of advertisements.
+#define ADVERTISING_URL_PERIOD        0
+#define ADVERTISING_TLM_PERIOD        0
+#define ADVERTISING_IDENTITY_PERIOD   0
+// Event counters frame, see libraries/counters. For example 100 sends counters every ~2 min at 1285 ms interval.
+#define ADVERTISING_COUNTERS_PERIOD   0
+#define ADVERTISING_URL               "\x03ruu.vi/"   // 0x03: https://
+#define ADVERTISING_URL_LENGTH        8
+
 //Raw v2
 #define RAWv1_DATA_LENGTH 14
 #define RAWv2_DATA_LENGTH 24
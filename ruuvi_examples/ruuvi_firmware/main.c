@@ -21,6 +21,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 // Nordic SDK
 #include "ble_advdata.h"
@@ -46,19 +48,30 @@
 #include "flash.h"
 #include "lis2dh12.h"
 #include "lis2dh12_acceleration_handler.h"
+#include "lis2dh12_events.h"
+#include "lis2dh12_motion.h"
+#include "lis2dh12_capture.h"
 #include "bme280.h"
+#include "bme280_governor.h"
+#include "bme280_temperature_handler.h"
 #include "battery.h"
+#include "battery_handler.h"
+#include "counters_handler.h"
 #include "bluetooth_core.h"
+#include "ble_bulk_transfer.h"
+#include "ble_event_handlers.h"
 #include "eddystone.h"
 #include "pin_interrupt.h"
 #include "nfc.h"
 #include "nfc_t2t_lib.h"
 #include "rtc.h"
+#include "rtc_time_handler.h"
 #include "application_config.h"
 
 // Libraries
 #include "base64.h"
 #include "sensortag.h"
+#include "probe.h"
 
 // Init
 #include "init.h"
@@ -72,6 +85,7 @@
 // ID for main loop timer.
 APP_TIMER_DEF(main_timer_id);                 // Creates timer id for our program.
 APP_TIMER_DEF(reset_timer_id);                 // Creates timer id for our program.
+APP_TIMER_DEF(bme280_timer_id);                // Single shot timer for forced BME280 conversion.
 
 static uint16_t init_status = 0;   // combined status of all initalizations.  Zero when all are complete if no errors occured.
 static uint8_t NFC_message[100];   // NFC message buffer has 4 records, up to 128 bytes each minus some overhead for NFC NDEF data keeping. 
@@ -108,14 +122,28 @@ static bool fast_advertising = true;           // Connectable mode
 static uint64_t fast_advertising_start = 0;    // Timestamp of when tag became connectable
 static uint64_t debounce = 0;                  // Flag for avoiding double presses
 static uint16_t acceleration_events = 0;       // Number of times accelerometer has triggered
-static volatile uint16_t vbat = 0;             // Update in interrupt after radio activity.
-static uint64_t last_battery_measurement = 0;  // Timestamp of VBat update.
+static uint16_t measurement_sequence = 0;      // Sequence number of encoded RAWv2 measurements
+static uint16_t advertising_interval = ADVERTISING_INTERVAL_RAW; // Current interval of adaptive advertising
+static uint16_t last_acceleration_events = 0;  // Acceleration events at previous adaptation
+static uint16_t stable_loops = 0;              // Main loops without activity
+static uint64_t adaptive_step_time = 0;        // Time of last activity or back-off step
+static ruuvi_sensor_t environment_reference = { .temperature = TEMPERATURE_INVALID,
+                                                 .humidity = HUMIDITY_INVALID,
+                                                 .pressure = PRESSURE_INVALID }; // Environmental values at start of change window
+static uint64_t environment_reference_time = 0;
+static uint64_t last_battery_measurement = 0;  // Timestamp of idle battery sample.
+static bool battery_loaded_due = false;        // Idle sample was started before radio event, take loaded sample after it.
 static volatile bool pressed = false;          // Debounce flag
+static bool capture_offered = false;           // Latest impact capture is queued to current connection
 
 // Possible modes of the app
 #define RAWv1 0
 #define RAWv2_FAST 1
 #define RAWv2_SLOW 2
+
+// Wake-on-motion and impact capture need interrupt function 2, which is taken by orientation events
+#define IMPACT_CAPTURE (LIS2DH12_CAPTURE_ENABLED && !(LIS2DH12_EVENTS & LIS2DH12_EVENT_ORIENTATION))
+#define MOTION_GATED (LIS2DH12_MOTION_ENABLED && !IMPACT_CAPTURE && !(LIS2DH12_EVENTS & LIS2DH12_EVENT_ORIENTATION))
 #define DEFAULT_MODE RAWv2_FAST
 
 // Must be UINT32_T as flash storage operated in 4-byte chunks
@@ -137,38 +165,215 @@ static const uint16_t advertising_sizes[] = {
 // Prototype declaration
 static void main_timer_handler(void * p_context);
 
+/**@brief Configure BME280 for a measurement every interval_ms milliseconds.
+ * With BME280_GOVERNOR_ENABLED oversampling and IIR are selected from noise targets and charge budget,
+ * otherwise fixed values of application_config.h are used. Sensor must be in sleep mode.
+ */
+static BME280_Ret configure_bme280(uint32_t interval_ms)
+{
+  // oversampling must be set for each used sensor.
+  bme280_config_t bme280_config = { .oversampling_temp  = BME280_TEMPERATURE_OVERSAMPLING,
+                                    .oversampling_press = BME280_PRESSURE_OVERSAMPLING,
+                                    .oversampling_hum   = BME280_HUMIDITY_OVERSAMPLING,
+                                    .iir                = BME280_IIR,
+                                    .interval           = BME280_DELAY,
+                                    .mode               = BME280_FORCED_MODE ? BME280_MODE_FORCED : BME280_MODE_NORMAL
+                                  };
+  if(BME280_GOVERNOR_ENABLED)
+  {
+    static const bme280_governor_target_t target = { .noise_temperature = BME280_GOVERNOR_NOISE_TEMPERATURE,
+                                                     .noise_humidity    = BME280_GOVERNOR_NOISE_HUMIDITY,
+                                                     .noise_pressure    = BME280_GOVERNOR_NOISE_PRESSURE,
+                                                     .budget_nc         = BME280_GOVERNOR_BUDGET_NC,
+                                                     .response_ms       = BME280_GOVERNOR_RESPONSE_MS
+                                                   };
+    bme280_governor_setting_t setting;
+    // In normal mode sensor converts once per standby time regardless of main loop.
+    bme280_governor_select(&target, BME280_FORCED_MODE ? interval_ms : BME280_DELAY_MS, &setting);
+    bme280_config.oversampling_temp  = setting.oversampling_temp;
+    bme280_config.oversampling_press = setting.oversampling_press;
+    bme280_config.oversampling_hum   = setting.oversampling_hum;
+    bme280_config.iir                = setting.iir;
+    NRF_LOG_INFO("BME280 governor: T %d P %d H %d IIR %d, %d nC\r\n", setting.oversampling_temp, setting.oversampling_press,
+                 setting.oversampling_hum, setting.iir, setting.charge_nc);
+  }
+  return bme280_configure(&bme280_config);
+}
+
+/**@brief Put BME280 to sleep and configure it for interval_ms main loop.
+ * Sensor is marked unavailable on failure, so that invalid values are sent instead of frozen ones.
+ */
+static void reconfigure_bme280(uint32_t interval_ms)
+{
+  if(bme280_set_mode(BME280_MODE_SLEEP) || configure_bme280(interval_ms))
+  {
+    NRF_LOG_ERROR("BME280 reconfiguration failed\r\n");
+    bme280_available = false;
+  }
+}
+
+/**@brief Returns true while BME280 is streamed over endpoint, stream owns the sensor and main loop only reads latest data.
+ * Restores main loop configuration once stream has stopped.
+ */
+static bool bme280_streaming(void)
+{
+  static bool streaming = false;
+  bool active = bme280_stream_active();
+  if(streaming && !active)
+  {
+    reconfigure_bme280((RAWv2_SLOW == tag_mode) ? MAIN_LOOP_INTERVAL_RAW_SLOW : MAIN_LOOP_INTERVAL_RAW);
+  }
+  streaming = active;
+  return active;
+}
+
+/**@brief Handle decoded accelerometer event, called in scheduler.
+ * Every hardware event counts as movement.
+ */
+static void lis2dh12_event_handler(const lis2dh12_event_t* const event)
+{
+  NRF_LOG_INFO("Accelerometer event %d, axes %x\r\n", event->type, event->axes);
+  acceleration_events++;
+}
+
+/**@brief Configure accelerometer hardware events of LIS2DH12_EVENTS.
+ * Durations are in samples, configure again after sample rate changes.
+ */
+static lis2dh12_ret_t configure_lis2dh12_events(void)
+{
+  lis2dh12_event_config_t config = LIS2DH12_EVENT_CONFIG_DEFAULT;
+  config.events = LIS2DH12_EVENTS;
+  return lis2dh12_events_configure(&config, lis2dh12_event_handler);
+}
+
+/**@brief Log time in accelerometer power states on wake-on-motion transitions, called in scheduler.
+ * Sample rate has changed, configure events again.
+ */
+static void lis2dh12_motion_handler(const lis2dh12_motion_state_t state)
+{
+  lis2dh12_motion_statistics_t statistics;
+  lis2dh12_motion_get_statistics(&statistics);
+  NRF_LOG_INFO("Accelerometer state %d, idle %d s, active %d s, wakeups %d\r\n", state,
+               (uint32_t)(statistics.idle_ms / 1000), (uint32_t)(statistics.active_ms / 1000), statistics.wakeups);
+  if(LIS2DH12_EVENTS) { configure_lis2dh12_events(); }
+}
+
+/**@brief Configure wake-on-motion with RAWv2 sample rate as active rate. Enters 1 Hz idle state.
+ */
+static lis2dh12_ret_t configure_lis2dh12_motion(void)
+{
+  lis2dh12_motion_config_t config = LIS2DH12_MOTION_CONFIG_DEFAULT;
+  config.active_sample_rate = LIS2DH12_SAMPLERATE_RAWv2;
+  config.active_resolution  = LIS2DH12_RESOLUTION;
+  config.wake_threshold_mg  = LIS2DH12_ACTIVITY_THRESHOLD;
+  config.sleep_threshold_mg = LIS2DH12_MOTION_SLEEP_THRESHOLD;
+  config.sleep_delay_ms     = LIS2DH12_MOTION_SLEEP_DELAY_MS;
+  return lis2dh12_motion_configure(&config, lis2dh12_motion_handler);
+}
+
+/**@brief Offer new impact capture to next connection, called in scheduler.
+ */
+static void lis2dh12_capture_handler(const lis2dh12_capture_header_t* const header)
+{
+  NRF_LOG_INFO("Impact capture %d at %d ms\r\n", header->sequence, header->trigger_ms);
+  capture_offered = false;
+}
+
+/**@brief Configure impact capture at LIS2DH12_CAPTURE_SAMPLERATE. Accelerometer keeps streaming to FIFO.
+ */
+static lis2dh12_ret_t configure_lis2dh12_capture(void)
+{
+  lis2dh12_capture_config_t config = LIS2DH12_CAPTURE_CONFIG_DEFAULT;
+  config.sample_rate  = LIS2DH12_CAPTURE_SAMPLERATE;
+  config.resolution   = LIS2DH12_RESOLUTION;
+  config.threshold_mg = LIS2DH12_CAPTURE_THRESHOLD;
+  config.post_samples = LIS2DH12_CAPTURE_POST_SAMPLES;
+  return lis2dh12_capture_configure(&config, lis2dh12_capture_handler);
+}
+
+/**@brief Queue latest impact capture to ACCELERATION endpoint once per connection.
+ * Bulk transfer frees its copy after sending, queue is dropped on disconnect.
+ */
+static void offer_capture(void)
+{
+  if(!is_ble_connected())
+  {
+    if(capture_offered) { ble_bulk_message_queue_purge(); }
+    capture_offered = false;
+    return;
+  }
+  const uint8_t* capture;
+  size_t length;
+  if(capture_offered || LIS2DH12_RET_OK != lis2dh12_capture_get(&capture, &length)) { return; }
+  uint8_t* copy = malloc(length);
+  if(NULL == copy) { return; }
+  memcpy(copy, capture, length);
+  if(TX_SUCCESS != ble_bulk_transfer_asynchronous(ACCELERATION, copy, length))
+  {
+    free(copy);
+    return;
+  }
+  capture_offered = true;
+  ble_message_queue_process();
+}
+
 /**@brief Handler for button press.
  * Called in scheduler, out of interrupt context.
  */
 void change_mode(void* data, uint16_t length)
 {
   app_timer_stop(main_timer_id);
+  uint32_t main_loop_interval = MAIN_LOOP_INTERVAL_RAW;
     switch(tag_mode)
     {  
       case RAWv2_SLOW:
-        lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv2);
-        app_timer_start(main_timer_id, APP_TIMER_TICKS(MAIN_LOOP_INTERVAL_RAW_SLOW, RUUVITAG_APP_TIMER_PRESCALER), NULL);
+        if(IMPACT_CAPTURE && lis2dh12_available) { configure_lis2dh12_capture(); }
+        else if(MOTION_GATED && lis2dh12_available) { configure_lis2dh12_motion(); }
+        else { lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv2); }
+        main_loop_interval = MAIN_LOOP_INTERVAL_RAW_SLOW;
         break;
 
       case RAWv2_FAST:
-        lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv2);
-        app_timer_start(main_timer_id, APP_TIMER_TICKS(MAIN_LOOP_INTERVAL_RAW, RUUVITAG_APP_TIMER_PRESCALER), NULL);
+        if(IMPACT_CAPTURE && lis2dh12_available) { configure_lis2dh12_capture(); }
+        else if(MOTION_GATED && lis2dh12_available) { configure_lis2dh12_motion(); }
+        else { lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv2); }
         break;
 
       case RAWv1:
       default:
+        // RAWv1 samples at 1 Hz anyway, restore resolution of idle state
+        if(MOTION_GATED && lis2dh12_available)
+        {
+          lis2dh12_motion_disable();
+          lis2dh12_set_resolution(LIS2DH12_RESOLUTION);
+        }
+        if(IMPACT_CAPTURE && lis2dh12_available)
+        {
+          lis2dh12_capture_disable();
+          lis2dh12_set_activity_interrupt_pin_2(LIS2DH12_ACTIVITY_THRESHOLD);
+        }
         lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv1);
-        app_timer_start(main_timer_id, APP_TIMER_TICKS(MAIN_LOOP_INTERVAL_RAW, RUUVITAG_APP_TIMER_PRESCALER), NULL);
         tag_mode = RAWv1;
         break;
     }
+  if(LIS2DH12_EVENTS && lis2dh12_available) { configure_lis2dh12_events(); }
+  app_timer_start(main_timer_id, APP_TIMER_TICKS(main_loop_interval, RUUVITAG_APP_TIMER_PRESCALER), NULL);
+  // Loop interval changes IIR response time, reselect oversampling. Cancel pending forced conversion first.
+  if(BME280_GOVERNOR_ENABLED && bme280_available && !bme280_streaming())
+  {
+    app_timer_stop(bme280_timer_id);
+    reconfigure_bme280(main_loop_interval);
+  }
+  advertising_interval = advertising_rates[tag_mode];
+  stable_loops = 0;
+  adaptive_step_time = millis();
   if(fast_advertising)
   {
     bluetooth_configure_advertising_interval(ADVERTISING_INTERVAL_STARTUP);
   }
   else
   {
-    bluetooth_configure_advertising_interval(advertising_rates[tag_mode]);
+    bluetooth_configure_advertising_interval(advertising_interval);
   }
   bluetooth_apply_configuration();
   NRF_LOG_INFO("Updating to %d mode\r\n", (uint32_t) tag_mode);
@@ -347,8 +552,72 @@ static void updateAdvertisement(void)
 }
 
 
+/**
+ * Check if environmental values have changed more than threshold during the change window.
+ * Invalid values are never considered as change.
+ */
+static bool environment_changed(const ruuvi_sensor_t* const data)
+{
+  bool changed = false;
+  if(millis() - environment_reference_time < ADAPTIVE_ADVERTISING_WINDOW) { return false; }
+
+  if(TEMPERATURE_INVALID != data->temperature && TEMPERATURE_INVALID != environment_reference.temperature)
+  {
+    changed |= abs(data->temperature - environment_reference.temperature) > ADAPTIVE_TEMPERATURE_THRESHOLD;
+  }
+  if(HUMIDITY_INVALID != data->humidity && HUMIDITY_INVALID != environment_reference.humidity)
+  {
+    changed |= abs((int32_t)(data->humidity - environment_reference.humidity)) > ADAPTIVE_HUMIDITY_THRESHOLD;
+  }
+  if(PRESSURE_INVALID != data->pressure && PRESSURE_INVALID != environment_reference.pressure)
+  {
+    changed |= abs((int32_t)(data->pressure - environment_reference.pressure)) > ADAPTIVE_PRESSURE_THRESHOLD;
+  }
+  environment_reference = *data;
+  environment_reference_time = millis();
+  return changed;
+}
+
+/**
+ * Adapt advertising interval to activity. Movement or environmental change returns the interval
+ * to the rate of current mode, stable readings back off exponentially to ADAPTIVE_ADVERTISING_CEILING.
+ * Environment is compared once per window, so each back-off step waits for at least one full window.
+ * Called from main loop after startup advertising has ended.
+ */
+static void adapt_advertising_interval(const ruuvi_sensor_t* const data)
+{
+  uint32_t interval = advertising_interval;
+  uint16_t fastest = advertising_rates[tag_mode];
+  uint16_t slowest = MAX(fastest, ADAPTIVE_ADVERTISING_CEILING);
+  bool moved = (acceleration_events != last_acceleration_events);
+  last_acceleration_events = acceleration_events;
+
+  if(environment_changed(data) || moved)
+  {
+    interval = fastest;
+    stable_loops = 0;
+    adaptive_step_time = millis();
+  }
+  else if(++stable_loops >= ADAPTIVE_ADVERTISING_STABLE_LOOPS &&
+          millis() - adaptive_step_time >= ADAPTIVE_ADVERTISING_WINDOW)
+  {
+    interval = MIN(interval * 2, slowest);
+    stable_loops = 0;
+    adaptive_step_time = millis();
+  }
+
+  if(interval != advertising_interval)
+  {
+    NRF_LOG_DEBUG("Advertising interval %d ms\r\n", interval);
+    advertising_interval = interval;
+    bluetooth_configure_advertising_interval(advertising_interval);
+    bluetooth_apply_configuration();
+  }
+}
+
 static void main_sensor_task(void* p_data, uint16_t length)
 {
+  COUNTER_INC(COUNTER_MEASUREMENTS);
   // Signal mode by led color.
   if (RAWv1 == tag_mode) { RED_LED_ON; }
   else { GREEN_LED_ON; }
@@ -359,7 +628,7 @@ static void main_sensor_task(void* p_data, uint16_t length)
                           .humidity = HUMIDITY_INVALID,
                           .pressure = PRESSURE_INVALID,
                           .temperature = TEMPERATURE_INVALID,
-                          .vbat = vbat
+                          .vbat = getBattery()
                         };
   lis2dh12_sensor_buffer_t buffer;
 
@@ -368,17 +637,22 @@ static void main_sensor_task(void* p_data, uint16_t length)
     fast_advertising = false;
     bluetooth_configure_advertisement_type(APPLICATION_ADVERTISEMENT_TYPE);
 
-    bluetooth_configure_advertising_interval(advertising_rates[tag_mode]);
+    advertising_interval = advertising_rates[tag_mode];
+    stable_loops = 0;
+    adaptive_step_time = millis();
+    bluetooth_configure_advertising_interval(advertising_interval);
     bluetooth_apply_configuration();
   }
 
   if (bme280_available)
   {
     // Get raw environmental data.
+    bme280_data_t environmental;
     bme280_read_measurements();
-    data.temperature = bme280_get_temperature();
-    data.pressure    = bme280_get_pressure();
-    data.humidity    = bme280_get_humidity();
+    bme280_get_data(&environmental);
+    data.temperature = environmental.temperature;
+    data.pressure    = environmental.pressure;
+    data.humidity    = environmental.humidity;
   }
   // If only temperature sensor is present.
   else
@@ -391,18 +665,25 @@ static void main_sensor_task(void* p_data, uint16_t length)
 
   if(lis2dh12_available)
   {
-    // Get accelerometer data.
-    lis2dh12_read_samples(&buffer, 1);
-    data.accX = buffer.sensor.x;
-    data.accY = buffer.sensor.y;
-    data.accZ = buffer.sensor.z;
+    // Recover wake-on-motion state if an edge on pin 2 was lost.
+    if(MOTION_GATED) { lis2dh12_motion_process(); }
+    // Get accelerometer data. Resolution is 8 bits while wake-on-motion is idle.
+    // Post-event samples of impact capture are read from FIFO, leave them to capture.
+    if(LIS2DH12_CAPTURE_POST != lis2dh12_capture_get_state())
+    {
+      lis2dh12_read_samples(&buffer, 1);
+      data.accX = buffer.sensor.x;
+      data.accY = buffer.sensor.y;
+      data.accZ = buffer.sensor.z;
+    }
+    if(IMPACT_CAPTURE) { offer_capture(); }
   }
 
   switch(tag_mode)
   {
     case RAWv2_FAST:
     case RAWv2_SLOW:
-      encodeToRawFormat5(data_buffer, &data, acceleration_events, BLE_TX_POWER);
+      encodeToRawFormat5Sequence(data_buffer, &data, acceleration_events, BLE_TX_POWER, measurement_sequence++);
       break;
     
     case RAWv1:
@@ -412,17 +693,58 @@ static void main_sensor_task(void* p_data, uint16_t length)
   }
 
   updateAdvertisement();
+  if(ADAPTIVE_ADVERTISING_ENABLED && !fast_advertising)
+  {
+    adapt_advertising_interval(&data);
+  }
+  if(ADVERTISING_TLM_PERIOD)
+  {
+    bluetooth_advertising_slot_set_eddystone_tlm(BLUETOOTH_ADV_SLOT_TLM, data.vbat, data.temperature, millis(), ADVERTISING_TLM_PERIOD);
+  }
+  if(ADVERTISING_COUNTERS_PERIOD)
+  {
+    uint8_t counters_frame[COUNTERS_ADV_LENGTH];
+    counters_encode_adv(counters_frame, sizeof(counters_frame));
+    bluetooth_advertising_slot_set_manufacturer_data(BLUETOOTH_ADV_SLOT_COUNTERS, counters_frame, sizeof(counters_frame), ADVERTISING_COUNTERS_PERIOD);
+  }
   watchdog_feed();
+  COUNTER_INC(COUNTER_WATCHDOG_FEEDS);
+}
+
+/**@brief Timeout handler for forced BME280 conversion, results are ready.
+ */
+static void bme280_timer_handler(void * p_context)
+{
+  app_sched_event_put (NULL, 0, main_sensor_task);
 }
 
 /**@brief Timeout handler for the repeated timer
+ * In forced mode starts BME280 conversion and delays sensor task until conversion is ready.
+ * Conversion is not triggered while BME280 is streamed over endpoint.
  */
 static void main_timer_handler(void * p_context)
 {
+  if(bme280_available && !bme280_streaming() && BME280_FORCED_MODE &&
+     BME280_RET_OK == bme280_start_forced_conversion(bme280_timer_id))
+  {
+    return;
+  }
   app_sched_event_put (NULL, 0, main_sensor_task);
 }
 
 
+/**
+ * @brief Handle interrupt from lis2dh12 pin 1.
+ * FIFO watermark of acceleration endpoint and tap / free-fall events share the pin.
+ * Watermark handler runs first, it takes time of the watermark sample.
+ **/
+static ret_code_t lis2dh12_int1_pin_handler(const ruuvi_standard_message_t message)
+{
+  lis2dh12_int1_handler(message);
+  if(LIS2DH12_EVENTS) { lis2dh12_events_interrupt_handler(message); }
+  return NRF_SUCCESS;
+}
+
 /**
  * @brief Handle interrupt from lis2dh12.
  * Never do long actions, such as sensor reads in interrupt context.
@@ -435,6 +757,12 @@ ret_code_t lis2dh12_int2_handler(const ruuvi_standard_message_t message)
 {
   NRF_LOG_DEBUG("Accelerometer interrupt to pin 2\r\n");
   acceleration_events++;
+  // Orientation changes are signaled on pin 2 instead of activity.
+  if(LIS2DH12_EVENTS & LIS2DH12_EVENT_ORIENTATION) { lis2dh12_events_interrupt_handler(message); }
+  // Wake-on-motion state changes are signaled on the same pin, return to idle counts once as movement.
+  if(MOTION_GATED) { lis2dh12_motion_interrupt_handler(message); }
+  // Activity interrupt freezes FIFO of impact capture.
+  if(IMPACT_CAPTURE) { lis2dh12_capture_interrupt_handler(message); }
   /*
   app_sched_event_put ((void*)(&message),
                        sizeof(message),
@@ -451,11 +779,19 @@ ret_code_t lis2dh12_int2_handler(const ruuvi_standard_message_t message)
  */
 static void on_radio_evt(bool active)
 {
-  // If radio is turned off (was active) and enough time has passed since last measurement
-  if(false == active && millis() - last_battery_measurement > APPLICATION_BATTERY_INTERVAL)
+  // Rotate interleaved advertisement slots
+  bluetooth_advertising_scheduler_radio_evt(active);
+
+  // Sample battery asynchronously, idle before radio event and loaded right after TX of the same event.
+  if(active && millis() - last_battery_measurement > APPLICATION_BATTERY_INTERVAL)
+  {
+    battery_loaded_due = (NRF_SUCCESS == battery_sample_start(BATTERY_SAMPLE_IDLE));
+    if(battery_loaded_due) { last_battery_measurement = millis(); }
+  }
+  else if(false == active && battery_loaded_due)
   {
-    vbat = getBattery();
-    last_battery_measurement = millis();
+    battery_loaded_due = false;
+    battery_sample_start(BATTERY_SAMPLE_LOADED);
   }
 }
 
@@ -486,13 +822,28 @@ int main(void)
   // watchdog_default_handler logs error and resets the tag.
   init_watchdog(NULL);
 
+  #if SCHED_PROFILE_ENABLED
+    // Time scheduler handlers, profile is read with STATUS_QUERY to SCHEDULER endpoint
+    sched_profile_init();
+    set_scheduler_handler(sched_profile_handler);
+  #endif
+
+  #if PROBE_ENABLED
+    // Time hot paths, probes are read with DATA_QUERY to SCHEDULER endpoint
+    probe_init();
+  #endif
+
   // Battery voltage initialization cannot fail under any reasonable circumstance.
   battery_voltage_init(); 
-  vbat = getBattery();
+  set_battery_handler(battery_handler); // Battery statistics over NUS
+  set_counters_handler(counters_handler); // Event counters since boot over NUS
 
-  if( vbat < BATTERY_MIN_V ) { init_status |=BATTERY_FAILED_INIT; }
+  if( getBattery() < BATTERY_MIN_V ) { init_status |=BATTERY_FAILED_INIT; }
   else NRF_LOG_INFO("BATTERY initalized \r\n"); 
 
+  // Read device address once for RAWv2 encoding.
+  initRawFormat5(NULL);
+
   if(init_lis2dh12() == NRF_SUCCESS )
   {
     lis2dh12_available = true;
@@ -526,10 +877,18 @@ int main(void)
   bluetooth_configure_advertisement_type(STARTUP_ADVERTISEMENT_TYPE);
   bluetooth_tx_power_set(BLE_TX_POWER);
   bluetooth_configure_advertising_interval(ADVERTISING_INTERVAL_STARTUP);
+  if(ADVERTISING_URL_PERIOD)
+  {
+    bluetooth_advertising_slot_set_eddystone_url(BLUETOOTH_ADV_SLOT_URL, ADVERTISING_URL, ADVERTISING_URL_LENGTH, ADVERTISING_URL_PERIOD);
+  }
+  if(ADVERTISING_IDENTITY_PERIOD)
+  {
+    bluetooth_advertising_slot_set_identity(BLUETOOTH_ADV_SLOT_IDENTITY, ADVERTISING_IDENTITY_PERIOD);
+  }
 
   // Priorities 2 and 3 are after SD timing critical events. 
   // 6, 7 after SD non-critical events.
-  // Triggers ADC, so use 3. 
+  // Starts ADC samples, so use 3. 
   ble_radio_notification_init(3,
                               NRF_RADIO_NOTIFICATION_DISTANCE_800US,
                               on_radio_evt);
@@ -561,7 +920,11 @@ int main(void)
   }
 
   if( init_rtc() ) { init_status |= RTC_FAILED_INIT; }
-  else { NRF_LOG_INFO("RTC initialized \r\n"); }
+  else
+  {
+    NRF_LOG_INFO("RTC initialized \r\n");
+    set_rtc_handler(rtc_time_handler); // Clients synchronise wall clock over NUS
+  }
 
   // Configure lis2dh12
   if (lis2dh12_available)    
@@ -581,18 +944,29 @@ int main(void)
     lis2dh12_set_sample_rate(LIS2DH12_SAMPLERATE_RAWv1);
     lis2dh12_set_resolution(LIS2DH12_RESOLUTION);
 
-    lis2dh12_set_activity_interrupt_pin_2(LIS2DH12_ACTIVITY_THRESHOLD);
+    // Orientation uses interrupt function 2 instead of activity detection, pin 2 handler dispatches it to events.
+    if(!(LIS2DH12_EVENTS & LIS2DH12_EVENT_ORIENTATION))
+    {
+      lis2dh12_set_activity_interrupt_pin_2(LIS2DH12_ACTIVITY_THRESHOLD);
+    }
+    // Tap and free-fall are signaled on pin 1, shared with FIFO watermark of acceleration endpoint.
+    if(LIS2DH12_EVENTS && configure_lis2dh12_events())
+    {
+      init_status |= ACCEL_INT_FAILED_INIT;
+    }
+    if(pin_interrupt_enable(INT_ACC1_PIN, NRF_GPIOTE_POLARITY_LOTOHI, NRF_GPIO_PIN_NOPULL, lis2dh12_int1_pin_handler))
+    {
+      init_status |= ACC_INT_FAILED_INIT;
+    }
     NRF_LOG_INFO("Accelerometer configuration done \r\n");
   }
   if(bme280_available)
   {
-    // oversampling must be set for each used sensor.
-    bme280_set_oversampling_hum  (BME280_HUMIDITY_OVERSAMPLING);
-    bme280_set_oversampling_temp (BME280_TEMPERATURE_OVERSAMPLING);
-    bme280_set_oversampling_press(BME280_PRESSURE_OVERSAMPLING);
-    bme280_set_iir(BME280_IIR);
-    bme280_set_interval(BME280_DELAY);
-    bme280_set_mode(BME280_MODE_NORMAL);
+    // In forced mode first sample is ready for first sensor task below.
+    if(configure_bme280(MAIN_LOOP_INTERVAL_RAW))
+    {
+      init_status |= BME_FAILED_INIT;
+    }
     NRF_LOG_INFO("BME280 configuration done \r\n");
   }
 
@@ -609,6 +983,11 @@ int main(void)
   {
     init_status |= TIMER_FAILED_INIT;
   }
+
+  if( app_timer_create(&bme280_timer_id, APP_TIMER_MODE_SINGLE_SHOT, bme280_timer_handler) )
+  {
+    init_status |= TIMER_FAILED_INIT;
+  }
   // Init starts timers, stop the reset
   app_timer_stop(reset_timer_id);
 
@@ -25,6 +25,8 @@
 #endif
 
 #define NRF_LOG_ENABLED 1  // Disable log output by default to save space (unless needed for testing)
+#define NRF_LOG_USES_TIMESTAMP 1    // Milliseconds since boot, RTC endpoint logs synchronisations to Unix time
+#define NRF_LOG_TIMESTAMP_DIGITS 10
 
 #if APP_GATT_PROFILE_ENABLED
   #define BLE_DIS_ENABLED 1  //Device information service
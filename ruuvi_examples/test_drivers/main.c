@@ -58,6 +58,7 @@
 #include  "test_rtc.h"
 #include  "test_environmental.h"
 #include  "test_lis2dh12.h"
+#include  "test_sensortag.h"
 #include  "test_mam.h"
 #include  "mam.h"
 
@@ -181,6 +182,7 @@ int main(void)
   test_led();
   test_nfc();
   test_environmental();
+  test_sensortag();
   
   test_byte_tryte_conversion();
   uint32_t test_end = millis();
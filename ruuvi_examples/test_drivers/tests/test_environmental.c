@@ -3,12 +3,61 @@
 #include "app_timer.h" //TODO: refactor scheduler dependency out of the driver
 #include "nrf_delay.h"
 #include "bme280.h"
+#include "spi.h"
+#include <string.h>
 
 #define NRF_LOG_MODULE_NAME "TEST_ENVIRONMENTAL"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 
 
+/**
+ *  Reloads calibration and compares burst-read parameters against register-by-register read.
+ *  Init should take 3 SPI transactions: WHO_AM_I and two calibration bursts.
+ */
+static void test_calibration(void)
+{
+  struct comp_params reference;
+  uint8_t e5 = bme280_read_reg(0xE5);
+  reference.dig_T1 = bme280_read_reg(BME280REG_CALIB_00)     | (bme280_read_reg(BME280REG_CALIB_00 + 1)  << 8);
+  reference.dig_T2 = bme280_read_reg(BME280REG_CALIB_00 + 2) | (bme280_read_reg(BME280REG_CALIB_00 + 3)  << 8);
+  reference.dig_T3 = bme280_read_reg(BME280REG_CALIB_00 + 4) | (bme280_read_reg(BME280REG_CALIB_00 + 5)  << 8);
+  reference.dig_P1 = bme280_read_reg(BME280REG_CALIB_00 + 6) | (bme280_read_reg(BME280REG_CALIB_00 + 7)  << 8);
+  reference.dig_P2 = bme280_read_reg(BME280REG_CALIB_00 + 8) | (bme280_read_reg(BME280REG_CALIB_00 + 9)  << 8);
+  reference.dig_P3 = bme280_read_reg(BME280REG_CALIB_00 + 10) | (bme280_read_reg(BME280REG_CALIB_00 + 11) << 8);
+  reference.dig_P4 = bme280_read_reg(BME280REG_CALIB_00 + 12) | (bme280_read_reg(BME280REG_CALIB_00 + 13) << 8);
+  reference.dig_P5 = bme280_read_reg(BME280REG_CALIB_00 + 14) | (bme280_read_reg(BME280REG_CALIB_00 + 15) << 8);
+  reference.dig_P6 = bme280_read_reg(BME280REG_CALIB_00 + 16) | (bme280_read_reg(BME280REG_CALIB_00 + 17) << 8);
+  reference.dig_P7 = bme280_read_reg(BME280REG_CALIB_00 + 18) | (bme280_read_reg(BME280REG_CALIB_00 + 19) << 8);
+  reference.dig_P8 = bme280_read_reg(BME280REG_CALIB_00 + 20) | (bme280_read_reg(BME280REG_CALIB_00 + 21) << 8);
+  reference.dig_P9 = bme280_read_reg(BME280REG_CALIB_00 + 22) | (bme280_read_reg(BME280REG_CALIB_00 + 23) << 8);
+  reference.dig_H1 = bme280_read_reg(0xA1);
+  reference.dig_H2 = bme280_read_reg(0xE1) | (bme280_read_reg(0xE2) << 8);
+  reference.dig_H3 = bme280_read_reg(0xE3);
+  reference.dig_H4 = (bme280_read_reg(0xE4) << 4) | (e5 & 0x0F);
+  reference.dig_H5 = (e5 >> 4) | (bme280_read_reg(0xE6) << 4);
+  reference.dig_H6 = bme280_read_reg(0xE7);
+
+  memset(&bme280.cp, 0, sizeof(bme280.cp));
+  uint32_t transactions = spi_get_transaction_count();
+  BME280_Ret status = bme280_init();
+  transactions = spi_get_transaction_count() - transactions;
+
+  bool match = reference.dig_T1 == bme280.cp.dig_T1 && reference.dig_T2 == bme280.cp.dig_T2 &&
+               reference.dig_T3 == bme280.cp.dig_T3 && reference.dig_P1 == bme280.cp.dig_P1 &&
+               reference.dig_P2 == bme280.cp.dig_P2 && reference.dig_P3 == bme280.cp.dig_P3 &&
+               reference.dig_P4 == bme280.cp.dig_P4 && reference.dig_P5 == bme280.cp.dig_P5 &&
+               reference.dig_P6 == bme280.cp.dig_P6 && reference.dig_P7 == bme280.cp.dig_P7 &&
+               reference.dig_P8 == bme280.cp.dig_P8 && reference.dig_P9 == bme280.cp.dig_P9 &&
+               reference.dig_H1 == bme280.cp.dig_H1 && reference.dig_H2 == bme280.cp.dig_H2 &&
+               reference.dig_H3 == bme280.cp.dig_H3 && reference.dig_H4 == bme280.cp.dig_H4 &&
+               reference.dig_H5 == bme280.cp.dig_H5 && reference.dig_H6 == bme280.cp.dig_H6;
+  NRF_LOG_INFO("Calibration reload status %d, %d SPI transactions, should be 3.\r\n", status, transactions);
+  NRF_LOG_INFO("Calibration matches register-by-register read: %s\r\n", (uint32_t)(match ? "PASS" : "FAIL"));
+  if(3 != transactions || !match) { NRF_LOG_ERROR("BME280 calibration test failed\r\n"); }
+  NRF_LOG_FLUSH();
+}
+
 void test_environmental(void)
 {
   NRF_LOG_INFO("Starting environmental test. Taking a few samples\r\n");
@@ -67,11 +116,17 @@ void test_environmental(void)
   NRF_LOG_FLUSH();
   nrf_delay_ms(10);
   err_code = bme280_set_mode(BME280_MODE_SLEEP);
-  bme280_set_oversampling_hum(BME280_OVERSAMPLING_16);
-  bme280_set_oversampling_temp(BME280_OVERSAMPLING_16);
-  bme280_set_oversampling_press(BME280_OVERSAMPLING_16);
+  bme280_config_t config = { .oversampling_temp  = BME280_OVERSAMPLING_16,
+                             .oversampling_press = BME280_OVERSAMPLING_16,
+                             .oversampling_hum   = BME280_OVERSAMPLING_16,
+                             .iir                = BME280_IIR_OFF,
+                             .interval           = BME280_STANDBY_1000_MS,
+                             .mode               = BME280_MODE_FORCED };
+  uint32_t transactions = spi_get_transaction_count();
+  err_code |= bme280_configure(&config);
+  transactions = spi_get_transaction_count() - transactions;
+  NRF_LOG_INFO("Configured in %d SPI transactions, should be 1.\r\n", transactions);
   NRF_LOG_INFO("Checking status register reading..\r\n");
-  err_code |= bme280_set_mode(BME280_MODE_FORCED);
   nrf_delay_ms(1);
   int  active = bme280_is_measuring();
   NRF_LOG_INFO("BME280 is taking sample? Should be 1: %d\r\n", (uint32_t)active);
@@ -119,4 +174,5 @@ void test_environmental(void)
     nrf_delay_ms(1100);
   }
   bme280_set_mode(BME280_MODE_SLEEP);
+  test_calibration();
 }
@@ -14,6 +14,9 @@
 
 /** Drivers **/
 #include "lis2dh12.h"
+#include "lis2dh12_events.h"
+#include "lis2dh12_motion.h"
+#include "lis2dh12_capture.h"
 #include "rtc.h"
 #include "pin_interrupt.h"
 
@@ -179,6 +182,117 @@ static void test_sample_rates(void)
   NRF_LOG_INFO("Sample rate test complete, above log should have one error at sample rate 0\r\n");
 }
 
+/**
+ *  Check that event configuration is routed to interrupt pins and latched,
+ *  and that disabling events releases pin 1 without touching FIFO interrupts.
+ */
+static void test_events(void)
+{
+  uint8_t value = 0;
+  lis2dh12_set_sample_rate(LIS2DH12_RATE_400);
+  lis2dh12_set_interrupts(LIS2DH12_I1_WTM, 1);
+  lis2dh12_event_config_t config = LIS2DH12_EVENT_CONFIG_DEFAULT;
+  config.events = LIS2DH12_EVENT_TAP | LIS2DH12_EVENT_DOUBLE_TAP | LIS2DH12_EVENT_FREE_FALL | LIS2DH12_EVENT_ORIENTATION;
+  if(lis2dh12_events_configure(&config, NULL)) { NRF_LOG_ERROR("Event configuration failed\r\n"); }
+
+  lis2dh12_read_register(LIS2DH12_CTRL_REG3, &value, 1);
+  if((LIS2DH12_I1_CLICK | LIS2DH12_I1_IA1 | LIS2DH12_I1_WTM) != value) { NRF_LOG_ERROR("CTRL_REG3 was %x\r\n", value); }
+  lis2dh12_read_register(LIS2DH12_CTRL_REG6, &value, 1);
+  if(!(LIS2DH12_I2C_INT2_MASK & value)) { NRF_LOG_ERROR("CTRL_REG6 was %x\r\n", value); }
+  lis2dh12_read_register(LIS2DH12_CTRL_REG5, &value, 1);
+  if((LIS2DH12_LIR_INT1_MASK | LIS2DH12_LIR_INT2_MASK) != (value & (LIS2DH12_LIR_INT1_MASK | LIS2DH12_LIR_INT2_MASK)))
+  {
+    NRF_LOG_ERROR("CTRL_REG5 was %x\r\n", value);
+  }
+  lis2dh12_read_register(LIS2DH12_CLICK_CFG, &value, 1);
+  if(0x3F != value) { NRF_LOG_ERROR("CLICK_CFG was %x\r\n", value); }
+  if(lis2dh12_events_process()) { NRF_LOG_ERROR("Event processing failed\r\n"); }
+
+  config.events = LIS2DH12_EVENT_NONE;
+  lis2dh12_events_configure(&config, NULL);
+  lis2dh12_read_register(LIS2DH12_CTRL_REG3, &value, 1);
+  if(LIS2DH12_I1_WTM != value) { NRF_LOG_ERROR("CTRL_REG3 was %x after disabling events\r\n", value); }
+  lis2dh12_set_interrupts(0, 1);
+  lis2dh12_set_interrupts(0, 2);
+  NRF_LOG_INFO("Event configuration test complete\r\n");
+}
+
+/**
+ *  Check that wake-on-motion idles at 1 Hz 8-bit with only activity routed to pin 2,
+ *  and that activity / inactivity registers are written as given.
+ */
+static void test_motion(void)
+{
+  uint8_t value = 0;
+  lis2dh12_set_scale(LIS2DH12_SCALE2G);
+  lis2dh12_motion_config_t config = LIS2DH12_MOTION_CONFIG_DEFAULT;
+  if(lis2dh12_motion_configure(&config, NULL)) { NRF_LOG_ERROR("Motion configuration failed\r\n"); }
+  if(LIS2DH12_MOTION_IDLE != lis2dh12_motion_get_state()) { NRF_LOG_ERROR("Motion state was not idle\r\n"); }
+
+  lis2dh12_read_register(LIS2DH12_CTRL_REG1, &value, 1);
+  if((LIS2DH12_RATE_1 | LIS2DH12_LPEN_MASK) != (value & (LIS2DH12_ODR_MASK | LIS2DH12_LPEN_MASK)))
+  {
+    NRF_LOG_ERROR("CTRL_REG1 was %x in idle\r\n", value);
+  }
+  lis2dh12_read_register(LIS2DH12_CTRL_REG6, &value, 1);
+  if(LIS2DH12_I2C_INT2_MASK != value) { NRF_LOG_ERROR("CTRL_REG6 was %x in idle\r\n", value); }
+  lis2dh12_read_register(LIS2DH12_ACT_THS, &value, 1);
+  if(0 != value) { NRF_LOG_ERROR("ACT_THS was %x in idle\r\n", value); }
+
+  lis2dh12_set_activity_threshold(4);
+  lis2dh12_set_activity_duration(37);
+  lis2dh12_read_register(LIS2DH12_ACT_THS, &value, 1);
+  if(4 != value) { NRF_LOG_ERROR("ACT_THS was %x\r\n", value); }
+  lis2dh12_read_register(LIS2DH12_ACT_DUR, &value, 1);
+  if(37 != value) { NRF_LOG_ERROR("ACT_DUR was %x\r\n", value); }
+
+  lis2dh12_motion_disable();
+  if(LIS2DH12_MOTION_DISABLED != lis2dh12_motion_get_state()) { NRF_LOG_ERROR("Motion state was not disabled\r\n"); }
+  lis2dh12_read_register(LIS2DH12_ACT_THS, &value, 1);
+  if(0 != value) { NRF_LOG_ERROR("ACT_THS was %x after disabling\r\n", value); }
+  lis2dh12_set_interrupts(0, 2);
+  NRF_LOG_INFO("Wake-on-motion configuration test complete\r\n");
+}
+
+/**
+ *  Check that impact capture streams to FIFO with trigger on pin 2 and fills FIFO before trigger,
+ *  and that disabling returns FIFO to bypass.
+ */
+static void test_capture(void)
+{
+  uint8_t value = 0;
+  size_t count = 0;
+  const uint8_t* data = NULL;
+  lis2dh12_set_scale(LIS2DH12_SCALE2G);
+  lis2dh12_capture_config_t config = LIS2DH12_CAPTURE_CONFIG_DEFAULT;
+  config.post_samples = LIS2DH12_CAPTURE_MAX_POST + 1;
+  if(LIS2DH12_RET_INVALID != lis2dh12_capture_configure(&config, NULL)) { NRF_LOG_ERROR("Too long capture was accepted\r\n"); }
+  config.post_samples = LIS2DH12_CAPTURE_MAX_POST;
+  if(lis2dh12_capture_configure(&config, NULL)) { NRF_LOG_ERROR("Capture configuration failed\r\n"); }
+  if(LIS2DH12_CAPTURE_ARMED != lis2dh12_capture_get_state()) { NRF_LOG_ERROR("Capture state was not armed\r\n"); }
+
+  lis2dh12_read_register(LIS2DH12_FIFO_CTRL_REG, &value, 1);
+  if((LIS2DH12_MODE_STREAM_TO_FIFO | LIS2DH12_TR_MASK) != (value & (LIS2DH12_FM_MASK | LIS2DH12_TR_MASK)))
+  {
+    NRF_LOG_ERROR("FIFO_CTRL_REG was %x when armed\r\n", value);
+  }
+  lis2dh12_read_register(LIS2DH12_CTRL_REG6, &value, 1);
+  if(!(LIS2DH12_I2C_INT2_MASK & value)) { NRF_LOG_ERROR("CTRL_REG6 was %x when armed\r\n", value); }
+  // 32 samples at 100 Hz
+  nrf_delay_ms(400);
+  lis2dh12_get_fifo_sample_number(&count);
+  if(LIS2DH12_FIFO_MAX_LENGTH > count + 1) { NRF_LOG_ERROR("FIFO had %d samples when armed\r\n", count); }
+  if(LIS2DH12_RET_INVALID != lis2dh12_capture_get(&data, &count)) { NRF_LOG_ERROR("Capture was ready before trigger\r\n"); }
+
+  lis2dh12_capture_disable();
+  if(LIS2DH12_CAPTURE_DISABLED != lis2dh12_capture_get_state()) { NRF_LOG_ERROR("Capture state was not disabled\r\n"); }
+  lis2dh12_read_register(LIS2DH12_FIFO_CTRL_REG, &value, 1);
+  if(LIS2DH12_MODE_BYPASS != (value & LIS2DH12_FM_MASK)) { NRF_LOG_ERROR("FIFO_CTRL_REG was %x after disabling\r\n", value); }
+  lis2dh12_set_fifo_trigger(1);
+  lis2dh12_set_interrupts(0, 2);
+  NRF_LOG_INFO("Impact capture configuration test complete\r\n");
+}
+
 /*
 static void test_activity_detection(void)
 {
@@ -246,6 +360,15 @@ void test_lis2dh12(void)
   // Test sample rates - Depends on FIFO, watermark, RTC, pin interrupt
   test_sample_rates();
   
+  // Test event engine configuration
+  test_events();
+
+  // Test wake-on-motion configuration
+  test_motion();
+
+  // Test impact capture configuration
+  test_capture();
+
   //Test activity detection
   //test_activity_detection();
 
@@ -0,0 +1,172 @@
+#include "test_sensortag.h"
+
+/** STDLIB **/
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/** Drivers **/
+#include "rtc.h"
+
+/** Ruuvi libs **/
+#include "sensortag.h"
+
+#define NRF_LOG_MODULE_NAME "TEST_SENSORTAG"
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+
+#define BENCHMARK_ROUNDS 10000
+
+static const uint8_t test_mac[RAW2_MAC_LENGTH] = {0xC1, 0x23, 0x45, 0x67, 0x89, 0xAB};
+
+// Test vectors: typical values, extremes of valid range and invalid values.
+static const ruuvi_sensor_t test_vectors[] = {
+  { .temperature = 2134,  .humidity = 45 * 1024,  .pressure = 101325 << 8, .accX = 12,   .accY = -1000, .accZ = 1016,  .vbat = 2977 },
+  { .temperature = -2134, .humidity = 0,          .pressure = 50000 << 8,  .accX = -32767, .accY = 32767, .accZ = 0,   .vbat = 1600 },
+  { .temperature = 16383, .humidity = 100 * 1024, .pressure = 115534 << 8, .accX = 0,    .accY = 0,     .accZ = 0,     .vbat = 3646 },
+  { .temperature = -16383, .humidity = 1,         .pressure = (50000 << 8) + 255, .accX = 1, .accY = -1, .accZ = 2,   .vbat = 1601 },
+  { .temperature = TEMPERATURE_INVALID, .humidity = HUMIDITY_INVALID, .pressure = PRESSURE_INVALID,
+    .accX = ACCELERATION_INVALID, .accY = ACCELERATION_INVALID, .accZ = ACCELERATION_INVALID, .vbat = 3000 }
+};
+
+/**
+ *  Reference encoder, encodeToRawFormat5 as it was before saturation was added.
+ *  Valid values must encode identically.
+ */
+static void reference_encode(uint8_t* data_buffer, const ruuvi_sensor_t* const data, uint16_t acceleration_events, int8_t tx_pwr, uint16_t sequence)
+{
+  data_buffer[0] = RAW_FORMAT_2;
+  int32_t temperature = data->temperature;
+  temperature *= 2;
+  if(data->temperature == TEMPERATURE_INVALID) { temperature = TEMPERATURE_INVALID; }
+  data_buffer[1] = (temperature)>>8;
+  data_buffer[2] = (temperature)&0xFF;
+  uint32_t humidity = data->humidity * 400 / 1024;
+  if(data->humidity == HUMIDITY_INVALID) { humidity = HUMIDITY_INVALID; }
+  data_buffer[3] = humidity>>8;
+  data_buffer[4] = humidity&0xFF;
+  uint32_t pressure = data->pressure;
+  pressure = (uint16_t)((pressure >> 8) - 50000);
+  if(data->pressure == PRESSURE_INVALID) { pressure = PRESSURE_INVALID; }
+  data_buffer[5] = (pressure)>>8;
+  data_buffer[6] = (pressure)&0xFF;
+  data_buffer[7] = (data->accX)>>8;
+  data_buffer[8] = (data->accX)&0xFF;
+  data_buffer[9] = (data->accY)>>8;
+  data_buffer[10] = (data->accY)&0xFF;
+  data_buffer[11] = (data->accZ)>>8;
+  data_buffer[12] = (data->accZ)&0xFF;
+  uint16_t vbatt = data->vbat;
+  vbatt -= 1600;
+  vbatt <<= 5;
+  data_buffer[13] = (vbatt)>>8;
+  data_buffer[14] = (vbatt)&0xFF;
+  tx_pwr += 40;
+  tx_pwr /= 2;
+  data_buffer[14] |= (tx_pwr)&0x1F;
+  data_buffer[15] = acceleration_events % 256;
+  data_buffer[16] = sequence>>8;
+  data_buffer[17] = sequence&0xFF;
+  memcpy(&data_buffer[RAW2_MAC_OFFSET], test_mac, sizeof(test_mac));
+}
+
+/** Encode, compare to reference, decode and re-encode. Returns number of errors. */
+static uint32_t test_round_trip(const ruuvi_sensor_t* const data, uint16_t events, int8_t tx_pwr, uint16_t sequence)
+{
+  uint32_t errors = 0;
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  uint8_t reference[RAW_2_ENCODED_DATA_LENGTH];
+  uint8_t reencoded[RAW_2_ENCODED_DATA_LENGTH];
+  ruuvi_sensor_t decoded;
+  uint8_t decoded_events = 0;
+  int8_t decoded_tx_pwr = 0;
+  uint16_t decoded_sequence = 0;
+
+  encodeToRawFormat5Sequence(encoded, data, events, tx_pwr, sequence);
+  reference_encode(reference, data, events, tx_pwr, sequence);
+  if(memcmp(encoded, reference, sizeof(encoded)))
+  {
+    NRF_LOG_ERROR("Encoding differs from reference, temperature %d\r\n", data->temperature);
+    errors++;
+  }
+  if(!decodeRawFormat5(encoded, &decoded, &decoded_events, &decoded_tx_pwr, &decoded_sequence))
+  {
+    NRF_LOG_ERROR("Decoder did not recognise RAWv2\r\n");
+    return ++errors;
+  }
+  encodeToRawFormat5Sequence(reencoded, &decoded, decoded_events, decoded_tx_pwr, decoded_sequence);
+  if(memcmp(encoded, reencoded, sizeof(encoded)))
+  {
+    NRF_LOG_ERROR("Round trip is not bit-exact, temperature %d\r\n", data->temperature);
+    errors++;
+  }
+  if(decoded_sequence != sequence || decoded_events != (events & 0xFF) || decoded_tx_pwr != tx_pwr)
+  {
+    NRF_LOG_ERROR("Round trip of counters failed\r\n");
+    errors++;
+  }
+  return errors;
+}
+
+/** Out-of-range values must saturate instead of wrapping into valid-looking data. */
+static uint32_t test_saturation(void)
+{
+  uint32_t errors = 0;
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  ruuvi_sensor_t data = { .temperature = 20000, .humidity = 200 * 1024, .pressure = 200000 << 8,
+                          .accX = 0, .accY = 0, .accZ = 0, .vbat = 1000 };
+  encodeToRawFormat5Sequence(encoded, &data, 0, 30, 0);
+  if(0x7F != encoded[1] || 0xFF != encoded[2]) { errors++; }
+  if(0xFF != encoded[3] || 0xFE != encoded[4]) { errors++; }
+  if(0xFF != encoded[5] || 0xFE != encoded[6]) { errors++; }
+  if(0x00 != encoded[13] || RAW2_TX_POWER_MAX != encoded[14]) { errors++; }
+  data.temperature = -20000;
+  data.pressure = 40000 << 8;
+  encodeToRawFormat5Sequence(encoded, &data, 0, INT8_MIN, 0);
+  if(0x80 != encoded[1] || 0x01 != encoded[2]) { errors++; }
+  if(0x00 != encoded[5] || 0x00 != encoded[6]) { errors++; }
+  if(RAW2_TX_POWER_INVALID != (encoded[14] & 0x1F)) { errors++; }
+  return errors;
+}
+
+void test_sensortag(void)
+{
+  NRF_LOG_INFO("Starting RAWv2 encoder test.\r\n");
+  uint32_t errors = 0;
+  initRawFormat5(test_mac);
+
+  for(size_t ii = 0; ii < sizeof(test_vectors)/sizeof(test_vectors[0]); ii++)
+  {
+    errors += test_round_trip(&test_vectors[ii], ii * 100, 4, 0xFFFE + ii);
+  }
+  // Sweep valid temperature and humidity range
+  ruuvi_sensor_t sweep = test_vectors[0];
+  for(int32_t temperature = -16383; temperature <= 16383; temperature += 7)
+  {
+    sweep.temperature = temperature;
+    sweep.humidity = (temperature + 16383) * 5;
+    errors += test_round_trip(&sweep, temperature, ((temperature & 0xFFFF) % 31) * 2 - 40, temperature);
+  }
+  errors += test_saturation();
+  NRF_LOG_INFO("RAWv2 encoder test done, %d errors.\r\n", errors);
+  NRF_LOG_FLUSH();
+
+  uint8_t encoded[RAW_2_ENCODED_DATA_LENGTH];
+  uint32_t start = millis();
+  for(uint16_t ii = 0; ii < BENCHMARK_ROUNDS; ii++)
+  {
+    encodeToRawFormat5Sequence(encoded, &test_vectors[0], ii, 4, ii);
+  }
+  uint32_t encoder_time = millis() - start;
+  start = millis();
+  for(uint16_t ii = 0; ii < BENCHMARK_ROUNDS; ii++)
+  {
+    reference_encode(encoded, &test_vectors[0], ii, 4, ii);
+  }
+  uint32_t reference_time = millis() - start;
+  NRF_LOG_INFO("%d encodes: %d ms, reference %d ms.\r\n", BENCHMARK_ROUNDS, encoder_time, reference_time);
+  NRF_LOG_FLUSH();
+
+  // Restore device address for application use
+  initRawFormat5(NULL);
+}
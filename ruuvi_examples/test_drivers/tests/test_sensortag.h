@@ -0,0 +1,4 @@
+#ifndef TEST_SENSORTAG_H
+#define TEST_SENSORTAG_H
+void test_sensortag(void);
+#endif